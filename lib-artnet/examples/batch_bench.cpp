@@ -0,0 +1,202 @@
+/**
+ * @file batch_bench.cpp
+ *
+ * Sends bursts of ArtDmx to a node on the loopback interface and compares
+ * the packets per second of HandlePacket and HandlePackets.
+ *
+ * Usage: batch_bench [SetData nanoseconds=0]
+ * The output can be made to spend some time in each SetData, as a real output does,
+ * for example about 1000 ns to encode a universe of WS2812B LEDs.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "hardwarelinux.h"
+#include "networklinux.h"
+#include "ledblinklinux.h"
+
+#include "artnetnode.h"
+#include "packets.h"
+
+#include "lightset.h"
+
+#define PORTS			4
+#define BURST			16		///< ArtDmx packets per burst, as ARTNET_BATCH_PACKETS
+#define BURSTS			20000
+
+static double nanos(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+class CountingOutput: public LightSet {
+public:
+	CountingOutput(uint32_t nSetDataNanos) : m_nSetData(0), m_nSetDataNanos(nSetDataNanos) {
+	}
+
+	void Start(uint8_t nPort) {
+	}
+
+	void Stop(uint8_t nPort) {
+	}
+
+	void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength) {
+		m_nSetData++;
+
+		if (m_nSetDataNanos != 0) {
+			const double fEnd = nanos() + m_nSetDataNanos;
+			while (nanos() < fEnd) {
+			}
+		}
+	}
+
+	uint32_t GetSetData(void) const {
+		return m_nSetData;
+	}
+
+	void Reset(void) {
+		m_nSetData = 0;
+	}
+
+private:
+	uint32_t m_nSetData;
+	uint32_t m_nSetDataNanos;
+};
+
+/*
+ * One burst: BURST / PORTS ArtDmx packets for each port, the data changes with every packet
+ */
+static void send_burst(int nSocket, const struct sockaddr_in *pNode, uint32_t nBurst) {
+	struct TArtDmx dmx;
+
+	memset(&dmx, 0, sizeof(struct TArtDmx));
+	memcpy(dmx.Id, NODE_ID, sizeof(dmx.Id));
+	dmx.OpCode = OP_DMX;
+	dmx.ProtVerLo = ARTNET_PROTOCOL_REVISION;
+	dmx.LengthHi = (ARTNET_DMX_LENGTH >> 8);
+	dmx.Length = (ARTNET_DMX_LENGTH & 0xFF);
+
+	for (uint32_t i = 0; i < BURST; i++) {
+		dmx.PortAddress = (uint16_t) (i % PORTS);
+		dmx.Data[0] = (uint8_t) (nBurst + i);
+
+		if (sendto(nSocket, &dmx, sizeof(struct TArtDmx), 0, (const struct sockaddr *) pNode, sizeof(struct sockaddr_in)) < 0) {
+			perror("sendto");
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+/*
+ * Nanoseconds spent in the node for BURSTS bursts; sending is not timed
+ */
+static double run(ArtNetNode& node, int nSocket, const struct sockaddr_in *pNode, bool bBatch) {
+	double fTotal = 0;
+
+	for (uint32_t nBurst = 0; nBurst < BURSTS; nBurst++) {
+		send_burst(nSocket, pNode, nBurst);
+
+		const double fStart = nanos();
+		int nHandled = 0;
+
+		while (nHandled < BURST) {
+			if (bBatch) {
+				nHandled += node.HandlePackets();
+			} else {
+				node.HandlePacket();
+				nHandled++;
+			}
+		}
+
+		fTotal += nanos() - fStart;
+	}
+
+	return fTotal;
+}
+
+int main(int argc, char **argv) {
+	HardwareLinux hw;
+	NetworkLinux nw;
+	LedBlinkLinux lb;
+	ArtNetNode node;
+	CountingOutput output((argc > 1) ? (uint32_t) atoi(argv[1]) : 0);
+
+	if (nw.Init("lo") < 0) {
+		fprintf(stderr, "Not able to start the network on lo\n");
+		return EXIT_FAILURE;
+	}
+
+	for (uint8_t i = 0; i < PORTS; i++) {
+		node.SetUniverseSwitch(i, ARTNET_OUTPUT_PORT, i);
+	}
+
+	node.SetOutput(&output);
+	node.Start();
+
+	const int nSocket = socket(AF_INET, SOCK_DGRAM, 0);
+
+	if (nSocket < 0) {
+		perror("socket");
+		return EXIT_FAILURE;
+	}
+
+	struct sockaddr_in node_address;
+
+	memset(&node_address, 0, sizeof(struct sockaddr_in));
+	node_address.sin_family = AF_INET;
+	node_address.sin_port = htons(ARTNET_UDP_PORT);
+	node_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	// Discard the ArtPollReply sent by Start, and anything else queued
+	while (node.HandlePacket() > 0) {
+	}
+
+	printf("%d bursts of %d ArtDmx on %d ports, SetData %s ns\n", BURSTS, BURST, PORTS, (argc > 1) ? argv[1] : "0");
+
+	const double fSingle = run(node, nSocket, &node_address, false);
+	const uint32_t nSetDataSingle = output.GetSetData();
+
+	output.Reset();
+
+	const double fBatch = run(node, nSocket, &node_address, true);
+	const uint32_t nSetDataBatch = output.GetSetData();
+
+	const double fPackets = (double) BURSTS * BURST;
+
+	printf("HandlePacket  %7.0f k packets/s, %.2f SetData per packet\n", fPackets / fSingle * 1e6, nSetDataSingle / fPackets);
+	printf("HandlePackets %7.0f k packets/s, %.2f SetData per packet\n", fPackets / fBatch * 1e6, nSetDataBatch / fPackets);
+
+	close(nSocket);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,301 @@
+/**
+ * @file dispatch_test.cpp
+ *
+ * Sends ArtDmx from two sources on the loopback interface and checks which ports
+ * are output, and with what data: the Port-Address table, ports sharing a Port-Address,
+ * and the merge state of each port, merge timeout included.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "hardwarelinux.h"
+#include "networklinux.h"
+#include "ledblinklinux.h"
+
+#include "artnetnode.h"
+#include "packets.h"
+
+#include "lightset.h"
+
+#define PORTS			8		///< 2 ArtPollReply pages
+#define SOURCE_A		0x7F000002	///< 127.0.0.2
+#define SOURCE_B		0x7F000003	///< 127.0.0.3
+#define MERGE_TIMEOUT	10			///< ARTNET_MERGE_TIMEOUT_SECONDS in artnetnode.cpp
+
+class RecordingOutput: public LightSet {
+public:
+	RecordingOutput(void) {
+		Reset();
+	}
+
+	void Start(uint8_t nPort) {
+	}
+
+	void Stop(uint8_t nPort) {
+	}
+
+	void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength) {
+		if (nPort < PORTS) {
+			m_nSetData[nPort]++;
+			m_nLength[nPort] = nLength;
+			m_aData[nPort][0] = pData[0];
+			m_aData[nPort][1] = pData[1];
+		}
+	}
+
+	void Reset(void) {
+		memset(m_nSetData, 0, sizeof(m_nSetData));
+		memset(m_nLength, 0, sizeof(m_nLength));
+		memset(m_aData, 0, sizeof(m_aData));
+	}
+
+	/**
+	 * @return the ports output since the previous Reset, one bit per port
+	 */
+	uint32_t GetPorts(void) const {
+		uint32_t nPorts = 0;
+
+		for (uint32_t i = 0; i < PORTS; i++) {
+			if (m_nSetData[i] != 0) {
+				nPorts |= (1U << i);
+			}
+		}
+
+		return nPorts;
+	}
+
+	uint16_t GetLength(uint8_t nPort) const {
+		return m_nLength[nPort];
+	}
+
+	bool IsData(uint8_t nPort, uint8_t nSlot1, uint8_t nSlot2) const {
+		return (m_aData[nPort][0] == nSlot1) && (m_aData[nPort][1] == nSlot2);
+	}
+
+private:
+	uint32_t m_nSetData[PORTS];
+	uint16_t m_nLength[PORTS];
+	uint8_t m_aData[PORTS][2];
+};
+
+static ArtNetNode *s_pNode;
+static RecordingOutput s_Output;
+static int s_nErrors;
+
+static void check(bool bCondition, const char *pWhat) {
+	if (!bCondition) {
+		printf("FAIL: %s\n", pWhat);
+		s_nErrors++;
+	}
+}
+
+static int open_source(uint32_t nIp) {
+	const int nSocket = socket(AF_INET, SOCK_DGRAM, 0);
+	struct sockaddr_in address;
+
+	memset(&address, 0, sizeof(struct sockaddr_in));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(nIp);
+
+	if ((nSocket < 0) || (bind(nSocket, (struct sockaddr *) &address, sizeof(struct sockaddr_in)) < 0)) {
+		perror("source");
+		exit(EXIT_FAILURE);
+	}
+
+	return nSocket;
+}
+
+/*
+ * Sends an ArtDmx with the first 2 slots set, and lets the node handle it.
+ * The header always claims 512 slots, nSlots are sent.
+ */
+static void send_dmx(int nSocket, uint16_t nPortAddress, uint8_t nSlot1, uint8_t nSlot2, uint16_t nSlots = ARTNET_DMX_LENGTH) {
+	struct TArtDmx dmx;
+	struct sockaddr_in node_address;
+
+	memset(&dmx, 0, sizeof(struct TArtDmx));
+	memcpy(dmx.Id, NODE_ID, sizeof(dmx.Id));
+	dmx.OpCode = OP_DMX;
+	dmx.ProtVerLo = ARTNET_PROTOCOL_REVISION;
+	dmx.PortAddress = nPortAddress;
+	dmx.LengthHi = (ARTNET_DMX_LENGTH >> 8);
+	dmx.Length = (ARTNET_DMX_LENGTH & 0xFF);
+	dmx.Data[0] = nSlot1;
+	dmx.Data[1] = nSlot2;
+
+	memset(&node_address, 0, sizeof(struct sockaddr_in));
+	node_address.sin_family = AF_INET;
+	node_address.sin_port = htons(ARTNET_UDP_PORT);
+	node_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (sendto(nSocket, &dmx, __builtin_offsetof(struct TArtDmx, Data) + nSlots, 0, (struct sockaddr *) &node_address, sizeof(struct sockaddr_in)) < 0) {
+		perror("sendto");
+		exit(EXIT_FAILURE);
+	}
+
+	s_pNode->HandlePacket();
+}
+
+static void test_dispatch(int nSource) {
+	char what[64];
+
+	// Port 2 shares Port-Address 0 with port 0
+	check(s_pNode->GetPortAddress(2) == 0, "port 2 has Port-Address 0");
+
+	static const struct {
+		uint16_t nPortAddress;
+		uint32_t nPorts;
+	} expected[] = {
+		{0x000, (1U << 0) | (1U << 2)},
+		{0x001, (1U << 1)},
+		{0x002, 0},
+		{0x003, (1U << 3)},
+		{0x004, (1U << 4)},
+		{0x007, (1U << 7)},
+		{0x010, 0},		// Another Sub-Net
+		{0x100, 0}	// Another Net
+	};
+
+	for (uint32_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+		s_Output.Reset();
+		send_dmx(nSource, expected[i].nPortAddress, (uint8_t) (i + 1), 0);
+
+		snprintf(what, sizeof(what), "Port-Address 0x%03x: ports 0x%02x, expected 0x%02x", expected[i].nPortAddress, s_Output.GetPorts(), expected[i].nPorts);
+		check(s_Output.GetPorts() == expected[i].nPorts, what);
+	}
+}
+
+/*
+ * The slots beyond the received datagram are not output
+ */
+static void test_truncated(int nSource) {
+	s_Output.Reset();
+	send_dmx(nSource, 0x001, 0x55, 0xAA, 4);
+
+	check(s_Output.GetPorts() == (1U << 1), "truncated: port 1 is output");
+	check(s_Output.GetLength(1) == 4, "truncated: 4 slots are output");
+	check(s_Output.IsData(1, 0x55, 0xAA), "truncated: the slots are output");
+}
+
+static void test_merge(int nSourceA, int nSourceB) {
+	// Ports 1, 4 and 5 merge A and B
+	send_dmx(nSourceA, 0x001, 10, 0);
+	send_dmx(nSourceB, 0x001, 0, 20);
+	check(s_Output.IsData(1, 10, 20), "port 1 merges HTP");
+
+	send_dmx(nSourceA, 0x004, 1, 0);
+	send_dmx(nSourceB, 0x004, 0, 30);
+	check(s_Output.IsData(4, 1, 30), "port 4 merges HTP");
+
+	send_dmx(nSourceA, 0x005, 4, 0);
+	send_dmx(nSourceB, 0x005, 0, 40);
+	check(s_Output.IsData(5, 4, 40), "port 5 merges HTP");
+
+	// Port 3 has one source, A
+	send_dmx(nSourceA, 0x003, 5, 5);
+	send_dmx(nSourceA, 0x003, 6, 1);
+	check(s_Output.IsData(3, 6, 1), "port 3 with one source is not merged");
+
+	printf("Waiting %d seconds for the merge timeout ...\n", MERGE_TIMEOUT + 2);
+
+	// B stops sending to ports 1 and 4, it stays alive on port 5
+	for (int i = 0; i < MERGE_TIMEOUT - 1; i++) {
+		sleep(1);
+		send_dmx(nSourceA, 0x001, 10, 0);
+		send_dmx(nSourceA, 0x004, 1, 0);
+		send_dmx(nSourceA, 0x005, 4, 0);
+		send_dmx(nSourceB, 0x005, 0, 40);
+	}
+
+	// Only B has timed out, on ports 1 and 4, when the next packets arrive
+	sleep(3);
+
+	// The first packet of A on each port finds B timed out, the second one is output as A only
+	send_dmx(nSourceA, 0x001, 3, 0);
+	send_dmx(nSourceA, 0x001, 3, 0);
+	check(s_Output.IsData(1, 3, 0), "port 1 leaves merging after the timeout of B");
+
+	// The timeout on port 1 does not end the merge of another port, nor hide the timeout of B on it
+	send_dmx(nSourceA, 0x004, 2, 0);
+	send_dmx(nSourceA, 0x004, 2, 0);
+	check(s_Output.IsData(4, 2, 0), "port 4 leaves merging after the timeout of B");
+
+	send_dmx(nSourceA, 0x005, 5, 0);
+	send_dmx(nSourceA, 0x005, 5, 0);
+	check(s_Output.IsData(5, 5, 40), "port 5 keeps merging");
+}
+
+int main(int argc, char **argv) {
+	HardwareLinux hw;
+	NetworkLinux nw;
+	LedBlinkLinux lb;
+	ArtNetNode node;
+
+	if (nw.Init("lo") < 0) {
+		fprintf(stderr, "Not able to start the network on lo\n");
+		return EXIT_FAILURE;
+	}
+
+	s_pNode = &node;
+
+	node.SetMaxPorts(PORTS);
+
+	for (uint8_t i = 0; i < PORTS; i++) {
+		node.SetUniverseSwitch(i, ARTNET_OUTPUT_PORT, i);
+	}
+
+	node.SetUniverseSwitch(2, ARTNET_OUTPUT_PORT, 0);
+
+	node.SetOutput(&s_Output);
+	node.Start();
+
+	const int nSourceA = open_source(SOURCE_A);
+	const int nSourceB = open_source(SOURCE_B);
+
+	// Discard the ArtPollReply packets sent by Start, one per page. HandlePacket returns 0 for those.
+	for (uint32_t i = 0; i < 16; i++) {
+		node.HandlePacket();
+	}
+
+	test_truncated(nSourceA);
+	test_dispatch(nSourceA);
+
+	if ((argc > 1) && (strcmp(argv[1], "-q") == 0)) {
+		printf("Merge test skipped\n");
+	} else {
+		test_merge(nSourceA, nSourceB);
+	}
+
+	printf("dispatch_test: %d errors\n", s_nErrors);
+
+	close(nSourceA);
+	close(nSourceB);
+
+	return (s_nErrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -41,6 +41,20 @@ enum {
 	ARTNET_MAX_PORTS = 4
 };
 
+/**
+ * The maximum ports for a node, reported with multiple ArtPollReply (BindIndex) pages.
+ */
+enum {
+	ARTNET_NODE_MAX_PORTS = 256
+};
+
+/**
+ * The maximum number of packets handled by ArtNetNode::HandlePackets
+ */
+enum {
+	ARTNET_BATCH_PACKETS = 16
+};
+
 /**
  * The length of the short name field. Always 18
  */
@@ -50,6 +50,15 @@
 #include "artnetipprog.h"
 #include "artnetstore.h"
 
+struct TNetworkPacket;
+struct TNetworkQueueStats;
+
+#define ARTNET_PORT_INDEX_NONE	0xFFFF
+
+#define ARTNET_RECV_QUEUE_DEPTH_PORT	2	///< Datagrams queued by the network stack for each enabled output port
+#define ARTNET_RECV_QUEUE_DEPTH_CONTROL	2	///< Room for ArtPoll, ArtRdm and the other control packets
+#define ARTNET_RECV_QUEUE_DEPTH_MAX		16	///< The network stack queues are taken from one small pool
+
 /**
  * Table 3 – NodeReport Codes
  * The NodeReport code defines generic error, advisory and status messages for both Nodes and Controllers.
@@ -92,9 +101,8 @@ struct TArtNetNodeState {
 	TNodeStatus status;					///< See \ref TNodeStatus
 	bool IsSynchronousMode;				///< ArtSync received
 	time_t ArtSyncTime;					///< Latest ArtSync received time
-	bool IsMergeMode;					///< Is the Node in merging mode?
 	bool IsChanged;						///< Is the DMX changed? Update output DMX
-	uint8_t nActivePorts;				///< Number of active ports
+	uint16_t nActivePorts;				///< Number of active ports
 	time_t nNetworkDataLossTimeout;		///<
 	bool bDisableMergeTimeout;			///<
 };
@@ -128,16 +136,23 @@ enum TPortProtocol {
 };
 
 struct TOutputPort {
-	uint8_t data[ARTNET_DMX_LENGTH];	///< Data sent
+	uint8_t *data;						///< Data sent
 	uint16_t nLength;					///< Length of sent DMX data
-	uint8_t dataA[ARTNET_DMX_LENGTH];	///< The data received from Port A
+	uint16_t nFirstSlot;				///< First slot changed since the last output
+	uint16_t nLastSlot;					///< Last slot changed since the last output
+	uint8_t *dataA;						///< The data received from Port A
 	time_t timeA;						///< The latest time of the data received from Port A
 	uint32_t ipA;						///< The IP address for port A
-	uint8_t dataB[ARTNET_DMX_LENGTH];	///< The data received from Port B
+	uint8_t *dataB;						///< The data received from Port B
 	time_t timeB;						///< The latest time of the data received from Port B
 	uint32_t ipB;						///< The IP address for Port B
 	TMerge mergeMode;					///< \ref TMerge
 	bool IsDataPending;					///< ArtDMX received and waiting for ArtSync
+	bool IsBatchPending;				///< ArtDMX received and waiting for the end of the receive batch
+	bool IsMerging;						///< Is the port in merging mode?
+	uint8_t nRdmPending;				///< ArtRdm requests queued on the port, DMX output is held while non zero
+	bool IsRdmDiscoveryHold;			///< A discovery slice holds the line, counted in nRdmPending
+	uint16_t nNextPortIndex;			///< Next port with the same Port-Address
 	bool bIsEnabled;					///< Is the port enabled ?
 	TGenericPort port;					///< \ref TGenericPort
 	TPortProtocol tPortProtocol;		///< Art-Net 4
@@ -152,6 +167,7 @@ public:
 	void Stop(void);
 
 	int HandlePacket(void);
+	int HandlePackets(void);
 
 	inline uint8_t GetVersion(void) {
 		return m_nVersion;
@@ -200,7 +216,10 @@ public:
 	void SetDisableMergeTimeout(bool);
 	bool GetDisableMergeTimeout(void) const;
 
-	uint8_t GetActiveOutputPorts(void) const;
+	void SetMaxPorts(uint16_t nPorts);
+	uint16_t GetMaxPorts(void) const;
+
+	uint16_t GetActiveOutputPorts(void) const;
 	uint8_t GetActiveInputPorts(void) { return 0; }
 
 	void SendDiag(const char *, TPriorityCodes);
@@ -212,15 +231,27 @@ public:
 	void SetIpProgHandler(ArtNetIpProg *);
 	void SetArtNetStore(ArtNetStore *pArtNetStore);
 
+	/**
+	 * @return false when the network stack does not keep receive queue statistics
+	 */
+	bool GetQueueStats(struct TNetworkQueueStats *pStats);
+
 	void Print(void);
 
 private:
+	int ProcessPacket(void);
 	void GetType(void);
 
 	void FillPollReply(void);
 	void FillDiagData(void);
 
-	uint16_t MakePortAddress(uint16_t);
+	uint16_t MakePortAddress(uint16_t, uint16_t nPortIndex);
+	uint8_t GetPageSubSwitch(uint16_t nPage) const;
+	void SetPageSubSwitch(uint16_t nPage, uint8_t nAddress);
+	inline uint16_t GetPages(void) const {	///< ArtPollReply pages, 4 ports each
+		return (uint16_t) ((m_nPorts + ARTNET_MAX_PORTS - 1) / ARTNET_MAX_PORTS);
+	}
+	void UpdatePortIndex(void);
 
 	void HandlePoll(void);
 	void HandleDmx(void);
@@ -231,12 +262,14 @@ private:
 	void HandleTodRequest(void);
 	void HandleTodControl(void);
 	void HandleRdm(void);
+	void HandleRdmResponses(void);
 	void HandleIpProg(void);
 	//void HandleDirectory(void);
 
 	bool IsMergedDmxDataChanged(uint8_t, const uint8_t *, uint16_t);
 	void CheckMergeTimeouts(uint8_t);
 	bool IsDmxDataChanged(uint8_t, const uint8_t *, uint16_t);
+	void SetLightSetData(uint8_t);
 
 	void SendPollRelply(bool);
 	void SendTod(uint8_t nPortId = 0);
@@ -262,9 +295,15 @@ private:
 	struct TArtDiagData m_DiagData;
 	struct TArtTimeCode *m_pTimeCodeData;
 	struct TArtTodData *m_pTodData;
+	struct TArtRdm *m_pRdmReply;			///< ArtRdm replies of the non-blocking transactions
 	struct TArtIpProgReply *m_pIpProgReply;
+	struct TArtNetPacket *m_pArtNetPacket;	///< The Art-Net package being handled
+	union UArtPacket *m_pArtPacket;			///< Its data, possibly borrowed from the network receive queue
+	struct TArtNetPacket *m_pBatchPackets;
+	struct TNetworkPacket *m_pNetworkPackets;
+	bool m_bIsBatchMode;
 
-	struct TOutputPort m_OutputPorts[ARTNET_MAX_PORTS];
+	uint16_t m_aPortIndex[256];				///< Port-Address bits 7-0 -> first port index
 
 	bool m_bDirectUpdate;
 
@@ -272,9 +311,14 @@ private:
 	time_t m_nPreviousPacketTime;
 	TOpCodes m_tOpCodePrevious;
 
-	bool m_IsLightSetRunning[ARTNET_MAX_PORTS];
 	bool m_IsRdmResponder;
 
+	uint16_t m_nPorts;
+	struct TOutputPort *m_OutputPorts;
+	bool *m_IsLightSetRunning;
+	uint8_t *m_pPageSubSwitch;				///< The Sub-Net of each group of 4 ports (ArtPollReply page)
+	uint8_t *m_pDmxArena;					///< The DMX buffers of all ports, allocated at Start
+
 	char m_aSysName[16];
 	char m_aDefaultNodeLongName[ARTNET_LONG_NAME_LENGTH];
 };
@@ -67,6 +67,8 @@ struct TArtNetParams {
 	uint8_t nMergeModePort[ARTNET_MAX_PORTS];
 	uint8_t nProtocol;
 	uint8_t nProtocolPort[ARTNET_MAX_PORTS];
+	uint16_t nMaxPorts;
+	uint16_t nRdmTodSize;
 };
 
 class ArtNetParamsStore {
@@ -137,6 +139,17 @@ public:
 		return m_tArtNetParams.bRdmDiscovery;
 	}
 
+	inline uint16_t GetMaxPorts(void) {
+		return m_tArtNetParams.nMaxPorts;
+	}
+
+	/**
+	 * @return The number of UIDs of the TOD per port, 0 is the default size
+	 */
+	inline uint16_t GetRdmTodSize(void) {
+		return m_tArtNetParams.nRdmTodSize;
+	}
+
 	uint8_t GetUniverse(uint8_t nPort, bool &IsSet) const;
 
 public:
@@ -30,16 +30,58 @@
 #define ARTNETRDM_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+
+enum TArtNetRdmDiscovery {
+	ARTNET_RDM_DISCOVERY_DONE,	///< Not running
+	ARTNET_RDM_DISCOVERY_BUSY,	///< The discovery holds the line, DMX output is held
+	ARTNET_RDM_DISCOVERY_PAUSE	///< Between discovery slices, the line is free for DMX frames
+};
+
+struct TArtNetRdmResponse {
+	const uint8_t *pRdmData;	///< The RDM response including the start code, 0 on time-out
+	uint32_t nIpAddress;		///< The controller that sent the ArtRdm
+	uint8_t nPort;				///< The port the transaction ran on
+};
 
 class ArtNetRdm {
 public:
 	virtual ~ArtNetRdm(void);
 
 	virtual void Full(uint8_t nPort)=0;
-	virtual const uint8_t GetUidCount(uint8_t nPort)=0;
-	virtual void Copy(uint8_t nPort, uint8_t *)=0;
+	virtual const uint16_t GetUidCount(uint8_t nPort)=0;
+	/**
+	 * Paged copy of the TOD, one ArtTodData block at a time
+	 * @return The number of UIDs copied, at most nCount
+	 */
+	virtual uint16_t Copy(uint8_t nPort, uint8_t *pTod, uint16_t nOffset, uint16_t nCount)=0;
 
 	virtual const uint8_t *Handler(uint8_t nPort, const uint8_t *)=0;
+
+	/**
+	 * Non-blocking transactions. When IsAsync returns false ArtNetNode uses the blocking Handler.
+	 */
+	virtual bool IsAsync(void);
+	/**
+	 * @return false when the queue of the port is full
+	 */
+	virtual bool Submit(uint8_t nPort, const uint8_t *pRdmData, uint32_t nIpAddress);
+	/**
+	 * Called from the main loop.
+	 * @return true when a transaction has completed, either with a response or a time-out
+	 */
+	virtual bool Run(struct TArtNetRdmResponse *pResponse);
+
+	/**
+	 * Non-blocking discovery, driven by Run.
+	 * @return false when not supported, ArtNetNode then uses the blocking Full
+	 */
+	virtual bool StartDiscovery(uint8_t nPort);
+	virtual TArtNetRdmDiscovery GetDiscoveryState(uint8_t nPort);
+	/**
+	 * @return true when the TOD has changed since the last Copy
+	 */
+	virtual bool IsTodChanged(uint8_t nPort);
 };
 
 #endif /* ARTNETRDM_H_ */
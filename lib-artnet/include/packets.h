@@ -37,6 +37,8 @@
 #define PACKED __attribute__((packed))
 #endif
 
+#define ARTNET_TOD_BLOCK_SIZE	200	///< The maximum number of UIDs in one ArtTodData packet
+
 /**
  * Table 1 - OpCodes
  * The supported legal OpCode values used in Art-Net packets
@@ -301,7 +303,7 @@ struct TArtTodData {
 	uint8_t UidTotalLo;
 	uint8_t BlockCount; 	///< The index number of this packet. When UidTotal exceeds 200, multiple ArtTodData packets are used.
 	uint8_t UidCount;		///< The number of UIDs encoded in this packet. This is the index of the following array.
-	uint8_t Tod[200][6];	///< 48 bit An array of RDM UID. // TODO #define
+	uint8_t Tod[ARTNET_TOD_BLOCK_SIZE][6];	///< 48 bit An array of RDM UID.
 }PACKED;
 
 /**
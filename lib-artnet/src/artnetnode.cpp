@@ -36,6 +36,7 @@
 #include "packets.h"
 
 #include "lightset.h"
+#include "lightsetdata.h"
 #include "ledblink.h"
 
 #include "artnetrdm.h"
@@ -68,6 +69,8 @@ union uip {
 #define NODE_DEFAULT_SUBNET_SWITCH	0
 #define NODE_DEFAULT_UNIVERSE		0
 
+#define ARTNET_PAGES_PER_SUBNET		(16 / ARTNET_MAX_PORTS)		///< 16 Universes per Sub-Net
+
 static const uint8_t DEVICE_MANUFACTURER_ID[] = { 0x7F, 0xF0 };	///< 0x7F, 0xF0 : RESERVED FOR PROTOTYPING/EXPERIMENTAL USE ONLY
 static const uint8_t DEVICE_SOFTWARE_VERSION[] = { 1, 25 };
 static const uint8_t DEVICE_OEM_VALUE[] = { 0x20, 0xE0 };		///< OemArtRelay , 0x00FF = developer code
@@ -90,28 +93,33 @@ ArtNetNode::ArtNetNode(uint8_t nVersion) :
 	m_pArtNetStore(0),
 	m_pTimeCodeData(0),
 	m_pTodData(0),
+	m_pRdmReply(0),
 	m_pIpProgReply(0),
+	m_pArtNetPacket(&m_ArtNetPacket),
+	m_pArtPacket(&m_ArtNetPacket.ArtPacket),
+	m_pBatchPackets(0),
+	m_pNetworkPackets(0),
+	m_bIsBatchMode(false),
 	m_bDirectUpdate(false),
 	m_nCurrentPacketTime(0),
 	m_nPreviousPacketTime(0),
-	m_IsRdmResponder(false)
+	m_IsRdmResponder(false),
+	m_nPorts(0),
+	m_OutputPorts(0),
+	m_IsLightSetRunning(0),
+	m_pPageSubSwitch(0),
+	m_pDmxArena(0)
 {
 	assert(Hardware::Get() != 0);
 	assert(Network::Get() != 0);
 
 	memset(&m_Node, 0, sizeof (struct TArtNetNode));
 
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
-		m_IsLightSetRunning[i] = false;
-		memset(&m_OutputPorts[i], 0 , sizeof(struct TOutputPort));
-	}
-
 	m_Node.Status1 = STATUS1_INDICATOR_NORMAL_MODE | STATUS1_PAP_FRONT_PANEL;
 	m_Node.Status2 = STATUS2_PORT_ADDRESS_15BIT | (m_nVersion > 3 ? STATUS2_SACN_ABLE_TO_SWITCH : STATUS2_SACN_NO_SWITCH);
 
 	m_State.IsSynchronousMode = false;
 	m_State.SendArtDiagData = false;
-	m_State.IsMergeMode = false;
 	m_State.IsChanged = false;
 	m_State.SendArtPollReplyOnChange = false;
 	m_State.ArtPollReplyCount = 0;
@@ -123,6 +131,8 @@ ArtNetNode::ArtNetNode(uint8_t nVersion) :
 	m_State.nNetworkDataLossTimeout = NETWORK_DATA_LOSS_TIMEOUT;
 	m_State.bDisableMergeTimeout = false;
 
+	SetMaxPorts(ARTNET_MAX_PORTS);
+
 	m_tOpCodePrevious = OP_NOT_DEFINED;
 
 	SetShortName((const char *) NODE_DEFAULT_SHORT_NAME);
@@ -144,7 +154,7 @@ ArtNetNode::ArtNetNode(uint8_t nVersion) :
 
 ArtNetNode::~ArtNetNode(void) {
 	if (m_pLightSet != 0) {
-		for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
+		for (unsigned i = 0; i < m_nPorts; i++) {
 			if (m_IsLightSetRunning[i]) {
 				m_pLightSet->Stop(i);
 				m_IsLightSetRunning[i] = false;
@@ -158,6 +168,10 @@ ArtNetNode::~ArtNetNode(void) {
 		delete m_pTodData;
 	}
 
+	if (m_pRdmReply != 0) {
+		delete m_pRdmReply;
+	}
+
 	if (m_pIpProgReply != 0) {
 		delete m_pIpProgReply;
 	}
@@ -166,15 +180,39 @@ ArtNetNode::~ArtNetNode(void) {
 		delete m_pTimeCodeData;
 	}
 
+	if (m_pBatchPackets != 0) {
+		delete[] m_pBatchPackets;
+	}
+
+	if (m_pDmxArena != 0) {
+		delete[] m_pDmxArena;
+	}
+
+	delete[] m_pPageSubSwitch;
+	delete[] m_IsLightSetRunning;
+	delete[] m_OutputPorts;
+
+	if (m_pNetworkPackets != 0) {
+		delete[] m_pNetworkPackets;
+	}
+
 	memset(&m_Node, 0, sizeof(struct TArtNetNode));
 	memset(&m_PollReply, 0, sizeof(struct TArtPollReply));
 	memset(&m_DiagData, 0, sizeof(struct TArtDiagData));
 }
 
+/**
+ * The store holds the Port-Address of the first \ref ARTNET_MAX_PORTS ports only,
+ * so a node with a store is limited to these ports.
+ */
 void ArtNetNode::SetArtNetStore(ArtNetStore *pArtNetStore) {
 	assert(pArtNetStore != 0);
 
 	m_pArtNetStore = pArtNetStore;
+
+	if (m_nPorts > ARTNET_MAX_PORTS) {
+		SetMaxPorts(ARTNET_MAX_PORTS);
+	}
 }
 
 void ArtNetNode::Start(void) {
@@ -191,14 +229,49 @@ void ArtNetNode::Start(void) {
 	FillPollReply();
 	FillDiagData();
 
-	m_nHandle = Network::Get()->Begin(ARTNET_UDP_PORT);
-	assert(m_nHandle != -1);
+	uint32_t nQueueDepth = ARTNET_RECV_QUEUE_DEPTH_CONTROL + (ARTNET_RECV_QUEUE_DEPTH_PORT * m_State.nActivePorts);
 
-	m_PollReply.NumPortsLo = m_State.nActivePorts;
+	if (nQueueDepth > ARTNET_RECV_QUEUE_DEPTH_MAX) {
+		nQueueDepth = ARTNET_RECV_QUEUE_DEPTH_MAX;
+	}
 
-	for (unsigned i = 0 ; i < ARTNET_MAX_PORTS; i++) {
-		if (m_OutputPorts[i].bIsEnabled) {
-			m_PollReply.PortTypes[i] = ARTNET_ENABLE_OUTPUT | ARTNET_PORT_DMX;
+	// A burst of ArtDmx for all ports must not overwrite unread packets; when it does
+	// not fit, the oldest data is the least useful
+	m_nHandle = Network::Get()->BeginQueue(ARTNET_UDP_PORT, nQueueDepth, NETWORK_QUEUE_DROP_OLDEST);
+
+	const uint32_t nQueueDepthWanted = nQueueDepth;
+
+	// Begin() would take a queue from the same pool, so use whatever room is left
+	while ((m_nHandle == -1) && (nQueueDepth > 1)) {
+		nQueueDepth /= 2;
+		m_nHandle = Network::Get()->BeginQueue(ARTNET_UDP_PORT, nQueueDepth, NETWORK_QUEUE_DROP_OLDEST);
+	}
+
+	if (m_nHandle == -1) {
+		printf("Art-Net: no receive queue left, the node is not started\n");
+		return;
+	}
+
+	if (nQueueDepth < nQueueDepthWanted) {
+		printf("Art-Net: receive queue for %d datagrams only, ArtDmx will be dropped in bursts\n", (int) nQueueDepth);
+	}
+
+	if (m_pDmxArena == 0) {
+		// One contiguous block for the data, dataA and dataB buffers of all ports
+		m_pDmxArena = new uint8_t[m_nPorts * 3 * ARTNET_DMX_LENGTH];
+		assert(m_pDmxArena != 0);
+
+		memset(m_pDmxArena, 0, m_nPorts * 3 * ARTNET_DMX_LENGTH);
+
+		uint8_t *p = m_pDmxArena;
+
+		for (unsigned i = 0; i < m_nPorts; i++) {
+			m_OutputPorts[i].data = p;
+			p += ARTNET_DMX_LENGTH;
+			m_OutputPorts[i].dataA = p;
+			p += ARTNET_DMX_LENGTH;
+			m_OutputPorts[i].dataB = p;
+			p += ARTNET_DMX_LENGTH;
 		}
 	}
 
@@ -209,9 +282,17 @@ void ArtNetNode::Start(void) {
 	SendPollRelply(false);	// send a reply on startup
 }
 
+bool ArtNetNode::GetQueueStats(struct TNetworkQueueStats *pStats) {
+	if (m_nHandle == -1) {
+		return false;
+	}
+
+	return Network::Get()->GetQueueStats(m_nHandle, pStats);
+}
+
 void ArtNetNode::Stop(void) {
 	if (m_pLightSet != 0) {
-		for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
+		for (unsigned i = 0; i < m_nPorts; i++) {
 			if ((m_OutputPorts[i].tPortProtocol == PORT_ARTNET_ARTNET) && (m_IsLightSetRunning[i])) {
 				m_pLightSet->Stop(i);
 				m_IsLightSetRunning[i] = false;
@@ -244,12 +325,82 @@ const uint8_t *ArtNetNode::GetSoftwareVersion(void) {
 	return DEVICE_SOFTWARE_VERSION;
 }
 
-uint8_t ArtNetNode::GetActiveOutputPorts(void) const{
+uint16_t ArtNetNode::GetActiveOutputPorts(void) const{
 	return m_State.nActivePorts;
 }
 
+/**
+ * The port storage is (re)allocated here, so this must be called before any of the port settings.
+ * The DMX buffers are allocated at \ref Start.
+ */
+void ArtNetNode::SetMaxPorts(uint16_t nPorts) {
+	assert(m_State.status != ARTNET_ON);
+	assert(m_pDmxArena == 0);
+
+	if (nPorts == 0) {
+		nPorts = 1;
+	} else if (nPorts > ARTNET_NODE_MAX_PORTS) {
+		nPorts = ARTNET_NODE_MAX_PORTS;
+	}
+
+	if ((m_pArtNetStore != 0) && (nPorts > ARTNET_MAX_PORTS)) {
+		nPorts = ARTNET_MAX_PORTS;
+	}
+
+	struct TOutputPort *pOutputPorts = new TOutputPort[nPorts];
+	assert(pOutputPorts != 0);
+
+	bool *pIsLightSetRunning = new bool[nPorts];
+	assert(pIsLightSetRunning != 0);
+
+	const uint16_t nPages = (uint16_t) ((nPorts + ARTNET_MAX_PORTS - 1) / ARTNET_MAX_PORTS);
+	uint8_t *pPageSubSwitch = new uint8_t[nPages];
+	assert(pPageSubSwitch != 0);
+
+	for (unsigned i = 0; i < nPages; i++) {
+		if (i < GetPages()) {
+			pPageSubSwitch[i] = m_pPageSubSwitch[i];
+		} else {
+			pPageSubSwitch[i] = (m_Node.SubSwitch + (i / ARTNET_PAGES_PER_SUBNET)) & 0x0F;
+		}
+	}
+
+	memset(pOutputPorts, 0, nPorts * sizeof(struct TOutputPort));
+
+	m_State.nActivePorts = 0;
+
+	for (unsigned i = 0; i < nPorts; i++) {
+		pIsLightSetRunning[i] = false;
+
+		if (i < m_nPorts) {
+			pOutputPorts[i] = m_OutputPorts[i];
+
+			if (pOutputPorts[i].bIsEnabled) {
+				m_State.nActivePorts++;
+			}
+		} else {
+			LightSetData::Clear(pOutputPorts[i].nFirstSlot, pOutputPorts[i].nLastSlot);
+		}
+	}
+
+	delete[] m_pPageSubSwitch;
+	delete[] m_IsLightSetRunning;
+	delete[] m_OutputPorts;
+
+	m_OutputPorts = pOutputPorts;
+	m_IsLightSetRunning = pIsLightSetRunning;
+	m_pPageSubSwitch = pPageSubSwitch;
+	m_nPorts = nPorts;
+
+	UpdatePortIndex();
+}
+
+uint16_t ArtNetNode::GetMaxPorts(void) const {
+	return m_nPorts;
+}
+
 int ArtNetNode::SetUniverseSwitch(uint8_t nPortIndex, TArtNetPortDir dir, uint8_t nAddress) {
-	assert(nPortIndex < ARTNET_MAX_PORTS);
+	assert(nPortIndex < m_nPorts);
 
 	if (dir == ARTNET_INPUT_PORT) {
 		// Not supported. We have output ports only.
@@ -257,7 +408,7 @@ int ArtNetNode::SetUniverseSwitch(uint8_t nPortIndex, TArtNetPortDir dir, uint8_
 	} else if (dir == ARTNET_OUTPUT_PORT) {
 		if (!m_OutputPorts[nPortIndex].bIsEnabled) {
 			m_State.nActivePorts = m_State.nActivePorts + 1;
-			assert(m_State.nActivePorts <= ARTNET_MAX_PORTS);
+			assert(m_State.nActivePorts <= m_nPorts);
 		}
 		m_OutputPorts[nPortIndex].bIsEnabled = true;
 	} else {
@@ -265,9 +416,11 @@ int ArtNetNode::SetUniverseSwitch(uint8_t nPortIndex, TArtNetPortDir dir, uint8_
 	}
 
 	m_OutputPorts[nPortIndex].port.nDefaultAddress = nAddress & (uint16_t) 0x0F;// Universe : Bits 3-0
-	m_OutputPorts[nPortIndex].port.nPortAddress = MakePortAddress((uint16_t) nAddress);
+	m_OutputPorts[nPortIndex].port.nPortAddress = MakePortAddress((uint16_t) nAddress, nPortIndex);
 
-	if ((m_pArtNetStore != 0) && (m_State.status == ARTNET_ON)) {
+	UpdatePortIndex();
+
+	if ((m_pArtNetStore != 0) && (m_State.status == ARTNET_ON) && (nPortIndex < ARTNET_MAX_PORTS)) {
 		m_pArtNetStore->SaveUniverseSwitch(nPortIndex, nAddress);
 	}
 
@@ -275,20 +428,29 @@ int ArtNetNode::SetUniverseSwitch(uint8_t nPortIndex, TArtNetPortDir dir, uint8_
 }
 
 bool ArtNetNode::GetUniverseSwitch(uint8_t nPortIndex, uint8_t &nAddress) const {
-	assert(nPortIndex < ARTNET_MAX_PORTS);
+	assert(nPortIndex < m_nPorts);
 
 	nAddress = m_OutputPorts[nPortIndex].port.nDefaultAddress;
 
 	return m_OutputPorts[nPortIndex].bIsEnabled;
 }
 
+/**
+ * Sets the Sub-Net of all ports, each group of 16 ports uses the next Sub-Net.
+ */
 void ArtNetNode::SetSubnetSwitch(uint8_t nAddress) {
 	m_Node.SubSwitch = nAddress;
 
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
-		m_OutputPorts[i].port.nPortAddress = MakePortAddress(m_OutputPorts[i].port.nPortAddress);
+	for (unsigned i = 0; i < GetPages(); i++) {
+		m_pPageSubSwitch[i] = (nAddress + (i / ARTNET_PAGES_PER_SUBNET)) & 0x0F;
+	}
+
+	for (unsigned i = 0; i < m_nPorts; i++) {
+		m_OutputPorts[i].port.nPortAddress = MakePortAddress(m_OutputPorts[i].port.nPortAddress, i);
 	}
 
+	UpdatePortIndex();
+
 	if ((m_pArtNetStore != 0) && (m_State.status == ARTNET_ON)) {
 		m_pArtNetStore->SaveSubnetSwitch(nAddress);
 	}
@@ -301,10 +463,12 @@ uint8_t ArtNetNode::GetSubnetSwitch(void) const {
 void ArtNetNode::SetNetSwitch(uint8_t nAddress) {
 	m_Node.NetSwitch = nAddress;
 
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
-		m_OutputPorts[i].port.nPortAddress = MakePortAddress(m_OutputPorts[i].port.nPortAddress);
+	for (unsigned i = 0; i < m_nPorts; i++) {
+		m_OutputPorts[i].port.nPortAddress = MakePortAddress(m_OutputPorts[i].port.nPortAddress, i);
 	}
 
+	UpdatePortIndex();
+
 	if ((m_pArtNetStore != 0) && (m_State.status == ARTNET_ON)) {
 		m_pArtNetStore->SaveNetSwitch(nAddress);
 	}
@@ -315,13 +479,13 @@ uint8_t ArtNetNode::GetNetSwitch(void) const{
 }
 
 uint16_t  ArtNetNode::GetPortAddress(uint8_t nPortIndex) const {
-	assert(nPortIndex < ARTNET_MAX_PORTS);
+	assert(nPortIndex < m_nPorts);
 
 	return m_OutputPorts[nPortIndex].port.nPortAddress;
 }
 
 void ArtNetNode::SetMergeMode(uint8_t nPortIndex, TMerge tMergeMode) {
-	assert(nPortIndex < ARTNET_MAX_PORTS);
+	assert(nPortIndex < m_nPorts);
 
 	m_OutputPorts[nPortIndex].mergeMode = tMergeMode;
 
@@ -331,25 +495,25 @@ void ArtNetNode::SetMergeMode(uint8_t nPortIndex, TMerge tMergeMode) {
 		m_OutputPorts[nPortIndex].port.nStatus &= (~GO_MERGE_MODE_LTP);
 	}
 
-	if ((m_pArtNetStore != 0) && (m_State.status == ARTNET_ON)) {
+	if ((m_pArtNetStore != 0) && (m_State.status == ARTNET_ON) && (nPortIndex < ARTNET_MAX_PORTS)) {
 		m_pArtNetStore->SaveMergeMode(nPortIndex, tMergeMode);
 	}
 }
 
 TMerge ArtNetNode::GetMergeMode(uint8_t nPortIndex) const {
-	assert(nPortIndex < ARTNET_MAX_PORTS);
+	assert(nPortIndex < m_nPorts);
 
 	return m_OutputPorts[nPortIndex].mergeMode;
 }
 
 void ArtNetNode::SetPortProtocol(uint8_t nPortIndex, TPortProtocol tPortProtocol) {
-	assert(nPortIndex < ARTNET_MAX_PORTS);
+	assert(nPortIndex < m_nPorts);
 
 	m_OutputPorts[nPortIndex].tPortProtocol = tPortProtocol;
 }
 
 TPortProtocol ArtNetNode::GetPortProtocol(uint8_t nPortIndex) const {
-	assert(nPortIndex < ARTNET_MAX_PORTS);
+	assert(nPortIndex < m_nPorts);
 
 	return m_OutputPorts[nPortIndex].tPortProtocol;
 }
@@ -426,15 +590,68 @@ bool ArtNetNode::GetDisableMergeTimeout(void) const {
 	return m_State.bDisableMergeTimeout;
 }
 
-uint16_t ArtNetNode::MakePortAddress(uint16_t nCurrentAddress) {
+/**
+ * The Sub-Net is the one of the ArtPollReply page (group of 4 ports) of the port.
+ */
+uint16_t ArtNetNode::MakePortAddress(uint16_t nCurrentAddress, uint16_t nPortIndex) {
 	// PortAddress Bit 15 = 0
 	uint16_t newAddress = (m_Node.NetSwitch & 0x7F) << 8;	// Net : Bits 14-8
-	newAddress |= (m_Node.SubSwitch & (uint8_t) 0x0F) << 4;	// Sub-Net : Bits 7-4
+	newAddress |= (GetPageSubSwitch(nPortIndex / ARTNET_MAX_PORTS) & (uint8_t) 0x0F) << 4;	// Sub-Net : Bits 7-4
 	newAddress |= nCurrentAddress & (uint16_t) 0x0F;		// Universe : Bits 3-0
 
 	return newAddress;
 }
 
+uint8_t ArtNetNode::GetPageSubSwitch(uint16_t nPage) const {
+	return m_pPageSubSwitch[nPage];
+}
+
+/**
+ * ArtAddress with a BindIndex : only the ports of that page move to the new Sub-Net.
+ * Page 0 is the Sub-Net of the node, which is the one persisted.
+ */
+void ArtNetNode::SetPageSubSwitch(uint16_t nPage, uint8_t nAddress) {
+	assert(nPage < GetPages());
+
+	m_pPageSubSwitch[nPage] = nAddress & 0x0F;
+
+	for (unsigned i = nPage * ARTNET_MAX_PORTS; (i < (nPage + 1U) * ARTNET_MAX_PORTS) && (i < m_nPorts); i++) {
+		m_OutputPorts[i].port.nPortAddress = MakePortAddress(m_OutputPorts[i].port.nPortAddress, i);
+	}
+
+	UpdatePortIndex();
+
+	if (nPage == 0) {
+		m_Node.SubSwitch = nAddress;
+
+		if ((m_pArtNetStore != 0) && (m_State.status == ARTNET_ON)) {
+			m_pArtNetStore->SaveSubnetSwitch(nAddress);
+		}
+	}
+}
+
+/**
+ * Rebuild the Port-Address lookup table used by \ref HandleDmx, \ref HandleTodControl,
+ * \ref HandleTodRequest and \ref HandleRdm.
+ * All ports share the same Net, so bits 7-0 of the Port-Address (Sub-Net + Universe)
+ * index the table. Ports with the same Port-Address are chained with nNextPortIndex.
+ */
+void ArtNetNode::UpdatePortIndex(void) {
+	for (unsigned i = 0; i < sizeof(m_aPortIndex) / sizeof(m_aPortIndex[0]); i++) {
+		m_aPortIndex[i] = ARTNET_PORT_INDEX_NONE;
+	}
+
+	for (int i = m_nPorts - 1; i >= 0; i--) {
+		if (m_OutputPorts[i].bIsEnabled) {
+			const uint8_t nIndex = m_OutputPorts[i].port.nPortAddress & 0xFF;
+			m_OutputPorts[i].nNextPortIndex = m_aPortIndex[nIndex];
+			m_aPortIndex[nIndex] = (uint16_t) i;
+		} else {
+			m_OutputPorts[i].nNextPortIndex = ARTNET_PORT_INDEX_NONE;
+		}
+	}
+}
+
 void ArtNetNode::FillPollReply(void) {
 	memset(&m_PollReply, 0, sizeof(struct TArtPollReply));
 
@@ -490,22 +707,22 @@ void ArtNetNode::FillDiagData(void) {
 }
 
 void ArtNetNode::GetType(void) {
-	char *data = (char *) &(m_ArtNetPacket.ArtPacket);
+	char *data = (char *) m_pArtPacket;
 
-	if (m_ArtNetPacket.length < ARTNET_MIN_HEADER_SIZE) {
-		m_ArtNetPacket.OpCode = OP_NOT_DEFINED;
+	if (m_pArtNetPacket->length < ARTNET_MIN_HEADER_SIZE) {
+		m_pArtNetPacket->OpCode = OP_NOT_DEFINED;
 		return;
 	}
 
 	if ((data[10] != 0) || (data[11] != (char) ARTNET_PROTOCOL_REVISION)) {
-		m_ArtNetPacket.OpCode = OP_NOT_DEFINED;
+		m_pArtNetPacket->OpCode = OP_NOT_DEFINED;
 		return;
 	}
 
 	if (memcmp(data, "Art-Net\0", 8) == 0) {
-		m_ArtNetPacket.OpCode = (TOpCodes) ((uint16_t)(data[9] << 8) + data[8]);
+		m_pArtNetPacket->OpCode = (TOpCodes) ((uint16_t)(data[9] << 8) + data[8]);
 	} else {
-		m_ArtNetPacket.OpCode = OP_NOT_DEFINED;
+		m_pArtNetPacket->OpCode = OP_NOT_DEFINED;
 	}
 }
 
@@ -515,16 +732,41 @@ void ArtNetNode::SendPollRelply(bool bResponse) {
 	}
 
 	m_PollReply.NetSwitch = m_Node.NetSwitch;
-	m_PollReply.SubSwitch = m_Node.SubSwitch;
-
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
-		m_PollReply.GoodOutput[i] = m_OutputPorts[i].port.nStatus;
-		m_PollReply.SwOut[i] = m_OutputPorts[i].port.nDefaultAddress;
-	}
 
 	snprintf((char *) m_PollReply.NodeReport, ARTNET_REPORT_LENGTH, "%04x [%04d] %s AvV", (int) m_State.reportCode, (int) m_State.ArtPollReplyCount, m_aSysName);
 
-	Network::Get()->SendTo(m_nHandle, (const uint8_t *) &(m_PollReply), (uint16_t) sizeof(struct TArtPollReply), m_Node.IPAddressBroadcast, (uint16_t) ARTNET_UDP_PORT);
+	// A node with more than 4 ports sends one ArtPollReply per group of 4 ports, numbered with the BindIndex
+	const uint16_t nPages = GetPages();
+
+	for (uint16_t nPage = 0; nPage < nPages; nPage++) {
+		uint8_t nPortsInPage = 0;
+
+		m_PollReply.SubSwitch = GetPageSubSwitch(nPage);
+
+		for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
+			const uint16_t nPortIndex = nPage * ARTNET_MAX_PORTS + i;
+
+			if ((nPortIndex < m_nPorts) && m_OutputPorts[nPortIndex].bIsEnabled) {
+				m_PollReply.PortTypes[i] = ARTNET_ENABLE_OUTPUT | ARTNET_PORT_DMX;
+				m_PollReply.GoodOutput[i] = m_OutputPorts[nPortIndex].port.nStatus;
+				m_PollReply.SwOut[i] = m_OutputPorts[nPortIndex].port.nDefaultAddress;
+				nPortsInPage++;
+			} else {
+				m_PollReply.PortTypes[i] = 0;
+				m_PollReply.GoodOutput[i] = 0;
+				m_PollReply.SwOut[i] = 0;
+			}
+		}
+
+		m_PollReply.NumPortsLo = nPortsInPage;
+
+		// Art-Net 3 has no BindIndex, but a controller cannot tell the pages apart without it
+		if ((m_nVersion > 3) || (nPages > 1)) {
+			m_PollReply.BindIndex = (uint8_t) (nPage + 1);
+		}
+
+		Network::Get()->SendTo(m_nHandle, (const uint8_t *) &(m_PollReply), (uint16_t) sizeof(struct TArtPollReply), m_Node.IPAddressBroadcast, (uint16_t) ARTNET_UDP_PORT);
+	}
 }
 
 void ArtNetNode::SendDiag(const char *text, TPriorityCodes nPriority) {
@@ -548,36 +790,44 @@ void ArtNetNode::SendDiag(const char *text, TPriorityCodes nPriority) {
 }
 
 bool ArtNetNode::IsDmxDataChanged(uint8_t nPortId, const uint8_t *pData, uint16_t nLength) {
-	bool isChanged = false;
-
-	const uint8_t *src = (uint8_t *) pData;
-	uint8_t *dst = m_OutputPorts[nPortId].data;
-
-	if (nLength != m_OutputPorts[nPortId].nLength) {
-		m_OutputPorts[nPortId].nLength = nLength;
+	// No slots, nothing to output
+	if (nLength == 0) {
+		return false;
+	}
 
-		for (unsigned i = 0; i < nLength; i++) {
-			*dst++ = *src++;
-		}
+	struct TOutputPort *pOutputPort = &m_OutputPorts[nPortId];
+	const bool isChanged = LightSetData::Copy(pOutputPort->data, pData, nLength, pOutputPort->nFirstSlot, pOutputPort->nLastSlot);
 
+	if (nLength != pOutputPort->nLength) {
+		pOutputPort->nLength = nLength;
+		LightSetData::Widen(pOutputPort->nFirstSlot, pOutputPort->nLastSlot, 0, nLength - 1);
 		return true;
 	}
 
-	for (unsigned i = 0; i < nLength; i++) {
-		if (*dst != *src) {
-			isChanged = true;
-		}
-		*dst++ = *src++;
-	}
-
 	return isChanged;
 }
 
+/**
+ * Outputs the port with the slots changed since the previous output
+ */
+void ArtNetNode::SetLightSetData(uint8_t nPortId) {
+	struct TOutputPort *pOutputPort = &m_OutputPorts[nPortId];
+
+	if (pOutputPort->nFirstSlot <= pOutputPort->nLastSlot) {
+		m_pLightSet->SetDataRange(nPortId, pOutputPort->data, pOutputPort->nLength, pOutputPort->nFirstSlot, pOutputPort->nLastSlot);
+		LightSetData::Clear(pOutputPort->nFirstSlot, pOutputPort->nLastSlot);
+	} else {
+		m_pLightSet->SetData(nPortId, pOutputPort->data, pOutputPort->nLength);
+	}
+}
+
 bool ArtNetNode::IsMergedDmxDataChanged(uint8_t nPortId, const uint8_t *pData, uint16_t nLength) {
-	bool isChanged = false;
+	if (nLength == 0) {
+		return false;
+	}
 
-	if (!m_State.IsMergeMode) {
-		m_State.IsMergeMode = true;
+	if (!m_OutputPorts[nPortId].IsMerging) {
+		m_OutputPorts[nPortId].IsMerging = true;
 		m_State.IsChanged = true;
 		uint8_t nStatus = m_OutputPorts[nPortId].port.nStatus;
 		m_OutputPorts[nPortId].port.nStatus = nStatus | (1 << 3);	// Bit 3 : Set – Output is merging ArtNet data.
@@ -585,24 +835,15 @@ bool ArtNetNode::IsMergedDmxDataChanged(uint8_t nPortId, const uint8_t *pData, u
 
 
 	if (m_OutputPorts[nPortId].mergeMode == ARTNET_MERGE_HTP) {
+		struct TOutputPort *pOutputPort = &m_OutputPorts[nPortId];
+		const bool isChanged = LightSetData::MergeHtp(pOutputPort->data, pOutputPort->dataA, pOutputPort->dataB, nLength, pOutputPort->nFirstSlot, pOutputPort->nLastSlot);
 
-		if (nLength != m_OutputPorts[nPortId].nLength) {
-			m_OutputPorts[nPortId].nLength = nLength;
-			for (unsigned i = 0; i < nLength; i++) {
-				uint8_t data = MAX(m_OutputPorts[nPortId].dataA[i], m_OutputPorts[nPortId].dataB[i]);
-				m_OutputPorts[nPortId].data[i] = data;
-			}
+		if (nLength != pOutputPort->nLength) {
+			pOutputPort->nLength = nLength;
+			LightSetData::Widen(pOutputPort->nFirstSlot, pOutputPort->nLastSlot, 0, nLength - 1);
 			return true;
 		}
 
-		for (unsigned i = 0; i < nLength; i++) {
-			uint8_t data = MAX(m_OutputPorts[nPortId].dataA[i], m_OutputPorts[nPortId].dataB[i]);
-			if (data != m_OutputPorts[nPortId].data[i]) {
-				m_OutputPorts[nPortId].data[i] = data;
-				isChanged = true;
-			}
-		}
-
 		return isChanged;
 	} else {
 		return IsDmxDataChanged(nPortId, pData, nLength);
@@ -615,15 +856,15 @@ void ArtNetNode::CheckMergeTimeouts(uint8_t nPortId) {
 
 	if (timeOutA > (time_t)ARTNET_MERGE_TIMEOUT_SECONDS) {
 		m_OutputPorts[nPortId].ipA = 0;
-		m_State.IsMergeMode = false;
+		m_OutputPorts[nPortId].IsMerging = false;
 	}
 
 	if (timeOutB > (time_t)ARTNET_MERGE_TIMEOUT_SECONDS) {
 		m_OutputPorts[nPortId].ipB = 0;
-		m_State.IsMergeMode = false;
+		m_OutputPorts[nPortId].IsMerging = false;
 	}
 
-	if (!m_State.IsMergeMode) {
+	if (!m_OutputPorts[nPortId].IsMerging) {
 		m_State.IsChanged = true;
 		const uint8_t nStatus = m_OutputPorts[nPortId].port.nStatus;
 		m_OutputPorts[nPortId].port.nStatus = nStatus & ~GO_OUTPUT_IS_MERGING;
@@ -634,7 +875,7 @@ void ArtNetNode::CheckMergeTimeouts(uint8_t nPortId) {
 }
 
 void ArtNetNode::HandlePoll(void) {
-	const struct TArtPoll *packet = (struct TArtPoll *)&(m_ArtNetPacket.ArtPacket.ArtPoll);
+	const struct TArtPoll *packet = (struct TArtPoll *)&(m_pArtPacket->ArtPoll);
 
 	if (packet->TalkToMe & TTM_SEND_ARTP_ON_CHANGE) {
 		m_State.SendArtPollReplyOnChange = true;
@@ -647,8 +888,8 @@ void ArtNetNode::HandlePoll(void) {
 		m_State.SendArtDiagData = true;
 
 		if (m_State.IPAddressArtPoll == 0) {
-			m_State.IPAddressArtPoll = m_ArtNetPacket.IPAddressFrom;
-		} else if (!m_State.IsMultipleControllersReqDiag && (m_State.IPAddressArtPoll != m_ArtNetPacket.IPAddressFrom)) {
+			m_State.IPAddressArtPoll = m_pArtNetPacket->IPAddressFrom;
+		} else if (!m_State.IsMultipleControllersReqDiag && (m_State.IPAddressArtPoll != m_pArtNetPacket->IPAddressFrom)) {
 			// If there are multiple controllers requesting diagnostics, diagnostics shall be broadcast.
 			m_State.IPAddressDiagSend = m_Node.IPAddressBroadcast;
 			m_State.IsMultipleControllersReqDiag = true;
@@ -663,7 +904,7 @@ void ArtNetNode::HandlePoll(void) {
 
 		// If there are multiple controllers requesting diagnostics, diagnostics shall be broadcast. (Ignore ArtPoll->TalkToMe->3).
 		if (!m_State.IsMultipleControllersReqDiag && (packet->TalkToMe & TTM_SEND_DIAG_UNICAST)) {
-			m_State.IPAddressDiagSend = m_ArtNetPacket.IPAddressFrom;
+			m_State.IPAddressDiagSend = m_pArtNetPacket->IPAddressFrom;
 		} else {
 			m_State.IPAddressDiagSend = m_Node.IPAddressBroadcast;
 		}
@@ -676,14 +917,26 @@ void ArtNetNode::HandlePoll(void) {
 }
 
 void ArtNetNode::HandleDmx(void) {
-	const struct TArtDmx *packet = (struct TArtDmx *)&(m_ArtNetPacket.ArtPacket.ArtDmx);
+	const struct TArtDmx *packet = (struct TArtDmx *)&(m_pArtPacket->ArtDmx);
+
+	// The packet is parsed in place, nothing may be read beyond what has been received
+	const int nHeaderLength = (int) __builtin_offsetof(struct TArtDmx, Data);
+
+	if (m_pArtNetPacket->length <= nHeaderLength) {
+		return;
+	}
 
 	unsigned data_length = (unsigned) ((packet->LengthHi << 8) & 0xff00) | (packet->Length);
 	data_length = MIN(data_length, ARTNET_DMX_LENGTH);
+	data_length = MIN(data_length, (unsigned) (m_pArtNetPacket->length - nHeaderLength));
 
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
+	if ((packet->PortAddress >> 8) != (m_Node.NetSwitch & 0x7F)) {
+		return;
+	}
 
-		if (m_OutputPorts[i].bIsEnabled && (m_OutputPorts[i].tPortProtocol == PORT_ARTNET_ARTNET) && (packet->PortAddress == m_OutputPorts[i].port.nPortAddress)) {
+	for (uint16_t i = m_aPortIndex[packet->PortAddress & 0xFF]; i != ARTNET_PORT_INDEX_NONE; i = m_OutputPorts[i].nNextPortIndex) {
+
+		if (m_OutputPorts[i].tPortProtocol == PORT_ARTNET_ARTNET) {
 
 			uint32_t ipA = m_OutputPorts[i].ipA;
 			uint32_t ipB = m_OutputPorts[i].ipB;
@@ -692,7 +945,7 @@ void ArtNetNode::HandleDmx(void) {
 
 			m_OutputPorts[i].port.nStatus = m_OutputPorts[i].port.nStatus |GO_DATA_IS_BEING_TRANSMITTED;
 
-			if (m_State.IsMergeMode) {
+			if (m_OutputPorts[i].IsMerging) {
 				if (__builtin_expect((!m_State.bDisableMergeTimeout), 1)) {
 					CheckMergeTimeouts(i);
 				}
@@ -702,58 +955,58 @@ void ArtNetNode::HandleDmx(void) {
 #ifdef SENDDIAG
 				SendDiag("1. first packet recv on this port", ARTNET_DP_LOW);
 #endif
-				m_OutputPorts[i].ipA = m_ArtNetPacket.IPAddressFrom;
+				m_OutputPorts[i].ipA = m_pArtNetPacket->IPAddressFrom;
 				m_OutputPorts[i].timeA = m_nCurrentPacketTime;
-				memcpy(&m_OutputPorts[i].dataA, packet->Data, data_length);
+				memcpy(m_OutputPorts[i].dataA, packet->Data, data_length);
 				sendNewData = IsDmxDataChanged(i, packet->Data, data_length);
-			} else if (ipA == m_ArtNetPacket.IPAddressFrom && ipB == 0) {
+			} else if (ipA == m_pArtNetPacket->IPAddressFrom && ipB == 0) {
 #ifdef SENDDIAG
 				SendDiag("2. continued transmission from the same ip (source A)", ARTNET_DP_LOW);
 #endif
 				m_OutputPorts[i].timeA = m_nCurrentPacketTime;
-				memcpy(&m_OutputPorts[i].dataA, packet->Data, data_length);
+				memcpy(m_OutputPorts[i].dataA, packet->Data, data_length);
 				sendNewData = IsDmxDataChanged(i, packet->Data, data_length);
-			} else if (ipA == 0 && ipB == m_ArtNetPacket.IPAddressFrom) {
+			} else if (ipA == 0 && ipB == m_pArtNetPacket->IPAddressFrom) {
 #ifdef SENDDIAG
 				SendDiag("3. continued transmission from the same ip (source B)", ARTNET_DP_LOW);
 #endif
 				m_OutputPorts[i].timeB = m_nCurrentPacketTime;
-				memcpy(&m_OutputPorts[i].dataB, packet->Data, data_length);
+				memcpy(m_OutputPorts[i].dataB, packet->Data, data_length);
 				sendNewData = IsDmxDataChanged(i, packet->Data, data_length);
-			} else if (ipA != m_ArtNetPacket.IPAddressFrom && ipB == 0) {
+			} else if (ipA != m_pArtNetPacket->IPAddressFrom && ipB == 0) {
 #ifdef SENDDIAG
 				SendDiag("4. new source, start the merge", ARTNET_DP_LOW);
 #endif
-				m_OutputPorts[i].ipB = m_ArtNetPacket.IPAddressFrom;
+				m_OutputPorts[i].ipB = m_pArtNetPacket->IPAddressFrom;
 				m_OutputPorts[i].timeB = m_nCurrentPacketTime;
-				memcpy(&m_OutputPorts[i].dataB, packet->Data, data_length);
+				memcpy(m_OutputPorts[i].dataB, packet->Data, data_length);
 				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].dataB, data_length);
-			} else if (ipA == 0 && ipB != m_ArtNetPacket.IPAddressFrom) {
+			} else if (ipA == 0 && ipB != m_pArtNetPacket->IPAddressFrom) {
 #ifdef SENDDIAG
 				SendDiag("5. new source, start the merge", ARTNET_DP_LOW);
 #endif
-				m_OutputPorts[i].ipA = m_ArtNetPacket.IPAddressFrom;
+				m_OutputPorts[i].ipA = m_pArtNetPacket->IPAddressFrom;
 				m_OutputPorts[i].timeA = m_nCurrentPacketTime;
-				memcpy(&m_OutputPorts[i].dataA, packet->Data, data_length);
+				memcpy(m_OutputPorts[i].dataA, packet->Data, data_length);
 				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].dataA, data_length);
-			} else if (ipA == m_ArtNetPacket.IPAddressFrom && ipB != m_ArtNetPacket.IPAddressFrom) {
+			} else if (ipA == m_pArtNetPacket->IPAddressFrom && ipB != m_pArtNetPacket->IPAddressFrom) {
 #ifdef SENDDIAG
 				SendDiag("6. continue merge", ARTNET_DP_LOW);
 #endif
 				m_OutputPorts[i].timeA = m_nCurrentPacketTime;
-				memcpy(&m_OutputPorts[i].dataA, packet->Data, data_length);
+				memcpy(m_OutputPorts[i].dataA, packet->Data, data_length);
 				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].dataA, data_length);
-			} else if (ipA != m_ArtNetPacket.IPAddressFrom && ipB == m_ArtNetPacket.IPAddressFrom) {
+			} else if (ipA != m_pArtNetPacket->IPAddressFrom && ipB == m_pArtNetPacket->IPAddressFrom) {
 #ifdef SENDDIAG
 				SendDiag("7. continue merge", ARTNET_DP_LOW);
 #endif
 				m_OutputPorts[i].timeB = m_nCurrentPacketTime;
-				memcpy(&m_OutputPorts[i].dataB, packet->Data, data_length);
+				memcpy(m_OutputPorts[i].dataB, packet->Data, data_length);
 				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].dataB, data_length);
-			} else if (ipA == m_ArtNetPacket.IPAddressFrom && ipB == m_ArtNetPacket.IPAddressFrom) {
+			} else if (ipA == m_pArtNetPacket->IPAddressFrom && ipB == m_pArtNetPacket->IPAddressFrom) {
 				SendDiag("8. Source matches both buffers, this shouldn't be happening!", ARTNET_DP_LOW);
 				return;
-			} else if (ipA != m_ArtNetPacket.IPAddressFrom && ipB != m_ArtNetPacket.IPAddressFrom) {
+			} else if (ipA != m_pArtNetPacket->IPAddressFrom && ipB != m_pArtNetPacket->IPAddressFrom) {
 				SendDiag("9. More than two sources, discarding data", ARTNET_DP_LOW);
 				return;
 			} else {
@@ -766,11 +1019,18 @@ void ArtNetNode::HandleDmx(void) {
 #ifdef SENDDIAG
 					SendDiag("Send new data", ARTNET_DP_LOW);
 #endif
-					m_pLightSet->SetData(i, m_OutputPorts[i].data, m_OutputPorts[i].nLength);
-
-					if(!m_IsLightSetRunning[i]) {
-						m_pLightSet->Start(i);
-						m_IsLightSetRunning[i] = true;
+					if (m_bIsBatchMode) {
+						// Output once per port at the end of the batch
+						m_OutputPorts[i].IsBatchPending = true;
+					} else {
+						SetLightSetData(i);
+
+						if(!m_IsLightSetRunning[i]) {
+							if (m_OutputPorts[i].nRdmPending == 0) {
+								m_pLightSet->Start(i);
+							}
+							m_IsLightSetRunning[i] = true;
+						}
 					}
 				} else {
 #ifdef SENDDIAG
@@ -791,15 +1051,17 @@ void ArtNetNode::HandleSync(void) {
 	m_State.IsSynchronousMode = true;
 	m_State.ArtSyncTime = Hardware::Get()->GetTime();
 
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
+	for (unsigned i = 0; i < m_nPorts; i++) {
 		if (m_OutputPorts[i].IsDataPending) {
 #ifdef SENDDIAG
 			SendDiag("Send pending data", ARTNET_DP_LOW);
 #endif
-			m_pLightSet->SetData(i, m_OutputPorts[i].data, 	m_OutputPorts[i].nLength);
+			SetLightSetData(i);
 
 			if(!m_IsLightSetRunning[i]) {
-				m_pLightSet->Start(i);
+				if (m_OutputPorts[i].nRdmPending == 0) {
+					m_pLightSet->Start(i);
+				}
 				m_IsLightSetRunning[i] = true;
 			}
 
@@ -809,8 +1071,14 @@ void ArtNetNode::HandleSync(void) {
 }
 
 void ArtNetNode::HandleAddress(void) {
-	const struct TArtAddress *packet = (struct TArtAddress *) &(m_ArtNetPacket.ArtPacket.ArtAddress);
-	uint8_t nPort = 0xFF;
+	const struct TArtAddress *packet = (struct TArtAddress *) &(m_pArtPacket->ArtAddress);
+	// Art-Net 4 : the BindIndex selects the group of 4 ports
+	const uint16_t nPageOffset = ((m_nVersion > 3) && (packet->BindIndex > 1)) ? (packet->BindIndex - 1) * ARTNET_MAX_PORTS : 0;
+	uint16_t nPort = 0xFFFF;
+
+	if (nPageOffset >= m_nPorts) {
+		return;
+	}
 
 	m_State.reportCode = ARTNET_RCPOWEROK;
 
@@ -825,9 +1093,9 @@ void ArtNetNode::HandleAddress(void) {
 	}
 
 	if (packet->SubSwitch == PROGRAM_DEFAULTS) {
-		SetSubnetSwitch(NODE_DEFAULT_SUBNET_SWITCH);
+		SetPageSubSwitch(nPageOffset / ARTNET_MAX_PORTS, NODE_DEFAULT_SUBNET_SWITCH);
 	} else if (packet->SubSwitch & PROGRAM_CHANGE_MASK) {
-		SetSubnetSwitch(packet->SubSwitch & ~PROGRAM_CHANGE_MASK);
+		SetPageSubSwitch(nPageOffset / ARTNET_MAX_PORTS, packet->SubSwitch & ~PROGRAM_CHANGE_MASK);
 	}
 
 	if (packet->NetSwitch == PROGRAM_DEFAULTS) {
@@ -836,21 +1104,21 @@ void ArtNetNode::HandleAddress(void) {
 		SetNetSwitch(packet->NetSwitch & ~PROGRAM_CHANGE_MASK);
 	}
 
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
+	for (unsigned i = 0; (i < ARTNET_MAX_PORTS) && (nPageOffset + i < m_nPorts); i++) {
 		if (packet->SwOut[i] == PROGRAM_NO_CHANGE) {
 			continue;
 		} else if (packet->SwOut[i] == PROGRAM_DEFAULTS) {
-			SetUniverseSwitch(i, ARTNET_OUTPUT_PORT, NODE_DEFAULT_UNIVERSE);
+			SetUniverseSwitch(nPageOffset + i, ARTNET_OUTPUT_PORT, NODE_DEFAULT_UNIVERSE);
 		} else if (packet->SwOut[i] & PROGRAM_CHANGE_MASK) {
-			SetUniverseSwitch(i, ARTNET_OUTPUT_PORT, packet->SwOut[i] & ~PROGRAM_CHANGE_MASK);
+			SetUniverseSwitch(nPageOffset + i, ARTNET_OUTPUT_PORT, packet->SwOut[i] & ~PROGRAM_CHANGE_MASK);
 		}
 	}
 
 	switch (packet->Command) {
 	case ARTNET_PC_CANCEL:
 		// If Node is currently in merge mode, cancel merge mode upon receipt of next ArtDmx packet.
-		m_State.IsMergeMode = false;
-		for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
+		for (unsigned i = 0; i < m_nPorts; i++) {
+			m_OutputPorts[i].IsMerging = false;
 			m_OutputPorts[i].port.nStatus = m_OutputPorts[i].port.nStatus & ~GO_OUTPUT_IS_MERGING;
 		}
 		break;
@@ -869,47 +1137,60 @@ void ArtNetNode::HandleAddress(void) {
 	case ARTNET_PC_MERGE_LTP_1:
 	case ARTNET_PC_MERGE_LTP_2:
 	case ARTNET_PC_MERGE_LTP_3:
-		SetMergeMode(packet->Command & 0x3, ARTNET_MERGE_LTP);
+		if (nPageOffset + (packet->Command & 0x3) < m_nPorts) {
+			SetMergeMode(nPageOffset + (packet->Command & 0x3), ARTNET_MERGE_LTP);
+		}
 		break;
 
 	case ARTNET_PC_MERGE_HTP_0:
 	case ARTNET_PC_MERGE_HTP_1:
 	case ARTNET_PC_MERGE_HTP_2:
 	case ARTNET_PC_MERGE_HTP_3:
-		SetMergeMode(packet->Command & 0x3, ARTNET_MERGE_HTP);
+		if (nPageOffset + (packet->Command & 0x3) < m_nPorts) {
+			SetMergeMode(nPageOffset + (packet->Command & 0x3), ARTNET_MERGE_HTP);
+		}
 		break;
 
 	case ARTNET_PC_ARTNET_SEL0:
 	case ARTNET_PC_ARTNET_SEL1:
 	case ARTNET_PC_ARTNET_SEL2:
 	case ARTNET_PC_ARTNET_SEL3:
-		SetPortProtocol(packet->Command & 0x3, PORT_ARTNET_ARTNET);
+		if (nPageOffset + (packet->Command & 0x3) < m_nPorts) {
+			SetPortProtocol(nPageOffset + (packet->Command & 0x3), PORT_ARTNET_ARTNET);
+		}
 		break;
 
 	case ARTNET_PC_ACN_SEL0:
 	case ARTNET_PC_ACN_SEL1:
 	case ARTNET_PC_ACN_SEL2:
 	case ARTNET_PC_ACN_SEL3:
-		SetPortProtocol(packet->Command & 0x3, PORT_ARTNET_SACN);
+		if (nPageOffset + (packet->Command & 0x3) < m_nPorts) {
+			SetPortProtocol(nPageOffset + (packet->Command & 0x3), PORT_ARTNET_SACN);
+		}
 		break;
 
 	case ARTNET_PC_CLR_0:
 	case ARTNET_PC_CLR_1:
 	case ARTNET_PC_CLR_2:
 	case ARTNET_PC_CLR_3:
-		nPort = packet->Command & 0x3;
-		for (unsigned i = 0; i < ARTNET_DMX_LENGTH; i++) {
-			m_OutputPorts[nPort].data[i] = 0;
+		nPort = nPageOffset + (packet->Command & 0x3);
+		if (nPort < m_nPorts) {
+			for (unsigned i = 0; i < ARTNET_DMX_LENGTH; i++) {
+				m_OutputPorts[nPort].data[i] = 0;
+			}
+			m_pLightSet->SetData(nPort, m_OutputPorts[nPort].data, m_OutputPorts[nPort].nLength);
+			LightSetData::Clear(m_OutputPorts[nPort].nFirstSlot, m_OutputPorts[nPort].nLastSlot);
 		}
-		m_pLightSet->SetData(nPort, m_OutputPorts[nPort].data, m_OutputPorts[nPort].nLength);
 		break;
 
 	default:
 		break;
 	}
 
-	if ((nPort < ARTNET_MAX_PORTS) && !m_IsLightSetRunning[nPort]) {
-		m_pLightSet->Start(nPort);
+	if ((nPort < m_nPorts) && !m_IsLightSetRunning[nPort]) {
+		if (m_OutputPorts[nPort].nRdmPending == 0) {
+			m_pLightSet->Start(nPort);
+		}
 		m_IsLightSetRunning[nPort] = true;
 	}
 
@@ -934,7 +1215,7 @@ void ArtNetNode::SetTimeCodeHandler(ArtNetTimeCode *pArtNetTimeCode) {
 }
 
 void ArtNetNode::HandleTimeCode(void) {
-	const struct TArtTimeCode *packet = (struct TArtTimeCode *) &(m_ArtNetPacket.ArtPacket.ArtTimeCode);
+	const struct TArtTimeCode *packet = (struct TArtTimeCode *) &(m_pArtPacket->ArtTimeCode);
 
 	m_pArtNetTimeCode->Handler((struct TArtNetTimeCode *) &packet->Frames);
 }
@@ -958,21 +1239,26 @@ void ArtNetNode::SetTimeSyncHandler(ArtNetTimeSync *pArtNetTimeSync) {
 }
 
 void ArtNetNode::HandleTimeSync(void) {
-	struct TArtTimeSync *packet = (struct TArtTimeSync *) &(m_ArtNetPacket.ArtPacket.ArtTimeSync);
+	struct TArtTimeSync *packet = (struct TArtTimeSync *) &(m_pArtPacket->ArtTimeSync);
 
 	m_pArtNetTimeSync->Handler((struct TArtNetTimeSync *)&packet->tm_sec);
 
 	packet->Prog = 0;
 
-	Network::Get()->SendTo(m_nHandle, (const uint8_t *) packet, (const uint16_t) sizeof(struct TArtTimeSync), m_ArtNetPacket.IPAddressFrom, (uint16_t) ARTNET_UDP_PORT);
+	Network::Get()->SendTo(m_nHandle, (const uint8_t *) packet, (const uint16_t) sizeof(struct TArtTimeSync), m_pArtNetPacket->IPAddressFrom, (uint16_t) ARTNET_UDP_PORT);
 }
 
 void ArtNetNode::HandleTodControl(void) {
-	const struct TArtTodControl *packet = (struct TArtTodControl *) &(m_ArtNetPacket.ArtPacket.ArtTodControl);
+	const struct TArtTodControl *packet = (struct TArtTodControl *) &(m_pArtPacket->ArtTodControl);
 	const uint16_t portAddress = (uint16_t)(packet->Net << 8) | (uint16_t)(packet->Address);
 
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
-		if ((portAddress == m_OutputPorts[i].port.nPortAddress) && m_OutputPorts[i].bIsEnabled) {
+	for (uint16_t i = m_aPortIndex[portAddress & 0xFF]; i != ARTNET_PORT_INDEX_NONE; i = m_OutputPorts[i].nNextPortIndex) {
+		if (portAddress == m_OutputPorts[i].port.nPortAddress) {
+
+			if ((packet->Command == 0x01) && (m_pRdmReply != 0) && m_pArtNetRdm->StartDiscovery(i)) {
+				// Non-blocking, the TOD is sent from HandleRdmResponses when the discovery is done
+				continue;
+			}
 
 			if (m_IsLightSetRunning[i] && (!m_IsRdmResponder)) {
 				m_pLightSet->Stop(i);
@@ -984,7 +1270,7 @@ void ArtNetNode::HandleTodControl(void) {
 
 			SendTod(i);
 
-			if (m_IsLightSetRunning[i] && (!m_IsRdmResponder)) {
+			if (m_IsLightSetRunning[i] && (!m_IsRdmResponder) && (m_OutputPorts[i].nRdmPending == 0)) {
 				m_pLightSet->Start(i);
 			}
 		}
@@ -992,35 +1278,49 @@ void ArtNetNode::HandleTodControl(void) {
 }
 
 void ArtNetNode::HandleTodRequest(void) {
-	const struct TArtTodRequest *packet = (struct TArtTodRequest *) &(m_ArtNetPacket.ArtPacket.ArtTodRequest);
+	const struct TArtTodRequest *packet = (struct TArtTodRequest *) &(m_pArtPacket->ArtTodRequest);
 	const uint16_t portAddress = (uint16_t)(packet->Net << 8) | (uint16_t)(packet->Address[0]);
 
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
-		if ((portAddress == m_OutputPorts[i].port.nPortAddress) && m_OutputPorts[i].bIsEnabled) {
+	for (uint16_t i = m_aPortIndex[portAddress & 0xFF]; i != ARTNET_PORT_INDEX_NONE; i = m_OutputPorts[i].nNextPortIndex) {
+		if (portAddress == m_OutputPorts[i].port.nPortAddress) {
 			SendTod(i);
 		}
 	}
 }
 
 void ArtNetNode::SendTod(uint8_t nPortId) {
-	assert(nPortId < ARTNET_MAX_PORTS);
+	assert(nPortId < m_nPorts);
 
 	m_pTodData->Net = m_Node.NetSwitch;
 	m_pTodData->Address = m_OutputPorts[nPortId].port.nDefaultAddress;
 
-	const uint8_t discovered = m_pArtNetRdm->GetUidCount(nPortId);
+	const uint16_t discovered = m_pArtNetRdm->GetUidCount(nPortId);
 
-	m_pTodData->UidTotalHi = 0;
-	m_pTodData->UidTotalLo = discovered;
-	m_pTodData->BlockCount = 0;
-	m_pTodData->UidCount = discovered;
+	m_pTodData->UidTotalHi = (uint8_t) (discovered >> 8);
+	m_pTodData->UidTotalLo = (uint8_t) discovered;
 	m_pTodData->Port = 1 + nPortId;
 
-	m_pArtNetRdm->Copy(nPortId, (uint8_t *) m_pTodData->Tod);
+	uint16_t nOffset = 0;
+	uint8_t nBlock = 0;
+
+	// When UidTotal exceeds 200, multiple ArtTodData packets are used
+	do {
+		const uint16_t nCount = m_pArtNetRdm->Copy(nPortId, (uint8_t *) m_pTodData->Tod, nOffset, ARTNET_TOD_BLOCK_SIZE);
+
+		m_pTodData->BlockCount = nBlock;
+		m_pTodData->UidCount = (uint8_t) nCount;
+
+		const uint16_t length = (uint16_t) sizeof(struct TArtTodData) - (uint16_t) (sizeof m_pTodData->Tod) + (uint16_t) (nCount * 6);
 
-	const uint16_t length = (uint16_t) sizeof(struct TArtTodData) - (uint16_t) (sizeof m_pTodData->Tod) + (uint16_t) (discovered * 6);
+		Network::Get()->SendTo(m_nHandle, (const uint8_t *) m_pTodData, (const uint16_t) length, m_Node.IPAddressBroadcast, (uint16_t) ARTNET_UDP_PORT);
 
-	Network::Get()->SendTo(m_nHandle, (const uint8_t *) m_pTodData, (const uint16_t) length, m_Node.IPAddressBroadcast, (uint16_t) ARTNET_UDP_PORT);
+		if (nCount == 0) {
+			break;
+		}
+
+		nOffset += nCount;
+		nBlock++;
+	} while (nOffset < discovered);
 }
 
 void ArtNetNode::SetRdmHandler(ArtNetRdm *pArtNetTRdm, bool IsResponder) {
@@ -1042,15 +1342,42 @@ void ArtNetNode::SetRdmHandler(ArtNetRdm *pArtNetTRdm, bool IsResponder) {
 			m_pTodData->ProtVerLo = ARTNET_PROTOCOL_REVISION;
 			m_pTodData->RdmVer = 0x01; // Devices that support RDM STANDARD V1.0 set field to 0x01.
 		}
+
+		if (m_pArtNetRdm->IsAsync()) {
+			m_pRdmReply = new TArtRdm;
+			assert(m_pRdmReply != 0);
+
+			memset(m_pRdmReply, 0, sizeof(struct TArtRdm));
+
+			memcpy(m_pRdmReply->Id, (const char *) NODE_ID, sizeof(m_pRdmReply->Id));
+			m_pRdmReply->OpCode = OP_RDM;
+			m_pRdmReply->ProtVerLo = ARTNET_PROTOCOL_REVISION;
+			m_pRdmReply->RdmVer = 0x01;
+		}
 	}
 }
 
 void ArtNetNode::HandleRdm(void) {
-	struct TArtRdm *packet = (struct TArtRdm *) &(m_ArtNetPacket.ArtPacket.ArtRdm);
+	struct TArtRdm *packet = (struct TArtRdm *) &(m_pArtPacket->ArtRdm);
 	const uint16_t portAddress = (uint16_t) (packet->Net << 8) | (uint16_t) (packet->Address);
 
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
-		if ((portAddress == m_OutputPorts[i].port.nPortAddress) && m_OutputPorts[i].bIsEnabled) {
+	for (uint16_t i = m_aPortIndex[portAddress & 0xFF]; i != ARTNET_PORT_INDEX_NONE; i = m_OutputPorts[i].nNextPortIndex) {
+		if (portAddress == m_OutputPorts[i].port.nPortAddress) {
+
+			if (m_pRdmReply != 0) {
+				// Non-blocking, the ArtRdm reply is sent from HandleRdmResponses
+				if (m_IsLightSetRunning[i] && (m_OutputPorts[i].nRdmPending == 0)) {
+					m_pLightSet->Stop(i);
+				}
+
+				if (m_pArtNetRdm->Submit(i, packet->RdmPacket, m_pArtNetPacket->IPAddressFrom)) {
+					m_OutputPorts[i].nRdmPending++;
+				} else if (m_IsLightSetRunning[i] && (m_OutputPorts[i].nRdmPending == 0)) {
+					m_pLightSet->Start(i); // Queue is full, the controller will retry
+				}
+
+				continue;
+			}
 
 			if (m_IsLightSetRunning[i] && (!m_IsRdmResponder)) {
 				m_pLightSet->Stop(i); // Stop DMX if was running
@@ -1066,7 +1393,7 @@ void ArtNetNode::HandleRdm(void) {
 				
 				const uint16_t nLength = (uint16_t) sizeof(struct TArtRdm) - (uint16_t) sizeof(packet->RdmPacket) + nMessageLength;
 
-				Network::Get()->SendTo(m_nHandle, (const uint8_t *) packet, (const uint16_t) nLength, m_ArtNetPacket.IPAddressFrom, (uint16_t) ARTNET_UDP_PORT);
+				Network::Get()->SendTo(m_nHandle, (const uint8_t *) packet, (const uint16_t) nLength, m_pArtNetPacket->IPAddressFrom, (uint16_t) ARTNET_UDP_PORT);
 			} else {
 				//printf("\n==> No response <==\n");
 			}
@@ -1078,6 +1405,62 @@ void ArtNetNode::HandleRdm(void) {
 	}
 }
 
+void ArtNetNode::HandleRdmResponses(void) {
+	struct TArtNetRdmResponse tResponse;
+
+	while (m_pArtNetRdm->Run(&tResponse)) {
+		const uint8_t i = tResponse.nPort;
+
+		if ((i >= m_nPorts) || (m_OutputPorts[i].nRdmPending == 0)) {
+			continue;
+		}
+
+		if (tResponse.pRdmData != 0) {
+			m_pRdmReply->Net = (uint8_t) (m_OutputPorts[i].port.nPortAddress >> 8);
+			m_pRdmReply->Address = (uint8_t) m_OutputPorts[i].port.nPortAddress;
+
+			const uint8_t nMessageLength = tResponse.pRdmData[2] + 1;
+			memcpy((uint8_t *) m_pRdmReply->RdmPacket, &tResponse.pRdmData[1], nMessageLength);
+
+			const uint16_t nLength = (uint16_t) sizeof(struct TArtRdm) - (uint16_t) sizeof(m_pRdmReply->RdmPacket) + nMessageLength;
+
+			Network::Get()->SendTo(m_nHandle, (const uint8_t *) m_pRdmReply, (const uint16_t) nLength, tResponse.nIpAddress, (uint16_t) ARTNET_UDP_PORT);
+		}
+
+		m_OutputPorts[i].nRdmPending--;
+
+		if (m_IsLightSetRunning[i] && (m_OutputPorts[i].nRdmPending == 0)) {
+			m_pLightSet->Start(i); // Start DMX if was running
+		}
+	}
+
+	// The discovery gives the line back for DMX frames between its slices
+	for (unsigned i = 0; i < m_nPorts; i++) {
+		const TArtNetRdmDiscovery tDiscovery = m_pArtNetRdm->GetDiscoveryState(i);
+		const bool IsHold = (tDiscovery == ARTNET_RDM_DISCOVERY_BUSY);
+
+		if (IsHold != m_OutputPorts[i].IsRdmDiscoveryHold) {
+			m_OutputPorts[i].IsRdmDiscoveryHold = IsHold;
+
+			if (IsHold) {
+				if (m_IsLightSetRunning[i] && (m_OutputPorts[i].nRdmPending == 0)) {
+					m_pLightSet->Stop(i);
+				}
+				m_OutputPorts[i].nRdmPending++;
+			} else {
+				m_OutputPorts[i].nRdmPending--;
+				if (m_IsLightSetRunning[i] && (m_OutputPorts[i].nRdmPending == 0)) {
+					m_pLightSet->Start(i);
+				}
+			}
+		}
+
+		if ((tDiscovery == ARTNET_RDM_DISCOVERY_DONE) && m_OutputPorts[i].bIsEnabled && m_pArtNetRdm->IsTodChanged(i)) {
+			SendTod(i);
+		}
+	}
+}
+
 void ArtNetNode::SetIpProgHandler(ArtNetIpProg *pArtNetIpProg) {
 	assert(pArtNetIpProg != 0);
 
@@ -1100,11 +1483,11 @@ void ArtNetNode::SetIpProgHandler(ArtNetIpProg *pArtNetIpProg) {
 }
 
 void ArtNetNode::HandleIpProg(void) {
-	struct TArtIpProg *packet = (struct TArtIpProg *) &(m_ArtNetPacket.ArtPacket.ArtIpProg);
+	struct TArtIpProg *packet = (struct TArtIpProg *) &(m_pArtPacket->ArtIpProg);
 
 	m_pArtNetIpProg->Handler((const TArtNetIpProg *) &packet->Command, (TArtNetIpProgReply *) &m_pIpProgReply->ProgIpHi);
 
-	Network::Get()->SendTo(m_nHandle, (const uint8_t *) m_pIpProgReply, (uint16_t) sizeof(struct TArtIpProgReply), m_ArtNetPacket.IPAddressFrom, (uint16_t) ARTNET_UDP_PORT);
+	Network::Get()->SendTo(m_nHandle, (const uint8_t *) m_pIpProgReply, (uint16_t) sizeof(struct TArtIpProgReply), m_pArtNetPacket->IPAddressFrom, (uint16_t) ARTNET_UDP_PORT);
 
 	memcpy(ip.u8, &m_pIpProgReply->ProgIpHi, ARTNET_IP_SIZE);
 
@@ -1128,7 +1511,7 @@ void ArtNetNode::HandleIpProg(void) {
 void ArtNetNode::SetNetworkDataLossCondition(void) {
 	m_State.IsSynchronousMode = false;
 
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
+	for (unsigned i = 0; i < m_nPorts; i++) {
 		if  ((m_OutputPorts[i].tPortProtocol == PORT_ARTNET_ARTNET) && (m_IsLightSetRunning[i])) {
 			m_pLightSet->Stop(i);
 			m_IsLightSetRunning[i] = false;
@@ -1136,16 +1519,25 @@ void ArtNetNode::SetNetworkDataLossCondition(void) {
 
 		m_OutputPorts[i].port.nStatus &= (~GO_DATA_IS_BEING_TRANSMITTED);
 		m_OutputPorts[i].nLength = 0;
+		LightSetData::Clear(m_OutputPorts[i].nFirstSlot, m_OutputPorts[i].nLastSlot);
 		m_OutputPorts[i].ipA = 0;
 		m_OutputPorts[i].ipB = 0;
 	}
 }
 
 int ArtNetNode::HandlePacket(void) {
-	const char *packet = (char *) &(m_ArtNetPacket.ArtPacket);
+	uint8_t *packet;
 	uint16_t nForeignPort;
 
-	const int nBytesReceived = Network::Get()->RecvFrom(m_nHandle, (uint8_t *) packet, (uint16_t) sizeof(m_ArtNetPacket.ArtPacket), &m_ArtNetPacket.IPAddressFrom, &nForeignPort);
+	if (__builtin_expect((m_nHandle == -1), 0)) {
+		return 0;
+	}
+
+	if (m_pRdmReply != 0) {
+		HandleRdmResponses();
+	}
+
+	const int nBytesReceived = Network::Get()->RecvFromRef(m_nHandle, &packet, &m_ArtNetPacket.IPAddressFrom, &nForeignPort);
 
 	m_nCurrentPacketTime = Hardware::Get()->GetTime();
 
@@ -1159,13 +1551,94 @@ int ArtNetNode::HandlePacket(void) {
 	m_ArtNetPacket.length = nBytesReceived;
 	m_nPreviousPacketTime = m_nCurrentPacketTime;
 
+	// Parse in place, the datagram is not copied
+	m_pArtPacket = (union UArtPacket *) packet;
+
+	const int nResult = ProcessPacket();
+
+	m_pArtPacket = &m_ArtNetPacket.ArtPacket;
+
+	Network::Get()->RecvRelease(m_nHandle);
+
+	return nResult;
+}
+
+int ArtNetNode::HandlePackets(void) {
+	if (m_pBatchPackets == 0) {
+		m_pBatchPackets = new TArtNetPacket[ARTNET_BATCH_PACKETS];
+		assert(m_pBatchPackets != 0);
+
+		m_pNetworkPackets = new TNetworkPacket[ARTNET_BATCH_PACKETS];
+		assert(m_pNetworkPackets != 0);
+
+		for (unsigned i = 0; i < ARTNET_BATCH_PACKETS; i++) {
+			m_pNetworkPackets[i].pBuffer = (uint8_t *) &(m_pBatchPackets[i].ArtPacket);
+			m_pNetworkPackets[i].nSize = (uint16_t) sizeof(m_pBatchPackets[i].ArtPacket);
+		}
+	}
+
+	if (__builtin_expect((m_nHandle == -1), 0)) {
+		return 0;
+	}
+
+	if (m_pRdmReply != 0) {
+		HandleRdmResponses();
+	}
+
+	const uint16_t nPackets = Network::Get()->RecvFromBatch(m_nHandle, m_pNetworkPackets, ARTNET_BATCH_PACKETS);
+
+	m_nCurrentPacketTime = Hardware::Get()->GetTime();
+
+	if (nPackets == 0) {
+		if ((m_State.nNetworkDataLossTimeout != 0) && ((m_nCurrentPacketTime - m_nPreviousPacketTime) >= m_State.nNetworkDataLossTimeout)) {
+			SetNetworkDataLossCondition();
+		}
+		return 0;
+	}
+
+	m_nPreviousPacketTime = m_nCurrentPacketTime;
+
+	m_bIsBatchMode = true;
+
+	for (unsigned i = 0; i < nPackets; i++) {
+		m_pArtNetPacket = &m_pBatchPackets[i];
+		m_pArtPacket = &m_pBatchPackets[i].ArtPacket;
+		m_pArtNetPacket->length = m_pNetworkPackets[i].nLength;
+		m_pArtNetPacket->IPAddressFrom = m_pNetworkPackets[i].nFromIp;
+
+		(void) ProcessPacket();
+	}
+
+	m_pArtNetPacket = &m_ArtNetPacket;
+	m_pArtPacket = &m_ArtNetPacket.ArtPacket;
+	m_bIsBatchMode = false;
+
+	for (unsigned i = 0; i < m_nPorts; i++) {
+		if (m_OutputPorts[i].IsBatchPending) {
+			SetLightSetData(i);
+
+			if(!m_IsLightSetRunning[i]) {
+				if (m_OutputPorts[i].nRdmPending == 0) {
+					m_pLightSet->Start(i);
+				}
+				m_IsLightSetRunning[i] = true;
+			}
+
+			m_OutputPorts[i].IsBatchPending = false;
+		}
+	}
+
+	return nPackets;
+}
+
+int ArtNetNode::ProcessPacket(void) {
 	GetType();
 
 	if (m_State.IsSynchronousMode) {
-		if ((m_ArtNetPacket.OpCode == OP_DMX) && (m_tOpCodePrevious == OP_DMX)) {
+		if ((m_pArtNetPacket->OpCode == OP_DMX) && (m_tOpCodePrevious == OP_DMX)) {
 			// WiFi UDP : We have missed the OP_SYNC
 			m_State.IsSynchronousMode = false;
-			for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
+			for (unsigned i = 0; i < m_nPorts; i++) {
 				m_OutputPorts[i].IsDataPending = false;
 			}
 		} else {
@@ -1175,7 +1648,7 @@ int ArtNetNode::HandlePacket(void) {
 		}
 	}
 
-	switch (m_ArtNetPacket.OpCode) {
+	switch (m_pArtNetPacket->OpCode) {
 	case OP_POLL:
 		HandlePoll();
 		break;
@@ -1234,8 +1707,8 @@ int ArtNetNode::HandlePacket(void) {
 		m_State.IsChanged = false;
 	}
 
-	m_tOpCodePrevious = m_ArtNetPacket.OpCode;
+	m_tOpCodePrevious = m_pArtNetPacket->OpCode;
 
-	return m_ArtNetPacket.length;
+	return m_pArtNetPacket->length;
 }
 
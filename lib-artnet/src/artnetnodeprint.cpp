@@ -30,6 +30,8 @@
 
 #include "artnetnode.h"
 
+#include "network.h"
+
 #define MERGEMODE2STRING(m)		(m == ARTNET_MERGE_HTP) ? "HTP" : "LTP"
 #define PROTOCOL2STRING(p)		(p == PORT_ARTNET_ARTNET) ? "Art-Net" : "sACN"
 
@@ -42,11 +44,16 @@ void ArtNetNode::Print(void) {
 	printf(" Long name  : %s\n", m_Node.LongName);
 	printf(" Net        : %d\n", m_Node.NetSwitch);
 	printf(" Sub-Net    : %d\n", m_Node.SubSwitch);
+	printf(" Ports      : %d\n", m_nPorts);
 
-	for (uint32_t i = 0; i < ARTNET_MAX_PORTS; i++) {
+	for (uint32_t i = 0; i < m_nPorts; i++) {
 		uint8_t nAddress;
 		if (GetUniverseSwitch(i, nAddress)) {
-			printf("  Port %c Universe %d [%s]", (char) ('A' + i), nAddress, MERGEMODE2STRING(m_OutputPorts[i].mergeMode));
+			if (i < ARTNET_MAX_PORTS) {
+				printf("  Port %c Universe %d [%s]", (char) ('A' + i), nAddress, MERGEMODE2STRING(m_OutputPorts[i].mergeMode));
+			} else {
+				printf("  Port %d Sub-Net %d Universe %d [%s]", (int) i, GetPageSubSwitch(i / ARTNET_MAX_PORTS), nAddress, MERGEMODE2STRING(m_OutputPorts[i].mergeMode));
+			}
 			if (m_nVersion == 4) {
 				printf(" {%s}\n", PROTOCOL2STRING(m_OutputPorts[i].tPortProtocol));
 			} else {
@@ -54,4 +61,10 @@ void ArtNetNode::Print(void) {
 			}
 		}
 	}
+
+	struct TNetworkQueueStats tStats;
+
+	if (GetQueueStats(&tStats)) {
+		printf(" Queue      : %d, received %d, dropped %d, high-water %d\n", (int) tStats.nDepth, (int) tStats.nReceived, (int) tStats.nDropped, (int) tStats.nHighWater);
+	}
 }
@@ -73,6 +73,8 @@
 #define SET_PROTOCOL_B_MASK		(1 << 24)
 #define SET_PROTOCOL_C_MASK		(1 << 25)
 #define SET_PROTOCOL_D_MASK		(1 << 26)
+#define SET_MAX_PORTS_MASK		(1 << 27)
+#define SET_RDM_TOD_SIZE_MASK	(1 << 28)
 
 static const char PARAMS_FILE_NAME[] ALIGNED = "artnet.txt";
 static const char PARAMS_NET[] ALIGNED = "net";												///< 0 {default}
@@ -83,6 +85,7 @@ static const char PARAMS_TIMECODE[] ALIGNED = "use_timecode";
 static const char PARAMS_TIMESYNC[] ALIGNED = "use_timesync";
 static const char PARAMS_RDM[] ALIGNED = "enable_rdm";										///< Enable RDM, 0 {default}
 static const char PARAMS_RDM_DISCOVERY[] ALIGNED = "rdm_discovery_at_startup";				///< 0 {default}
+static const char PARAMS_RDM_TOD_SIZE[] ALIGNED = "rdm_tod_size";							///< 200 {default}, UIDs per port
 static const char PARAMS_NODE_SHORT_NAME[] ALIGNED = "short_name";
 static const char PARAMS_NODE_LONG_NAME[] ALIGNED = "long_name";
 static const char PARAMS_NODE_MANUFACTURER_ID[] ALIGNED = "manufacturer_id";
@@ -94,6 +97,7 @@ static const char PARAMS_UNIVERSE_PORT[4][16] ALIGNED = { "universe_port_a",
 static const char PARAMS_MERGE_MODE[] ALIGNED = "merge_mode";
 static const char PARAMS_MERGE_MODE_PORT[4][18] ALIGNED = { "merge_mode_port_a",
 		"merge_mode_port_b", "merge_mode_port_c", "merge_mode_port_d" };
+static const char PARAMS_MAX_PORTS[] ALIGNED = "max_ports";								///< 4 {default}, at most 4 with an ArtNetStore
 static const char PARAMS_PROTOCOL[] ALIGNED = "protocol";
 static const char PARAMS_PROTOCOL_PORT[4][16] ALIGNED = { "protocol_port_a",
 		"protocol_port_b", "protocol_port_a", "protocol_port_d" };
@@ -108,6 +112,8 @@ ArtNetParams::ArtNetParams(ArtNetParamsStore *pArtNetParamsStore): m_pArtNetPara
 	for (uint32_t i = 0; i < ARTNET_MAX_PORTS; i++) {
 		m_tArtNetParams.nUniversePort[i] = i;
 	}
+
+	m_tArtNetParams.nMaxPorts = ARTNET_MAX_PORTS;
 }
 
 ArtNetParams::~ArtNetParams(void) {
@@ -138,6 +144,7 @@ void ArtNetParams::callbackFunction(const char *pLine) {
 	char value[128];
 	uint8_t len;
 	uint8_t value8;
+	uint16_t value16;
 
 	if (Sscan::Uint8(pLine, PARAMS_TIMECODE, &value8) == SSCAN_OK) {
 		if (value8 != 0) {
@@ -170,6 +177,14 @@ void ArtNetParams::callbackFunction(const char *pLine) {
 		return;
 	}
 
+	if (Sscan::Uint16(pLine, PARAMS_RDM_TOD_SIZE, &value16) == SSCAN_OK) {
+		if (value16 != 0) {
+			m_tArtNetParams.nRdmTodSize = value16;
+			m_tArtNetParams.nSetList |= SET_RDM_TOD_SIZE_MASK;
+		}
+		return;
+	}
+
 	len = ARTNET_SHORT_NAME_LENGTH;
 	if (Sscan::Char(pLine, PARAMS_NODE_SHORT_NAME, value, &len) == SSCAN_OK) {
 		strncpy((char *)m_tArtNetParams.aShortName, value, len);
@@ -253,6 +268,14 @@ void ArtNetParams::callbackFunction(const char *pLine) {
 		return;
 	}
 
+	if (Sscan::Uint16(pLine, PARAMS_MAX_PORTS, &value16) == SSCAN_OK) {
+		if ((value16 != 0) && (value16 <= ARTNET_NODE_MAX_PORTS)) {
+			m_tArtNetParams.nMaxPorts = value16;
+			m_tArtNetParams.nSetList |= SET_MAX_PORTS_MASK;
+		}
+		return;
+	}
+
 	len = 3;
 	if (Sscan::Char(pLine, PARAMS_MERGE_MODE, value, &len) == SSCAN_OK) {
 		if (memcmp(value, "ltp", 3) == 0) {
@@ -334,6 +357,10 @@ void ArtNetParams::Set(ArtNetNode *pArtNetNode) {
 		return;
 	}
 
+	if (isMaskSet(SET_MAX_PORTS_MASK)) {
+		pArtNetNode->SetMaxPorts(m_tArtNetParams.nMaxPorts);
+	}
+
 	if(isMaskSet(SET_SHORT_NAME_MASK)) {
 		pArtNetNode->SetShortName((const char *)m_tArtNetParams.aShortName);
 	}
@@ -366,14 +393,14 @@ void ArtNetParams::Set(ArtNetNode *pArtNetNode) {
 		pArtNetNode->SetDisableMergeTimeout(m_tArtNetParams.bDisableMergeTimeout);
 	}
 
-	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
-		if (isMaskSet(SET_MERGE_MODE_A_MASK << i)) {
+	for (unsigned i = 0; i < pArtNetNode->GetMaxPorts(); i++) {
+		if ((i < ARTNET_MAX_PORTS) && isMaskSet(SET_MERGE_MODE_A_MASK << i)) {
 			pArtNetNode->SetMergeMode(i, (TMerge) m_tArtNetParams.nMergeModePort[i]);
 		} else {
 			pArtNetNode->SetMergeMode(i, (TMerge) m_tArtNetParams.nMergeMode);
 		}
 
-		if (isMaskSet(SET_PROTOCOL_A_MASK << i)) {
+		if ((i < ARTNET_MAX_PORTS) && isMaskSet(SET_PROTOCOL_A_MASK << i)) {
 			pArtNetNode->SetPortProtocol(i, (TPortProtocol) m_tArtNetParams.nProtocolPort[i]);
 		} else {
 			pArtNetNode->SetPortProtocol(i, (TPortProtocol) m_tArtNetParams.nProtocol);
@@ -416,6 +443,10 @@ void ArtNetParams::Dump(void) {
 		}
 	}
 
+	if (isMaskSet(SET_RDM_TOD_SIZE_MASK)) {
+		printf(" %s=%d\n", PARAMS_RDM_TOD_SIZE, (int) m_tArtNetParams.nRdmTodSize);
+	}
+
 	if(isMaskSet(SET_TIMECODE_MASK)) {
 		printf(" %s=%d [%s]\n", PARAMS_TIMECODE, (int) m_tArtNetParams.bUseTimeCode, BOOL2STRING(m_tArtNetParams.bUseTimeCode));
 	}
@@ -444,6 +475,10 @@ void ArtNetParams::Dump(void) {
 		printf(" %s=%d [%s]\n", PARAMS_NODE_DISABLE_MERGE_TIMEOUT, (int) m_tArtNetParams.bDisableMergeTimeout, BOOL2STRING(m_tArtNetParams.bDisableMergeTimeout));
 	}
 
+	if (isMaskSet(SET_MAX_PORTS_MASK)) {
+		printf(" %s=%d\n", PARAMS_MAX_PORTS, (int) m_tArtNetParams.nMaxPorts);
+	}
+
 	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
 		if (isMaskSet(SET_UNIVERSE_A_MASK << i)) {
 			printf(" %s=%d\n", PARAMS_UNIVERSE_PORT[i], m_tArtNetParams.nUniversePort[i]);
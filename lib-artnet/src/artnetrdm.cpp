@@ -26,8 +26,35 @@
  * THE SOFTWARE.
  */
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #include <artnetrdm.h>
 
 ArtNetRdm::~ArtNetRdm(void) {
 
 }
+
+bool ArtNetRdm::IsAsync(void) {
+	return false;
+}
+
+bool ArtNetRdm::Submit(uint8_t nPort, const uint8_t *pRdmData, uint32_t nIpAddress) {
+	return false;
+}
+
+bool ArtNetRdm::Run(struct TArtNetRdmResponse *pResponse) {
+	return false;
+}
+
+bool ArtNetRdm::StartDiscovery(uint8_t nPort) {
+	return false;
+}
+
+TArtNetRdmDiscovery ArtNetRdm::GetDiscoveryState(uint8_t nPort) {
+	return ARTNET_RDM_DISCOVERY_DONE;
+}
+
+bool ArtNetRdm::IsTodChanged(uint8_t nPort) {
+	return false;
+}
@@ -35,6 +35,8 @@
  #else
   #define DMX_MAX_UARTS	2	///< Orange Pi Zero & NanoPi NEO
  #endif
+#elif defined(__linux__) && !defined(RASPPI)
+ #define DMX_MAX_UARTS	4	///< Simulated RDM responders, see src/linux/rdm.cpp
 #else
  #define DMX_MAX_UARTS	1	///< All Raspberry Pi's
 #endif
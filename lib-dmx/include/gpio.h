@@ -50,6 +50,8 @@
   #define GPIO_ANALYZER_CH6
   #define GPIO_ANALYZER_CH7
  #endif
+#elif defined(__linux__) && !defined(RASPPI)
+ #define GPIO_DMX_DATA_DIRECTION			0	///< Simulated RDM responders, there is no data direction pin
 #else
  #include "bcm2835.h"
  #define GPIO_DMX_DATA_DIRECTION			RPI_V2_GPIO_P1_12
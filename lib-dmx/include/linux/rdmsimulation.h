@@ -0,0 +1,68 @@
+/**
+ * @file rdmsimulation.h
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LINUX_RDMSIMULATION_H_
+#define LINUX_RDMSIMULATION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct TRdmSimulationStats {
+	uint32_t nDiscUniqueBranch;
+	uint32_t nCollisions;		///< DISC_UNIQUE_BRANCH answered by more than one responder
+	uint32_t nMute;
+	uint32_t nUnMute;
+	uint32_t nRequests;			///< GET and SET
+};
+
+enum TRdmSimulationMute {
+	RDM_SIMULATION_MUTE,			///< DISC_MUTE is acknowledged and the responder stops answering DISC_UNIQUE_BRANCH
+	RDM_SIMULATION_MUTE_IGNORED,	///< DISC_MUTE is neither acknowledged nor kept
+	RDM_SIMULATION_MUTE_NOT_KEPT	///< DISC_MUTE is acknowledged, but the responder keeps answering DISC_UNIQUE_BRANCH
+};
+
+/**
+ * The line of simulated responders behind each port of the Linux Rdm backend
+ */
+class RdmSimulation {
+public:
+	/**
+	 * @param nSeed 0: sequential device id's, else the device id's are spread pseudo randomly
+	 */
+	static void SetResponders(uint8_t nPort, uint32_t nCount, uint32_t nSeed = 0);
+	static bool AddResponder(uint8_t nPort, const uint8_t *pUid);
+	static bool RemoveResponder(uint8_t nPort, const uint8_t *pUid);
+	/**
+	 * Simulates a responder that does not follow the discovery rules
+	 */
+	static bool SetMute(uint8_t nPort, const uint8_t *pUid, TRdmSimulationMute tMute);
+	static uint32_t GetResponders(uint8_t nPort);
+	static const uint8_t *GetResponderUid(uint8_t nPort, uint32_t nIndex);
+
+	static void GetStats(uint8_t nPort, struct TRdmSimulationStats *pStats);
+	static void ResetStats(uint8_t nPort);
+};
+
+#endif /* LINUX_RDMSIMULATION_H_ */
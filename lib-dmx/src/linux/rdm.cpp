@@ -0,0 +1,551 @@
+/**
+ * @file rdm.cpp
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Simulated RDM responders, so that the RDM controller code can run on Linux.
+ * Each port has a line of responders, SIMULATED_RESPONDERS by default, which
+ * answer after SIMULATED_RESPONSE_DELAY micro seconds, as they would on the wire.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <assert.h>
+
+#include "rdm.h"
+#include "rdm_e120.h"
+#include "dmx.h"
+
+#include "linux/rdmsimulation.h"
+
+#include "debug.h"
+
+#define SIMULATED_RESPONDERS			3
+#define SIMULATED_RESPONSE_DELAY		2000	///< Micro seconds
+#define SIMULATED_MANUFACTURER_ID		0x7FF0	///< ESTA prototype range
+
+struct TSimulatedResponder {
+	uint8_t Uid[RDM_UID_SIZE];
+	bool IsMuted;
+	TRdmSimulationMute tMute;
+	uint8_t nIdentify;
+	uint8_t nDeviceLabelLength;
+	char aDeviceLabel[RDM_DEVICE_LABEL_MAX_LENGTH];
+};
+
+struct TSimulatedPort {
+	struct TSimulatedResponder *pResponders;
+	uint32_t nResponders;
+	uint32_t nSize;
+	struct TRdmSimulationStats tStats;
+	uint8_t Response[sizeof(struct TRdmMessage) + RDM_MESSAGE_CHECKSUM_SIZE];
+	uint64_t nAvailableMicros;
+	bool IsAvailable;
+};
+
+static struct TSimulatedPort s_Ports[DMX_MAX_UARTS];
+static bool s_IsInitDone = false;
+
+uint8_t Rdm::m_TransactionNumber = 0;
+
+static uint64_t micros(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000;
+}
+
+static void add_responder(struct TSimulatedPort *pPort, const uint8_t *pUid) {
+	if (pPort->nResponders == pPort->nSize) {
+		const uint32_t nSize = pPort->nSize == 0 ? 8 : 2 * pPort->nSize;
+		struct TSimulatedResponder *pResponders = new TSimulatedResponder[nSize];
+		assert(pResponders != 0);
+
+		if (pPort->pResponders != 0) {
+			memcpy(pResponders, pPort->pResponders, pPort->nResponders * sizeof(struct TSimulatedResponder));
+			delete[] pPort->pResponders;
+		}
+
+		pPort->pResponders = pResponders;
+		pPort->nSize = nSize;
+	}
+
+	struct TSimulatedResponder *pResponder = &pPort->pResponders[pPort->nResponders++];
+
+	memcpy(pResponder->Uid, pUid, RDM_UID_SIZE);
+	pResponder->IsMuted = false;
+	pResponder->tMute = RDM_SIMULATION_MUTE;
+	pResponder->nIdentify = RDM_IDENTIFY_STATE_OFF;
+	pResponder->nDeviceLabelLength = (uint8_t) snprintf(pResponder->aDeviceLabel, sizeof(pResponder->aDeviceLabel), "Responder %.2x%.2x:%.2x%.2x%.2x%.2x", pUid[0], pUid[1], pUid[2], pUid[3], pUid[4], pUid[5]);
+}
+
+static int find_responder(const struct TSimulatedPort *pPort, const uint8_t *pUid) {
+	for (uint32_t i = 0; i < pPort->nResponders; i++) {
+		if (memcmp(pPort->pResponders[i].Uid, pUid, RDM_UID_SIZE) == 0) {
+			return (int) i;
+		}
+	}
+
+	return -1;
+}
+
+static void init(void) {
+	s_IsInitDone = true;
+
+	for (unsigned nPort = 0; nPort < DMX_MAX_UARTS; nPort++) {
+		s_Ports[nPort].pResponders = 0;
+		s_Ports[nPort].nResponders = 0;
+		s_Ports[nPort].nSize = 0;
+		s_Ports[nPort].IsAvailable = false;
+
+		RdmSimulation::SetResponders(nPort, SIMULATED_RESPONDERS);
+	}
+}
+
+static bool is_broadcast(const uint8_t *pUid) {
+	return (pUid[2] == 0xFF) && (pUid[3] == 0xFF) && (pUid[4] == 0xFF) && (pUid[5] == 0xFF);
+}
+
+static bool is_addressed(const struct TSimulatedResponder *pResponder, const uint8_t *pUid) {
+	if (memcmp(pResponder->Uid, pUid, RDM_UID_SIZE) == 0) {
+		return true;
+	}
+
+	return is_broadcast(pUid) && ((memcmp(pUid, UID_ALL, 2) == 0) || (memcmp(pResponder->Uid, pUid, 2) == 0));
+}
+
+static uint64_t uid_to_uint(const uint8_t *pUid) {
+	uint64_t nUid = 0;
+
+	for (unsigned i = 0; i < RDM_UID_SIZE; i++) {
+		nUid = (nUid << 8) | pUid[i];
+	}
+
+	return nUid;
+}
+
+static void respond(struct TSimulatedPort *pPort, const struct TRdmMessage *pRequest, const struct TSimulatedResponder *pResponder, uint8_t nResponseType, const uint8_t *pParamData, uint8_t nParamDataLength) {
+	struct TRdmMessage *pResponse = (struct TRdmMessage *) pPort->Response;
+
+	pResponse->start_code = E120_SC_RDM;
+	pResponse->sub_start_code = E120_SC_SUB_MESSAGE;
+	pResponse->message_length = RDM_MESSAGE_MINIMUM_SIZE + nParamDataLength;
+	memcpy(pResponse->destination_uid, pRequest->source_uid, RDM_UID_SIZE);
+	memcpy(pResponse->source_uid, pResponder->Uid, RDM_UID_SIZE);
+	pResponse->transaction_number = pRequest->transaction_number;
+	pResponse->slot16.response_type = nResponseType;
+	pResponse->message_count = 0;
+	pResponse->sub_device[0] = pRequest->sub_device[0];
+	pResponse->sub_device[1] = pRequest->sub_device[1];
+	pResponse->command_class = pRequest->command_class + 1;
+	pResponse->param_id[0] = pRequest->param_id[0];
+	pResponse->param_id[1] = pRequest->param_id[1];
+	pResponse->param_data_length = nParamDataLength;
+	memcpy(pResponse->param_data, pParamData, nParamDataLength);
+
+	uint16_t nChecksum = 0;
+	unsigned i;
+
+	for (i = 0; i < pResponse->message_length; i++) {
+		nChecksum += pPort->Response[i];
+	}
+
+	pPort->Response[i++] = (uint8_t) (nChecksum >> 8);
+	pPort->Response[i] = (uint8_t) nChecksum;
+
+	pPort->nAvailableMicros = micros() + SIMULATED_RESPONSE_DELAY;
+	pPort->IsAvailable = true;
+}
+
+static void respond_nack(struct TSimulatedPort *pPort, const struct TRdmMessage *pRequest, const struct TSimulatedResponder *pResponder, uint16_t nReason) {
+	const uint8_t ParamData[2] = { (uint8_t) (nReason >> 8), (uint8_t) nReason };
+	respond(pPort, pRequest, pResponder, E120_RESPONSE_TYPE_NACK_REASON, ParamData, sizeof(ParamData));
+}
+
+/**
+ * 7.5 Discovery Unique Branch Message. Responders in the same branch collide,
+ * the bytes on the wire are OR-ed which corrupts the checksum.
+ */
+static void disc_unique_branch(struct TSimulatedPort *pPort, const struct TRdmMessage *pRequest) {
+	struct TRdmDiscoveryMsg *pResponse = (struct TRdmDiscoveryMsg *) pPort->Response;
+	const uint64_t nLowerBound = uid_to_uint(&pRequest->param_data[0]);
+	const uint64_t nUpperBound = uid_to_uint(&pRequest->param_data[RDM_UID_SIZE]);
+
+	memset(pResponse, 0, sizeof(struct TRdmDiscoveryMsg));
+
+	uint32_t nResponding = 0;
+
+	pPort->tStats.nDiscUniqueBranch++;
+
+	for (uint32_t i = 0; i < pPort->nResponders; i++) {
+		const struct TSimulatedResponder *pResponder = &pPort->pResponders[i];
+		const uint64_t nUid = uid_to_uint(pResponder->Uid);
+
+		if (pResponder->IsMuted || (nUid < nLowerBound) || (nUid > nUpperBound)) {
+			continue;
+		}
+
+		uint16_t nChecksum = 0;
+
+		for (unsigned j = 0; j < RDM_UID_SIZE; j++) {
+			pResponse->masked_device_id[2 * j] |= pResponder->Uid[j] | 0xAA;
+			pResponse->masked_device_id[2 * j + 1] |= pResponder->Uid[j] | 0x55;
+			nChecksum += (pResponder->Uid[j] | 0xAA) + (pResponder->Uid[j] | 0x55);
+		}
+
+		pResponse->checksum[0] |= (uint8_t) (nChecksum >> 8) | 0xAA;
+		pResponse->checksum[1] |= (uint8_t) (nChecksum >> 8) | 0x55;
+		pResponse->checksum[2] |= (uint8_t) nChecksum | 0xAA;
+		pResponse->checksum[3] |= (uint8_t) nChecksum | 0x55;
+
+		nResponding++;
+	}
+
+	if (nResponding > 1) {
+		pPort->tStats.nCollisions++;
+	}
+
+	if (nResponding != 0) {
+		memset(pResponse->header_FE, 0xFE, sizeof(pResponse->header_FE));
+		pResponse->header_AA = 0xAA;
+
+		pPort->nAvailableMicros = micros() + SIMULATED_RESPONSE_DELAY;
+		pPort->IsAvailable = true;
+	}
+}
+
+static void process(struct TSimulatedPort *pPort, const struct TRdmMessage *pRequest) {
+	const uint16_t nParamId = (uint16_t) (pRequest->param_id[0] << 8) | pRequest->param_id[1];
+	const bool IsBroadcast = is_broadcast(pRequest->destination_uid);
+
+	if (pRequest->command_class == E120_DISCOVERY_COMMAND) {
+		if (nParamId == E120_DISC_UNIQUE_BRANCH) {
+			disc_unique_branch(pPort, pRequest);
+			return;
+		}
+
+		if (nParamId == E120_DISC_MUTE) {
+			pPort->tStats.nMute++;
+		} else if (nParamId == E120_DISC_UN_MUTE) {
+			pPort->tStats.nUnMute++;
+		}
+
+		for (uint32_t i = 0; i < pPort->nResponders; i++) {
+			struct TSimulatedResponder *pResponder = &pPort->pResponders[i];
+
+			if (!is_addressed(pResponder, pRequest->destination_uid)) {
+				continue;
+			}
+
+			if ((nParamId == E120_DISC_MUTE) && (pResponder->tMute == RDM_SIMULATION_MUTE_IGNORED)) {
+				continue;
+			}
+
+			if ((nParamId == E120_DISC_MUTE) || (nParamId == E120_DISC_UN_MUTE)) {
+				pResponder->IsMuted = (nParamId == E120_DISC_MUTE) && (pResponder->tMute == RDM_SIMULATION_MUTE);
+
+				if (!IsBroadcast) {
+					const uint8_t ControlField[2] = { 0, 0 };
+					respond(pPort, pRequest, pResponder, E120_RESPONSE_TYPE_ACK, ControlField, sizeof(ControlField));
+				}
+			}
+		}
+
+		return;
+	}
+
+	pPort->tStats.nRequests++;
+
+	for (uint32_t i = 0; i < pPort->nResponders; i++) {
+		struct TSimulatedResponder *pResponder = &pPort->pResponders[i];
+
+		if (!is_addressed(pResponder, pRequest->destination_uid)) {
+			continue;
+		}
+
+		const bool IsGet = (pRequest->command_class == E120_GET_COMMAND);
+
+		switch (nParamId) {
+		case E120_DEVICE_LABEL:
+			if (IsGet) {
+				respond(pPort, pRequest, pResponder, E120_RESPONSE_TYPE_ACK, (const uint8_t *) pResponder->aDeviceLabel, pResponder->nDeviceLabelLength);
+				continue;
+			}
+
+			pResponder->nDeviceLabelLength = pRequest->param_data_length > RDM_DEVICE_LABEL_MAX_LENGTH ? RDM_DEVICE_LABEL_MAX_LENGTH : pRequest->param_data_length;
+			memcpy(pResponder->aDeviceLabel, pRequest->param_data, pResponder->nDeviceLabelLength);
+			break;
+		case E120_IDENTIFY_DEVICE:
+			if (IsGet) {
+				respond(pPort, pRequest, pResponder, E120_RESPONSE_TYPE_ACK, &pResponder->nIdentify, 1);
+				continue;
+			}
+
+			if (pRequest->param_data_length != 1) {
+				if (!IsBroadcast) {
+					respond_nack(pPort, pRequest, pResponder, E120_NR_FORMAT_ERROR);
+				}
+				continue;
+			}
+
+			pResponder->nIdentify = pRequest->param_data[0];
+			break;
+		default:
+			if (!IsBroadcast) {
+				respond_nack(pPort, pRequest, pResponder, E120_NR_UNKNOWN_PID);
+			}
+			continue;
+		}
+
+		if (!IsBroadcast) {
+			respond(pPort, pRequest, pResponder, E120_RESPONSE_TYPE_ACK, 0, 0);
+		}
+	}
+}
+
+void RdmSimulation::SetResponders(uint8_t nPort, uint32_t nCount, uint32_t nSeed) {
+	assert(nPort < DMX_MAX_UARTS);
+
+	if (!s_IsInitDone) {
+		init();
+	}
+
+	struct TSimulatedPort *pPort = &s_Ports[nPort];
+	uint32_t nRandom = nSeed;
+	uint8_t Uid[RDM_UID_SIZE];
+
+	pPort->nResponders = 0;
+
+	Uid[0] = (uint8_t) (SIMULATED_MANUFACTURER_ID >> 8);
+	Uid[1] = (uint8_t) SIMULATED_MANUFACTURER_ID;
+
+	while (pPort->nResponders < nCount) {
+		uint32_t nDeviceId;
+
+		if (nSeed == 0) {
+			nDeviceId = ((uint32_t) nPort << 24) | (pPort->nResponders + 1);
+		} else {
+			// xorshift32
+			nRandom ^= nRandom << 13;
+			nRandom ^= nRandom >> 17;
+			nRandom ^= nRandom << 5;
+			nDeviceId = nRandom;
+		}
+
+		Uid[2] = (uint8_t) (nDeviceId >> 24);
+		Uid[3] = (uint8_t) (nDeviceId >> 16);
+		Uid[4] = (uint8_t) (nDeviceId >> 8);
+		Uid[5] = (uint8_t) nDeviceId;
+
+		if ((nDeviceId != 0xFFFFFFFF) && (find_responder(pPort, Uid) < 0)) {
+			add_responder(pPort, Uid);
+		}
+	}
+}
+
+bool RdmSimulation::AddResponder(uint8_t nPort, const uint8_t *pUid) {
+	assert(nPort < DMX_MAX_UARTS);
+
+	if (!s_IsInitDone) {
+		init();
+	}
+
+	if (find_responder(&s_Ports[nPort], pUid) >= 0) {
+		return false;
+	}
+
+	add_responder(&s_Ports[nPort], pUid);
+
+	return true;
+}
+
+bool RdmSimulation::RemoveResponder(uint8_t nPort, const uint8_t *pUid) {
+	assert(nPort < DMX_MAX_UARTS);
+
+	if (!s_IsInitDone) {
+		init();
+	}
+
+	struct TSimulatedPort *pPort = &s_Ports[nPort];
+	const int i = find_responder(pPort, pUid);
+
+	if (i < 0) {
+		return false;
+	}
+
+	pPort->pResponders[i] = pPort->pResponders[--pPort->nResponders];
+
+	return true;
+}
+
+bool RdmSimulation::SetMute(uint8_t nPort, const uint8_t *pUid, TRdmSimulationMute tMute) {
+	assert(nPort < DMX_MAX_UARTS);
+
+	if (!s_IsInitDone) {
+		init();
+	}
+
+	struct TSimulatedPort *pPort = &s_Ports[nPort];
+	const int i = find_responder(pPort, pUid);
+
+	if (i < 0) {
+		return false;
+	}
+
+	pPort->pResponders[i].tMute = tMute;
+
+	return true;
+}
+
+uint32_t RdmSimulation::GetResponders(uint8_t nPort) {
+	assert(nPort < DMX_MAX_UARTS);
+
+	if (!s_IsInitDone) {
+		init();
+	}
+
+	return s_Ports[nPort].nResponders;
+}
+
+const uint8_t *RdmSimulation::GetResponderUid(uint8_t nPort, uint32_t nIndex) {
+	assert(nPort < DMX_MAX_UARTS);
+
+	if (!s_IsInitDone) {
+		init();
+	}
+
+	if (nIndex >= s_Ports[nPort].nResponders) {
+		return 0;
+	}
+
+	return s_Ports[nPort].pResponders[nIndex].Uid;
+}
+
+void RdmSimulation::GetStats(uint8_t nPort, struct TRdmSimulationStats *pStats) {
+	assert(nPort < DMX_MAX_UARTS);
+	assert(pStats != 0);
+
+	memcpy(pStats, &s_Ports[nPort].tStats, sizeof(struct TRdmSimulationStats));
+}
+
+void RdmSimulation::ResetStats(uint8_t nPort) {
+	assert(nPort < DMX_MAX_UARTS);
+
+	memset(&s_Ports[nPort].tStats, 0, sizeof(struct TRdmSimulationStats));
+}
+
+Rdm::Rdm(void) {
+}
+
+Rdm::~Rdm(void) {
+
+}
+
+const uint8_t *Rdm::Receive(uint8_t nPort) {
+	assert(nPort < DMX_MAX_UARTS);
+
+	struct TSimulatedPort *pPort = &s_Ports[nPort];
+
+	if (pPort->IsAvailable && (micros() >= pPort->nAvailableMicros)) {
+		pPort->IsAvailable = false;
+		return (const uint8_t *) pPort->Response;
+	}
+
+	return 0;
+}
+
+const uint8_t *Rdm::ReceiveTimeOut(uint8_t nPort, uint32_t nTimeOut) {
+	const uint64_t nMicros = micros() + nTimeOut;
+	const uint8_t *p;
+
+	do {
+		if ((p = Receive(nPort)) != 0) {
+			return p;
+		}
+	} while (micros() < nMicros);
+
+	return 0;
+}
+
+void Rdm::Send(uint8_t nPort, struct TRdmMessage *pRdmCommand) {
+	assert(pRdmCommand != 0);
+
+	uint8_t *rdm_data = (uint8_t *)pRdmCommand;
+	uint32_t i;
+	uint16_t rdm_checksum = 0;
+
+	pRdmCommand->transaction_number = m_TransactionNumber;
+
+	for (i = 0; i < pRdmCommand->message_length; i++) {
+		rdm_checksum += rdm_data[i];
+	}
+
+	rdm_data[i++] = rdm_checksum >> 8;
+	rdm_data[i] = rdm_checksum & 0XFF;
+
+	SendRaw(nPort, (const uint8_t *)pRdmCommand, pRdmCommand->message_length + RDM_MESSAGE_CHECKSUM_SIZE);
+
+	m_TransactionNumber++;
+}
+
+void Rdm::SendRaw(uint8_t nPort, const uint8_t *pRdmData, uint16_t nLength) {
+	assert(nPort < DMX_MAX_UARTS);
+	assert(pRdmData != 0);
+	assert(nLength != 0);
+
+	if (!s_IsInitDone) {
+		init();
+	}
+
+	const struct TRdmMessage *pRequest = (const struct TRdmMessage *) pRdmData;
+
+	if ((nLength < RDM_MESSAGE_MINIMUM_SIZE + RDM_MESSAGE_CHECKSUM_SIZE) || (pRequest->start_code != E120_SC_RDM) || (pRequest->message_length + RDM_MESSAGE_CHECKSUM_SIZE > nLength)) {
+		DEBUG_PRINTF("nPort=%d, invalid message", nPort);
+		return;
+	}
+
+	uint16_t nChecksum = 0;
+	unsigned i;
+
+	for (i = 0; i < pRequest->message_length; i++) {
+		nChecksum += pRdmData[i];
+	}
+
+	if ((pRdmData[i] != (uint8_t) (nChecksum >> 8)) || (pRdmData[i + 1] != (uint8_t) nChecksum)) {
+		DEBUG_PRINTF("nPort=%d, checksum error", nPort);
+		return;
+	}
+
+	process(&s_Ports[nPort], pRequest);
+}
+
+void Rdm::SendRawRespondMessage(uint8_t nPort, const uint8_t *pRdmData, uint16_t nLength) {
+	// The simulation has no RDM controller on the wire
+}
+
+void Rdm::SendDiscoveryRespondMessage(const uint8_t *data, uint16_t data_length) {
+	// The simulation has no RDM controller on the wire
+}
@@ -32,7 +32,7 @@
 #include "lightset.h"
 
 #if defined (__linux__) || defined (__CYGWIN__) || defined(__APPLE__)
- #define DMXMONITOR_MAX_PORTS	4
+ #define DMXMONITOR_MAX_PORTS	256	///< linux_artnet outputs all its ports (up to ARTNET_NODE_MAX_PORTS, configured with max_ports) to one DMXMonitor
 #endif
 
 class DMXMonitor: public LightSet {
@@ -49,6 +49,7 @@ public:
 	void Stop(uint8_t nPort = 0);
 
 	void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength);
+	void SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nLength, uint16_t nFirstSlot, uint16_t nLastSlot);
 
 #if defined (__linux__) || defined (__CYGWIN__) || defined(__APPLE__)
 #else
@@ -64,6 +65,10 @@ private:
 
 private:
 	void Update(void);
+#if defined (__linux__) || defined (__CYGWIN__) || defined(__APPLE__)
+#else
+	void UpdateRow(uint32_t nRow);
+#endif
 
 private:
 	uint16_t m_nSlots;
@@ -127,3 +127,14 @@ void DMXMonitor::SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength)
 	printf("\n");
 }
 
+void DMXMonitor::SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nLength, uint16_t nFirstSlot, uint16_t nLastSlot) {
+	const uint16_t nFirst = m_nDmxStartAddress - 1;
+
+	// Nothing changed inside the monitored window
+	if ((nLastSlot < nFirst) || (nFirstSlot >= nFirst + m_nMaxChannels)) {
+		return;
+	}
+
+	SetData(nPort, pData, nLength);
+}
+
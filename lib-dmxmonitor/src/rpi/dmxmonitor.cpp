@@ -117,32 +117,54 @@ void DMXMonitor::SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength)
 	Update();
 }
 
-void DMXMonitor::Update(void) {
-	uint32_t row = TOP_ROW;
-	uint32_t i, j;
-	uint8_t *p = (uint8_t *) m_Data;
-	uint16_t slot = 0;
+void DMXMonitor::SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nLength, uint16_t nFirstSlot, uint16_t nLastSlot) {
+	if ((nLength != m_nSlots) || (nFirstSlot > nLastSlot) || (nLastSlot >= nLength)) {
+		SetData(nPort, pData, nLength);
+		return;
+	}
 
-	for (i = 0; (i < 16) && (slot < m_nSlots); i++) {
+	for (uint32_t i = nFirstSlot; i <= nLastSlot; i++) {
+		m_Data[i] = pData[i];
+	}
 
-		console_set_cursor(4, ++row);
+	// Only redraw the rows holding changed slots
+	for (uint32_t i = nFirstSlot / 32; i <= (uint32_t) (nLastSlot / 32); i++) {
+		UpdateRow(i);
+	}
+}
 
-		for (j = 0; (j < 32) && (slot < m_nSlots); j++) {
-			const uint8_t d = *p++;
+void DMXMonitor::UpdateRow(uint32_t nRow) {
+	uint32_t j;
+	const uint8_t *p = (const uint8_t *) &m_Data[nRow * 32];
+	uint16_t slot = nRow * 32;
 
-			if (d == 0) {
-				console_puts(" 0");
-			} else {
-				console_puthex_fg_bg(d, (uint16_t) (d > 92 ? CONSOLE_BLACK : CONSOLE_WHITE), (uint16_t) RGB(d, d, d));
-			}
+	console_set_cursor(4, TOP_ROW + 1 + nRow);
 
-			console_putc((int) ' ');
-			slot++;
-		}
+	for (j = 0; (j < 32) && (slot < m_nSlots); j++) {
+		const uint8_t d = *p++;
 
-		for (; j < 32; j++) {
-			console_puts("   ");
+		if (d == 0) {
+			console_puts(" 0");
+		} else {
+			console_puthex_fg_bg(d, (uint16_t) (d > 92 ? CONSOLE_BLACK : CONSOLE_WHITE), (uint16_t) RGB(d, d, d));
 		}
+
+		console_putc((int) ' ');
+		slot++;
+	}
+
+	for (; j < 32; j++) {
+		console_puts("   ");
+	}
+}
+
+void DMXMonitor::Update(void) {
+	uint32_t row = TOP_ROW;
+	uint32_t i;
+
+	for (i = 0; (i < 16) && ((i * 32) < m_nSlots); i++) {
+		UpdateRow(i);
+		row++;
 	}
 
 	for (; i < 16; i++) {
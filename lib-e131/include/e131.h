@@ -33,6 +33,10 @@ enum {
 	E131_MAX_PORTS = 4
 };
 
+enum {
+	E131_NODE_MAX_PORTS = 256	///< Limited by the uint8_t port index of LightSet
+};
+
 ///< ANSI E1.31 — 2016 Entertainment Technology
 ///< Lightweight streaming protocol for transport of DMX512 using ACN
 
@@ -80,6 +84,12 @@ enum TVectorDMP {
 
 #define VECTOR_UNIVERSE_DISCOVERY_UNIVERSE_LIST 0x00000001
 
+/**
+ * 8 Universe Discovery Layer
+ * A Universe Discovery Packet lists up to 512 universes. Longer lists are sent in multiple pages.
+ */
+#define E131_DISCOVERY_UNIVERSES_PER_PAGE	512
+
 /**
  * When multicast addressing is used, the UDP destination Port shall be set to the standard ACN-SDT
  * multicast port (5568).
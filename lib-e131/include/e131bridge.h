@@ -35,16 +35,21 @@
 
 #define UUID_STRING_LENGTH	36
 
+#define E131_UNIVERSE_INDEX_SIZE	256		///< Number of entries in the universe lookup table
+#define E131_PORT_INDEX_NONE		0xFFFF	///< Marks the end of a universe lookup chain
+
+#define E131_RECV_QUEUE_DEPTH_PORT	2	///< Datagrams queued by the network stack for each port with a universe
+#define E131_RECV_QUEUE_DEPTH_MAX	16	///< The network stack queues are taken from one small pool
+
+struct TNetworkQueueStats;
+
 struct TE131BridgeState {
-	uint8_t nPriority;
 	bool IsNetworkDataLoss;			///<
-	bool IsMergeMode;				///< Is the Bridge in merging mode?
-	bool IsTransmitting;			///<
 	bool IsSynchronized;			///< “Synchronized” or an “Unsynchronized” state.
 	bool IsForcedSynchronized;		///<
 	uint32_t SynchronizationTime;	///<
 	uint32_t DiscoveryTime;			///<
-	uint16_t DiscoveryPacketLength;	///<
+	uint16_t nActiveUniverses;		///< Number of different universes in the Universe Discovery list
 };
 
 struct TSource {
@@ -58,8 +63,17 @@ struct TSource {
 struct TE131OutputPort {
 	uint8_t data[E131_DMX_LENGTH];	///< Data sent
 	uint16_t length;				///< Length of sent DMX data
+	uint16_t nFirstSlot;			///< First slot changed since the last output
+	uint16_t nLastSlot;				///< Last slot changed since the last output
+	uint16_t nUniverse;				///< 0 when the port is not used
+	uint32_t nMulticastIp;			///<
+	uint8_t nPriority;				///<
 	TE131Merge mergeMode;			///<
+	bool IsMerging;					///< Is the port in merging mode?
+	bool IsTransmitting;			///<
 	bool IsDataPending;				///<
+	uint16_t nNextPortIndex;		///< Next port with the same universe lookup table entry
+	uint32_t nPacketMillis;			///< Last data packet for the universe, for the network data loss timeout
 	struct TSource sourceA;			///<
 	struct TSource sourceB;			///<
 };
@@ -73,16 +87,35 @@ public:
 
 	const uint8_t *GetSoftwareVersion(void);
 
+	void SetMaxPorts(uint16_t);
+	inline uint16_t GetMaxPorts(void) const {
+		return m_nPorts;
+	}
+
 	uint16_t GetUniverse(void) const;
 	void SetUniverse(const uint16_t);
 
-	inline uint32_t GetMulticastIp(void) {
-		return m_nMulticastIp;
+	uint16_t GetUniverse(uint16_t nPortIndex) const;
+	void SetUniverse(uint16_t nPortIndex, const uint16_t);
+
+	inline uint32_t GetMulticastIp(void) const {
+		return m_OutputPorts[0].nMulticastIp;
+	}
+
+	inline uint32_t GetMulticastIp(uint16_t nPortIndex) const {
+		return m_OutputPorts[nPortIndex].nMulticastIp;
+	}
+
+	inline uint16_t GetActiveUniverses(void) const {
+		return m_State.nActiveUniverses;
 	}
 
 	TE131Merge GetMergeMode(void) const;
 	void SetMergeMode(TE131Merge);
 
+	TE131Merge GetMergeMode(uint16_t nPortIndex) const;
+	void SetMergeMode(uint16_t nPortIndex, TE131Merge);
+
 	const uint8_t *GetCid(void);
 	void SetCid(const uint8_t[E131_CID_LENGTH]);
 
@@ -94,43 +127,61 @@ public:
 
 	int Run(void);
 
+	/**
+	 * @return false when the network stack does not keep receive queue statistics
+	 */
+	bool GetQueueStats(struct TNetworkQueueStats *pStats);
+
 	void Print(void);
 
 private:
+	void UpdateUniverseIndex(void);
+	void JoinGroups(void);
+	void LeaveGroups(void);
+
 	void FillDiscoveryPacket(void);
 
 	bool IsValidRoot(void);
 	bool IsValidDataPacket(void);
+	void ReleasePacket(void);
 
 	void SetNetworkDataLossCondition(void);
-	void CheckMergeTimeouts(void);
-	bool IsPriorityTimeOut(void);
+	void SetNetworkDataLossCondition(uint16_t nPortIndex);
+	void CheckNetworkDataLoss(void);
+	void CheckMergeTimeouts(uint16_t nPortIndex);
+	bool IsPriorityTimeOut(uint16_t nPortIndex);
 	bool isIpCidMatch(const struct TSource *);
-	bool IsDmxDataChanged(const uint8_t *, uint16_t);
-	bool IsMergedDmxDataChanged(const uint8_t *, uint16_t );
+	bool IsDmxDataChanged(uint16_t nPortIndex, const uint8_t *, uint16_t);
+	bool IsMergedDmxDataChanged(uint16_t nPortIndex, const uint8_t *, uint16_t );
+
+	void SetLightSetData(uint16_t nPortIndex);
 
 	void SendDiscoveryPacket(void);
 
 	void HandleDmx(void);
+	void HandleDmx(uint16_t nPortIndex);
 	void HandleSynchronization(void);
 
 private:
 	int32_t m_nHandle;
 	LightSet *m_pLightSet;
-	uint16_t m_nUniverse;
-	uint32_t m_nMulticastIp;
 	uint8_t m_Cid[E131_CID_LENGTH];
 	char m_SourceName[E131_SOURCE_NAME_LENGTH];
 
 	uint32_t m_DiscoveryIpAddress;
 
 	uint32_t m_nCurrentPacketMillis;
-	uint32_t m_nPreviousPacketMillis;
+	uint32_t m_nDataLossCheckMillis;
 
 	struct TE131BridgeState m_State;
-	struct TE131OutputPort m_OutputPort;
+
+	uint16_t m_nPorts;
+	struct TE131OutputPort *m_OutputPorts;
+	uint16_t m_aUniverseIndex[E131_UNIVERSE_INDEX_SIZE];	///< Universe & 0xFF -> first port index
+	uint16_t *m_pDiscoveryUniverses;						///< Sorted list of the different universes
 
 	struct TE131 m_E131;
+	union UE131Packet *m_pE131Packet;						///< The packet being handled, borrowed from the network receive queue
 	struct TE131DiscoveryPacket m_E131DiscoveryPacket;
 };
 
@@ -46,6 +46,7 @@ struct TE131Params {
     uint16_t nUniversePort[E131_MAX_PORTS];
 	uint8_t nMergeMode;
 	uint8_t nMergeModePort[E131_MAX_PORTS];
+	uint16_t nMaxPorts;
 };
 
 class E131ParamsStore {
@@ -79,6 +80,10 @@ public:
 		return (TE131Merge) m_tE131Params.nMergeMode;
 	}
 
+	inline uint16_t GetMaxPorts(void) {
+		return m_tE131Params.nMaxPorts;
+	}
+
 	inline bool isHaveCustomCid(void) {
 		return m_tE131Params.bHaveCustomCid;
 	}
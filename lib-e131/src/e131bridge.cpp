@@ -44,6 +44,7 @@
 #include "e131bridge.h"
 
 #include "lightset.h"
+#include "lightsetdata.h"
 
 #include "hardware.h"
 #include "network.h"
@@ -53,35 +54,38 @@ static const uint8_t ACN_PACKET_IDENTIFIER[E131_PACKET_IDENTIFIER_LENGTH] = { 0x
 
 #define DEFAULT_SOURCE_NAME_SUFFIX  "sACN E1.31"
 
+#define DATA_LOSS_CHECK_MILLIS		100	///< The ports are checked for the network data loss timeout at this interval
+
+
+static uint32_t UniverseToMulticastIp(uint16_t nUniverse) {
+	struct in_addr group_ip;
+	(void) inet_aton("239.255.0.0", &group_ip);
+
+	return group_ip.s_addr
+			| ((uint32_t) (((uint32_t) nUniverse & (uint32_t) 0xFF) << 24))
+			| ((uint32_t) (((uint32_t) nUniverse & (uint32_t) 0xFF00) << 8));
+}
+
 E131Bridge::E131Bridge(void) :
 	m_nHandle(-1),
 	m_pLightSet(0),
-	m_nUniverse(E131_UNIVERSE_DEFAULT),
-	m_nMulticastIp(0),
 	m_nCurrentPacketMillis(0),
-	m_nPreviousPacketMillis(0)
+	m_nDataLossCheckMillis(0),
+	m_nPorts(0),
+	m_OutputPorts(0),
+	m_pDiscoveryUniverses(0),
+	m_pE131Packet(0)
 {
 	assert(Hardware::Get() != 0);
 	assert(Network::Get() != 0);
 
-	memset(&m_OutputPort, 0, sizeof(struct TE131OutputPort));
-	m_OutputPort.mergeMode = E131_MERGE_HTP;
-	m_OutputPort.IsDataPending = false;
-
 	memset(&m_State, 0, sizeof(struct TE131BridgeState));
 	m_State.IsNetworkDataLoss = true;
-	m_State.IsMergeMode = false;
-	m_State.IsTransmitting = false;
 	m_State.IsSynchronized = false;
 	m_State.IsForcedSynchronized = false;
-	m_State.nPriority = E131_PRIORITY_LOWEST;
 	m_State.DiscoveryTime = 0;
 
-	m_DiscoveryIpAddress = 0;
-
-	struct in_addr addr;
-	(void)inet_aton("239.255.0.0", &addr);
-	m_DiscoveryIpAddress = addr.s_addr | ((uint32_t)(((uint32_t)E131_UNIVERSE_DISCOVERY & (uint32_t)0xFF) << 24)) | ((uint32_t)(((uint32_t)E131_UNIVERSE_DISCOVERY & (uint32_t)0xFF00) << 8));
+	m_DiscoveryIpAddress = UniverseToMulticastIp(E131_UNIVERSE_DISCOVERY);
 
 	char aDefaultSourceName[E131_SOURCE_NAME_LENGTH];
 	uint8_t nBoardNameLength;
@@ -90,11 +94,18 @@ E131Bridge::E131Bridge(void) :
 	snprintf((char *)aDefaultSourceName, E131_SOURCE_NAME_LENGTH, "%s %s %s", pBoardName, DEFAULT_SOURCE_NAME_SUFFIX, pWebsiteUrl);
 	SetSourceName(aDefaultSourceName);
 
+	SetMaxPorts(1);
 	SetUniverse(E131_UNIVERSE_DEFAULT);
 }
 
 E131Bridge::~E131Bridge(void) {
 	Stop();
+
+	delete[] m_pDiscoveryUniverses;
+	m_pDiscoveryUniverses = 0;
+
+	delete[] m_OutputPorts;
+	m_OutputPorts = 0;
 }
 
 void E131Bridge::Start(void) {
@@ -102,22 +113,64 @@ void E131Bridge::Start(void) {
 
 	FillDiscoveryPacket();
 
-	m_nHandle = Network::Get()->Begin(E131_DEFAULT_PORT);
-	assert(m_nHandle != -1);
+	uint32_t nQueueDepth = 0;
+
+	for (unsigned i = 0; i < m_nPorts; i++) {
+		if (m_OutputPorts[i].nUniverse != 0) {
+			nQueueDepth += E131_RECV_QUEUE_DEPTH_PORT;
+		}
+	}
+
+	if (nQueueDepth == 0) {
+		nQueueDepth = E131_RECV_QUEUE_DEPTH_PORT;
+	} else if (nQueueDepth > E131_RECV_QUEUE_DEPTH_MAX) {
+		nQueueDepth = E131_RECV_QUEUE_DEPTH_MAX;
+	}
+
+	// A burst of universes arriving together must not overwrite unread packets; when it does
+	// not fit, the oldest data is the least useful
+	m_nHandle = Network::Get()->BeginQueue(E131_DEFAULT_PORT, nQueueDepth, NETWORK_QUEUE_DROP_OLDEST);
+
+	const uint32_t nQueueDepthWanted = nQueueDepth;
+
+	// Begin() would take a queue from the same pool, so use whatever room is left
+	while ((m_nHandle == -1) && (nQueueDepth > 1)) {
+		nQueueDepth /= 2;
+		m_nHandle = Network::Get()->BeginQueue(E131_DEFAULT_PORT, nQueueDepth, NETWORK_QUEUE_DROP_OLDEST);
+	}
+
+	if (m_nHandle == -1) {
+		printf("E1.31: no receive queue left, the bridge is not started\n");
+		return;
+	}
+
+	if (nQueueDepth < nQueueDepthWanted) {
+		printf("E1.31: receive queue for %d datagrams only, universes will be dropped in bursts\n", (int) nQueueDepth);
+	}
+
+	JoinGroups();
+}
+
+bool E131Bridge::GetQueueStats(struct TNetworkQueueStats *pStats) {
+	if (m_nHandle == -1) {
+		return false;
+	}
 
-	Network::Get()->JoinGroup(m_nHandle, m_nMulticastIp);
+	return Network::Get()->GetQueueStats(m_nHandle, pStats);
 }
 
 void E131Bridge::Stop(void) {
-	if (m_pLightSet != 0) {
-		m_pLightSet->Stop(0);
+	for (unsigned i = 0; i < m_nPorts; i++) {
+		if ((m_pLightSet != 0) && (m_OutputPorts[i].nUniverse != 0)) {
+			m_pLightSet->Stop(i);
+		}
+		m_OutputPorts[i].IsTransmitting = false;
+		m_OutputPorts[i].length = 0;
+		LightSetData::Clear(m_OutputPorts[i].nFirstSlot, m_OutputPorts[i].nLastSlot);
+		m_OutputPorts[i].IsDataPending = false;
 	}
 	//
 	m_State.IsNetworkDataLoss = true;
-	m_State.IsTransmitting = false;
-	//
-	m_OutputPort.length = 0;
-	m_OutputPort.IsDataPending = false;
 }
 
 const uint8_t *E131Bridge::GetSoftwareVersion(void) {
@@ -130,21 +183,150 @@ void E131Bridge::SetOutput(LightSet *pLightSet) {
 	m_pLightSet = pLightSet;
 }
 
-uint16_t E131Bridge::GetUniverse() const{
-	return m_nUniverse;
+void E131Bridge::SetMaxPorts(uint16_t nPorts) {
+	assert(m_nHandle == -1);
+
+	if (nPorts == 0) {
+		nPorts = 1;
+	} else if (nPorts > E131_NODE_MAX_PORTS) {
+		nPorts = E131_NODE_MAX_PORTS;
+	}
+
+	struct TE131OutputPort *pOutputPorts = new TE131OutputPort[nPorts];
+	assert(pOutputPorts != 0);
+
+	uint16_t *pDiscoveryUniverses = new uint16_t[nPorts];
+	assert(pDiscoveryUniverses != 0);
+
+	memset(pOutputPorts, 0, nPorts * sizeof(struct TE131OutputPort));
+
+	for (unsigned i = 0; i < nPorts; i++) {
+		if (i < m_nPorts) {
+			pOutputPorts[i] = m_OutputPorts[i];
+		} else {
+			pOutputPorts[i].mergeMode = E131_MERGE_HTP;
+			pOutputPorts[i].nPriority = E131_PRIORITY_LOWEST;
+			LightSetData::Clear(pOutputPorts[i].nFirstSlot, pOutputPorts[i].nLastSlot);
+		}
+	}
+
+	delete[] m_pDiscoveryUniverses;
+	delete[] m_OutputPorts;
+
+	m_OutputPorts = pOutputPorts;
+	m_pDiscoveryUniverses = pDiscoveryUniverses;
+	m_nPorts = nPorts;
+
+	UpdateUniverseIndex();
+}
+
+uint16_t E131Bridge::GetUniverse(void) const {
+	return m_OutputPorts[0].nUniverse;
 }
 
 void E131Bridge::SetUniverse(const uint16_t nUniverse) {
-	assert((nUniverse >= E131_UNIVERSE_DEFAULT) && (nUniverse <= E131_UNIVERSE_MAX));
+	SetUniverse(0, nUniverse);
+}
 
-	struct in_addr group_ip;
-	(void) inet_aton("239.255.0.0", &group_ip);
+uint16_t E131Bridge::GetUniverse(uint16_t nPortIndex) const {
+	assert(nPortIndex < m_nPorts);
 
-	m_nMulticastIp = group_ip.s_addr
-			| ((uint32_t) (((uint32_t) nUniverse & (uint32_t) 0xFF) << 24))
-			| ((uint32_t) (((uint32_t) nUniverse & (uint32_t) 0xFF00) << 8));
+	return m_OutputPorts[nPortIndex].nUniverse;
+}
+
+/**
+ * Universe 0 disables the port.
+ */
+void E131Bridge::SetUniverse(uint16_t nPortIndex, const uint16_t nUniverse) {
+	assert(nPortIndex < m_nPorts);
+	assert(nUniverse <= E131_UNIVERSE_MAX);
+
+	if (m_OutputPorts[nPortIndex].nUniverse == nUniverse) {
+		return;
+	}
 
-	m_nUniverse = nUniverse;
+	if (m_nHandle != -1) {
+		LeaveGroups();
+	}
+
+	if ((m_OutputPorts[nPortIndex].nUniverse != 0) && m_OutputPorts[nPortIndex].IsTransmitting) {
+		m_pLightSet->Stop(nPortIndex);
+		m_OutputPorts[nPortIndex].IsTransmitting = false;
+	}
+
+	m_OutputPorts[nPortIndex].nUniverse = nUniverse;
+	m_OutputPorts[nPortIndex].nMulticastIp = (nUniverse == 0) ? 0 : UniverseToMulticastIp(nUniverse);
+	m_OutputPorts[nPortIndex].length = 0;
+	LightSetData::Clear(m_OutputPorts[nPortIndex].nFirstSlot, m_OutputPorts[nPortIndex].nLastSlot);
+	m_OutputPorts[nPortIndex].IsDataPending = false;
+	m_OutputPorts[nPortIndex].IsMerging = false;
+	m_OutputPorts[nPortIndex].nPriority = E131_PRIORITY_LOWEST;
+	m_OutputPorts[nPortIndex].sourceA.ip = 0;
+	m_OutputPorts[nPortIndex].sourceB.ip = 0;
+
+	UpdateUniverseIndex();
+
+	if (m_nHandle != -1) {
+		JoinGroups();
+		FillDiscoveryPacket();
+	}
+}
+
+/**
+ * Rebuilds the universe lookup table and the sorted Universe Discovery list.
+ * Ports with the same (universe & 0xFF) are chained in port order.
+ */
+void E131Bridge::UpdateUniverseIndex(void) {
+	for (unsigned i = 0; i < E131_UNIVERSE_INDEX_SIZE; i++) {
+		m_aUniverseIndex[i] = E131_PORT_INDEX_NONE;
+	}
+
+	m_State.nActiveUniverses = 0;
+
+	for (int i = m_nPorts - 1; i >= 0; i--) {
+		const uint16_t nUniverse = m_OutputPorts[i].nUniverse;
+
+		if (nUniverse == 0) {
+			m_OutputPorts[i].nNextPortIndex = E131_PORT_INDEX_NONE;
+			continue;
+		}
+
+		const uint8_t nIndex = nUniverse & 0xFF;
+		m_OutputPorts[i].nNextPortIndex = m_aUniverseIndex[nIndex];
+		m_aUniverseIndex[nIndex] = (uint16_t) i;
+
+		// Insertion sort, skipping duplicates
+		unsigned j = m_State.nActiveUniverses;
+
+		while ((j > 0) && (m_pDiscoveryUniverses[j - 1] > nUniverse)) {
+			j--;
+		}
+
+		if ((j > 0) && (m_pDiscoveryUniverses[j - 1] == nUniverse)) {
+			continue;
+		}
+
+		for (unsigned k = m_State.nActiveUniverses; k > j; k--) {
+			m_pDiscoveryUniverses[k] = m_pDiscoveryUniverses[k - 1];
+		}
+
+		m_pDiscoveryUniverses[j] = nUniverse;
+		m_State.nActiveUniverses++;
+	}
+}
+
+void E131Bridge::JoinGroups(void) {
+	for (unsigned i = 0; i < m_State.nActiveUniverses; i++) {
+		if (Network::Get()->JoinGroup(m_nHandle, UniverseToMulticastIp(m_pDiscoveryUniverses[i])) < 0) {
+			printf("E1.31: joining the multicast group of universe %d failed\n", (int) m_pDiscoveryUniverses[i]);
+		}
+	}
+}
+
+void E131Bridge::LeaveGroups(void) {
+	for (unsigned i = 0; i < m_State.nActiveUniverses; i++) {
+		Network::Get()->LeaveGroup(m_nHandle, UniverseToMulticastIp(m_pDiscoveryUniverses[i]));
+	}
 }
 
 const uint8_t* E131Bridge::GetCid(void) {
@@ -171,125 +353,131 @@ void E131Bridge::SetSourceName(const char *aSourceName) {
 }
 
 TE131Merge E131Bridge::GetMergeMode(void) const {
-	return m_OutputPort.mergeMode;
+	return m_OutputPorts[0].mergeMode;
 }
 
 void E131Bridge::SetMergeMode(TE131Merge mergeMode) {
-	m_OutputPort.mergeMode = mergeMode;
+	SetMergeMode(0, mergeMode);
 }
 
-void E131Bridge::FillDiscoveryPacket(void) {
-	uint16_t root_layer_length = sizeof(struct TRootLayer);
-	uint16_t framing_layer_size = sizeof(struct TDiscoveryFrameLayer);
-	uint16_t discovery_layer_size = sizeof(struct TUniverseDiscoveryLayer) - (511 * 2);
+TE131Merge E131Bridge::GetMergeMode(uint16_t nPortIndex) const {
+	assert(nPortIndex < m_nPorts);
 
-	m_State.DiscoveryPacketLength = root_layer_length + framing_layer_size + discovery_layer_size;
+	return m_OutputPorts[nPortIndex].mergeMode;
+}
 
+void E131Bridge::SetMergeMode(uint16_t nPortIndex, TE131Merge mergeMode) {
+	assert(nPortIndex < m_nPorts);
+
+	m_OutputPorts[nPortIndex].mergeMode = mergeMode;
+}
+
+/**
+ * The fields that depend on the page are set in SendDiscoveryPacket
+ */
+void E131Bridge::FillDiscoveryPacket(void) {
 	memset(&m_E131DiscoveryPacket, 0, sizeof(struct TE131DiscoveryPacket));
 
 	// Root Layer (See Section 5)
 	m_E131DiscoveryPacket.RootLayer.PreAmbleSize = __builtin_bswap16(0x10);
 	memcpy(m_E131DiscoveryPacket.RootLayer.ACNPacketIdentifier, ACN_PACKET_IDENTIFIER, E131_PACKET_IDENTIFIER_LENGTH);
-	m_E131DiscoveryPacket.RootLayer.FlagsLength = __builtin_bswap16((0x07 << 12) | (m_State.DiscoveryPacketLength));
 	m_E131DiscoveryPacket.RootLayer.Vector = __builtin_bswap32(E131_VECTOR_ROOT_EXTENDED);
 	memcpy(m_E131DiscoveryPacket.RootLayer.Cid, m_Cid, E131_CID_LENGTH);
 
-
 	// E1.31 Framing Layer (See Section 6)
-	m_E131DiscoveryPacket.FrameLayer.FLagsLength = __builtin_bswap16((0x07 << 12) | (framing_layer_size + discovery_layer_size) );
 	m_E131DiscoveryPacket.FrameLayer.Vector = __builtin_bswap32(E131_VECTOR_EXTENDED_DISCOVERY);
 	memcpy(m_E131DiscoveryPacket.FrameLayer.SourceName, m_SourceName, E131_SOURCE_NAME_LENGTH);
 
 	// Universe Discovery Layer (See Section 8)
-	m_E131DiscoveryPacket.UniverseDiscoveryLayer.FlagsLength = __builtin_bswap16((0x07 << 12) | discovery_layer_size);
 	m_E131DiscoveryPacket.UniverseDiscoveryLayer.Vector = __builtin_bswap32(VECTOR_UNIVERSE_DISCOVERY_UNIVERSE_LIST);
-	m_E131DiscoveryPacket.UniverseDiscoveryLayer.ListOfUniverses[0] = __builtin_bswap16(m_nUniverse);
 }
 
-bool E131Bridge::IsDmxDataChanged(const uint8_t *pData, uint16_t nLength) {
-	bool isChanged = false;
+bool E131Bridge::IsDmxDataChanged(uint16_t nPortIndex, const uint8_t *pData, uint16_t nLength) {
+	// No slots, nothing to output
+	if (nLength == 0) {
+		return false;
+	}
 
-	uint8_t *src = (uint8_t *)pData;
-	uint8_t *dst = (uint8_t *)m_OutputPort.data;
+	struct TE131OutputPort *pOutputPort = &m_OutputPorts[nPortIndex];
+	const bool isChanged = LightSetData::Copy(pOutputPort->data, pData, nLength, pOutputPort->nFirstSlot, pOutputPort->nLastSlot);
 
-	if (nLength != m_OutputPort.length) {
-		m_OutputPort.length = nLength;
-		for (unsigned i = 0 ; i < E131_DMX_LENGTH; i++) {
-			*dst++ = *src++;
-		}
+	if (nLength != pOutputPort->length) {
+		pOutputPort->length = nLength;
+		LightSetData::Widen(pOutputPort->nFirstSlot, pOutputPort->nLastSlot, 0, nLength - 1);
 		return true;
 	}
 
-	for (unsigned i = 0; i < E131_DMX_LENGTH; i++) {
-		if (*dst != *src) {
-			*dst = *src;
-			isChanged = true;
-		}
-		dst++;
-		src++;
-	}
-
 	return isChanged;
 }
 
-bool E131Bridge::IsMergedDmxDataChanged(const uint8_t *pData, uint16_t nLength) {
-	bool isChanged = false;
+bool E131Bridge::IsMergedDmxDataChanged(uint16_t nPortIndex, const uint8_t *pData, uint16_t nLength) {
+	if (nLength == 0) {
+		return false;
+	}
+
+	struct TE131OutputPort *pOutputPort = &m_OutputPorts[nPortIndex];
 
-	if (m_OutputPort.mergeMode == E131_MERGE_HTP) {
+	if (pOutputPort->mergeMode == E131_MERGE_HTP) {
+		const bool isChanged = LightSetData::MergeHtp(pOutputPort->data, pOutputPort->sourceA.data, pOutputPort->sourceB.data, nLength, pOutputPort->nFirstSlot, pOutputPort->nLastSlot);
 
-		if (nLength != m_OutputPort.length) {
-			m_OutputPort.length = nLength;
-			for (unsigned i = 0; i < nLength; i++) {
-				uint8_t data = MAX(m_OutputPort.sourceA.data[i], m_OutputPort.sourceB.data[i]);
-				m_OutputPort.data[i] = data;
-			}
+		if (nLength != pOutputPort->length) {
+			pOutputPort->length = nLength;
+			LightSetData::Widen(pOutputPort->nFirstSlot, pOutputPort->nLastSlot, 0, nLength - 1);
 			return true;
 		}
 
-		for (unsigned i = 0; i < nLength; i++) {
-			uint8_t data = MAX(m_OutputPort.sourceA.data[i], m_OutputPort.sourceB.data[i]);
-			if (data != m_OutputPort.data[i]) {
-				m_OutputPort.data[i] = data;
-				isChanged = true;
-			}
-		}
-
 		return isChanged;
 	} else {
-		return IsDmxDataChanged(pData, nLength);
+		return IsDmxDataChanged(nPortIndex, pData, nLength);
 	}
 }
 
-void E131Bridge::CheckMergeTimeouts(void) {
-	const uint32_t timeOutA = m_nCurrentPacketMillis - m_OutputPort.sourceA.time;
-	const uint32_t timeOutB = m_nCurrentPacketMillis - m_OutputPort.sourceB.time;
+/**
+ * Outputs the port with the slots changed since the previous output
+ */
+void E131Bridge::SetLightSetData(uint16_t nPortIndex) {
+	struct TE131OutputPort *pOutputPort = &m_OutputPorts[nPortIndex];
+
+	if (pOutputPort->nFirstSlot <= pOutputPort->nLastSlot) {
+		m_pLightSet->SetDataRange(nPortIndex, pOutputPort->data, pOutputPort->length, pOutputPort->nFirstSlot, pOutputPort->nLastSlot);
+		LightSetData::Clear(pOutputPort->nFirstSlot, pOutputPort->nLastSlot);
+	} else {
+		m_pLightSet->SetData(nPortIndex, pOutputPort->data, pOutputPort->length);
+	}
+}
+
+void E131Bridge::CheckMergeTimeouts(uint16_t nPortIndex) {
+	struct TE131OutputPort *pOutputPort = &m_OutputPorts[nPortIndex];
+	const uint32_t timeOutA = m_nCurrentPacketMillis - pOutputPort->sourceA.time;
+	const uint32_t timeOutB = m_nCurrentPacketMillis - pOutputPort->sourceB.time;
 
 	if (timeOutA > (uint32_t)(E131_MERGE_TIMEOUT_SECONDS * 1000)) {
-		m_OutputPort.sourceA.ip = 0;
-		m_State.IsMergeMode = false;
+		pOutputPort->sourceA.ip = 0;
+		pOutputPort->IsMerging = false;
 	}
 
 	if (timeOutB > (uint32_t)(E131_MERGE_TIMEOUT_SECONDS * 1000)) {
-		m_OutputPort.sourceB.ip = 0;
-		m_State.IsMergeMode = false;
+		pOutputPort->sourceB.ip = 0;
+		pOutputPort->IsMerging = false;
 	}
 }
 
-bool E131Bridge::IsPriorityTimeOut(void) {
-	const uint32_t timeOutA = m_nCurrentPacketMillis - m_OutputPort.sourceA.time;
-	const uint32_t timeOutB = m_nCurrentPacketMillis - m_OutputPort.sourceB.time;
+bool E131Bridge::IsPriorityTimeOut(uint16_t nPortIndex) {
+	const struct TE131OutputPort *pOutputPort = &m_OutputPorts[nPortIndex];
+	const uint32_t timeOutA = m_nCurrentPacketMillis - pOutputPort->sourceA.time;
+	const uint32_t timeOutB = m_nCurrentPacketMillis - pOutputPort->sourceB.time;
 
-	if ( (m_OutputPort.sourceA.ip != 0) && (m_OutputPort.sourceB.ip != 0) ) {
+	if ( (pOutputPort->sourceA.ip != 0) && (pOutputPort->sourceB.ip != 0) ) {
 		if ( (timeOutA < (uint32_t)(E131_PRIORITY_TIMEOUT_SECONDS * 1000)) || (timeOutB < (uint32_t)(E131_PRIORITY_TIMEOUT_SECONDS * 1000)) ) {
 			return false;
 		} else {
 			return true;
 		}
-	} else if ( (m_OutputPort.sourceA.ip != 0) && (m_OutputPort.sourceB.ip == 0) ) {
+	} else if ( (pOutputPort->sourceA.ip != 0) && (pOutputPort->sourceB.ip == 0) ) {
 		if (timeOutA > (uint32_t)(E131_PRIORITY_TIMEOUT_SECONDS * 1000)) {
 			return true;
 		}
-	} else if ( (m_OutputPort.sourceA.ip == 0) && (m_OutputPort.sourceB.ip != 0) ) {
+	} else if ( (pOutputPort->sourceA.ip == 0) && (pOutputPort->sourceB.ip != 0) ) {
 		if (timeOutB > (uint32_t)(E131_PRIORITY_TIMEOUT_SECONDS * 1000)) {
 			return true;
 		}
@@ -303,7 +491,7 @@ bool E131Bridge::isIpCidMatch(const struct TSource *source) {
 		return false;
 	}
 
-	if (memcmp(source->cid, m_E131.E131Packet.Raw.RootLayer.Cid, E131_CID_LENGTH) != 0) {
+	if (memcmp(source->cid, m_pE131Packet->Raw.RootLayer.Cid, E131_CID_LENGTH) != 0) {
 		return false;
 	}
 
@@ -311,12 +499,25 @@ bool E131Bridge::isIpCidMatch(const struct TSource *source) {
 }
 
 void E131Bridge::HandleDmx(void) {
-	const uint8_t *p = &m_E131.E131Packet.Data.DMPLayer.PropertyValues[1];
-	const uint16_t slots = __builtin_bswap16(m_E131.E131Packet.Data.DMPLayer.PropertyValueCount) - (uint16_t)1;
-	const uint32_t ipA = m_OutputPort.sourceA.ip;
-	const uint32_t ipB = m_OutputPort.sourceB.ip;
-	struct TSource *pSourceA = &m_OutputPort.sourceA;
-	struct TSource *pSourceB = &m_OutputPort.sourceB;
+	const uint16_t nUniverse = __builtin_bswap16(m_pE131Packet->Data.FrameLayer.Universe);
+
+	for (uint16_t i = m_aUniverseIndex[nUniverse & 0xFF]; i != E131_PORT_INDEX_NONE; i = m_OutputPorts[i].nNextPortIndex) {
+		if (m_OutputPorts[i].nUniverse == nUniverse) {
+			m_State.IsNetworkDataLoss = false;
+			m_OutputPorts[i].nPacketMillis = m_nCurrentPacketMillis;
+			HandleDmx(i);
+		}
+	}
+}
+
+void E131Bridge::HandleDmx(uint16_t nPortIndex) {
+	struct TE131OutputPort *pOutputPort = &m_OutputPorts[nPortIndex];
+	const uint8_t *p = &m_pE131Packet->Data.DMPLayer.PropertyValues[1];
+	const uint16_t slots = __builtin_bswap16(m_pE131Packet->Data.DMPLayer.PropertyValueCount) - (uint16_t)1;
+	const uint32_t ipA = pOutputPort->sourceA.ip;
+	const uint32_t ipB = pOutputPort->sourceB.ip;
+	struct TSource *pSourceA = &pOutputPort->sourceA;
+	struct TSource *pSourceB = &pOutputPort->sourceB;
 	const bool isSourceA = isIpCidMatch(pSourceA);
 	const bool isSourceB = isIpCidMatch(pSourceB);
 
@@ -327,14 +528,14 @@ void E131Bridge::HandleDmx(void) {
 	// arrives. If, using signed 8-bit binary arithmetic, B – A is less than or equal to 0, but greater than -20 then
 	// the packet containing sequence number B shall be deemed out of sequence and discarded
 	if (isSourceA) {
-		const int8_t diff = (int8_t) (m_E131.E131Packet.Data.FrameLayer.SequenceNumber - pSourceA->sequenceNumberData);
-		pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
+		const int8_t diff = (int8_t) (m_pE131Packet->Data.FrameLayer.SequenceNumber - pSourceA->sequenceNumberData);
+		pSourceA->sequenceNumberData = m_pE131Packet->Data.FrameLayer.SequenceNumber;
 		if ((diff <= (int8_t) 0) && (diff > (int8_t) -20)) {
 			return;
 		}
 	} else if (isSourceB) {
-		const int8_t diff = (int8_t) (m_E131.E131Packet.Data.FrameLayer.SequenceNumber - pSourceB->sequenceNumberData);
-		pSourceB->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
+		const int8_t diff = (int8_t) (m_pE131Packet->Data.FrameLayer.SequenceNumber - pSourceB->sequenceNumberData);
+		pSourceB->sequenceNumberData = m_pE131Packet->Data.FrameLayer.SequenceNumber;
 		if ((diff <= (int8_t) 0) && (diff > (int8_t) -20)) {
 			return;
 		}
@@ -342,16 +543,16 @@ void E131Bridge::HandleDmx(void) {
 
 	// This bit, when set to 1, indicates that the data in this packet is intended for use in visualization or media
 	// server preview applications and shall not be used to generate live output.
-	if ((m_E131.E131Packet.Data.FrameLayer.Options & E131_OPTIONS_MASK_PREVIEW_DATA) != 0) {
+	if ((m_pE131Packet->Data.FrameLayer.Options & E131_OPTIONS_MASK_PREVIEW_DATA) != 0) {
 		return;
 	}
 
 	// Upon receipt of a packet containing this bit set to a value of 1, receiver shall enter network data loss condition.
 	// Any property values in these packets shall be ignored.
-	if ((m_E131.E131Packet.Data.FrameLayer.Options & E131_OPTIONS_MASK_STREAM_TERMINATED) != 0) {
+	if ((m_pE131Packet->Data.FrameLayer.Options & E131_OPTIONS_MASK_STREAM_TERMINATED) != 0) {
 		if (isSourceA || isSourceB) {
-			if (!m_State.IsMergeMode) {
-				SetNetworkDataLossCondition();
+			if (!pOutputPort->IsMerging) {
+				SetNetworkDataLossCondition(nPortIndex);
 			}
 		}
 		return;
@@ -363,7 +564,7 @@ void E131Bridge::HandleDmx(void) {
 	// until synchronization resumes.
 	// When set to 1, once synchronization has been lost, components that had been operating in a synchronized state
 	// need not wait for a new E1.31 Synchronization Packet in order to update to the next E1.31 Data Packet.
-	if ((m_E131.E131Packet.Data.FrameLayer.Options & E131_OPTIONS_MASK_FORCE_SYNCHRONIZATION) == 0) {
+	if ((m_pE131Packet->Data.FrameLayer.Options & E131_OPTIONS_MASK_FORCE_SYNCHRONIZATION) == 0) {
 		m_State.IsForcedSynchronized = true;
 		if (m_State.IsSynchronized) {
 			return;
@@ -372,78 +573,78 @@ void E131Bridge::HandleDmx(void) {
 		m_State.IsForcedSynchronized = false;
 	}
 
-	if (m_State.IsMergeMode) {
-		CheckMergeTimeouts();
+	if (pOutputPort->IsMerging) {
+		CheckMergeTimeouts(nPortIndex);
 	}
 
-	if (m_E131.E131Packet.Data.FrameLayer.Priority < m_State.nPriority ){
-		if (!IsPriorityTimeOut()) {
+	if (m_pE131Packet->Data.FrameLayer.Priority < pOutputPort->nPriority ){
+		if (!IsPriorityTimeOut(nPortIndex)) {
 			return;
 		}
-		m_State.nPriority = m_E131.E131Packet.Data.FrameLayer.Priority;
-	} else if (m_E131.E131Packet.Data.FrameLayer.Priority > m_State.nPriority) {
-		m_OutputPort.sourceA.ip = 0;
-		m_OutputPort.sourceB.ip = 0;
-		m_State.IsMergeMode = false;
-		m_State.nPriority = m_E131.E131Packet.Data.FrameLayer.Priority;
+		pOutputPort->nPriority = m_pE131Packet->Data.FrameLayer.Priority;
+	} else if (m_pE131Packet->Data.FrameLayer.Priority > pOutputPort->nPriority) {
+		pOutputPort->sourceA.ip = 0;
+		pOutputPort->sourceB.ip = 0;
+		pOutputPort->IsMerging = false;
+		pOutputPort->nPriority = m_pE131Packet->Data.FrameLayer.Priority;
 	}
 
 	if ((ipA == 0) && (ipB == 0)) {
 		//printf("1. First package from Source\n");
 		pSourceA->ip = m_E131.IPAddressFrom;
-		pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
-		memcpy(pSourceA->cid, m_E131.E131Packet.Data.RootLayer.Cid, 16);
+		pSourceA->sequenceNumberData = m_pE131Packet->Data.FrameLayer.SequenceNumber;
+		memcpy(pSourceA->cid, m_pE131Packet->Data.RootLayer.Cid, 16);
 		pSourceA->time = m_nCurrentPacketMillis;
 		memcpy((void *)pSourceA->data, (const void *)p, slots);
-		sendNewData = IsDmxDataChanged(p, slots);
+		sendNewData = IsDmxDataChanged(nPortIndex, p, slots);
 
 	} else if (isSourceA && (ipB == 0)) {
 		//printf("2. Continue package from SourceA\n");
-		pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
+		pSourceA->sequenceNumberData = m_pE131Packet->Data.FrameLayer.SequenceNumber;
 		pSourceA->time = m_nCurrentPacketMillis;
 		memcpy((void *)pSourceA->data, (const void *)p, slots);
-		sendNewData = IsDmxDataChanged(p, slots);
+		sendNewData = IsDmxDataChanged(nPortIndex, p, slots);
 
 	} else if ((ipA == 0) && isSourceB) {
 		//printf("3. Continue package from SourceB\n");
-		pSourceB->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
+		pSourceB->sequenceNumberData = m_pE131Packet->Data.FrameLayer.SequenceNumber;
 		pSourceB->time = m_nCurrentPacketMillis;
 		memcpy((void *)pSourceB->data, (const void *)p, slots);
-		sendNewData = IsDmxDataChanged(p, slots);
+		sendNewData = IsDmxDataChanged(nPortIndex, p, slots);
 
 	} else if (!isSourceA && (ipB == 0)) {
 		//printf("4. New ip, start merging\n");
 		pSourceB->ip = m_E131.IPAddressFrom;
-		pSourceB->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
-		memcpy(m_OutputPort.sourceB.cid, m_E131.E131Packet.Data.RootLayer.Cid, 16);
+		pSourceB->sequenceNumberData = m_pE131Packet->Data.FrameLayer.SequenceNumber;
+		memcpy(pSourceB->cid, m_pE131Packet->Data.RootLayer.Cid, 16);
 		pSourceB->time = m_nCurrentPacketMillis;
-		m_State.IsMergeMode = true;
+		pOutputPort->IsMerging = true;
 		memcpy((void *)pSourceB->data, (const void *)p, slots);
-		sendNewData = IsMergedDmxDataChanged(pSourceB->data, slots);
+		sendNewData = IsMergedDmxDataChanged(nPortIndex, pSourceB->data, slots);
 
 	} else if ((ipA == 0) && !isSourceB) {
 		//printf("5. New ip, start merging\n");
 		pSourceA->ip = m_E131.IPAddressFrom;
-		pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
-		memcpy(m_OutputPort.sourceA.cid, m_E131.E131Packet.Data.RootLayer.Cid, 16);
+		pSourceA->sequenceNumberData = m_pE131Packet->Data.FrameLayer.SequenceNumber;
+		memcpy(pSourceA->cid, m_pE131Packet->Data.RootLayer.Cid, 16);
 		pSourceA->time = m_nCurrentPacketMillis;
-		m_State.IsMergeMode = true;
+		pOutputPort->IsMerging = true;
 		memcpy((void *)pSourceA->data, (const void *)p, slots);
-		sendNewData = IsMergedDmxDataChanged(pSourceA->data, slots);
+		sendNewData = IsMergedDmxDataChanged(nPortIndex, pSourceA->data, slots);
 
 	} else if (isSourceA && !isSourceB) {
 		//printf("6. Continue merging\n");
-		pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
+		pSourceA->sequenceNumberData = m_pE131Packet->Data.FrameLayer.SequenceNumber;
 		pSourceA->time = m_nCurrentPacketMillis;
 		memcpy((void *)pSourceA->data, (const void *)p, slots);
-		sendNewData = IsMergedDmxDataChanged(pSourceA->data, slots);
+		sendNewData = IsMergedDmxDataChanged(nPortIndex, pSourceA->data, slots);
 
 	} else if (!isSourceA && isSourceB) {
 		//printf("7. Continue merging\n");
-		pSourceB->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
+		pSourceB->sequenceNumberData = m_pE131Packet->Data.FrameLayer.SequenceNumber;
 		pSourceB->time = m_nCurrentPacketMillis;
 		memcpy((void *)pSourceB->data, (const void *)p, slots);
-		sendNewData = IsMergedDmxDataChanged(pSourceB->data, slots);
+		sendNewData = IsMergedDmxDataChanged(nPortIndex, pSourceB->data, slots);
 
 	} else if (isSourceA && isSourceB) {
 		//printf("8. Source matches both buffers, this shouldn't be happening!\n");
@@ -460,67 +661,155 @@ void E131Bridge::HandleDmx(void) {
 
 	if (sendNewData) {
 		if (!m_State.IsSynchronized) {
-			m_pLightSet->SetData(0, m_OutputPort.data, m_OutputPort.length);
-			if (!m_State.IsTransmitting) {
-				m_pLightSet->Start(0);
-				m_State.IsTransmitting = true;
+			SetLightSetData(nPortIndex);
+			if (!pOutputPort->IsTransmitting) {
+				m_pLightSet->Start(nPortIndex);
+				pOutputPort->IsTransmitting = true;
 			}
 		} else {
-			m_OutputPort.IsDataPending = true;
+			pOutputPort->IsDataPending = true;
 		}
-
-
 	}
 }
 
+/**
+ * The Synchronization Address is matched against all universes of the bridge.
+ * All ports with pending data are then updated.
+ */
 void E131Bridge::HandleSynchronization(void) {
-	if (m_E131.E131Packet.Synchronization.FrameLayer.UniverseNumber != __builtin_bswap16(m_nUniverse)) {
+	const uint16_t nUniverse = __builtin_bswap16(m_pE131Packet->Synchronization.FrameLayer.UniverseNumber);
+	uint16_t nPortIndex = m_aUniverseIndex[nUniverse & 0xFF];
+
+	while ((nPortIndex != E131_PORT_INDEX_NONE) && (m_OutputPorts[nPortIndex].nUniverse != nUniverse)) {
+		nPortIndex = m_OutputPorts[nPortIndex].nNextPortIndex;
+	}
+
+	if (nPortIndex == E131_PORT_INDEX_NONE) {
 		return;
 	}
 
 	m_State.IsSynchronized = true;
 	m_State.SynchronizationTime = m_nCurrentPacketMillis;
 
-	if (m_OutputPort.IsDataPending) {
-		m_pLightSet->SetData(0, m_OutputPort.data, m_OutputPort.length);
-		if (m_State.IsTransmitting) {
-			m_pLightSet->Start(0);
-			m_State.IsTransmitting = true;
+	for (unsigned i = 0; i < m_nPorts; i++) {
+		struct TE131OutputPort *pOutputPort = &m_OutputPorts[i];
+
+		if (pOutputPort->IsDataPending) {
+			SetLightSetData(i);
+			if (!pOutputPort->IsTransmitting) {
+				m_pLightSet->Start(i);
+				pOutputPort->IsTransmitting = true;
+			}
+			pOutputPort->IsDataPending = false;
 		}
-		m_OutputPort.IsDataPending = false;
 	}
 }
 
 void E131Bridge::SetNetworkDataLossCondition(void) {
-	m_pLightSet->Stop(0);
-	//
 	m_State.IsNetworkDataLoss = true;
-	m_State.IsMergeMode = false;
-	m_State.IsTransmitting = false;
 	m_State.IsSynchronized = false;
 	m_State.IsForcedSynchronized = false;
-	m_State.nPriority = E131_PRIORITY_LOWEST;
+
+	for (unsigned i = 0; i < m_nPorts; i++) {
+		if (m_OutputPorts[i].nUniverse != 0) {
+			SetNetworkDataLossCondition(i);
+		}
+	}
+}
+
+/**
+ * The timeout is per universe: a port whose source stops enters the data loss
+ * condition, while the other universes keep streaming.
+ */
+void E131Bridge::CheckNetworkDataLoss(void) {
+	if (m_State.IsNetworkDataLoss) {
+		return;
+	}
+
+	bool IsDataLoss = true;
+
+	for (unsigned i = 0; i < m_nPorts; i++) {
+		struct TE131OutputPort *pOutputPort = &m_OutputPorts[i];
+
+		if ((pOutputPort->nUniverse == 0) || ((pOutputPort->sourceA.ip == 0) && (pOutputPort->sourceB.ip == 0))) {
+			continue;
+		}
+
+		if ((m_nCurrentPacketMillis - pOutputPort->nPacketMillis) >= (uint32_t)(E131_NETWORK_DATA_LOSS_TIMEOUT_SECONDS * 1000)) {
+			SetNetworkDataLossCondition(i);
+		} else {
+			IsDataLoss = false;
+		}
+	}
+
+	if (IsDataLoss) {
+		SetNetworkDataLossCondition();
+	}
+}
+
+void E131Bridge::SetNetworkDataLossCondition(uint16_t nPortIndex) {
+	struct TE131OutputPort *pOutputPort = &m_OutputPorts[nPortIndex];
+
+	if (pOutputPort->IsTransmitting) {
+		m_pLightSet->Stop(nPortIndex);
+		pOutputPort->IsTransmitting = false;
+	}
 	//
-	m_OutputPort.length = 0;
-	m_OutputPort.IsDataPending = false;
-	m_OutputPort.sourceA.ip = (uint32_t) 0;
-	m_OutputPort.sourceB.ip = (uint32_t) 0;
+	pOutputPort->IsMerging = false;
+	pOutputPort->nPriority = E131_PRIORITY_LOWEST;
+	pOutputPort->length = 0;
+	LightSetData::Clear(pOutputPort->nFirstSlot, pOutputPort->nLastSlot);
+	pOutputPort->IsDataPending = false;
+	pOutputPort->sourceA.ip = (uint32_t) 0;
+	pOutputPort->sourceB.ip = (uint32_t) 0;
 }
 
+/**
+ * 8 Universe Discovery Layer
+ * The sorted list of universes is sent in pages of E131_DISCOVERY_UNIVERSES_PER_PAGE universes.
+ */
 void E131Bridge::SendDiscoveryPacket(void) {
-	Network::Get()->SendTo(m_nHandle, (const uint8_t *)&(m_E131DiscoveryPacket), m_State.DiscoveryPacketLength, m_DiscoveryIpAddress, (uint16_t)E131_DEFAULT_PORT);
+	const uint16_t nUniverses = m_State.nActiveUniverses;
+	const uint8_t nLastPage = (nUniverses == 0) ? 0 : (uint8_t) ((nUniverses - 1) / E131_DISCOVERY_UNIVERSES_PER_PAGE);
+
+	for (unsigned nPage = 0; nPage <= nLastPage; nPage++) {
+		const unsigned nFirst = nPage * E131_DISCOVERY_UNIVERSES_PER_PAGE;
+		const uint16_t nCount = (uint16_t) MIN(nUniverses - nFirst, (unsigned) E131_DISCOVERY_UNIVERSES_PER_PAGE);
+
+		const uint16_t root_layer_length = sizeof(struct TRootLayer);
+		const uint16_t framing_layer_size = sizeof(struct TDiscoveryFrameLayer);
+		const uint16_t discovery_layer_size = sizeof(struct TUniverseDiscoveryLayer) - sizeof(m_E131DiscoveryPacket.UniverseDiscoveryLayer.ListOfUniverses) + (nCount * 2);
+		const uint16_t nPacketLength = root_layer_length + framing_layer_size + discovery_layer_size;
+
+		m_E131DiscoveryPacket.RootLayer.FlagsLength = __builtin_bswap16((0x07 << 12) | nPacketLength);
+		m_E131DiscoveryPacket.FrameLayer.FLagsLength = __builtin_bswap16((0x07 << 12) | (framing_layer_size + discovery_layer_size));
+		m_E131DiscoveryPacket.UniverseDiscoveryLayer.FlagsLength = __builtin_bswap16((0x07 << 12) | discovery_layer_size);
+		m_E131DiscoveryPacket.UniverseDiscoveryLayer.Page = (uint8_t) nPage;
+		m_E131DiscoveryPacket.UniverseDiscoveryLayer.LastPage = nLastPage;
+
+		for (unsigned i = 0; i < nCount; i++) {
+			m_E131DiscoveryPacket.UniverseDiscoveryLayer.ListOfUniverses[i] = __builtin_bswap16(m_pDiscoveryUniverses[nFirst + i]);
+		}
+
+		Network::Get()->SendTo(m_nHandle, (const uint8_t *)&(m_E131DiscoveryPacket), nPacketLength, m_DiscoveryIpAddress, (uint16_t)E131_DEFAULT_PORT);
+	}
+
 	m_State.DiscoveryTime = m_nCurrentPacketMillis;
 }
 
 bool E131Bridge::IsValidRoot(void) {
+	if (m_E131.length < (int) sizeof(struct TE131RawPacket)) {
+		return false;
+	}
+
 	// 5 E1.31 use of the ACN Root Layer Protocol
 	// Receivers shall discard the packet if the ACN Packet Identifier is not valid.
-	if (memcmp(m_E131.E131Packet.Raw.RootLayer.ACNPacketIdentifier, ACN_PACKET_IDENTIFIER, 12) != 0) {
+	if (memcmp(m_pE131Packet->Raw.RootLayer.ACNPacketIdentifier, ACN_PACKET_IDENTIFIER, 12) != 0) {
 		return false;
 	}
 	
-	if (m_E131.E131Packet.Raw.RootLayer.Vector != __builtin_bswap32(E131_VECTOR_ROOT_DATA)
-			 && (m_E131.E131Packet.Raw.RootLayer.Vector != __builtin_bswap32(E131_VECTOR_ROOT_EXTENDED)) ) {
+	if (m_pE131Packet->Raw.RootLayer.Vector != __builtin_bswap32(E131_VECTOR_ROOT_DATA)
+			 && (m_pE131Packet->Raw.RootLayer.Vector != __builtin_bswap32(E131_VECTOR_ROOT_EXTENDED)) ) {
 		return false;
 	}
 
@@ -528,50 +817,66 @@ bool E131Bridge::IsValidRoot(void) {
 }
 
 bool E131Bridge::IsValidDataPacket(void) {
+	// The packet is parsed in place, nothing may be read beyond what has been received
+	const int nHeaderLength = (int) __builtin_offsetof(struct TE131DataPacket, DMPLayer.PropertyValues);
+
+	if (m_E131.length <= nHeaderLength) {
+		return false;
+	}
+
+	// The START Code and at most 512 slots, all of them in the datagram
+	const uint16_t nPropertyValueCount = __builtin_bswap16(m_pE131Packet->Data.DMPLayer.PropertyValueCount);
+
+	if ((nPropertyValueCount == 0) || (nPropertyValueCount > (E131_DMX_LENGTH + 1)) || (nPropertyValueCount > (m_E131.length - nHeaderLength))) {
+		return false;
+	}
+
 	// Frame layer
 
 	// 8.2 Association of Multicast Addresses and Universe
 	// Note: The identity of the universe shall be determined by the universe number in the
 	// packet and not assumed from the multicast address.
-	if (m_E131.E131Packet.Data.FrameLayer.Universe != __builtin_bswap16(m_nUniverse)) {
-		return false;
-	}
+	// The universe number is matched against the ports in HandleDmx.
 
 	// DMP layer
 
 	// The DMP Layer's Vector shall be set to 0x02, which indicates a DMP Set Property message by
 	// transmitters. Receivers shall discard the packet if the received value is not 0x02.
-	if (m_E131.E131Packet.Data.DMPLayer.Vector != (uint8_t)E131_VECTOR_DMP_SET_PROPERTY) {
+	if (m_pE131Packet->Data.DMPLayer.Vector != (uint8_t)E131_VECTOR_DMP_SET_PROPERTY) {
 		return false;
 	}
 
 	// Transmitters shall set the DMP Layer's Address Type and Data Type to 0xa1. Receivers shall discard the
 	// packet if the received value is not 0xa1.
-	if (m_E131.E131Packet.Data.DMPLayer.Type != (uint8_t)0xa1) {
+	if (m_pE131Packet->Data.DMPLayer.Type != (uint8_t)0xa1) {
 		return false;
 	}
 
 	// Transmitters shall set the DMP Layer's First Property Address to 0x0000. Receivers shall discard the
 	// packet if the received value is not 0x0000.
-	if (m_E131.E131Packet.Data.DMPLayer.FirstAddressProperty != __builtin_bswap16((uint16_t)0x0000)) {
+	if (m_pE131Packet->Data.DMPLayer.FirstAddressProperty != __builtin_bswap16((uint16_t)0x0000)) {
 		return false;
 	}
 
 	// Transmitters shall set the DMP Layer's Address Increment to 0x0001. Receivers shall discard the packet if
 	// the received value is not 0x0001.
-	if (m_E131.E131Packet.Data.DMPLayer.AddressIncrement != __builtin_bswap16((uint16_t)0x0001)) {
+	if (m_pE131Packet->Data.DMPLayer.AddressIncrement != __builtin_bswap16((uint16_t)0x0001)) {
 		return false;
 	}
 
 	return true;
 }
 
+
 int E131Bridge::Run(void) {
-	const char *packet = (char *) &(m_E131.E131Packet);
+	uint8_t *packet;
 	uint16_t nForeignPort;
-	uint32_t IPAddressFrom;
 
-	const int nBytesReceived = Network::Get()->RecvFrom(m_nHandle, (uint8_t *)packet, (const uint16_t)sizeof(m_E131.E131Packet), &IPAddressFrom, &nForeignPort) ;
+	if (__builtin_expect((m_nHandle == -1), 0)) {
+		return 0;
+	}
+
+	const int nBytesReceived = Network::Get()->RecvFromRef(m_nHandle, &packet, &m_E131.IPAddressFrom, &nForeignPort);
 
 	m_nCurrentPacketMillis = Hardware::Get()->Millis();
 
@@ -579,40 +884,54 @@ int E131Bridge::Run(void) {
 		SendDiscoveryPacket();
 	}
 
+	if ((m_nCurrentPacketMillis - m_nDataLossCheckMillis) >= DATA_LOSS_CHECK_MILLIS) {
+		m_nDataLossCheckMillis = m_nCurrentPacketMillis;
+		CheckNetworkDataLoss();
+	}
+
 	if (nBytesReceived == 0) {
-		if ((m_nCurrentPacketMillis - m_nPreviousPacketMillis) >= (uint32_t)(E131_NETWORK_DATA_LOSS_TIMEOUT_SECONDS * 1000)) {
-			SetNetworkDataLossCondition();
-		}
 		return 0;
 	}
 
+	// Parse in place, the datagram is not copied
+	m_pE131Packet = (union UE131Packet *) packet;
+	m_E131.length = nBytesReceived;
+
 	if (!IsValidRoot()) {
+		ReleasePacket();
 		return 0;
 	}
 
-	m_nPreviousPacketMillis = m_nCurrentPacketMillis;
-
 	if (m_State.IsSynchronized && !m_State.IsForcedSynchronized) {
 		if ((m_nCurrentPacketMillis - m_State.SynchronizationTime) >= (E131_NETWORK_DATA_LOSS_TIMEOUT_SECONDS * 1000)) {
 			m_State.IsSynchronized = false;
 		}
 	}
 
-	const uint32_t nRootVector = __builtin_bswap32(m_E131.E131Packet.Raw.RootLayer.Vector);
+	const uint32_t nRootVector = __builtin_bswap32(m_pE131Packet->Raw.RootLayer.Vector);
 
 	if (nRootVector == E131_VECTOR_ROOT_DATA) {
 		if (!IsValidDataPacket()) {
+			ReleasePacket();
 			return 0;
 		}
 		HandleDmx();
 	} else if (nRootVector == E131_VECTOR_ROOT_EXTENDED) {
-		const uint32_t nFramingVector = __builtin_bswap32(m_E131.E131Packet.Raw.FrameLayer.Vector);
+		const uint32_t nFramingVector = __builtin_bswap32(m_pE131Packet->Raw.FrameLayer.Vector);
 
-		if (nFramingVector == E131_VECTOR_EXTENDED_SYNCHRONIZATION) {
+		if ((nFramingVector == E131_VECTOR_EXTENDED_SYNCHRONIZATION) && (m_E131.length >= (int) sizeof(struct TE131SynchronizationPacket))) {
 			HandleSynchronization();
 		}
 
 	}
 
+	ReleasePacket();
+
 	return nBytesReceived;
 }
+
+void E131Bridge::ReleasePacket(void) {
+	Network::Get()->RecvRelease(m_nHandle);
+	// The packet belongs to the receive queue again
+	m_pE131Packet = 0;
+}
@@ -43,8 +43,25 @@ void E131Bridge::Print(void) {
 	printf("\nBridge configuration\n");
 	printf(" Firmware     : %d.%d\n", firmware_version[0], firmware_version[1]);
 	printf(" CID          : %s\n", uuid_str);
-	printf(" Universe     : %d\n", GetUniverse());
-	printf(" Merge mode   : %s\n", GetMergeMode() == E131_MERGE_HTP ? "HTP" : "LTP");
-	printf(" Multicast ip : " IPSTR "\n", IP2STR(GetMulticastIp()));
+	if (GetMaxPorts() == 1) {
+		printf(" Universe     : %d\n", GetUniverse());
+		printf(" Merge mode   : %s\n", GetMergeMode() == E131_MERGE_HTP ? "HTP" : "LTP");
+		printf(" Multicast ip : " IPSTR "\n", IP2STR(GetMulticastIp()));
+	} else {
+		printf(" Ports        : %d\n", GetMaxPorts());
+		printf(" Universes    : %d\n", GetActiveUniverses());
+
+		for (unsigned i = 0; i < GetMaxPorts(); i++) {
+			if (GetUniverse(i) != 0) {
+				printf("  Port %-3d    : %d %s " IPSTR "\n", i, GetUniverse(i), GetMergeMode(i) == E131_MERGE_HTP ? "HTP" : "LTP", IP2STR(GetMulticastIp(i)));
+			}
+		}
+	}
 	printf(" Unicast ip   : " IPSTR "\n", IP2STR(Network::Get()->GetIp()));
+
+	struct TNetworkQueueStats tStats;
+
+	if (GetQueueStats(&tStats)) {
+		printf(" Queue        : %d, received %d, dropped %d, high-water %d\n", (int) tStats.nDepth, (int) tStats.nReceived, (int) tStats.nDropped, (int) tStats.nHighWater);
+	}
 }
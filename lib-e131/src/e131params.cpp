@@ -51,12 +51,18 @@
 #define SET_MERGE_MODE_B_MASK	(1 << 9)
 #define SET_MERGE_MODE_C_MASK	(1 << 10)
 #define SET_MERGE_MODE_D_MASK	(1 << 11)
+#define SET_MAX_PORTS_MASK		(1 << 12)
 
 static const char PARAMS_FILE_NAME[] ALIGNED = "e131.txt";
 static const char PARAMS_UNIVERSE[] ALIGNED = "universe";
 static const char PARAMS_MERGE_MODE[] ALIGNED = "merge_mode";
 static const char PARAMS_OUTPUT[] ALIGNED = "output";
 static const char PARAMS_CID[] ALIGNED = "cid";
+static const char PARAMS_UNIVERSE_PORT[4][16] ALIGNED = { "universe_port_a",
+		"universe_port_b", "universe_port_c", "universe_port_d" };
+static const char PARAMS_MERGE_MODE_PORT[4][18] ALIGNED = { "merge_mode_port_a",
+		"merge_mode_port_b", "merge_mode_port_c", "merge_mode_port_d" };
+static const char PARAMS_MAX_PORTS[] ALIGNED = "max_ports";	///< 1 {default}
 
 E131Params::E131Params(E131ParamsStore *pE131ParamsStore):m_pE131ParamsStore(pE131ParamsStore) {
 	uint8_t *p = (uint8_t *) &m_tE131Params;
@@ -66,6 +72,7 @@ E131Params::E131Params(E131ParamsStore *pE131ParamsStore):m_pE131ParamsStore(pE1
 	}
 
 	m_tE131Params.nUniverse = E131_UNIVERSE_DEFAULT;
+	m_tE131Params.nMaxPorts = 1;
 }
 
 E131Params::~E131Params(void) {
@@ -107,6 +114,24 @@ void E131Params::callbackFunction(const char *pLine) {
 		return;
 	}
 
+	for (unsigned i = 0; i < E131_MAX_PORTS; i++) {
+		if (Sscan::Uint16(pLine, PARAMS_UNIVERSE_PORT[i], &value16) == SSCAN_OK) {
+			if (value16 <= E131_UNIVERSE_MAX) {
+				m_tE131Params.nUniversePort[i] = value16;
+				m_tE131Params.nSetList |= (SET_UNIVERSE_A_MASK << i);
+			}
+			return;
+		}
+	}
+
+	if (Sscan::Uint16(pLine, PARAMS_MAX_PORTS, &value16) == SSCAN_OK) {
+		if ((value16 != 0) && (value16 <= E131_NODE_MAX_PORTS)) {
+			m_tE131Params.nMaxPorts = value16;
+			m_tE131Params.nSetList |= SET_MAX_PORTS_MASK;
+		}
+		return;
+	}
+
 	len = 3;
 	if (Sscan::Char(pLine, PARAMS_OUTPUT, value, &len) == SSCAN_OK) {
 		if (memcmp(value, "spi", 3) == 0) {
@@ -134,6 +159,20 @@ void E131Params::callbackFunction(const char *pLine) {
 		return;
 	}
 
+	for (unsigned i = 0; i < E131_MAX_PORTS; i++) {
+		len = 3;
+		if (Sscan::Char(pLine, PARAMS_MERGE_MODE_PORT[i], value, &len) == SSCAN_OK) {
+			if (memcmp(value, "ltp", 3) == 0) {
+				m_tE131Params.nMergeModePort[i] = E131_MERGE_LTP;
+				m_tE131Params.nSetList |= (SET_MERGE_MODE_A_MASK << i);
+			} else if (memcmp(value, "htp", 3) == 0) {
+				m_tE131Params.nMergeModePort[i] = E131_MERGE_HTP;
+				m_tE131Params.nSetList |= (SET_MERGE_MODE_A_MASK << i);
+			}
+			return;
+		}
+	}
+
 	len = UUID_STRING_LENGTH;
 	if (Sscan::Uuid(pLine, PARAMS_CID, value, &len) == SSCAN_OK) {
 		memcpy(m_tE131Params.aCidString, value, UUID_STRING_LENGTH);
@@ -144,7 +183,9 @@ void E131Params::callbackFunction(const char *pLine) {
 	}
 }
 
-// FIXME E131Params::Set(E131Bridge *pE131Bridge)
+/**
+ * Port n uses universe_port_x when set (ports 0..3), otherwise universe + n.
+ */
 void E131Params::Set(E131Bridge *pE131Bridge) {
 	assert(pE131Bridge != 0);
 
@@ -152,10 +193,24 @@ void E131Params::Set(E131Bridge *pE131Bridge) {
 		return;
 	}
 
-	if (isMaskSet(SET_MERGE_MODE_MASK)) {
-		pE131Bridge->SetMergeMode((TE131Merge) m_tE131Params.nMergeMode);
+	if (isMaskSet(SET_MAX_PORTS_MASK)) {
+		pE131Bridge->SetMaxPorts(m_tE131Params.nMaxPorts);
 	}
 
+	for (unsigned i = 0; i < pE131Bridge->GetMaxPorts(); i++) {
+		if ((i < E131_MAX_PORTS) && isMaskSet(SET_UNIVERSE_A_MASK << i)) {
+			pE131Bridge->SetUniverse(i, m_tE131Params.nUniversePort[i]);
+		} else if (isMaskSet(SET_UNIVERSE_MASK) || isMaskSet(SET_MAX_PORTS_MASK)) {
+			const uint32_t nUniverse = m_tE131Params.nUniverse + i;
+			pE131Bridge->SetUniverse(i, nUniverse <= E131_UNIVERSE_MAX ? nUniverse : 0);
+		}
+
+		if ((i < E131_MAX_PORTS) && isMaskSet(SET_MERGE_MODE_A_MASK << i)) {
+			pE131Bridge->SetMergeMode(i, (TE131Merge) m_tE131Params.nMergeModePort[i]);
+		} else if (isMaskSet(SET_MERGE_MODE_MASK)) {
+			pE131Bridge->SetMergeMode(i, (TE131Merge) m_tE131Params.nMergeMode);
+		}
+	}
 }
 
 void E131Params::Dump(void) {
@@ -170,6 +225,16 @@ void E131Params::Dump(void) {
 		printf(" %s=%d\n", PARAMS_UNIVERSE, (int) m_tE131Params.nUniverse);
 	}
 
+	for (unsigned i = 0; i < E131_MAX_PORTS; i++) {
+		if (isMaskSet(SET_UNIVERSE_A_MASK << i)) {
+			printf(" %s=%d\n", PARAMS_UNIVERSE_PORT[i], (int) m_tE131Params.nUniversePort[i]);
+		}
+	}
+
+	if (isMaskSet(SET_MAX_PORTS_MASK)) {
+		printf(" %s=%d\n", PARAMS_MAX_PORTS, (int) m_tE131Params.nMaxPorts);
+	}
+
 	if (isMaskSet(SET_CID_MASK)) {
 		printf(" %s=%s\n", PARAMS_CID, m_tE131Params.aCidString);
 	}
@@ -178,6 +243,12 @@ void E131Params::Dump(void) {
 		printf(" %s=%s\n", PARAMS_MERGE_MODE, (TE131Merge)m_tE131Params.nMergeMode == E131_MERGE_HTP ? "HTP" : "LTP");
 	}
 
+	for (unsigned i = 0; i < E131_MAX_PORTS; i++) {
+		if (isMaskSet(SET_MERGE_MODE_A_MASK << i)) {
+			printf(" %s=%s\n", PARAMS_MERGE_MODE_PORT[i], (TE131Merge)m_tE131Params.nMergeModePort[i] == E131_MERGE_HTP ? "HTP" : "LTP");
+		}
+	}
+
 	if (isMaskSet(SET_OUTPUT_MASK)) {
 		printf(" %s=%s [%d]\n", PARAMS_OUTPUT, m_tE131Params.tOutputType == E131_OUTPUT_TYPE_MONITOR ? "mon" : (m_tE131Params.tOutputType == E131_OUTPUT_TYPE_SPI ? "spi": "dmx"), (int) m_tE131Params.tOutputType);
 	}
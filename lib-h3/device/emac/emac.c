@@ -57,6 +57,9 @@
 #define RX_CTL1_RX_DMA_EN			(1 << 30)
 
 #define RX_FRM_FLT_RX_ALL_MULTICAST	(1 << 16)
+#define RX_FRM_FLT_HASH_MULTICAST	(1 << 9)
+
+#define INT_STA_RX_BUF_UA			(1 << 9)
 
 #define	ARM_DMA_ALIGN	64
 
@@ -313,6 +316,42 @@ void emac_eth_send(void *packet, int len) {
 	H3_EMAC->TX_CTL1 = value;
 }
 
+void emac_set_multicast_filter(uint32_t hash_high, uint32_t hash_low, bool all_multicast) {
+	H3_EMAC->RX_HASH0 = hash_high;
+	H3_EMAC->RX_HASH1 = hash_low;
+	H3_EMAC->RX_FRM_FLT = all_multicast ? RX_FRM_FLT_RX_ALL_MULTICAST : RX_FRM_FLT_HASH_MULTICAST;
+}
+
+/**
+ * Number of received frames waiting in the RX ring
+ */
+uint32_t emac_rx_pending(void) {
+	uint32_t desc_num = p_coherent_region->rx_currdescnum;
+	uint32_t pending = 0;
+
+	while ((pending < CONFIG_RX_DESCR_NUM) && !(p_coherent_region->rx_chain[desc_num].status & (1 << 31))) {
+		pending++;
+
+		if (++desc_num >= CONFIG_RX_DESCR_NUM) {
+			desc_num = 0;
+		}
+	}
+
+	return pending;
+}
+
+/**
+ * The DMA found no free RX descriptor since the previous call, so frames have been dropped
+ */
+bool emac_rx_overflowed(void) {
+	if (H3_EMAC->INT_STA & INT_STA_RX_BUF_UA) {
+		H3_EMAC->INT_STA = INT_STA_RX_BUF_UA;	// Write 1 to clear
+		return true;
+	}
+
+	return false;
+}
+
 void emac_free_pkt(void) {
 	uint32_t desc_num = p_coherent_region->rx_currdescnum;
 	struct emac_dma_desc *desc_p = &p_coherent_region->rx_chain[desc_num];
@@ -0,0 +1,243 @@
+/**
+ * @file arp_test.c
+ *
+ * Checks the ARP cache: frames waiting for a reply, the request retries,
+ * the LRU eviction, the RFC 826 merge rule and the aging of entries.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "net/net.h"
+#include "net/emac_shim.h"
+
+#include "net_packets.h"
+
+extern void arp_handle(struct t_arp *);
+extern void arp_cache_timer(void);
+
+#define PORT		6454
+#define RECORDS		64		// MAX_RECORDS in arp_cache.c
+#define TICKS_10MIN	(10 * 60 * 10)
+
+static uint32_t s_my_ip;
+static int s_handle;
+static int s_errors;
+
+static void check(bool condition, const char *what) {
+	if (!condition) {
+		printf("FAIL: %s\n", what);
+		s_errors++;
+	}
+}
+
+/*
+ * The address in network byte order, as the stack keeps it
+ */
+static uint32_t ip_address(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+	const uint8_t bytes[IPv4_ADDR_LEN] = {a, b, c, d};
+	uint32_t ip;
+
+	memcpy(&ip, bytes, sizeof(ip));
+
+	return ip;
+}
+
+static void receive_arp(uint16_t opcode, uint32_t sender_ip, uint8_t sender_mac, uint32_t target_ip) {
+	struct t_arp arp;
+
+	memset(&arp, 0, sizeof(arp));
+	arp.arp.opcode = __builtin_bswap16(opcode);
+	arp.arp.sender_ip = sender_ip;
+	memset(arp.arp.sender_mac, sender_mac, ETH_ADDR_LEN);
+	arp.arp.target_ip = target_ip;
+
+	arp_handle(&arp);
+}
+
+static uint32_t tx_frames(void) {
+	struct emac_shim_stats stats;
+
+	emac_shim_get_stats(&stats);
+
+	return stats.tx_frames;
+}
+
+/*
+ * The number of frames sent by udp_send, the ARP request included
+ */
+static uint32_t send(uint32_t ip, int *result) {
+	const uint8_t data[16] = {0};
+	const uint32_t tx = tx_frames();
+
+	*result = udp_send((uint8_t) s_handle, data, sizeof(data), ip, PORT);
+
+	return tx_frames() - tx;
+}
+
+static void ticks(uint32_t count) {
+	while (count-- != 0) {
+		arp_cache_timer();
+	}
+}
+
+static void test_pending(void) {
+	const uint32_t peer = ip_address(192, 168, 2, 10);
+	struct arp_cache_stats stats;
+	uint32_t tx;
+	int result;
+
+	tx = send(peer, &result);
+	check((result == 0) && (tx == 1), "unknown host: only the ARP request is sent");
+
+	tx = send(peer, &result);
+	check((result == 0) && (tx == 0), "a second frame for the same host sends no new request");
+
+	tx = tx_frames();
+	receive_arp(ARP_OPCODE_REPLY, peer, 0xAA, s_my_ip);
+	check(tx_frames() - tx == 2, "the waiting frames are sent on the ARP reply");
+
+	tx = send(peer, &result);
+	check((result == 0) && (tx == 1), "known host: the frame is sent at once");
+
+	arp_cache_get_stats(&stats);
+	check((stats.hits == 1) && (stats.misses == 2) && (stats.entries == 1), "statistics after the ARP reply");
+}
+
+static void test_retries(void) {
+	const uint32_t host = ip_address(192, 168, 2, 11);
+	struct arp_cache_stats stats;
+	uint32_t tx;
+	int result;
+
+	send(host, &result);
+
+	tx = tx_frames();
+	ticks(30);
+	check(tx_frames() - tx == 2, "the ARP request is repeated twice");
+
+	arp_cache_get_stats(&stats);
+	check(stats.pending_dropped == 1, "the frame is dropped without a reply");
+
+	// 4 frames can wait, the fifth cannot
+	send(ip_address(192, 168, 2, 21), &result);
+	send(ip_address(192, 168, 2, 22), &result);
+	send(ip_address(192, 168, 2, 23), &result);
+	send(ip_address(192, 168, 2, 24), &result);
+	check(result == 0, "4 frames wait for a reply");
+	send(ip_address(192, 168, 2, 25), &result);
+	check(result == -2, "udp_send fails when no frame can wait");
+
+	ticks(30);
+}
+
+static void test_eviction(void) {
+	const uint32_t peer = ip_address(192, 168, 2, 10);
+	struct arp_cache_stats stats;
+	uint32_t tx;
+	int result;
+	uint8_t i;
+
+	// ARP requests for this node add the sender
+	for (i = 1; i <= 100; i++) {
+		receive_arp(ARP_OPCODE_RQST, ip_address(192, 168, 3, i), 0x10, s_my_ip);
+	}
+
+	arp_cache_get_stats(&stats);
+	check((stats.entries == RECORDS) && (stats.evictions == 100 + 1 - RECORDS), "a full cache replaces entries");
+
+	// The peer has been used most recently, so it is not replaced
+	receive_arp(ARP_OPCODE_REPLY, peer, 0xAA, s_my_ip);
+	ticks(1);
+	send(peer, &result);
+	ticks(1);
+
+	for (i = 1; i <= RECORDS - 1; i++) {
+		receive_arp(ARP_OPCODE_RQST, ip_address(192, 168, 4, i), 0x20, s_my_ip);
+	}
+
+	tx = send(peer, &result);
+	check((result == 0) && (tx == 1), "the least recently used entries are replaced");
+
+	arp_cache_get_stats(&stats);
+	check(stats.entries == RECORDS, "the cache stays full");
+}
+
+static void test_merge(void) {
+	const uint32_t host = ip_address(192, 168, 5, 1);
+	const uint32_t peer = ip_address(192, 168, 2, 10);
+	struct arp_cache_stats stats_before;
+	struct arp_cache_stats stats;
+	uint32_t tx;
+
+	arp_cache_get_stats(&stats_before);
+
+	// A gratuitous ARP of an unknown host is not added, nor answered
+	tx = tx_frames();
+	receive_arp(ARP_OPCODE_RQST, host, 0x30, host);
+	check(tx_frames() == tx, "an ARP request for another host is not answered");
+
+	arp_cache_get_stats(&stats);
+	check((stats.entries == stats_before.entries) && (stats.evictions == stats_before.evictions), "an unknown host is not added by a gratuitous ARP");
+
+	// A known host is refreshed: it survives the aging below
+	ticks(TICKS_10MIN / 2);
+	receive_arp(ARP_OPCODE_RQST, peer, 0xAB, peer);
+	ticks(TICKS_10MIN / 2 + RECORDS + 1);
+
+	arp_cache_get_stats(&stats);
+	check(stats.entries == 1, "a refreshed entry is kept");
+	check(stats.expired == RECORDS - 1, "entries not refreshed for 10 minutes are removed");
+
+	ticks(TICKS_10MIN / 2);
+
+	arp_cache_get_stats(&stats);
+	check((stats.entries == 0) && (stats.expired == RECORDS), "the refreshed entry is removed 10 minutes later");
+}
+
+int main(void) {
+	const uint8_t mac[ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+	struct ip_info ip_info;
+
+	s_my_ip = ip_address(192, 168, 2, 100);
+
+	ip_info.ip.addr = s_my_ip;
+	ip_info.netmask.addr = ip_address(255, 255, 255, 0);
+	ip_info.gw.addr = 0;
+
+	net_init(mac, &ip_info, (const uint8_t *) "arp_test", false);
+
+	s_handle = udp_bind(PORT);
+
+	test_pending();
+	test_retries();
+	test_eviction();
+	test_merge();
+
+	printf("arp_test: %d errors\n", s_errors);
+
+	return (s_errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
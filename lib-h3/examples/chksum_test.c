@@ -0,0 +1,177 @@
+/**
+ * @file chksum_test.c
+ *
+ * Checks net_chksum and the RFC 1624 incremental update net_chksum_update
+ * against a plain RFC 1071 reference sum.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern uint16_t net_chksum(void *, uint32_t);
+extern uint16_t net_chksum_update(uint16_t, uint16_t, uint16_t);
+
+#define BUFFER_SIZE		1600
+#define BUFFERS			200000
+#define UPDATES			1000000
+
+static uint8_t s_buffer[BUFFER_SIZE + 8];
+
+/*
+ * RFC 1071, 16-bit words in network order, the odd byte padded with zero.
+ * The result is in network order.
+ */
+static uint16_t reference_chksum(const uint8_t *p, uint32_t len) {
+	uint32_t sum = 0;
+	uint32_t i;
+
+	for (i = 0; i + 1 < len; i += 2) {
+		sum += (uint32_t) ((p[i] << 8) | p[i + 1]);
+	}
+
+	if (len & 1) {
+		sum += (uint32_t) (p[len - 1] << 8);
+	}
+
+	while (sum >> 16) {
+		sum = (sum & 0xFFFF) + (sum >> 16);
+	}
+
+	return (uint16_t) ~sum;
+}
+
+/*
+ * net_chksum returns the checksum as it is stored in the packet
+ */
+static uint16_t to_network_order(uint16_t chksum) {
+	uint8_t bytes[2];
+
+	memcpy(bytes, &chksum, sizeof(bytes));
+
+	return (uint16_t) ((bytes[0] << 8) | bytes[1]);
+}
+
+static uint16_t random16(void) {
+	switch (rand() % 8) {
+	case 0:
+		return 0x0000;
+	case 1:
+		return 0xFFFF;
+	default:
+		return (uint16_t) rand();
+	}
+}
+
+static int test_chksum(void) {
+	int errors = 0;
+	uint32_t n;
+
+	for (n = 0; n < BUFFERS; n++) {
+		const uint32_t offset = (uint32_t) rand() % 8;
+		const uint32_t len = (uint32_t) rand() % BUFFER_SIZE;
+		uint32_t i;
+
+		switch (n % 4) {
+		case 0:
+			memset(s_buffer, 0xFF, sizeof(s_buffer));	// Most carries
+			break;
+		case 1:
+			memset(s_buffer, 0x00, sizeof(s_buffer));
+			break;
+		default:
+			for (i = 0; i < sizeof(s_buffer); i++) {
+				s_buffer[i] = (uint8_t) rand();
+			}
+			break;
+		}
+
+		const uint16_t expected = reference_chksum(&s_buffer[offset], len);
+		const uint16_t result = to_network_order(net_chksum(&s_buffer[offset], len));
+
+		if (result != expected) {
+			if (errors < 10) {
+				printf("net_chksum: offset %u, length %u: 0x%04x, expected 0x%04x\n", offset, len, result, expected);
+			}
+			errors++;
+		}
+	}
+
+	printf("net_chksum: %d buffers, %d errors\n", BUFFERS, errors);
+
+	return errors;
+}
+
+/*
+ * The updates of udp.c _set_ip4_header: a 20 byte IPv4 header, 16-bit fields
+ * change one at a time, the checksum is never recomputed.
+ */
+static int test_chksum_update(void) {
+	uint16_t header[10];
+	uint32_t i, n;
+	int errors = 0;
+
+	for (i = 0; i < 10; i++) {
+		header[i] = (uint16_t) rand();
+	}
+
+	header[0] = 0x0045;	// Version and header length, a header is never all zero
+	header[5] = 0;
+	header[5] = net_chksum(header, sizeof(header));
+
+	for (n = 0; n < UPDATES; n++) {
+		uint32_t field = 1 + (uint32_t) rand() % 8;
+		const uint16_t value = random16();
+
+		field = (field >= 5) ? field + 1 : field;	// Not the checksum itself
+
+		const uint16_t chksum = net_chksum_update(header[5], header[field], value);
+		header[field] = value;
+
+		header[5] = 0;
+		const uint16_t expected = reference_chksum((const uint8_t *) header, sizeof(header));
+
+		if (to_network_order(chksum) != expected) {
+			if (errors < 10) {
+				printf("net_chksum_update: update %u, field %u: 0x%04x, expected 0x%04x\n", n, field, to_network_order(chksum), expected);
+			}
+			errors++;
+			header[5] = net_chksum(header, sizeof(header));	// Start over from a correct checksum
+		} else {
+			header[5] = chksum;
+		}
+	}
+
+	printf("net_chksum_update: %d updates, %d errors\n", UPDATES, errors);
+
+	return errors;
+}
+
+int main(int argc, char **argv) {
+	srand((argc > 1) ? (unsigned) atoi(argv[1]) : 1);
+
+	const int errors = test_chksum() + test_chksum_update();
+
+	return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,327 @@
+/**
+ * @file netbench.c
+ *
+ * Replays Ethernet frames through the lib-h3 IP stack on a Linux host, with the
+ * EMAC driver replaced by net/linux/emac_shim.c, and reports frames/s and cycles/frame.
+ *
+ * netbench [file.pcap|-] [budget] [rounds]
+ *  Without a file, or with '-', a synthetic capture is written to NETBENCH_PCAP and replayed:
+ *  per cycle 4 Art-Net ArtDmx unicast and 5 sACN multicast universes.
+ * netbench -t tap_interface [seconds]
+ *  Handles the frames of an existing TAP interface, for example one created
+ *  with 'ip tuntap add mode tap'.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined (__x86_64__) || defined (__i386__)
+ #include <x86intrin.h>
+#endif
+
+#include "net/net.h"
+#include "net/emac_shim.h"
+
+#define NETBENCH_PCAP		"/tmp/netbench.pcap"
+
+#define ARTNET_PORT			6454
+#define E131_PORT			5568
+
+#define ARTNET_UNIVERSES	4
+#define E131_UNIVERSES		5
+#define CYCLES				200
+
+#define QUEUE_DEPTH			8
+
+static const uint8_t s_mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+static const uint8_t s_mac_source[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static const uint8_t s_ip[4] = { 192, 168, 2, 100 };
+static const uint8_t s_ip_source[4] = { 192, 168, 2, 10 };
+
+static uint8_t s_frame[1514];
+
+static uint64_t get_cycles(void) {
+#if defined (__x86_64__) || defined (__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static double get_seconds(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static void put16(uint8_t *p, uint16_t value) {
+	p[0] = (uint8_t) (value >> 8);
+	p[1] = (uint8_t) value;
+}
+
+static void put32le(uint8_t *p, uint32_t value) {
+	p[0] = (uint8_t) value;
+	p[1] = (uint8_t) (value >> 8);
+	p[2] = (uint8_t) (value >> 16);
+	p[3] = (uint8_t) (value >> 24);
+}
+
+static uint16_t ip_chksum(const uint8_t *p, uint32_t len) {
+	uint32_t sum = 0;
+	uint32_t i;
+
+	for (i = 0; i < len; i += 2) {
+		sum += (uint32_t) ((p[i] << 8) | p[i + 1]);
+	}
+
+	while (sum >> 16) {
+		sum = (sum & 0xFFFF) + (sum >> 16);
+	}
+
+	return (uint16_t) ~sum;
+}
+
+/*
+ * Ethernet + IPv4 + UDP headers in s_frame, the payload is at offset 42
+ */
+static uint16_t make_frame(const uint8_t *dst_mac, const uint8_t *dst_ip, uint16_t port, uint16_t payload_length) {
+	uint8_t *ip = &s_frame[14];
+	uint8_t *udp = &s_frame[34];
+
+	memcpy(s_frame, dst_mac, 6);
+	memcpy(&s_frame[6], s_mac_source, 6);
+	put16(&s_frame[12], 0x0800);
+
+	memset(ip, 0, 20);
+	ip[0] = 0x45;
+	put16(&ip[2], (uint16_t) (20 + 8 + payload_length));
+	put16(&ip[6], 0x4000);
+	ip[8] = 64;
+	ip[9] = 17;
+	memcpy(&ip[12], s_ip_source, 4);
+	memcpy(&ip[16], dst_ip, 4);
+	put16(&ip[10], ip_chksum(ip, 20));
+
+	put16(&udp[0], port);
+	put16(&udp[2], port);
+	put16(&udp[4], (uint16_t) (8 + payload_length));
+	put16(&udp[6], 0);
+
+	return (uint16_t) (42 + payload_length);
+}
+
+static void write_record(FILE *fp, uint32_t index, uint16_t length) {
+	uint8_t record[16];
+
+	put32le(&record[0], index / 1000);
+	put32le(&record[4], index % 1000);
+	put32le(&record[8], length);
+	put32le(&record[12], length);
+
+	fwrite(record, sizeof(record), 1, fp);
+	fwrite(s_frame, length, 1, fp);
+}
+
+static int write_capture(const char *file) {
+	FILE *fp = fopen(file, "wb");
+
+	if (fp == NULL) {
+		perror(file);
+		return -1;
+	}
+
+	uint8_t header[24];
+
+	put32le(&header[0], 0xa1b2c3d4);
+	header[4] = 2; header[5] = 0;	// Version 2.4, little endian
+	header[6] = 4; header[7] = 0;
+	put32le(&header[8], 0);
+	put32le(&header[12], 0);
+	put32le(&header[16], 65535);
+	put32le(&header[20], 1);		// Ethernet
+
+	fwrite(header, sizeof(header), 1, fp);
+
+	uint32_t index = 0;
+	uint32_t cycle, universe;
+
+	for (cycle = 0; cycle < CYCLES; cycle++) {
+		for (universe = 0; universe < ARTNET_UNIVERSES; universe++) {
+			uint8_t *art = &s_frame[42];
+
+			memset(art, 0, 18 + 512);
+			memcpy(art, "Art-Net", 8);
+			art[8] = 0x00; art[9] = 0x50;	// OpDmx
+			art[11] = 14;
+			art[12] = (uint8_t) cycle;		// Sequence
+			art[14] = (uint8_t) universe;
+			put16(&art[16], 512);
+
+			write_record(fp, index++, make_frame(s_mac, s_ip, ARTNET_PORT, 18 + 512));
+		}
+
+		for (universe = 1; universe <= E131_UNIVERSES; universe++) {
+			const uint8_t mac[6] = { 0x01, 0x00, 0x5e, 0x7f, 0x00, (uint8_t) universe };
+			const uint8_t ip[4] = { 239, 255, 0, (uint8_t) universe };
+
+			memset(&s_frame[42], 0, 126 + 513);
+
+			write_record(fp, index++, make_frame(mac, ip, E131_PORT, 126 + 513));
+		}
+	}
+
+	fclose(fp);
+
+	return (int) index;
+}
+
+static uint32_t drain(int handle) {
+	uint8_t *data;
+	uint32_t from_ip;
+	uint16_t from_port;
+	uint32_t count = 0;
+
+	while (udp_recv_ref((uint8_t) handle, &data, &from_ip, &from_port) != 0) {
+		udp_release((uint8_t) handle);
+		count++;
+	}
+
+	return count;
+}
+
+int main(int argc, char **argv) {
+	const bool is_tap = (argc > 2) && (strcmp(argv[1], "-t") == 0);
+	const bool is_synthetic = !is_tap && ((argc < 2) || (strcmp(argv[1], "-") == 0));
+	const char *file = is_synthetic ? NETBENCH_PCAP : argv[1];
+	uint32_t budget = 8;
+	uint32_t rounds = 500;
+	uint32_t seconds = 10;
+
+	if (is_tap) {
+		if (argc > 3) {
+			seconds = (uint32_t) atoi(argv[3]);
+		}
+
+		if (emac_shim_open_tap(argv[2]) < 0) {
+			return EXIT_FAILURE;
+		}
+	} else {
+		if (argc > 2) {
+			budget = (uint32_t) atoi(argv[2]);
+		}
+
+		if (argc > 3) {
+			rounds = (uint32_t) atoi(argv[3]);
+		}
+
+		if (is_synthetic && (write_capture(file) < 0)) {
+			return EXIT_FAILURE;
+		}
+
+		if (emac_shim_open_pcap(file) <= 0) {
+			fprintf(stderr, "%s: no frames\n", file);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (budget == 0) {
+		budget = 1;
+	}
+
+	struct ip_info ip_info;
+
+	memcpy(&ip_info.ip.addr, s_ip, 4);
+	ip_info.netmask.addr = 0x00FFFFFF;
+	ip_info.gw.addr = 0;
+
+	net_init(s_mac, &ip_info, (const uint8_t *) "netbench", false);
+	net_set_handle_budget(budget, 0);
+
+	const int artnet = udp_bind_queue(ARTNET_PORT, QUEUE_DEPTH, UDP_QUEUE_DROP_OLDEST);
+	const int e131 = udp_bind_queue(E131_PORT, QUEUE_DEPTH, UDP_QUEUE_DROP_OLDEST);
+
+	if ((artnet < 0) || (e131 < 0)) {
+		fprintf(stderr, "udp_bind_queue failed\n");
+		return EXIT_FAILURE;
+	}
+
+	uint32_t universe;
+
+	for (universe = 1; universe <= E131_UNIVERSES; universe++) {
+		igmp_join(0x0000FFEF | (universe << 24));
+	}
+
+	uint64_t delivered = 0;
+	const double start = get_seconds();
+	const uint64_t cycles_start = get_cycles();
+
+	if (is_tap) {
+		while ((get_seconds() - start) < (double) seconds) {
+			net_handle();
+			delivered += drain(artnet);
+			delivered += drain(e131);
+		}
+	} else {
+		uint32_t round;
+
+		for (round = 0; round < rounds; round++) {
+			struct emac_shim_stats before, after;
+
+			emac_shim_rewind();
+
+			do {
+				emac_shim_get_stats(&before);
+				net_handle();
+				delivered += drain(artnet);
+				delivered += drain(e131);
+				emac_shim_get_stats(&after);
+			} while (after.rx_frames != before.rx_frames);
+		}
+	}
+
+	const uint64_t cycles = get_cycles() - cycles_start;
+	const double elapsed = get_seconds() - start;
+
+	struct net_stats net_stats;
+	struct emac_shim_stats shim_stats;
+
+	net_get_stats(&net_stats);
+	emac_shim_get_stats(&shim_stats);
+	emac_shim_close();
+
+	printf("%s: %u frames handled, %llu datagrams delivered, %u filtered\n", is_tap ? argv[2] : file, net_stats.frames, (unsigned long long) delivered, shim_stats.rx_filtered);
+	printf("budget %u: %.2f M frames/s", budget, (elapsed > 0) ? (double) net_stats.frames / elapsed / 1e6 : 0);
+
+	if ((cycles != 0) && (net_stats.frames != 0)) {
+		printf(", %.0f cycles/frame", (double) cycles / (double) net_stats.frames);
+	}
+
+	printf("\nbudget exhausted %u, drain max %u, pending max %u\n", net_stats.budget_exhausted, net_stats.drain_max, net_stats.rx_pending_max);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file udp_queue_test.c
+ *
+ * Checks the UDP receive queues: the depth taken from the shared pool,
+ * both full policies, the borrowed entry and the counters.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "net/net.h"
+
+#include "net_packets.h"
+
+extern void udp_init(const uint8_t *, const struct ip_info  *);
+extern void udp_handle(struct t_udp *);
+
+#define PORT_ARTNET		6454
+#define PORT_SACN		5568
+#define PORT_OTHER		7000
+
+static struct t_udp s_packet;
+static int s_errors;
+
+static void check(bool condition, const char *what) {
+	if (!condition) {
+		printf("FAIL: %s\n", what);
+		s_errors++;
+	}
+}
+
+/*
+ * A datagram of length bytes, all set to tag, as ip_handle passes it on
+ */
+static void receive(uint16_t port, uint8_t tag, uint16_t length) {
+	s_packet.udp.source_port = __builtin_bswap16(1234);
+	s_packet.udp.destination_port = __builtin_bswap16(port);
+	s_packet.udp.len = __builtin_bswap16((uint16_t) (length + UDP_HEADER_SIZE));
+	memset(s_packet.udp.data, tag, length);
+
+	udp_handle(&s_packet);
+}
+
+static bool is_filled(const uint8_t *data, uint16_t length, uint8_t tag) {
+	uint16_t i;
+
+	for (i = 0; i < length; i++) {
+		if (data[i] != tag) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void test_bind(void) {
+	const uint8_t mac[ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+	struct ip_info ip_info;
+	struct udp_queue_stats stats;
+
+	memset(&ip_info, 0, sizeof(ip_info));
+	udp_init(mac, &ip_info);
+
+	check(udp_bind(PORT_ARTNET) == 0, "udp_bind");
+	check(udp_bind_queue(PORT_SACN, 8, UDP_QUEUE_DROP_OLDEST) == 1, "udp_bind_queue");
+	check(udp_bind(PORT_ARTNET) == 0, "udp_bind of a bound port returns its index");
+
+	// 4 + 8 of the 24 entries are used
+	check(udp_bind_queue(PORT_OTHER, 13, UDP_QUEUE_DROP_NEWEST) == -1, "udp_bind_queue beyond the pool");
+	check(udp_bind_queue(PORT_OTHER, 12, UDP_QUEUE_DROP_NEWEST) == 2, "udp_bind_queue with the rest of the pool");
+
+	// Unbinding returns the entries to the pool
+	check(udp_unbind(PORT_OTHER) == 0, "udp_unbind");
+	check(udp_bind_queue(PORT_OTHER, 12, UDP_QUEUE_DROP_NEWEST) == 2, "udp_bind_queue after udp_unbind");
+
+	udp_get_queue_stats(2, &stats);
+	check((stats.depth == 12) && (stats.received == 0) && (stats.high_water == 0), "queue statistics after a rebind");
+}
+
+static void test_drop_oldest(void) {
+	struct udp_queue_stats stats;
+	uint8_t *data;
+	uint32_t from_ip;
+	uint16_t from_port;
+	uint16_t length;
+	uint8_t i;
+
+	for (i = 0; i < 10; i++) {
+		receive(PORT_SACN, i, (uint16_t) (100 + i));
+	}
+
+	// The newest 8 are kept, in order
+	for (i = 2; i < 10; i++) {
+		length = udp_recv_ref(1, &data, &from_ip, &from_port);
+		check((length == 100 + i) && is_filled(data, length, i) && (from_port == 1234), "drop oldest: the newest datagrams are kept");
+		udp_release(1);
+	}
+
+	check(udp_recv_ref(1, &data, &from_ip, &from_port) == 0, "drop oldest: the queue is empty");
+
+	udp_get_queue_stats(1, &stats);
+	check((stats.received == 10) && (stats.dropped == 2) && (stats.high_water == 8), "drop oldest: statistics");
+
+	// The borrowed oldest entry is not dropped, the new datagram is
+	for (i = 0; i < 8; i++) {
+		receive(PORT_SACN, i, 10);
+	}
+
+	length = udp_recv_ref(1, &data, &from_ip, &from_port);
+	receive(PORT_SACN, 99, 10);
+	check((length == 10) && is_filled(data, length, 0), "drop oldest: the borrowed datagram is kept");
+	udp_release(1);
+
+	for (i = 1; i < 8; i++) {
+		length = udp_recv_ref(1, &data, &from_ip, &from_port);
+		check((length == 10) && is_filled(data, length, i), "drop oldest: the datagram received while borrowed is dropped");
+		udp_release(1);
+	}
+
+	check(udp_recv_ref(1, &data, &from_ip, &from_port) == 0, "drop oldest: the queue is empty again");
+}
+
+static void test_drop_newest(void) {
+	struct udp_queue_stats stats;
+	uint8_t buffer[FRAME_BUFFER_SIZE];
+	uint32_t from_ip;
+	uint16_t from_port;
+	uint16_t length;
+	uint8_t i;
+
+	for (i = 0; i < 6; i++) {
+		receive(PORT_ARTNET, i, (uint16_t) (50 + i));
+	}
+
+	// The first 4 are kept
+	for (i = 0; i < 4; i++) {
+		length = udp_recv(0, buffer, sizeof(buffer), &from_ip, &from_port);
+		check((length == 50 + i) && is_filled(buffer, length, i), "drop newest: the first datagrams are kept");
+	}
+
+	check(udp_recv(0, buffer, sizeof(buffer), &from_ip, &from_port) == 0, "drop newest: the queue is empty");
+
+	udp_get_queue_stats(0, &stats);
+	check((stats.received == 6) && (stats.dropped == 2) && (stats.high_water == 4) && (stats.depth == 4), "drop newest: statistics");
+}
+
+int main(void) {
+	test_bind();
+	test_drop_oldest();
+	test_drop_newest();
+
+	printf("udp_queue_test: %d errors\n", s_errors);
+
+	return (s_errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
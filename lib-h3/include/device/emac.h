@@ -29,6 +29,30 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/**
+ * Index, 0-63, of the multicast hash table bit for a destination MAC address:
+ * the upper 6 bits of the bit-reversed Ethernet CRC of the address
+ */
+static inline uint32_t emac_multicast_hash(const uint8_t *mac_address) {
+	uint32_t crc = 0xFFFFFFFF;
+	uint32_t i, j;
+
+	for (i = 0; i < 6; i++) {
+		crc ^= mac_address[i];
+		for (j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+		}
+	}
+
+	uint32_t index = 0;
+
+	for (i = 0; i < 6; i++) {
+		index |= ((crc >> i) & 1) << (5 - i);
+	}
+
+	return index ^ 0x3F;
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -36,6 +60,10 @@ extern "C" {
 extern void emac_init(void);
 extern void emac_start(bool reset_emac);
 extern void emac_shutdown(void);
+/**
+ * Only multicast frames with their hash table bit set are received; all multicast is received when all_multicast is true
+ */
+extern void emac_set_multicast_filter(uint32_t hash_high, uint32_t hash_low, bool all_multicast);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,68 @@
+/**
+ * @file emac_shim.h
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NET_EMAC_SHIM_H_
+#define NET_EMAC_SHIM_H_
+
+/*
+ * Linux replacement for the H3 EMAC driver, so that the lib-h3/net stack can run on a host.
+ * Frames are read from a pcap file (Ethernet link type) or from a TAP device.
+ */
+
+#include <stdint.h>
+
+struct emac_shim_stats {
+	uint32_t rx_frames;		///< Frames handed to the stack
+	uint32_t tx_frames;		///< Frames sent by the stack
+	uint32_t rx_filtered;	///< Multicast frames dropped by the emulated hash filter
+	uint64_t rx_bytes;		///<
+	uint64_t tx_bytes;		///<
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Loads all frames of the pcap file in memory. When the last frame has been handed out,
+ * emac_eth_recv reports that nothing is received until emac_shim_rewind is called.
+ * @return the number of frames loaded, -1 on error
+ */
+extern int emac_shim_open_pcap(const char *);
+/**
+ * Attaches to an existing TAP interface, for example one created with 'ip tuntap add mode tap'.
+ * @return 0 on success, -1 on error
+ */
+extern int emac_shim_open_tap(const char *);
+extern void emac_shim_rewind(void);
+extern void emac_shim_close(void);
+
+extern void emac_shim_get_stats(struct emac_shim_stats *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_EMAC_SHIM_H_ */
@@ -43,6 +43,35 @@ struct ip_info {
 
 #define IP_BROADCAST	((uint32_t) 0xFFFFFFFF)
 
+typedef enum udp_queue_policy {
+	UDP_QUEUE_DROP_NEWEST = 0,	///< A full queue discards the datagram that just arrived
+	UDP_QUEUE_DROP_OLDEST		///< A full queue discards its oldest datagram
+} udp_queue_policy_t;
+
+struct udp_queue_stats {
+	uint32_t received;			///< Datagrams delivered to the port
+	uint32_t dropped;			///< Datagrams discarded because the queue was full
+	uint16_t high_water;		///< Highest number of queued datagrams seen
+	uint16_t depth;				///< Number of queue entries
+};
+
+struct net_stats {
+	uint32_t frames;			///< Frames handled by net_handle
+	uint32_t budget_exhausted;	///< net_handle calls that stopped on the budget with frames left in the RX ring
+	uint32_t rx_overflows;		///< Times the RX ring was full and the EMAC dropped frames
+	uint16_t drain_max;			///< Most frames handled in one net_handle call
+	uint16_t rx_pending_max;	///< Highest backlog seen by one net_handle call: frames handled plus frames left in the RX ring
+};
+
+struct arp_cache_stats {
+	uint32_t hits;				///< Lookups answered from the cache
+	uint32_t misses;			///< Lookups that needed an ARP request
+	uint32_t evictions;			///< Least recently used entries replaced because the cache was full
+	uint32_t expired;			///< Entries removed because they were not refreshed in time
+	uint32_t pending_dropped;	///< Frames dropped while waiting for an ARP reply
+	uint16_t entries;			///< Entries in use
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -50,10 +79,18 @@ extern "C" {
 extern void net_init(const uint8_t *, struct ip_info *, const uint8_t *, bool);
 extern void net_handle(void);
 extern void net_set_ip(uint32_t);
+extern void net_set_handle_budget(uint32_t, uint32_t);
+extern void net_get_stats(struct net_stats *);
+//
+extern void arp_cache_get_stats(struct arp_cache_stats *);
 //
 extern int udp_bind(uint16_t);
+extern int udp_bind_queue(uint16_t, uint16_t, udp_queue_policy_t);
 extern int udp_unbind(uint16_t);
 extern uint16_t udp_recv(uint8_t, uint8_t *, uint16_t, uint32_t *, uint16_t *);
+extern uint16_t udp_recv_ref(uint8_t, uint8_t **, uint32_t *, uint16_t *);
+extern void udp_release(uint8_t);
+extern void udp_get_queue_stats(uint8_t, struct udp_queue_stats *);
 extern int udp_send(uint8_t, const uint8_t *, uint16_t, uint32_t, uint16_t);
 //
 extern int igmp_join(uint32_t);
@@ -38,6 +38,7 @@
 
 extern void arp_cache_init(void);
 extern void arp_cache_update(uint8_t *, uint32_t);
+extern void arp_cache_refresh(uint8_t *, uint32_t);
 
 extern void emac_eth_send(void *, int);
 
@@ -63,6 +64,16 @@ static void arp_announce(void) {
 static void arp_handle_request(struct t_arp *p_arp) {
 	DEBUG2_ENTRY
 
+	if (p_arp->arp.target_ip != s_arp_reply.arp.sender_ip) {
+		// Not for us, but it keeps a known entry up to date, gratuitous ARP included
+		arp_cache_refresh(p_arp->arp.sender_mac, p_arp->arp.sender_ip);
+		DEBUG2_EXIT
+		return;
+	}
+
+	// The sender is about to talk to us
+	arp_cache_update(p_arp->arp.sender_mac, p_arp->arp.sender_ip);
+
 	// Ethernet header
 	memcpy(s_arp_reply.ether.dst, p_arp->ether.src, ETH_ADDR_LEN);
 
@@ -24,9 +24,12 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <assert.h>
 
+#include "net/net.h"
+
 #include "net_packets.h"
 #include "net_debug.h"
 
@@ -35,13 +38,34 @@
 #endif
 
 extern void arp_send_request(uint32_t ip);
-extern void net_handle(void);
+extern void emac_eth_send(void *, int);
+
+#define MAX_RECORDS			64		// Must always be a power of 2, at most 255
+#define HASH_SIZE			64		// Must always be a power of 2
+#define HASH_MASK			(HASH_SIZE - 1)
+#define INDEX_NONE			0xFF
 
-#define MAX_RECORDS	32
+#define MAX_PENDING			4		// Outgoing frames waiting for an ARP reply
+
+#define TICKS_PER_SECOND	10		// arp_cache_timer runs every 100 msec
+#define RECORD_TIMEOUT		(10 * 60 * TICKS_PER_SECOND)	// Entries not refreshed for 10 minutes are removed
+#define REQUEST_INTERVAL	(TICKS_PER_SECOND / 2)
+#define REQUEST_RETRIES		3
 
 struct t_arp_record {
 	uint32_t ip;
+	uint32_t updated;	// Tick of the last ARP packet from ip
+	uint32_t used;		// Tick of the last lookup, for the LRU eviction
 	uint8_t mac_address[ETH_ADDR_LEN];
+	uint8_t next;		// Next record in the same hash chain
+} ALIGNED;
+
+struct t_arp_pending {
+	uint32_t ip;
+	uint16_t length;
+	uint8_t requests;
+	uint8_t ticks;
+	uint8_t frame[FRAME_BUFFER_SIZE] ALIGNED;
 } ALIGNED;
 
 typedef union pcast32 {
@@ -50,7 +74,12 @@ typedef union pcast32 {
 } _pcast32;
 
 static struct t_arp_record s_arp_records[MAX_RECORDS] ALIGNED;
-static uint16_t s_entry_current;
+static uint8_t s_hash_table[HASH_SIZE] ALIGNED;
+static uint8_t s_free_list;
+static uint16_t s_records_used;
+static struct t_arp_pending s_pending[MAX_PENDING] ALIGNED;
+static uint32_t s_ticks;
+static struct arp_cache_stats s_stats;
 static uint8_t s_multicast_mac[ETH_ADDR_LEN] = {0x01, 0x00, 0x5E}; // Fixed part
 
 #ifndef NDEBUG
@@ -58,44 +87,144 @@ static uint8_t s_multicast_mac[ETH_ADDR_LEN] = {0x01, 0x00, 0x5E}; // Fixed part
  static volatile uint32_t s_ticker ;
 #endif
 
+static inline uint32_t hash(uint32_t ip) {
+	// ip is in network byte order, the host part is in the upper bytes
+	return ((ip >> 24) ^ (ip >> 16)) & HASH_MASK;
+}
+
+static struct t_arp_record *find(uint32_t ip) {
+	uint8_t index = s_hash_table[hash(ip)];
+
+	while (index != INDEX_NONE) {
+		if (s_arp_records[index].ip == ip) {
+			return &s_arp_records[index];
+		}
+		index = s_arp_records[index].next;
+	}
+
+	return 0;
+}
+
+static void remove_record(uint8_t index) {
+	struct t_arp_record *p_record = &s_arp_records[index];
+	uint8_t *p_link = &s_hash_table[hash(p_record->ip)];
+
+	while (*p_link != index) {
+		assert(*p_link != INDEX_NONE);
+		p_link = &s_arp_records[*p_link].next;
+	}
+
+	*p_link = p_record->next;
+
+	p_record->ip = 0;
+	p_record->next = s_free_list;
+	s_free_list = index;
+	s_records_used--;
+}
+
+static uint8_t evict_lru(void) {
+	uint32_t i;
+	uint8_t lru = 0;
+
+	for (i = 1; i < MAX_RECORDS; i++) {
+		if ((s_ticks - s_arp_records[i].used) > (s_ticks - s_arp_records[lru].used)) {
+			lru = (uint8_t) i;
+		}
+	}
+
+	DEBUG_PRINTF("Evict " IPSTR, IP2STR(s_arp_records[lru].ip));
+
+	remove_record(lru);
+	s_stats.evictions++;
+
+	return lru;
+}
+
+static void send_pending(uint32_t ip, const uint8_t *mac_address) {
+	uint32_t i;
+
+	for (i = 0; i < MAX_PENDING; i++) {
+		struct t_arp_pending *p_pending = &s_pending[i];
+
+		if ((p_pending->length != 0) && (p_pending->ip == ip)) {
+			memcpy(((struct ether_packet *) p_pending->frame)->dst, mac_address, ETH_ADDR_LEN);
+			emac_eth_send((void *) p_pending->frame, p_pending->length);
+			p_pending->length = 0;
+		}
+	}
+}
+
 void arp_cache_init(void) {
-	uint16_t i;
+	uint32_t i;
 
-	s_entry_current = 0;
+	memset(s_hash_table, INDEX_NONE, sizeof(s_hash_table));
 
 	for (i = 0; i < MAX_RECORDS; i++) {
 		s_arp_records[i].ip = 0;
 		memset(s_arp_records[i].mac_address, 0, ETH_ADDR_LEN);
+		s_arp_records[i].next = (i == MAX_RECORDS - 1) ? INDEX_NONE : (uint8_t) (i + 1);
+	}
+
+	for (i = 0; i < MAX_PENDING; i++) {
+		s_pending[i].length = 0;
 	}
 
+	s_free_list = 0;
+	s_records_used = 0;
+	s_ticks = 0;
+
+	memset(&s_stats, 0, sizeof(struct arp_cache_stats));
+
 #ifndef NDEBUG
 	s_ticker = TICKER_COUNT;
 #endif
 }
 
+/**
+ * Adds or updates the entry for ip. When the table is full, the least recently used entry is replaced.
+ * Frames waiting for ip are sent.
+ */
 void arp_cache_update(uint8_t *mac_address, uint32_t ip) {
 	DEBUG2_ENTRY
-	uint16_t i;
 
-	if (s_entry_current == MAX_RECORDS) {
-		assert(0);
-		return;
-	}
+	struct t_arp_record *p_record = find(ip);
 
-	for (i = 0; i < s_entry_current; i++) {
-		if (s_arp_records[i].ip == ip) {
-			return;
-		}
+	if (p_record == 0) {
+		const uint8_t index = (s_free_list != INDEX_NONE) ? s_free_list : evict_lru();
+
+		p_record = &s_arp_records[index];
+		s_free_list = p_record->next;
+
+		p_record->ip = ip;
+		p_record->used = s_ticks;
+		p_record->next = s_hash_table[hash(ip)];
+		s_hash_table[hash(ip)] = index;
+		s_records_used++;
 	}
 
-	memcpy(s_arp_records[s_entry_current].mac_address, mac_address, ETH_ADDR_LEN);
-	s_arp_records[s_entry_current].ip = ip;
+	memcpy(p_record->mac_address, mac_address, ETH_ADDR_LEN);
+	p_record->updated = s_ticks;
 
-	s_entry_current++;
+	send_pending(ip, mac_address);
 
 	DEBUG2_EXIT
 }
 
+/**
+ * Updates the entry for ip only when there is one, as for a gratuitous ARP (RFC 826 merge flag)
+ */
+void arp_cache_refresh(uint8_t *mac_address, uint32_t ip) {
+	struct t_arp_record *p_record = find(ip);
+
+	if (p_record != 0) {
+		memcpy(p_record->mac_address, mac_address, ETH_ADDR_LEN);
+		p_record->updated = s_ticks;
+	}
+}
+
+/**
+ * @return ip, with mac_address filled in, when the MAC address is known; 0 otherwise
+ */
 uint32_t arp_cache_lookup(uint32_t ip, uint8_t *mac_address) {
 	DEBUG2_ENTRY
 
@@ -112,67 +241,129 @@ uint32_t arp_cache_lookup(uint32_t ip, uint8_t *mac_address) {
 		return ip;
 	}
 
-	DEBUG_PRINTF(IPSTR " " MACSTR, IP2STR(ip), MAC2STR(mac_address));
-
-	uint16_t i;
-
-	for (i = 0; i < MAX_RECORDS; i++) {
-		if (s_arp_records[i].ip == ip) {
-			memcpy(mac_address, s_arp_records[i].mac_address, ETH_ADDR_LEN);
-			return ip;
-		}
+	struct t_arp_record *p_record = find(ip);
 
-		if (s_arp_records[i].ip == 0) {
-			break;
-		}
+	if (__builtin_expect((p_record != 0), 1)) {
+		memcpy(mac_address, p_record->mac_address, ETH_ADDR_LEN);
+		p_record->used = s_ticks;
+		s_stats.hits++;
+		DEBUG2_EXIT
+		return ip;
 	}
 
-	uint16_t current_entry = s_entry_current;
-	int16_t timeout;
-	int8_t retries = 3;
+	s_stats.misses++;
 
-	while (retries--) {
-		arp_send_request(ip);
+	DEBUG2_EXIT
+	return 0;
+}
 
-		timeout = 0xFFF;
+/**
+ * Sends an Ethernet frame to ip. When the MAC address of ip is not known yet, a copy of the frame
+ * is kept and sent when the ARP reply arrives.
+ * @return 0 when sent, 1 when waiting for the ARP reply, -1 when there is no room to wait
+ */
+int arp_cache_send(void *frame, uint32_t length, uint32_t ip) {
+	struct ether_packet *p_ether = (struct ether_packet *) frame;
 
-		while ((timeout-- > 0) && (current_entry == s_entry_current)) {
-			net_handle();
-		}
+	if (arp_cache_lookup(ip, p_ether->dst) == ip) {
+		emac_eth_send(frame, (int) length);
+		return 0;
+	}
 
-		if (current_entry != s_entry_current) {
-			memcpy(mac_address, s_arp_records[current_entry].mac_address, ETH_ADDR_LEN);
-			DEBUG_PRINTF("timeout=%x", timeout);
-			return ip;
+	uint32_t i;
+	bool is_requested = false;
+	struct t_arp_pending *p_free = 0;
+
+	for (i = 0; i < MAX_PENDING; i++) {
+		if (s_pending[i].length == 0) {
+			if (p_free == 0) {
+				p_free = &s_pending[i];
+			}
+		} else if (s_pending[i].ip == ip) {
+			is_requested = true;
 		}
+	}
 
-		DEBUG_PRINTF("i=%d, timeout=%d, current_entry=%d, s_entry_current=%d", i, timeout, current_entry, s_entry_current);
+	if ((p_free == 0) || (length > sizeof(p_free->frame))) {
+		s_stats.pending_dropped++;
+		DEBUG_PRINTF("No room for " IPSTR, IP2STR(ip));
+		return -1;
 	}
 
-	DEBUG2_EXIT
-	return 0;
+	memcpy(p_free->frame, frame, length);
+	p_free->ip = ip;
+	p_free->length = (uint16_t) length;
+	p_free->requests = 1;
+	p_free->ticks = 0;
+
+	if (!is_requested) {
+		arp_send_request(ip);
+	}
+
+	return 1;
+}
+
+void arp_cache_get_stats(struct arp_cache_stats *stats) {
+	assert(stats != 0);
+
+	memcpy(stats, &s_stats, sizeof(struct arp_cache_stats));
+	stats->entries = s_records_used;
 }
 
 void arp_cache_dump(void) {
 #ifndef NDEBUG
-	uint16_t i;
+	uint32_t i;
 
-	printf("ARP Cache size=%d\n", s_entry_current);
+	printf("ARP Cache size=%d\n", s_records_used);
 
-	for (i = 0; i < s_entry_current; i++) {
-		printf("%02d " IPSTR " " MACSTR "\n", i, IP2STR(s_arp_records[i].ip),MAC2STR(s_arp_records[i].mac_address));
+	for (i = 0; i < MAX_RECORDS; i++) {
+		if (s_arp_records[i].ip != 0) {
+			printf("%02d " IPSTR " " MACSTR " %d\n", i, IP2STR(s_arp_records[i].ip), MAC2STR(s_arp_records[i].mac_address), (int) (s_ticks - s_arp_records[i].updated) / TICKS_PER_SECOND);
+		}
 	}
 #endif
 }
 
-#ifndef NDEBUG
 void arp_cache_timer(void) {
+	uint32_t i;
+
+	s_ticks++;
+
+	for (i = 0; i < MAX_PENDING; i++) {
+		struct t_arp_pending *p_pending = &s_pending[i];
+
+		if ((p_pending->length == 0) || (++p_pending->ticks < REQUEST_INTERVAL)) {
+			continue;
+		}
+
+		p_pending->ticks = 0;
+
+		if (p_pending->requests == REQUEST_RETRIES) {
+			DEBUG_PRINTF("No ARP reply from " IPSTR, IP2STR(p_pending->ip));
+			p_pending->length = 0;
+			s_stats.pending_dropped++;
+			continue;
+		}
+
+		p_pending->requests++;
+		arp_send_request(p_pending->ip);
+	}
+
+	// Aging, one record per tick keeps the timer cheap
+	const uint8_t index = (uint8_t) (s_ticks & (MAX_RECORDS - 1));
+
+	if ((s_arp_records[index].ip != 0) && ((s_ticks - s_arp_records[index].updated) > RECORD_TIMEOUT)) {
+		DEBUG_PRINTF("Expired " IPSTR, IP2STR(s_arp_records[index].ip));
+		remove_record(index);
+		s_stats.expired++;
+	}
+
+#ifndef NDEBUG
 	s_ticker--;
 
 	if (s_ticker == 0) {
 		s_ticker = TICKER_COUNT;
 		arp_cache_dump();
 	}
-}
 #endif
-
+}
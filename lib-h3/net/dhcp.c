@@ -34,8 +34,7 @@
 
 #include "net_packets.h"
 #include "net_debug.h"
-
-#include "h3.h"
+#include "net_platform.h"
 
 #ifndef ALIGNED
  #define ALIGNED __attribute__ ((aligned (4)))
@@ -204,9 +203,9 @@ static int _parse_response(int idx, const uint8_t *mac_address) {
 	struct t_dhcp_message response;
 	uint16_t size = 0;
 
-	const uint32_t micros_timeout = H3_TIMER->AVS_CNT1 + (5 * 1000 * 1000); // 3 seconds
+	const uint32_t micros_timeout = net_micros() + (5 * 1000 * 1000); // 3 seconds
 
-	while (H3_TIMER->AVS_CNT1 < micros_timeout) {
+	while (net_micros() < micros_timeout) {
 		net_handle();
 
 		uint32_t from_ip;
@@ -221,7 +220,7 @@ static int _parse_response(int idx, const uint8_t *mac_address) {
 		}
 	}
 
-	DEBUG_PRINTF("micros_timeout - H3_TIMER->AVS_CNT1=%d", micros_timeout - H3_TIMER->AVS_CNT1);
+	DEBUG_PRINTF("micros_timeout - net_micros()=%d", micros_timeout - net_micros());
 
 	uint8_t type = 0;
 	uint8_t opt_len = 0;
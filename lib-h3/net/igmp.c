@@ -32,6 +32,8 @@
 #include "net_packets.h"
 #include "net_debug.h"
 
+#include "device/emac.h"
+
 #ifndef ALIGNED
  #define ALIGNED __attribute__ ((aligned (4)))
 #endif
@@ -39,15 +41,23 @@
 extern uint16_t net_chksum(void *, uint32_t);
 extern void emac_eth_send(void *, int);
 
-#define MAX_JOINS_ALLOWED	4
+#define MAX_JOINS_ALLOWED	64
+
+#define JOIN_DELAY_MAX					5	// 1/10 seconds, spreads the first reports of many joins
+#define UNSOLICITED_REPORT_INTERVAL		100	// 1/10 seconds, RFC 2236
+#define LEAVE_DELAY_MAX					5	// 1/10 seconds
+#define QUERY_RESPONSE_DEFAULT			100	// 1/10 seconds, for IGMPv1 queries with a zero max_resp_time
+
+#define ALL_HOSTS_GROUP					0x010000e0	// 224.0.0.1
 
 typedef enum s_state {
-	NON_MEMBER = 0, DELAYING_MEMBER, IDLE_MEMBER
+	NON_MEMBER = 0, DELAYING_MEMBER, IDLE_MEMBER, LEAVING
 } _state;
 
 struct t_group_info {
 	uint32_t group_address;
 	uint8_t timer;		// 1/10 seconds
+	uint8_t reports;	// Unsolicited reports still to send
 	_state state;
 };
 
@@ -60,8 +70,57 @@ static struct t_igmp s_report ALIGNED;
 static struct t_igmp s_leave ALIGNED;
 static uint8_t s_multicast_mac[ETH_ADDR_LEN] ALIGNED;
 static struct t_group_info s_groups[MAX_JOINS_ALLOWED] ALIGNED;
-static uint8_t s_joins_allowed_index ALIGNED;
+static uint8_t s_groups_used ALIGNED;
+static uint16_t s_groups_overflow ALIGNED;	// Joins that did not fit in s_groups
 static uint16_t s_id ALIGNED;
+static uint32_t s_random ALIGNED;
+
+static uint8_t _random_delay(uint8_t max) {
+	// xorshift32
+	s_random ^= s_random << 13;
+	s_random ^= s_random >> 17;
+	s_random ^= s_random << 5;
+
+	return (uint8_t) (1 + (s_random % max));
+}
+
+static void _multicast_mac(uint32_t group_address, uint8_t *mac_address) {
+	_pcast32 multicast_ip;
+
+	multicast_ip.u32 = group_address;
+
+	mac_address[0] = 0x01;
+	mac_address[1] = 0x00;
+	mac_address[2] = 0x5E;
+	mac_address[3] = multicast_ip.u8[1] & 0x7F;
+	mac_address[4] = multicast_ip.u8[2];
+	mac_address[5] = multicast_ip.u8[3];
+}
+
+/*
+ * Only frames for the joined groups, and for the all-hosts group that carries the queries,
+ * make it through the EMAC. Hash collisions let some other groups through.
+ * When a join did not fit in the table, all multicast is passed, so that group is still received.
+ */
+static void _update_filter(void) {
+	uint32_t hash[2] = {0, 0};
+	uint8_t mac_address[ETH_ADDR_LEN];
+	uint32_t i;
+
+	_multicast_mac(ALL_HOSTS_GROUP, mac_address);
+	i = emac_multicast_hash(mac_address);
+	hash[i >> 5] |= (1U << (i & 31));
+
+	for (i = 0; i < MAX_JOINS_ALLOWED; i++) {
+		if ((s_groups[i].state != NON_MEMBER) && (s_groups[i].state != LEAVING)) {
+			_multicast_mac(s_groups[i].group_address, mac_address);
+			const uint32_t bit = emac_multicast_hash(mac_address);
+			hash[bit >> 5] |= (1U << (bit & 31));
+		}
+	}
+
+	emac_set_multicast_filter(hash[1], hash[0], s_groups_overflow != 0);
+}
 
 void igmp_set_ip(const struct ip_info  *p_ip_info) {
 	_pcast32 src;
@@ -79,14 +138,17 @@ void igmp_init(uint8_t *mac_address, const struct ip_info  *p_ip_info) {
 		memset(&s_groups[i], 0, sizeof(struct t_group_info));
 	}
 
-	s_joins_allowed_index = 0;
+	s_groups_used = 0;
+	s_groups_overflow = 0;
 	s_id = 0;
 
-	igmp_set_ip(p_ip_info);
+	// Different nodes must not pick the same delays
+	s_random = 0x9E3779B9;
+	for (i = 0; i < ETH_ADDR_LEN; i++) {
+		s_random = (s_random << 5) ^ (s_random >> 27) ^ mac_address[i];
+	}
 
-	s_multicast_mac[0] = 0x01;
-	s_multicast_mac[1] = 0x00;
-	s_multicast_mac[2] = 0x5E;
+	igmp_set_ip(p_ip_info);
 
 	// Ethernet
 	memcpy(s_report.ether.src, mac_address, ETH_ADDR_LEN);
@@ -129,6 +191,8 @@ void igmp_init(uint8_t *mac_address, const struct ip_info  *p_ip_info) {
 	// IGMP
 	s_leave.igmp.report.igmp.type = IGMP_TYPE_LEAVE;
 	s_leave.igmp.report.igmp.max_resp_time = 0;
+
+	_update_filter();
 }
 
 static void _send_report(uint32_t group_address) {
@@ -137,9 +201,7 @@ static void _send_report(uint32_t group_address) {
 
 	multicast_ip.u32 = group_address;
 
-	s_multicast_mac[3] = multicast_ip.u8[1] & 0x7F;
-	s_multicast_mac[4] = multicast_ip.u8[2];
-	s_multicast_mac[5] = multicast_ip.u8[3];
+	_multicast_mac(group_address, s_multicast_mac);
 
 	DEBUG_PRINTF(IPSTR " " MACSTR, IP2STR(group_address),MAC2STR(s_multicast_mac));
 
@@ -175,7 +237,7 @@ static void _send_leave(uint32_t group_address) {
 	// IPv4
 	s_leave.ip4.id = s_id;
 	s_leave.ip4.chksum = 0;
-	s_leave.ip4.chksum = net_chksum((void *) &s_report.ip4, 24); //TODO
+	s_leave.ip4.chksum = net_chksum((void *) &s_leave.ip4, 24); //TODO
 	// IGMP
 	memcpy(s_leave.igmp.report.igmp.group_address, multicast_ip.u8, IPv4_ADDR_LEN);
 	s_leave.igmp.report.igmp.checksum = 0;
@@ -203,22 +265,26 @@ void igmp_handle(struct t_igmp *p_igmp) {
 
 		bool  is_general_request = false;
 
-		igmp_generic_address.u32 = 0x010000e0;
+		igmp_generic_address.u32 = ALL_HOSTS_GROUP;
 
 		if (memcmp(p_igmp->ip4.dst, igmp_generic_address.u8, 4) == 0) {
 			is_general_request = true;
 		}
 
-		for (i = 0; i < s_joins_allowed_index; i++) {
+		const uint8_t max_resp_time = (p_igmp->igmp.igmp.max_resp_time == 0) ? QUERY_RESPONSE_DEFAULT : p_igmp->igmp.igmp.max_resp_time;
+
+		for (i = 0; i < MAX_JOINS_ALLOWED; i++) {
+			if ((s_groups[i].state != DELAYING_MEMBER) && (s_groups[i].state != IDLE_MEMBER)) {
+				continue;
+			}
+
 			group_address.u32 = s_groups[i].group_address;
+
 			if (is_general_request || ( memcmp(p_igmp->ip4.dst, group_address.u8, IPv4_ADDR_LEN) == 0)) {
-				if (s_groups[i].state == DELAYING_MEMBER) {
-					if (p_igmp->igmp.igmp.max_resp_time  < s_groups[i].timer) {
-						s_groups[i].timer = 1 + p_igmp->igmp.igmp.max_resp_time / 2;
-					}
-				} else { // s_groups[s_joins_allowed_index].state == IDLE_MEMBER
+				// A random delay in [1, max_resp_time] spreads the reports of all groups
+				if ((s_groups[i].state == IDLE_MEMBER) || (s_groups[i].timer > max_resp_time)) {
 					s_groups[i].state = DELAYING_MEMBER;
-					s_groups[i].timer = 1 + p_igmp->igmp.igmp.max_resp_time / 2;
+					s_groups[i].timer = _random_delay(max_resp_time);
 				}
 			}
 		}
@@ -229,70 +295,117 @@ void igmp_handle(struct t_igmp *p_igmp) {
 
 void igmp_timer(void) {
 	uint32_t i;
-	// TODO optimize ?
+
+	if (s_groups_used == 0) {
+		return;
+	}
+
 	for (i = 0; i < MAX_JOINS_ALLOWED ; i++) {
+		struct t_group_info *p_group = &s_groups[i];
 
-		if ((s_groups[i].state == DELAYING_MEMBER) && (s_groups[i].timer > 0)) {
-			s_groups[i].timer--;
+		if (((p_group->state != DELAYING_MEMBER) && (p_group->state != LEAVING)) || (p_group->timer == 0)) {
+			continue;
+		}
 
-			if (s_groups[i].timer == 0) {
-				_send_report(s_groups[i].group_address);
-				s_groups[i].state = IDLE_MEMBER;
-			}
+		if (--p_group->timer != 0) {
+			continue;
+		}
+
+		if (p_group->state == LEAVING) {
+			_send_leave(p_group->group_address);
+			p_group->group_address = 0;
+			p_group->state = NON_MEMBER;
+			s_groups_used--;
+			continue;
+		}
+
+		_send_report(p_group->group_address);
+
+		if (p_group->reports != 0) {
+			p_group->reports--;
+			p_group->timer = _random_delay(UNSOLICITED_REPORT_INTERVAL);
+		} else {
+			p_group->state = IDLE_MEMBER;
 		}
 	}
 }
 
 // --> Public
 
+/**
+ * @return The table index of the group, -1 for an address that is not multicast,
+ * or -2 when the table is full. The group is then still received, as all multicast is passed,
+ * but no membership reports are sent for it.
+ */
 int igmp_join(uint32_t group_address) {
 	uint32_t i;
+	int free_index = -1;
 
 	if ((group_address& 0xE0) != 0xE0) {
 		return -1;
 	}
 
-	if (s_joins_allowed_index == MAX_JOINS_ALLOWED) {
-		return -2;
-	}
-
-	for (i = 0; i < s_joins_allowed_index; i++) {
-		if (s_groups[i].group_address == group_address) {
+	for (i = 0; i < MAX_JOINS_ALLOWED; i++) {
+		if ((s_groups[i].group_address == group_address) && (s_groups[i].state != NON_MEMBER)) {
+			if (s_groups[i].state == LEAVING) {
+				// Still a member, the leave has not been sent yet
+				s_groups[i].state = IDLE_MEMBER;
+				s_groups[i].timer = 0;
+				_update_filter();
+			}
 			return i;
 		}
+
+		if ((free_index < 0) && (s_groups[i].state == NON_MEMBER)) {
+			free_index = i;
+		}
+	}
+
+	if (free_index < 0) {
+		DEBUG_PRINTF(IPSTR " does not fit, passing all multicast", IP2STR(group_address));
+		s_groups_overflow++;
+		_update_filter();
+		return -2;
 	}
 
-	const int current_index = s_joins_allowed_index;
+	struct t_group_info *p_group = &s_groups[free_index];
 
-	s_groups[s_joins_allowed_index].group_address = group_address;
-	s_groups[s_joins_allowed_index].state = DELAYING_MEMBER;
-	s_groups[s_joins_allowed_index].timer = 2; // TODO
+	p_group->group_address = group_address;
+	p_group->state = DELAYING_MEMBER;
+	p_group->timer = _random_delay(JOIN_DELAY_MAX);
+	p_group->reports = 1;	// The first report, then one repeat
 
-	s_joins_allowed_index++;
+	s_groups_used++;
 
-	_send_report(group_address);
+	_update_filter();
 
-	return current_index;
+	return free_index;
 }
 
 int igmp_leave(uint32_t group_address) {
 	uint32_t i;
 
 	for (i = 0; i < MAX_JOINS_ALLOWED; i++) {
-		if (s_groups[i].group_address == group_address) {
+		if ((s_groups[i].group_address == group_address) && (s_groups[i].state != NON_MEMBER) && (s_groups[i].state != LEAVING)) {
 			break;
 		}
 	}
 
 	if (i == MAX_JOINS_ALLOWED) {
+		if (s_groups_overflow != 0) {
+			// One of the joins that did not fit
+			s_groups_overflow--;
+			_update_filter();
+			return 0;
+		}
 		return -1;
 	}
 
-	_send_leave(s_groups[i].group_address);
+	// Stop receiving now, send the leave a little later so that leaving many groups does not burst
+	s_groups[i].state = LEAVING;
+	s_groups[i].timer = _random_delay(LEAVE_DELAY_MAX);
 
-	s_groups[i].group_address = 0;
-	s_groups[i].state = NON_MEMBER;
-	s_groups[i].timer = 0;
+	_update_filter();
 
 	return 0;
 }
@@ -0,0 +1,328 @@
+/**
+ * @file emac_shim.c
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+#include "net/emac_shim.h"
+#include "device/emac.h"
+
+#include "net_packets.h"
+#include "net_debug.h"
+
+#define PCAP_MAGIC				0xa1b2c3d4
+#define PCAP_MAGIC_NSEC			0xa1b23c4d
+#define PCAP_LINKTYPE_ETHERNET	1
+
+#define RX_DESCR_NUM			32	// As CONFIG_RX_DESCR_NUM in the H3 EMAC driver
+
+struct pcap_file_header {
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+struct pcap_record_header {
+	uint32_t ts_sec;
+	uint32_t ts_frac;
+	uint32_t incl_len;
+	uint32_t orig_len;
+};
+
+struct frame {
+	uint32_t offset;	///< Offset in s_pcap_data
+	uint16_t length;
+};
+
+static uint8_t s_rx_buffer[FRAME_BUFFER_SIZE] __attribute__ ((aligned (4)));
+
+static uint8_t *s_pcap_data;
+static struct frame *s_frames;
+static uint32_t s_frames_count;
+static uint32_t s_frame_index;
+
+static int s_tap_fd = -1;
+
+static struct emac_shim_stats s_stats;
+
+static uint32_t s_multicast_hash[2];
+static bool s_all_multicast = true;
+
+// As the EMAC does in hardware
+static bool is_filtered(const uint8_t *frame) {
+	const struct ether_packet *p_ether = (const struct ether_packet *) frame;
+
+	if (s_all_multicast || ((p_ether->dst[0] & 0x01) == 0) || (memcmp(p_ether->dst, "\xff\xff\xff\xff\xff\xff", ETH_ADDR_LEN) == 0)) {
+		return false;
+	}
+
+	const uint32_t bit = emac_multicast_hash(p_ether->dst);
+
+	return (s_multicast_hash[bit >> 5] & (1U << (bit & 31))) == 0;
+}
+
+static uint32_t get_uint32(uint32_t value, int swap) {
+	return swap ? __builtin_bswap32(value) : value;
+}
+
+int emac_shim_open_pcap(const char *file) {
+	assert(file != 0);
+
+	emac_shim_close();
+
+	FILE *fp = fopen(file, "rb");
+
+	if (fp == NULL) {
+		perror("fopen");
+		return -1;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	const long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	struct pcap_file_header header;
+
+	if ((size < (long) sizeof(header)) || (fread(&header, sizeof(header), 1, fp) != 1)) {
+		fclose(fp);
+		return -1;
+	}
+
+	int swap;
+
+	if ((header.magic == PCAP_MAGIC) || (header.magic == PCAP_MAGIC_NSEC)) {
+		swap = 0;
+	} else if ((header.magic == __builtin_bswap32(PCAP_MAGIC)) || (header.magic == __builtin_bswap32(PCAP_MAGIC_NSEC))) {
+		swap = 1;
+	} else {
+		fprintf(stderr, "%s: not a pcap file\n", file);
+		fclose(fp);
+		return -1;
+	}
+
+	if (get_uint32(header.linktype, swap) != PCAP_LINKTYPE_ETHERNET) {
+		fprintf(stderr, "%s: link type %u is not Ethernet\n", file, get_uint32(header.linktype, swap));
+		fclose(fp);
+		return -1;
+	}
+
+	const uint32_t data_size = (uint32_t) size - sizeof(header);
+
+	s_pcap_data = malloc(data_size);
+	// A record header is 16 bytes, so this is an upper bound for the number of frames
+	s_frames = malloc((data_size / sizeof(struct pcap_record_header) + 1) * sizeof(struct frame));
+
+	if ((s_pcap_data == NULL) || (s_frames == NULL) || (fread(s_pcap_data, 1, data_size, fp) != data_size)) {
+		fclose(fp);
+		emac_shim_close();
+		return -1;
+	}
+
+	fclose(fp);
+
+	uint32_t offset = 0;
+
+	while (offset + sizeof(struct pcap_record_header) <= data_size) {
+		struct pcap_record_header record;
+
+		memcpy(&record, &s_pcap_data[offset], sizeof(record));
+		offset += sizeof(record);
+
+		const uint32_t incl_len = get_uint32(record.incl_len, swap);
+
+		if (offset + incl_len > data_size) {
+			break;
+		}
+
+		// Frames that do not fit in the EMAC buffer are not received on the board either
+		if ((incl_len >= sizeof(struct ether_packet)) && (incl_len <= FRAME_BUFFER_SIZE)) {
+			s_frames[s_frames_count].offset = offset;
+			s_frames[s_frames_count].length = (uint16_t) incl_len;
+			s_frames_count++;
+		}
+
+		offset += incl_len;
+	}
+
+	s_frame_index = 0;
+
+	return (int) s_frames_count;
+}
+
+int emac_shim_open_tap(const char *ifname) {
+	assert(ifname != 0);
+
+	emac_shim_close();
+
+	const int fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+
+	if (fd < 0) {
+		perror("open /dev/net/tun");
+		return -1;
+	}
+
+	struct ifreq ifr;
+
+	memset(&ifr, 0, sizeof(ifr));
+	ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+	strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+
+	if (ioctl(fd, TUNSETIFF, (void *) &ifr) < 0) {
+		perror("ioctl TUNSETIFF");
+		close(fd);
+		return -1;
+	}
+
+	s_tap_fd = fd;
+
+	return 0;
+}
+
+void emac_shim_rewind(void) {
+	s_frame_index = 0;
+}
+
+void emac_shim_close(void) {
+	if (s_tap_fd >= 0) {
+		close(s_tap_fd);
+		s_tap_fd = -1;
+	}
+
+	free(s_pcap_data);
+	s_pcap_data = NULL;
+	free(s_frames);
+	s_frames = NULL;
+
+	s_frames_count = 0;
+	s_frame_index = 0;
+}
+
+void emac_shim_get_stats(struct emac_shim_stats *stats) {
+	assert(stats != 0);
+
+	memcpy(stats, &s_stats, sizeof(struct emac_shim_stats));
+}
+
+/*
+ * The H3 EMAC driver interface
+ */
+
+int emac_eth_recv(uint8_t **packetp) {
+	int length = -1;
+
+	if (s_tap_fd >= 0) {
+		ssize_t n;
+
+		for (;;) {
+			n = read(s_tap_fd, s_rx_buffer, sizeof(s_rx_buffer));
+
+			if (n <= 0) {
+				return -1;
+			}
+
+			if (!is_filtered(s_rx_buffer)) {
+				break;
+			}
+
+			s_stats.rx_filtered++;
+		}
+
+		length = (int) n;
+	} else {
+		while ((s_frame_index != s_frames_count) && is_filtered(&s_pcap_data[s_frames[s_frame_index].offset])) {
+			s_frame_index++;
+			s_stats.rx_filtered++;
+		}
+
+		if (s_frame_index == s_frames_count) {
+			return -1;
+		}
+
+		const struct frame *p_frame = &s_frames[s_frame_index];
+
+		// The stack may modify the frame in place, as it does with the DMA buffer on the board
+		memcpy(s_rx_buffer, &s_pcap_data[p_frame->offset], p_frame->length);
+		length = p_frame->length;
+	}
+
+	s_stats.rx_frames++;
+	s_stats.rx_bytes += (uint64_t) length;
+
+	*packetp = s_rx_buffer;
+
+	return length;
+}
+
+void emac_free_pkt(void) {
+	// A TAP read returns one frame at a time, there is nothing to release
+	if ((s_tap_fd < 0) && (s_frame_index < s_frames_count)) {
+		s_frame_index++;
+	}
+}
+
+void emac_set_multicast_filter(uint32_t hash_high, uint32_t hash_low, bool all_multicast) {
+	s_multicast_hash[1] = hash_high;
+	s_multicast_hash[0] = hash_low;
+	s_all_multicast = all_multicast;
+}
+
+uint32_t emac_rx_pending(void) {
+	if (s_tap_fd >= 0) {
+		return 0;
+	}
+
+	const uint32_t pending = s_frames_count - s_frame_index;
+
+	return pending < RX_DESCR_NUM ? pending : RX_DESCR_NUM;
+}
+
+bool emac_rx_overflowed(void) {
+	return false;
+}
+
+void emac_eth_send(void *packet, int len) {
+	s_stats.tx_frames++;
+	s_stats.tx_bytes += (uint64_t) len;
+
+	if (s_tap_fd >= 0) {
+		if (write(s_tap_fd, packet, (size_t) len) != (ssize_t) len) {
+			DEBUG_PRINTF("write failed: %s", strerror(errno));
+		}
+	}
+}
@@ -25,14 +25,22 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+#include <assert.h>
 
 #include "net/net.h"
 
 #include "net_packets.h"
 #include "net_debug.h"
+#include "net_platform.h"
+
+#define HANDLE_BUDGET_FRAMES	8	// Default maximum number of frames handled per net_handle call
+#define HANDLE_BUDGET_MICROS	0	// Default time slice per net_handle call, 0 is no limit
 
 extern int emac_eth_recv(uint8_t **);
 extern void emac_free_pkt(void);
+extern uint32_t emac_rx_pending(void);
+extern bool emac_rx_overflowed(void);
 
 extern void net_timers_init(void);
 extern void net_timers_run(void);
@@ -48,6 +56,9 @@ extern int dhcp_client(const uint8_t *, struct ip_info  *, const uint8_t *);
 
 static struct ip_info s_ip_info;
 static uint8_t s_mac_address[ETH_ADDR_LEN];
+static uint32_t s_budget_frames = HANDLE_BUDGET_FRAMES;
+static uint32_t s_budget_micros = HANDLE_BUDGET_MICROS;
+static struct net_stats s_stats;
 
 void net_init(const uint8_t *mac_address, struct ip_info *p_ip_info, const uint8_t *hostname, bool use_dhcp) {
 	uint16_t i;
@@ -86,11 +97,19 @@ void net_init(const uint8_t *mac_address, struct ip_info *p_ip_info, const uint8
 }
 
 void net_handle(void) {
-	uint8_t *p;
+	const uint32_t micros_start = net_micros();
+	uint32_t frames = 0;
+	bool is_budget_exhausted = false;
+
+	for (;;) {
+		uint8_t *p;
 
-	const int length = emac_eth_recv(&p);
+		const int length = emac_eth_recv(&p);
+
+		if (length <= 0) {
+			break;
+		}
 
-	if (__builtin_expect((length > 0), 1)) {
 		const struct ether_packet *eth = (struct ether_packet *) p;
 
 		switch (__builtin_bswap16(eth->type)) {
@@ -106,11 +125,63 @@ void net_handle(void) {
 		}
 
 		emac_free_pkt();
+
+		frames++;
+
+		if ((frames == s_budget_frames) || ((s_budget_micros != 0) && ((net_micros() - micros_start) >= s_budget_micros))) {
+			is_budget_exhausted = true;
+			break;
+		}
+	}
+
+	if (frames != 0) {
+		uint32_t pending = frames;
+
+		s_stats.frames += frames;
+
+		if (frames > s_stats.drain_max) {
+			s_stats.drain_max = (uint16_t) frames;
+		}
+
+		if (is_budget_exhausted) {
+			// Only walk the ring when frames are left behind
+			const uint32_t left = emac_rx_pending();
+
+			if (left != 0) {
+				s_stats.budget_exhausted++;
+				pending += left;
+			}
+		}
+
+		if (pending > s_stats.rx_pending_max) {
+			s_stats.rx_pending_max = (uint16_t) pending;
+		}
+
+		if (__builtin_expect(emac_rx_overflowed(), 0)) {
+			s_stats.rx_overflows++;
+		}
 	}
 
 	net_timers_run();
 }
 
+/**
+ * Sets how much work a single net_handle call may do: at most frames frames,
+ * and it stops after micros microseconds when micros is not 0
+ */
+void net_set_handle_budget(uint32_t frames, uint32_t micros) {
+	assert(frames != 0);
+
+	s_budget_frames = frames;
+	s_budget_micros = micros;
+}
+
+void net_get_stats(struct net_stats *stats) {
+	assert(stats != 0);
+
+	memcpy(stats, &s_stats, sizeof(struct net_stats));
+}
+
 void net_set_ip(uint32_t ip) {
 	s_ip_info.ip.addr = ip;
 	arp_init(s_mac_address, &s_ip_info);
@@ -25,28 +25,70 @@
 
 #include <stdint.h>
 
+static inline uint32_t _load32(const uint8_t *p) {
+	uint32_t value;
+	// A single load where unaligned access is allowed, also with -ffreestanding
+	__builtin_memcpy(&value, p, sizeof(uint32_t));
+	return value;
+}
+
+/*
+ * One's complement sum in 32-bit words with a 64-bit accumulator (RFC 1071).
+ * Folding the 32-bit words gives the same result as summing the 16-bit words.
+ */
 uint16_t net_chksum(void *data, uint32_t len) {
-	uint32_t sum;
-	uint16_t *ptr;
+	const uint8_t *ptr = (const uint8_t *) data;
+	uint64_t sum = 0;
 
-	ptr = (uint16_t *) data;
-	sum = 0;
+	while (len >= 16) {
+		sum += _load32(ptr);
+		sum += _load32(ptr + 4);
+		sum += _load32(ptr + 8);
+		sum += _load32(ptr + 12);
+		ptr += 16;
+		len -= 16;
+	}
 
-	while (len > 1) {
-		sum += *ptr;
-		ptr++;
+	while (len >= 4) {
+		sum += _load32(ptr);
+		ptr += 4;
+		len -= 4;
+	}
+
+	if (len >= 2) {
+		uint16_t value;
+		__builtin_memcpy(&value, ptr, sizeof(uint16_t));
+		sum += value;
+		ptr += 2;
 		len -= 2;
 	}
 
 	/* Add left-over byte, if any */
 	if (len > 0) {
-		sum += __builtin_bswap16((*((uint8_t *) ptr) << 8));
+		sum += __builtin_bswap16((*ptr << 8));
 	}
 
-	/* Fold 32-bit sum into 16 bits */
-	while (sum >> 16) {
-		sum = (sum >> 16) + (sum & 0xFFFF);
-	}
+	/* Fold 64-bit sum into 16 bits */
+	sum = (sum >> 32) + (sum & 0xFFFFFFFF);
+	sum = (sum >> 32) + (sum & 0xFFFFFFFF);
+
+	uint32_t sum32 = (uint32_t) sum;
+
+	sum32 = (sum32 >> 16) + (sum32 & 0xFFFF);
+	sum32 = (sum32 >> 16) + (sum32 & 0xFFFF);
+
+	return (uint16_t) ~sum32;
+}
+
+/*
+ * Checksum after a 16-bit field changed from old_value to new_value, RFC 1624 eqn. 3:
+ * HC' = ~(~HC + ~m + m')
+ */
+uint16_t net_chksum_update(uint16_t chksum, uint16_t old_value, uint16_t new_value) {
+	uint32_t sum = (uint32_t) (uint16_t) ~chksum + (uint32_t) (uint16_t) ~old_value + new_value;
+
+	sum = (sum >> 16) + (sum & 0xFFFF);
+	sum = (sum >> 16) + (sum & 0xFFFF);
 
-	return (~sum);
+	return (uint16_t) ~sum;
 }
@@ -25,12 +25,10 @@
 
 #include <stdint.h>
 
-#include "h3.h"
+#include "net_platform.h"
 
 extern void igmp_timer(void);
-#ifndef NDEBUG
- extern void arp_cache_timer(void);
-#endif
+extern void arp_cache_timer(void);
 
 static volatile uint32_t s_ticker;
 
@@ -41,13 +39,11 @@ void net_timers_init(void) {
 }
 
 void net_timers_run(void) {
-	const uint32_t micros_now = H3_TIMER->AVS_CNT1;
+	const uint32_t micros_now = net_micros();
 
 	if (__builtin_expect((micros_now >= s_ticker), 0)) {
 		s_ticker = micros_now + INTERVAL_US;
 		igmp_timer();
-#ifndef NDEBUG
 		arp_cache_timer();
-#endif
 	}
 }
@@ -40,12 +40,13 @@
 #endif
 
 extern void emac_eth_send(void *, int);
-extern uint32_t arp_cache_lookup(uint32_t, uint8_t *);
+extern int arp_cache_send(void *, uint32_t, uint32_t);
 extern uint16_t net_chksum(void *, uint32_t);
+extern uint16_t net_chksum_update(uint16_t, uint16_t, uint16_t);
 
 #define MAX_PORTS_ALLOWED	4
-#define MAX_ENTRIES			(1 << 2) // Must always be a power of 2
-#define MAX_ENTRIES_MASK	(MAX_ENTRIES - 1)
+#define MAX_ENTRIES			24	// Receive queue entries, shared by all ports
+#define DEFAULT_DEPTH		4
 
 struct queue_entry {
 	uint8_t data[FRAME_BUFFER_SIZE];
@@ -55,19 +56,29 @@ struct queue_entry {
 }ALIGNED;
 
 struct queue {
-	uint8_t queue_head;
-	uint8_t queue_tail;
-	struct queue_entry entries[MAX_ENTRIES] ALIGNED;
+	struct queue_entry *entries;
+	uint32_t received;
+	uint32_t dropped;
+	uint16_t depth;
+	uint16_t queue_head;
+	uint16_t queue_tail;
+	uint16_t count;
+	uint16_t high_water;
+	uint8_t policy;
+	bool borrowed;
 }ALIGNED;
 
 typedef union pcast32 {
 	uint32_t u32;
+	uint16_t u16[2];
 	uint8_t u8[4];
 } _pcast32;
 
 static uint16_t s_ports_allowed[MAX_PORTS_ALLOWED] ALIGNED;
 static uint8_t s_ports_used_index ALIGNED;
 static struct queue s_recv_queue[MAX_PORTS_ALLOWED] ALIGNED;
+static struct queue_entry s_queue_entries[MAX_ENTRIES] ALIGNED;
+static uint32_t s_queue_entries_used;
 static struct t_udp s_send_packet ALIGNED;
 static uint16_t s_id ALIGNED;
 
@@ -76,6 +87,39 @@ void udp_set_ip(const struct ip_info *p_ip_info) {
 
 	src.u32 = p_ip_info->ip.addr;
 	memcpy(s_send_packet.ip4.src, src.u8, IPv4_ADDR_LEN);
+
+	// The starting point for the incremental updates in _set_ip4_header
+	s_send_packet.ip4.chksum = 0;
+	s_send_packet.ip4.chksum = net_chksum((void *)&s_send_packet.ip4, (uint32_t)sizeof(s_send_packet.ip4));
+}
+
+/*
+ * Only the id, the length and the destination differ between datagrams,
+ * so the header checksum is updated (RFC 1624) instead of recomputed.
+ */
+static void _set_ip4_header(uint16_t id, uint16_t len, uint32_t to_ip) {
+	uint16_t chksum = s_send_packet.ip4.chksum;
+	_pcast32 dst_old;
+	_pcast32 dst_new;
+
+	chksum = net_chksum_update(chksum, s_send_packet.ip4.id, id);
+	s_send_packet.ip4.id = id;
+
+	if (s_send_packet.ip4.len != len) {
+		chksum = net_chksum_update(chksum, s_send_packet.ip4.len, len);
+		s_send_packet.ip4.len = len;
+	}
+
+	memcpy(dst_old.u8, s_send_packet.ip4.dst, IPv4_ADDR_LEN);
+	dst_new.u32 = to_ip;
+
+	if (dst_old.u32 != dst_new.u32) {
+		chksum = net_chksum_update(chksum, dst_old.u16[0], dst_new.u16[0]);
+		chksum = net_chksum_update(chksum, dst_old.u16[1], dst_new.u16[1]);
+		memcpy(s_send_packet.ip4.dst, dst_new.u8, IPv4_ADDR_LEN);
+	}
+
+	s_send_packet.ip4.chksum = chksum;
 }
 
 void udp_init(const uint8_t *mac_address, const struct ip_info  *p_ip_info) {
@@ -83,11 +127,11 @@ void udp_init(const uint8_t *mac_address, const struct ip_info  *p_ip_info) {
 
 	for (i = 0; i < MAX_PORTS_ALLOWED; i++) {
 		s_ports_allowed[i] = 0;
-		s_recv_queue[i].queue_head = 0;
-		s_recv_queue[i].queue_tail = 0;
+		memset(&s_recv_queue[i], 0, sizeof(struct queue));
 	}
 
 	s_ports_used_index = 0;
+	s_queue_entries_used = 0;
 	s_id = 0;
 
 	// Ethernet
@@ -104,10 +148,14 @@ void udp_init(const uint8_t *mac_address, const struct ip_info  *p_ip_info) {
 	s_send_packet.udp.checksum = 0;
 }
 
+static inline uint16_t next_index(const struct queue *p_queue, uint16_t index) {
+	index++;
+	return (index == p_queue->depth) ? 0 : index;
+}
+
 void udp_handle(struct t_udp *p_udp) {
 	uint32_t port_index;
 	_pcast32 src;
-	uint32_t i;
 
 	const uint16_t dest_port = __builtin_bswap16(p_udp->udp.destination_port);
 
@@ -129,43 +177,95 @@ void udp_handle(struct t_udp *p_udp) {
 		return;
 	}
 
-	const uint8_t entry = s_recv_queue[port_index].queue_tail;
-	struct queue_entry *p_queue_entry = &s_recv_queue[port_index].entries[entry];
+	struct queue *p_queue = &s_recv_queue[port_index];
+
+	uint32_t size = (uint32_t) __builtin_bswap16(p_udp->udp.len);
 
-	for (i = 0; (i < 2048) && (i < __builtin_bswap16(p_udp->udp.len)); i++) {
-		p_queue_entry->data[i] = p_udp->udp.data[i];
+	if (size < UDP_HEADER_SIZE) {
+		return;
 	}
 
+	size -= UDP_HEADER_SIZE;
+
+	p_queue->received++;
+
+	if (p_queue->count == p_queue->depth) {
+		p_queue->dropped++;
+
+		// The oldest entry cannot be dropped while it is borrowed by udp_recv_ref
+		if ((p_queue->policy == UDP_QUEUE_DROP_NEWEST) || p_queue->borrowed) {
+			DEBUG_PRINTF("Queue full, port:%d", dest_port);
+			return;
+		}
+
+		p_queue->queue_tail = next_index(p_queue, p_queue->queue_tail);
+		p_queue->count--;
+	}
+
+	struct queue_entry *p_queue_entry = &p_queue->entries[p_queue->queue_head];
+
+	if (size > sizeof(p_queue_entry->data)) {
+		size = sizeof(p_queue_entry->data);
+	}
+
+	memcpy(p_queue_entry->data, p_udp->udp.data, size);
+
 	memcpy(src.u8, p_udp->ip4.src, IPv4_ADDR_LEN);
 	p_queue_entry->from_ip = src.u32;
 	p_queue_entry->from_port = __builtin_bswap16(p_udp->udp.source_port);
-	p_queue_entry->size = i;
+	p_queue_entry->size = (uint16_t) size;
 
-	s_recv_queue[port_index].queue_head = (s_recv_queue[port_index].queue_head + 1) & MAX_ENTRIES_MASK;
+	p_queue->queue_head = next_index(p_queue, p_queue->queue_head);
+	p_queue->count++;
+
+	if (p_queue->count > p_queue->high_water) {
+		p_queue->high_water = p_queue->count;
+	}
 }
 
 // -->
 
-int udp_bind(uint16_t local_port) {
+/**
+ * Binds local_port with a receive queue of depth entries, taken from a pool shared by all ports.
+ * Fails with -1 when the pool has fewer than depth entries left.
+ * When the queue is full, policy selects whether the new or the oldest datagram is dropped.
+ */
+int udp_bind_queue(uint16_t local_port, uint16_t depth, udp_queue_policy_t policy) {
 	uint32_t i;
 
-	if (s_ports_used_index == MAX_PORTS_ALLOWED) {
-		return -1;
-	}
-
 	for (i = 0; i < s_ports_used_index; i++) {
 		if (s_ports_allowed[i] == local_port) {
 			return i;
 		}
 	}
 
+	if (s_ports_used_index == MAX_PORTS_ALLOWED) {
+		return -1;
+	}
+
+	if ((depth == 0) || (depth > (MAX_ENTRIES - s_queue_entries_used))) {
+		DEBUG_PRINTF("%d queue entries left, port:%d depth:%d", MAX_ENTRIES - s_queue_entries_used, local_port, depth);
+		return -1;
+	}
+
 	const int current_index = s_ports_used_index;
+	struct queue *p_queue = &s_recv_queue[current_index];
 
+	memset(p_queue, 0, sizeof(struct queue));
+	p_queue->entries = &s_queue_entries[s_queue_entries_used];
+	p_queue->depth = depth;
+	p_queue->policy = (uint8_t) policy;
+
+	s_queue_entries_used += depth;
 	s_ports_allowed[s_ports_used_index++] = local_port;
 
 	return current_index;
 }
 
+int udp_bind(uint16_t local_port) {
+	return udp_bind_queue(local_port, DEFAULT_DEPTH, UDP_QUEUE_DROP_NEWEST);
+}
+
 int udp_unbind(uint16_t local_port) {
 	DEBUG_PRINTF("s_ports_allowed_index=%d, local_port=%d", s_ports_used_index, local_port);
 
@@ -176,9 +276,11 @@ int udp_unbind(uint16_t local_port) {
 	DEBUG_PRINTF("s_ports_allowed[s_ports_allowed_index - 1]=%d", s_ports_allowed[s_ports_used_index - 1]);
 
 	if ((s_ports_allowed[s_ports_used_index - 1]) == local_port) {
+		struct queue *p_queue = &s_recv_queue[s_ports_used_index - 1];
+
 		s_ports_allowed[s_ports_used_index - 1] = 0;
-		s_recv_queue[s_ports_used_index - 1].queue_head = 0;
-		s_recv_queue[s_ports_used_index - 1].queue_tail = 0;
+		s_queue_entries_used -= p_queue->depth;
+		memset(p_queue, 0, sizeof(struct queue));
 		s_ports_used_index--;
 		return 0;
 	}
@@ -186,37 +288,81 @@ int udp_unbind(uint16_t local_port) {
 	return -2; // TODO implement udp_unbind
 }
 
-uint16_t udp_recv(uint8_t idx, uint8_t *packet, uint16_t size, uint32_t *from_ip, uint16_t *from_port) {
+void udp_get_queue_stats(uint8_t idx, struct udp_queue_stats *stats) {
+	assert(idx < MAX_PORTS_ALLOWED);
+	assert(stats != 0);
+
+	stats->received = s_recv_queue[idx].received;
+	stats->dropped = s_recv_queue[idx].dropped;
+	stats->high_water = s_recv_queue[idx].high_water;
+	stats->depth = s_recv_queue[idx].depth;
+}
+
+/**
+ * Borrows the oldest datagram in the queue, without copying it.
+ * The data stays valid, and may be modified in place, until udp_release is called.
+ * Calling udp_recv_ref again before udp_release returns the same datagram.
+ */
+uint16_t udp_recv_ref(uint8_t idx, uint8_t **packet, uint32_t *from_ip, uint16_t *from_port) {
 	assert(idx < MAX_PORTS_ALLOWED);
 
-	if (s_recv_queue[idx].queue_head == s_recv_queue[idx].queue_tail) {
+	struct queue *p_queue = &s_recv_queue[idx];
+
+	if (p_queue->count == 0) {
 		return 0;
 	}
 
-	const uint8_t entry = s_recv_queue[idx].queue_tail;
-	struct queue_entry *p_queue_entry = &s_recv_queue[idx].entries[entry];
-
-	uint32_t i;
+	struct queue_entry *p_queue_entry = &p_queue->entries[p_queue->queue_tail];
 
-	for (i = 0; (i < size) && (i < p_queue_entry->size); i ++) {
-		packet[i] = p_queue_entry->data[i];
- 	}
+	p_queue->borrowed = true;
 
+	*packet = p_queue_entry->data;
 	*from_ip = p_queue_entry->from_ip;
 	*from_port = p_queue_entry->from_port;
 
-	s_recv_queue[idx].queue_tail = (s_recv_queue[idx].queue_tail + 1) & MAX_ENTRIES_MASK;
+	DEBUG_PRINTF("%d " IPSTR, p_queue_entry->size, IP2STR(*from_ip));
+
+	return p_queue_entry->size;
+}
+
+void udp_release(uint8_t idx) {
+	assert(idx < MAX_PORTS_ALLOWED);
+
+	struct queue *p_queue = &s_recv_queue[idx];
+
+	if (p_queue->count != 0) {
+		p_queue->queue_tail = next_index(p_queue, p_queue->queue_tail);
+		p_queue->count--;
+	}
+
+	p_queue->borrowed = false;
+}
+
+uint16_t udp_recv(uint8_t idx, uint8_t *packet, uint16_t size, uint32_t *from_ip, uint16_t *from_port) {
+	uint8_t *data;
+
+	uint16_t length = udp_recv_ref(idx, &data, from_ip, from_port);
+
+	if (length == 0) {
+		return 0;
+	}
+
+	if (length > size) {
+		length = size;
+	}
+
+	memcpy(packet, data, length);
 
-	DEBUG_PRINTF("%d " IPSTR, i, IP2STR(*from_ip));
+	udp_release(idx);
 
-	return i;
+	return length;
 }
 
 int udp_send(uint8_t idx, const uint8_t *packet, uint16_t size, uint32_t to_ip, uint16_t remote_port) {
 	assert(idx < MAX_PORTS_ALLOWED);
 
-	_pcast32 dst;
 	uint32_t i;
+	bool is_unicast = false;
 
 	if (s_ports_allowed[idx] == 0) {
 		DEBUG_PUTS("ports_allowed[idx] == 0");
@@ -225,28 +371,15 @@ int udp_send(uint8_t idx, const uint8_t *packet, uint16_t size, uint32_t to_ip,
 
 	DEBUG_PRINTF("%d %p " IPSTR, size, to_ip, IP2STR(to_ip));
 
-	if (to_ip == IPv4_BROADCAST) {
+	if ((to_ip == IPv4_BROADCAST) || ((to_ip & 0xff000000) == 0xff000000)) {
 		memset(s_send_packet.ether.dst, 0xFF, ETH_ADDR_LEN);
-		memset(s_send_packet.ip4.dst, 0xFF, IPv4_ADDR_LEN);
-	} else if ((to_ip & 0xff000000) == 0xff000000) {
-		memset(s_send_packet.ether.dst, 0xFF, ETH_ADDR_LEN);
-		dst.u32 = to_ip;
-		memcpy(s_send_packet.ip4.dst, dst.u8, IPv4_ADDR_LEN);
 	} else {
-		if (to_ip == arp_cache_lookup(to_ip, s_send_packet.ether.dst)) {
-			dst.u32 = to_ip;
-			memcpy(s_send_packet.ip4.dst, dst.u8, IPv4_ADDR_LEN);
-		} else {
-			DEBUG_PUTS("ARP lookup failed");
-			return -2;
-		}
+		// The Ethernet destination is filled in by arp_cache_send
+		is_unicast = true;
 	}
 
 	//IPv4
-	s_send_packet.ip4.id = s_id;
-	s_send_packet.ip4.len = __builtin_bswap16(size + IPv4_UDP_HEADERS_SIZE);
-	s_send_packet.ip4.chksum = 0;
-	s_send_packet.ip4.chksum = net_chksum((void *)&s_send_packet.ip4, (uint32_t)sizeof(s_send_packet.ip4));
+	_set_ip4_header(s_id, __builtin_bswap16(size + IPv4_UDP_HEADERS_SIZE), to_ip);
 
 	//UDP
 	s_send_packet.udp.source_port = __builtin_bswap16(s_ports_allowed[idx]);
@@ -259,7 +392,15 @@ int udp_send(uint8_t idx, const uint8_t *packet, uint16_t size, uint32_t to_ip,
 
 	debug_dump((void *)&s_send_packet, size + UDP_PACKET_HEADERS_SIZE);
 
-	emac_eth_send((void *)&s_send_packet, size + UDP_PACKET_HEADERS_SIZE);
+	if (is_unicast) {
+		// When the MAC address is not known yet, the datagram is sent once the ARP reply is in
+		if (arp_cache_send((void *)&s_send_packet, size + UDP_PACKET_HEADERS_SIZE, to_ip) < 0) {
+			DEBUG_PUTS("ARP lookup failed");
+			return -2;
+		}
+	} else {
+		emac_eth_send((void *)&s_send_packet, size + UDP_PACKET_HEADERS_SIZE);
+	}
 
 	s_id++;
 
@@ -31,6 +31,8 @@
 
 #ifdef __cplusplus
 
+#include "reboothandler.h"
+
 enum THardwareLedStatus {
 	HARDWARE_LED_OFF = 0,
 	HARDWARE_LED_ON,
@@ -92,11 +94,18 @@ public:
 
 	virtual const char* GetWebsiteUrl(void);
 
+	inline void SetRebootHandler(RebootHandler *pRebootHandler) {
+		m_pRebootHandler = pRebootHandler;
+	}
+
 public:
 	inline static Hardware* Get(void) {
 		return s_pThis;
 	}
 
+protected:
+	RebootHandler *m_pRebootHandler;
+
 private:
 	static Hardware *s_pThis;
 };
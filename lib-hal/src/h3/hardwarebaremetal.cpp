@@ -172,6 +172,10 @@ void HardwareBaremetal::SetLed(THardwareLedStatus tLedStatus) {
 }
 
 bool HardwareBaremetal::Reboot(void) {
+	if (m_pRebootHandler != 0) {
+		m_pRebootHandler->Run();
+	}
+
 	hardware_led_set(1);
 
 	h3_watchdog_enable();
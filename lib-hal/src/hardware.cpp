@@ -27,7 +27,7 @@
 
 Hardware *Hardware::s_pThis = 0;
 
-Hardware::Hardware(void) {
+Hardware::Hardware(void): m_pRebootHandler(0) {
 	s_pThis = this;
 }
 
@@ -247,6 +247,10 @@ bool HardwareLinux::Reboot(void) {
 	return false;
 #else
 	if(geteuid() == 0) {
+		if (m_pRebootHandler != 0) {
+			m_pRebootHandler->Run();
+		}
+
 		sync();
 
 		if (reboot(RB_AUTOBOOT) == 0) {
@@ -168,6 +168,10 @@ void HardwareBaremetal::SetLed(THardwareLedStatus tLedStatus) {
 }
 
 bool HardwareBaremetal::Reboot(void) {
+	if (m_pRebootHandler != 0) {
+		m_pRebootHandler->Run();
+	}
+
 	hardware_led_set(1);
 
 	bcm2835_watchdog_init();
@@ -0,0 +1,166 @@
+/**
+ * @file chain_bench.cpp
+ *
+ * Daisy chain traffic of AutoDriver on the simulated SPI bus, per byte and batched.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "autodriver.h"
+
+#include "linux/l6470simulation.h"
+
+#define BOARDS		8
+#define UPDATES		100
+
+static void update(AutoDriver **pMotors, int nUpdate) {
+	for (int i = 0; i < BOARDS; i++) {
+		switch ((nUpdate + i) % 3) {
+		case 0:
+			pMotors[i]->run(L6470_DIR_FWD, 100.0f + nUpdate * 10 + i);
+			break;
+		case 1:
+			pMotors[i]->goToDir(L6470_DIR_REV, 1000 * nUpdate + i);
+			break;
+		default:
+			pMotors[i]->softStop();
+			pMotors[i]->move(L6470_DIR_FWD, 50 + i);
+			break;
+		}
+	}
+}
+
+// As SparkFunDmx in mode 3: the new position is relative to the current one
+static void update_relative(AutoDriver **pMotors, int nUpdate) {
+	for (int i = 0; i < BOARDS; i++) {
+		const long nPosition = pMotors[i]->getPos();
+		pMotors[i]->goToDir(L6470_DIR_FWD, nPosition + nUpdate + i);
+	}
+}
+
+static void run(AutoDriver **pMotors, void (*pUpdate)(AutoDriver **, int), bool IsBatched, struct TL6470SimulationStats *pStats, uint32_t *pHash) {
+	L6470Simulation::SetBoards(BCM2835_SPI_CS0, BOARDS);
+	L6470Simulation::ResetStats();
+
+	for (int nUpdate = 0; nUpdate < UPDATES; nUpdate++) {
+		if (IsBatched) {
+			AutoDriver::BeginBatch();
+		}
+
+		pUpdate(pMotors, nUpdate);
+
+		if (IsBatched) {
+			AutoDriver::EndBatch();
+		}
+	}
+
+	L6470Simulation::GetStats(pStats);
+
+	for (int i = 0; i < BOARDS; i++) {
+		pHash[i] = L6470Simulation::GetCommandHash(BCM2835_SPI_CS0, i);
+	}
+}
+
+// A TLC59711 in the same LightSet chain sets its own chip select, clock and mode for every update
+static void other_spi_device(void) {
+	bcm2835_spi_chipSelect(BCM2835_SPI_CS_NONE);
+	bcm2835_spi_setClockDivider(8);
+	bcm2835_spi_setDataMode(BCM2835_SPI_MODE0);
+}
+
+static int test_other_spi_device(AutoDriver **pMotors) {
+	struct TL6470SimulationStats Stats;
+
+	L6470Simulation::ResetStats();
+
+	for (int nUpdate = 0; nUpdate < UPDATES; nUpdate++) {
+		AutoDriver::BeginBatch();
+		update(pMotors, nUpdate);
+		AutoDriver::EndBatch();
+
+		other_spi_device();
+		update_relative(pMotors, nUpdate);
+		other_spi_device();
+	}
+
+	L6470Simulation::GetStats(&Stats);
+
+	if (Stats.nLost != 0) {
+		printf("FAIL: %u frames were sent with the SPI set-up of another device\n", Stats.nLost);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	AutoDriver *pMotors[BOARDS];
+	int nErrors = 0;
+
+	L6470Simulation::SetBoards(BCM2835_SPI_CS0, BOARDS);
+
+	for (int i = 0; i < BOARDS; i++) {
+		pMotors[i] = new AutoDriver(i, BCM2835_SPI_CS0, 0);
+
+		if (!pMotors[i]->IsConnected()) {
+			printf("FAIL: board %d is not connected\n", i);
+			nErrors++;
+		}
+	}
+
+	const char *pName[2] = { "run/goToDir/softStop+move", "getPos + goToDir (mode 3)" };
+	void (*pUpdate[2])(AutoDriver **, int) = { update, update_relative };
+
+	printf("%d boards on one chip select, %d updates\n", BOARDS, UPDATES);
+
+	for (int nTest = 0; nTest < 2; nTest++) {
+		struct TL6470SimulationStats Stats[2];
+		uint32_t nHash[2][BOARDS];
+
+		run(pMotors, pUpdate[nTest], false, &Stats[0], nHash[0]);
+		run(pMotors, pUpdate[nTest], true, &Stats[1], nHash[1]);
+
+		printf("%-26s per byte: %5u frames %6u bytes %5u set-up | batched: %5u frames %6u bytes %5u set-up\n", pName[nTest],
+				Stats[0].nTransfers, Stats[0].nBytes, Stats[0].nSetup,
+				Stats[1].nTransfers, Stats[1].nBytes, Stats[1].nSetup);
+
+		for (int i = 0; i < BOARDS; i++) {
+			if (nHash[0][i] != nHash[1][i]) {
+				printf("FAIL: %s: board %d received another command stream when batched\n", pName[nTest], i);
+				nErrors++;
+			}
+		}
+	}
+
+	nErrors += test_other_spi_device(pMotors);
+
+	for (int i = 0; i < BOARDS; i++) {
+		delete pMotors[i];
+	}
+
+	printf("chain_bench: %d errors\n", nErrors);
+
+	return (nErrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -33,6 +33,16 @@
 
 #include "l6470.h"
 
+#define AUTODRIVER_CHAIN_MAX_BOARDS	8
+#define AUTODRIVER_CHAIN_QUEUE_SIZE	16	///< Pending bytes per board, a full queue sends the chain
+
+struct TAutoDriverChain {
+	uint8_t Queue[AUTODRIVER_CHAIN_MAX_BOARDS][AUTODRIVER_CHAIN_QUEUE_SIZE];
+	uint8_t nHead[AUTODRIVER_CHAIN_MAX_BOARDS];		///< Next byte to send
+	uint8_t nLength[AUTODRIVER_CHAIN_MAX_BOARDS];
+	uint8_t nReadDepth;		///< A read is in progress, bypass the queue
+};
+
 class AutoDriver: public L6470 {
 public:
 	AutoDriver(uint8_t, uint8_t, uint8_t, uint8_t);
@@ -42,8 +52,22 @@ public:
 
 	int busyCheck(void);
 
+	/**
+	 * Between BeginBatch and EndBatch the command bytes for all motors are
+	 * collected per daisy chain. EndBatch clocks them out together, one chain
+	 * frame per byte position, with NOPs for the motors that have less to send.
+	 */
+	static void BeginBatch(void);
+	static void EndBatch(void);
+
 private:
 	uint8_t SPIXfer(uint8_t);
+	void SPIReadBegin(void);
+	void SPIReadEnd(void);
+
+	static void SetupSpi(uint8_t nSpiChipSelect);
+	static void Flush(uint8_t nSpiChipSelect);
+	static void Transfer(uint8_t nSpiChipSelect, char *pFrame, int nPosition);
 
 	/*
 	 * Additional methods
@@ -83,6 +107,9 @@ private:
 	bool m_bIsBusy;
 	static uint8_t m_nNumBoards[2];
 	bool m_bIsConnected;
+
+	static struct TAutoDriverChain s_Chain[2];
+	static bool s_IsBatch;
 };
 
 #endif /* AUTODRIVER_H_ */
@@ -197,6 +197,12 @@ public:
 
 private:
 	virtual uint8_t SPIXfer(uint8_t)=0;
+	/**
+	 * A read needs the response right away. A driver that batches the
+	 * transfers sends the pending bytes in SPIReadBegin.
+	 */
+	virtual void SPIReadBegin(void);
+	virtual void SPIReadEnd(void);
 
 private:
 	long paramHandler(uint8_t, unsigned long);
@@ -0,0 +1,87 @@
+/**
+ * @file l6470simulation.h
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LINUX_L6470SIMULATION_H_
+#define LINUX_L6470SIMULATION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The subset of the bcm2835 SPI and GPIO API used by AutoDriver
+ */
+#define BCM2835_SPI_CS0					0
+#define BCM2835_SPI_CS1					1
+#define BCM2835_SPI_CS_NONE				3
+#define BCM2835_SPI_CLOCK_DIVIDER_64	64
+#define BCM2835_SPI_MODE0				0
+#define BCM2835_SPI_MODE3				3
+
+#ifndef HIGH
+ #define HIGH	0x1
+#endif
+#ifndef LOW
+ #define LOW	0x0
+#endif
+
+extern void bcm2835_spi_chipSelect(uint8_t);
+extern void bcm2835_spi_setClockDivider(uint16_t);
+extern void bcm2835_spi_setDataMode(uint8_t);
+extern void bcm2835_spi_transfern(char *, uint32_t);
+extern uint8_t bcm2835_gpio_lev(uint8_t);
+
+struct TL6470SimulationStats {
+	uint32_t nSetup;		///< chipSelect, setClockDivider and setDataMode calls
+	uint32_t nTransfers;	///< Chain frames, one chip select assertion each
+	uint32_t nBytes;		///< Bytes clocked out on the bus
+	uint32_t nLost;			///< Frames sent without the L6470 chip select or SPI mode
+};
+
+/**
+ * The daisy chains of simulated L6470 devices behind the two SPI chip selects.
+ * Each device decodes its byte stream as a real L6470 does.
+ */
+class L6470Simulation {
+public:
+	static void SetBoards(uint8_t nSpiChipSelect, uint8_t nCount);
+	/**
+	 * The device reports BUSY in its STATUS register until it is cleared again
+	 */
+	static void SetBusy(uint8_t nSpiChipSelect, uint8_t nPosition, bool IsBusy);
+
+	/**
+	 * @return The number of complete commands the device has received, NOPs excluded
+	 */
+	static uint32_t GetCommands(uint8_t nSpiChipSelect, uint8_t nPosition);
+	/**
+	 * @return A hash over the complete commands and their arguments, in the order of arrival
+	 */
+	static uint32_t GetCommandHash(uint8_t nSpiChipSelect, uint8_t nPosition);
+
+	static void GetStats(struct TL6470SimulationStats *pStats);
+	static void ResetStats(void);
+};
+
+#endif /* LINUX_L6470SIMULATION_H_ */
@@ -27,14 +27,17 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
 
-#include "bcm2835.h"
-
-#if defined(__linux__)
+#if defined(__linux__) && !defined(RASPPI)
+ #include "linux/l6470simulation.h"
 #else
- #include "bcm2835_gpio.h"
- #include "bcm2835_spi.h"
+ #include "bcm2835.h"
+ #if !defined(__linux__)
+  #include "bcm2835_gpio.h"
+  #include "bcm2835_spi.h"
+ #endif
 #endif
 
 #include "autodriver.h"
@@ -45,8 +48,12 @@
 
 uint8_t AutoDriver::m_nNumBoards[2];
 
+struct TAutoDriverChain AutoDriver::s_Chain[2];
+bool AutoDriver::s_IsBatch = false;
+
 AutoDriver::AutoDriver(uint8_t nPosition, uint8_t nSpiChipSelect, uint8_t nResetPin, uint8_t nBusyPin) : m_bIsBusy(false), m_bIsConnected(false) {
 	assert(nSpiChipSelect <= BCM2835_SPI_CS1);
+	assert(nPosition < AUTODRIVER_CHAIN_MAX_BOARDS);
 	assert(nResetPin <= 31);
 	assert(nBusyPin <= 31);
 
@@ -63,6 +70,7 @@ AutoDriver::AutoDriver(uint8_t nPosition, uint8_t nSpiChipSelect, uint8_t nReset
 
 AutoDriver::AutoDriver(uint8_t nPosition, uint8_t nSpiChipSelect, uint8_t nResetPin) : m_bIsBusy(false), m_bIsConnected(false) {
 	assert(nSpiChipSelect <= BCM2835_SPI_CS1);
+	assert(nPosition < AUTODRIVER_CHAIN_MAX_BOARDS);
 	assert(nResetPin <= 31);
 
 	m_nSpiChipSelect = nSpiChipSelect;
@@ -109,21 +117,121 @@ int AutoDriver::busyCheck(void) {
 	}
 }
 
-uint8_t AutoDriver::SPIXfer(uint8_t data) {
-	uint8_t dataPacket[m_nNumBoards[m_nSpiChipSelect]];
+void AutoDriver::BeginBatch(void) {
+	s_IsBatch = true;
+}
 
-	for (int i = 0; i < m_nNumBoards[m_nSpiChipSelect]; i++) {
-		dataPacket[i] = 0;
-	}
+void AutoDriver::EndBatch(void) {
+	s_IsBatch = false;
 
-	dataPacket[m_nPosition] = data;
+	Flush(BCM2835_SPI_CS0);
+	Flush(BCM2835_SPI_CS1);
+}
 
-	bcm2835_spi_chipSelect(m_nSpiChipSelect);
+/**
+ * Other SPI devices, such as a TLC59711 in the same LightSet chain, change the
+ * chip select, clock and mode between our transfers. So the set-up is done
+ * for every non-batched transfer, and once for all frames of a flush or a read.
+ */
+void AutoDriver::SetupSpi(uint8_t nSpiChipSelect) {
+	bcm2835_spi_chipSelect(nSpiChipSelect);
 	bcm2835_spi_setClockDivider(BCM2835_SPI_CLOCK_DIVIDER_64);
 	bcm2835_spi_setDataMode(BCM2835_SPI_MODE3);
-	bcm2835_spi_transfern((char *) dataPacket, m_nNumBoards[m_nSpiChipSelect]);
+}
+
+/**
+ * Sends one chain frame, the SPI must be set up for the chain. The frame holds the byte for nPosition, the other
+ * boards get their next pending byte or a NOP.
+ * @param nPosition -1 when the frame only carries pending bytes
+ */
+void AutoDriver::Transfer(uint8_t nSpiChipSelect, char *pFrame, int nPosition) {
+	struct TAutoDriverChain *pChain = &s_Chain[nSpiChipSelect];
+	const uint8_t nBoards = m_nNumBoards[nSpiChipSelect];
+
+	for (int i = 0; i < (int) nBoards; i++) {
+		if (i == nPosition) {
+			continue;
+		}
+
+		if (pChain->nHead[i] < pChain->nLength[i]) {
+			pFrame[i] = (char) pChain->Queue[i][pChain->nHead[i]++];
+		} else {
+			pFrame[i] = (char) L6470_CMD_NOP;
+		}
+	}
+
+	bcm2835_spi_transfern(pFrame, nBoards);
+}
+
+void AutoDriver::Flush(uint8_t nSpiChipSelect) {
+	struct TAutoDriverChain *pChain = &s_Chain[nSpiChipSelect];
+	const uint8_t nBoards = m_nNumBoards[nSpiChipSelect];
+	uint8_t nFrames = 0;
+
+	for (uint32_t i = 0; i < nBoards; i++) {
+		if ((pChain->nLength[i] - pChain->nHead[i]) > nFrames) {
+			nFrames = pChain->nLength[i] - pChain->nHead[i];
+		}
+	}
+
+	char frame[AUTODRIVER_CHAIN_MAX_BOARDS];
+
+	if (nFrames != 0) {
+		SetupSpi(nSpiChipSelect);
+	}
+
+	while (nFrames-- != 0) {
+		Transfer(nSpiChipSelect, frame, -1);
+	}
+
+	memset(pChain->nHead, 0, sizeof(pChain->nHead));
+	memset(pChain->nLength, 0, sizeof(pChain->nLength));
+}
+
+void AutoDriver::SPIReadBegin(void) {
+	struct TAutoDriverChain *pChain = &s_Chain[m_nSpiChipSelect];
+	char frame[AUTODRIVER_CHAIN_MAX_BOARDS];
+
+	// Only the bytes pending for this board must go first, the other boards
+	// keep theirs for the frames of the read. The set-up holds for the whole read.
+	SetupSpi(m_nSpiChipSelect);
+
+	while (pChain->nHead[m_nPosition] < pChain->nLength[m_nPosition]) {
+		Transfer(m_nSpiChipSelect, frame, -1);
+	}
+
+	pChain->nReadDepth++;
+}
+
+void AutoDriver::SPIReadEnd(void) {
+	assert(s_Chain[m_nSpiChipSelect].nReadDepth != 0);
+	s_Chain[m_nSpiChipSelect].nReadDepth--;
+}
+
+uint8_t AutoDriver::SPIXfer(uint8_t data) {
+	struct TAutoDriverChain *pChain = &s_Chain[m_nSpiChipSelect];
+
+	if (s_IsBatch && (pChain->nReadDepth == 0)) {
+		if (pChain->nLength[m_nPosition] == AUTODRIVER_CHAIN_QUEUE_SIZE) {
+			Flush(m_nSpiChipSelect);
+		}
+
+		pChain->Queue[m_nPosition][pChain->nLength[m_nPosition]++] = data;
+
+		return 0;
+	}
+
+	char frame[AUTODRIVER_CHAIN_MAX_BOARDS];
+
+	frame[m_nPosition] = (char) data;
+
+	if (pChain->nReadDepth == 0) {
+		SetupSpi(m_nSpiChipSelect);
+	}
+
+	Transfer(m_nSpiChipSelect, frame, m_nPosition);
 
-	return dataPacket[m_nPosition];
+	return (uint8_t) frame[m_nPosition];
 }
 
 /*
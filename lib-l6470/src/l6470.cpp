@@ -29,6 +29,12 @@
 L6470::~L6470(void) {
 }
 
+void L6470::SPIReadBegin(void) {
+}
+
+void L6470::SPIReadEnd(void) {
+}
+
 void L6470::setMicroSteps(unsigned int nMicroSteps) {
 	hardHiZ();
 
@@ -37,9 +37,14 @@ void L6470::setParam(TL6470ParamRegisters param, unsigned long value) {
 }
 
 long L6470::getParam(TL6470ParamRegisters param) {
+	SPIReadBegin();
+
 	SPIXfer((uint8_t) param | L6470_CMD_GET_PARAM);
+	const long value = paramHandler(param, 0);
+
+	SPIReadEnd();
 
-	return paramHandler(param, 0);
+	return value;
 }
 
 long L6470::getPos() {
@@ -183,8 +188,10 @@ void L6470::hardHiZ() {
 int L6470::getStatus() {
 	int temp = 0;
 	uint8_t *bytePointer = (uint8_t *) &temp;
+	SPIReadBegin();
 	SPIXfer(L6470_CMD_GET_STATUS);
 	bytePointer[1] = SPIXfer(0);
 	bytePointer[0] = SPIXfer(0);
+	SPIReadEnd();
 	return temp;
 }
@@ -0,0 +1,294 @@
+/**
+ * @file l6470simulation.cpp
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * A recording SPI backend, so that the AutoDriver daisy chain traffic can be
+ * measured on a Linux host. Each chain position holds a simulated L6470 that
+ * decodes the command bytes, keeps its registers and answers GET_PARAM and
+ * GET_STATUS on the following bytes.
+ */
+
+#if defined(__linux__) && !defined(RASPPI)
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "linux/l6470simulation.h"
+
+#include "l6470.h"
+#include "l6470constants.h"
+
+#define SIMULATION_MAX_BOARDS	8
+#define SIMULATION_REGISTERS	(L6470_PARAM_STATUS + 1)
+
+#define CONFIG_POWER_UP			0x2E88
+#define STATUS_POWER_UP			(L6470_STATUS_BUSY | L6470_STATUS_HIZ)	///< BUSY is active low
+
+struct TL6470Device {
+	uint32_t Registers[SIMULATION_REGISTERS];
+	uint32_t nArgument;
+	uint32_t nOutput;
+	uint32_t nCommands;
+	uint32_t nHash;
+	uint8_t nCommand;
+	uint8_t nArgumentBytes;		///< Still to receive
+	uint8_t nOutputBytes;		///< Still to send
+	bool IsPresent;
+};
+
+static struct TL6470Device s_Devices[2][SIMULATION_MAX_BOARDS];
+static struct TL6470SimulationStats s_Stats;
+static uint8_t s_nChipSelect;
+static uint8_t s_nDataMode;
+static bool s_IsInitialized;
+
+// Register length in bytes, indexed by the parameter address
+static const uint8_t s_RegisterBytes[SIMULATION_REGISTERS] = {
+	1, 3, 2, 3, 3, 2, 2, 2, 2, 1, 1, 1, 1, 2, 1, 1,
+	1, 1, 1, 1, 1, 2, 1, 1, 2, 2 };
+
+static void reset(struct TL6470Device *pDevice) {
+	memset(pDevice, 0, sizeof(struct TL6470Device));
+
+	pDevice->Registers[L6470_PARAM_CONFIG] = CONFIG_POWER_UP;
+	pDevice->Registers[L6470_PARAM_STATUS] = STATUS_POWER_UP;
+	pDevice->IsPresent = true;
+}
+
+static void init(void) {
+	if (s_IsInitialized) {
+		return;
+	}
+
+	for (uint32_t nCs = 0; nCs < 2; nCs++) {
+		for (uint32_t i = 0; i < SIMULATION_MAX_BOARDS; i++) {
+			reset(&s_Devices[nCs][i]);
+		}
+	}
+
+	s_IsInitialized = true;
+}
+
+static uint8_t argument_bytes(uint8_t nCommand) {
+	if ((nCommand & 0xE0) == L6470_CMD_SET_PARAM) {
+		const uint8_t nParam = nCommand & 0x1F;
+		return (nParam < SIMULATION_REGISTERS) ? s_RegisterBytes[nParam] : 1;
+	}
+
+	switch (nCommand & 0xF8) {
+	case L6470_CMD_RUN:
+	case L6470_CMD_MOVE:
+	case L6470_CMD_GOTO:
+	case L6470_CMD_GOTO_DIR:
+		return 3;
+	default:
+		break;
+	}
+
+	if ((nCommand & 0xF0) == (L6470_CMD_GO_UNTIL & 0xF0)) {
+		return 3;
+	}
+
+	return 0;
+}
+
+static void execute(struct TL6470Device *pDevice) {
+	const uint8_t nCommand = pDevice->nCommand;
+	const uint32_t nArgument = pDevice->nArgument;
+
+	if ((nCommand & 0xE0) == L6470_CMD_SET_PARAM) {
+		const uint8_t nParam = nCommand & 0x1F;
+		if ((nParam < SIMULATION_REGISTERS) && (nParam != L6470_PARAM_STATUS)) {
+			pDevice->Registers[nParam] = nArgument;
+		}
+	} else if ((nCommand & 0xF8) == L6470_CMD_GOTO) {
+		pDevice->Registers[L6470_PARAM_ABS_POS] = nArgument & 0x3FFFFF;
+	} else if ((nCommand & 0xF8) == L6470_CMD_GOTO_DIR) {
+		pDevice->Registers[L6470_PARAM_ABS_POS] = nArgument & 0x3FFFFF;
+	} else if (nCommand == L6470_CMD_RESET_POS) {
+		pDevice->Registers[L6470_PARAM_ABS_POS] = 0;
+	}
+
+	// FNV-1a over the command and its argument
+	uint32_t nHash = pDevice->nHash ^ nCommand;
+	nHash *= 16777619;
+	nHash ^= nArgument;
+	nHash *= 16777619;
+
+	pDevice->nHash = nHash;
+	pDevice->nCommands++;
+}
+
+static uint8_t clock_byte(struct TL6470Device *pDevice, uint8_t nByte) {
+	uint8_t nOut = 0;
+
+	if (!pDevice->IsPresent) {
+		return 0;
+	}
+
+	if (pDevice->nOutputBytes != 0) {
+		pDevice->nOutputBytes--;
+		nOut = (uint8_t) (pDevice->nOutput >> (8 * pDevice->nOutputBytes));
+		return nOut;	// The input byte is ignored, it should be a NOP
+	}
+
+	if (pDevice->nArgumentBytes != 0) {
+		pDevice->nArgument = (pDevice->nArgument << 8) | nByte;
+
+		if (--pDevice->nArgumentBytes == 0) {
+			execute(pDevice);
+		}
+
+		return 0;
+	}
+
+	if (nByte == L6470_CMD_NOP) {
+		return 0;
+	}
+
+	pDevice->nCommand = nByte;
+	pDevice->nArgument = 0;
+
+	if ((nByte & 0xE0) == L6470_CMD_GET_PARAM) {
+		const uint8_t nParam = nByte & 0x1F;
+		if (nParam < SIMULATION_REGISTERS) {
+			pDevice->nOutput = pDevice->Registers[nParam];
+			pDevice->nOutputBytes = s_RegisterBytes[nParam];
+		}
+		execute(pDevice);
+	} else if (nByte == L6470_CMD_GET_STATUS) {
+		pDevice->nOutput = pDevice->Registers[L6470_PARAM_STATUS];
+		pDevice->nOutputBytes = 2;
+		execute(pDevice);
+	} else if (nByte == L6470_CMD_RESET_DEVICE) {
+		const uint32_t nHash = pDevice->nHash;
+		const uint32_t nCommands = pDevice->nCommands;
+		reset(pDevice);
+		pDevice->nHash = nHash;
+		pDevice->nCommands = nCommands;
+		execute(pDevice);
+	} else {
+		pDevice->nArgumentBytes = argument_bytes(nByte);
+
+		if (pDevice->nArgumentBytes == 0) {
+			execute(pDevice);
+		}
+	}
+
+	return nOut;
+}
+
+void bcm2835_spi_chipSelect(uint8_t nChipSelect) {
+	assert(nChipSelect <= BCM2835_SPI_CS_NONE);
+
+	s_nChipSelect = nChipSelect;
+	s_Stats.nSetup++;
+}
+
+void bcm2835_spi_setClockDivider(uint16_t nDivider) {
+	s_Stats.nSetup++;
+}
+
+void bcm2835_spi_setDataMode(uint8_t nMode) {
+	s_nDataMode = nMode;
+	s_Stats.nSetup++;
+}
+
+void bcm2835_spi_transfern(char *pBuffer, uint32_t nLength) {
+	assert(nLength <= SIMULATION_MAX_BOARDS);
+
+	init();
+
+	// Another SPI device has left its set-up, the L6470 chain does not see the frame
+	if ((s_nChipSelect > BCM2835_SPI_CS1) || (s_nDataMode != BCM2835_SPI_MODE3)) {
+		s_Stats.nLost++;
+		return;
+	}
+
+	for (uint32_t i = 0; i < nLength; i++) {
+		pBuffer[i] = (char) clock_byte(&s_Devices[s_nChipSelect][i], (uint8_t) pBuffer[i]);
+	}
+
+	s_Stats.nTransfers++;
+	s_Stats.nBytes += nLength;
+}
+
+uint8_t bcm2835_gpio_lev(uint8_t nPin) {
+	return HIGH;	// Not busy
+}
+
+void L6470Simulation::SetBoards(uint8_t nSpiChipSelect, uint8_t nCount) {
+	assert(nSpiChipSelect <= BCM2835_SPI_CS1);
+	assert(nCount <= SIMULATION_MAX_BOARDS);
+
+	init();
+
+	for (uint32_t i = 0; i < SIMULATION_MAX_BOARDS; i++) {
+		reset(&s_Devices[nSpiChipSelect][i]);
+		s_Devices[nSpiChipSelect][i].IsPresent = (i < nCount);
+	}
+}
+
+void L6470Simulation::SetBusy(uint8_t nSpiChipSelect, uint8_t nPosition, bool IsBusy) {
+	assert(nSpiChipSelect <= BCM2835_SPI_CS1);
+	assert(nPosition < SIMULATION_MAX_BOARDS);
+
+	init();
+
+	uint32_t *pStatus = &s_Devices[nSpiChipSelect][nPosition].Registers[L6470_PARAM_STATUS];
+
+	if (IsBusy) {
+		*pStatus &= ~L6470_STATUS_BUSY;
+	} else {
+		*pStatus |= L6470_STATUS_BUSY;
+	}
+}
+
+uint32_t L6470Simulation::GetCommands(uint8_t nSpiChipSelect, uint8_t nPosition) {
+	assert(nSpiChipSelect <= BCM2835_SPI_CS1);
+	assert(nPosition < SIMULATION_MAX_BOARDS);
+
+	return s_Devices[nSpiChipSelect][nPosition].nCommands;
+}
+
+uint32_t L6470Simulation::GetCommandHash(uint8_t nSpiChipSelect, uint8_t nPosition) {
+	assert(nSpiChipSelect <= BCM2835_SPI_CS1);
+	assert(nPosition < SIMULATION_MAX_BOARDS);
+
+	return s_Devices[nSpiChipSelect][nPosition].nHash;
+}
+
+void L6470Simulation::GetStats(struct TL6470SimulationStats *pStats) {
+	assert(pStats != 0);
+
+	memcpy(pStats, &s_Stats, sizeof(struct TL6470SimulationStats));
+}
+
+void L6470Simulation::ResetStats(void) {
+	memset(&s_Stats, 0, sizeof(struct TL6470SimulationStats));
+}
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * @file dmxmodes_test.cpp
+ *
+ * The L6470DmxModes mailbox on the simulated L6470: commanded, coalesced and dropped targets.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "autodriver.h"
+
+#include "l6470dmxmodes.h"
+#include "motorparams.h"
+#include "modeparams.h"
+
+#include "linux/l6470simulation.h"
+
+#define MOTOR_PARAMS_FILE	"dmxmodes_test.txt"
+#define STEP_ANGEL			1.8f
+
+static int s_nErrors;
+
+static void check(bool bCondition, const char *pMessage) {
+	if (!bCondition) {
+		printf("FAIL: %s\n", pMessage);
+		s_nErrors++;
+	}
+}
+
+static void check_stats(L6470DmxModes *pModes, uint32_t nCommanded, uint32_t nCoalesced, uint32_t nDropped, const char *pMessage) {
+	struct TL6470DmxModesStats Stats;
+
+	pModes->GetStats(&Stats);
+
+	if ((Stats.nCommanded != nCommanded) || (Stats.nCoalesced != nCoalesced) || (Stats.nDropped != nDropped)) {
+		printf("FAIL: %s: commanded %u coalesced %u dropped %u, expected %u %u %u\n", pMessage,
+				Stats.nCommanded, Stats.nCoalesced, Stats.nDropped, nCommanded, nCoalesced, nDropped);
+		s_nErrors++;
+	}
+}
+
+// The absolute position L6470DmxMode3 sends for a DMX value, full steps
+static long steps(uint8_t nValue) {
+	const float fSteps = (float) 360 / STEP_ANGEL / 0xFF;
+	return (long) (uint32_t) (nValue * fSteps);
+}
+
+static bool post(L6470DmxModes *pModes, uint8_t *pDmxData, uint8_t nValue) {
+	pDmxData[0] = nValue;
+	return pModes->Post(pDmxData, 512);
+}
+
+int main(int argc, char **argv) {
+	uint8_t DmxData[512];
+
+	FILE *fp = fopen(MOTOR_PARAMS_FILE, "w");
+
+	if (fp == 0) {
+		perror(MOTOR_PARAMS_FILE);
+		return EXIT_FAILURE;
+	}
+
+	fprintf(fp, "motor_step_angel=%.1f\n", STEP_ANGEL);
+	fclose(fp);
+
+	memset(DmxData, 0, sizeof(DmxData));
+
+	L6470Simulation::SetBoards(BCM2835_SPI_CS0, 1);
+
+	AutoDriver *pMotor = new AutoDriver(0, BCM2835_SPI_CS0, 0);
+	MotorParams *pMotorParams = new MotorParams(MOTOR_PARAMS_FILE);
+	ModeParams *pModeParams = new ModeParams(MOTOR_PARAMS_FILE);
+
+	remove(MOTOR_PARAMS_FILE);
+
+	// Mode 3 positions the motor and checks its BUSY flag before a new target
+	L6470DmxModes *pModes = new L6470DmxModes(L6470DMXMODE3, 1, pMotor, pMotorParams, pModeParams);
+
+	check(pMotor->IsConnected(), "the simulated L6470 is not connected");
+
+	pModes->Start();
+
+	// A changed frame is posted, the free motor takes it on the next Poll
+	check(post(pModes, DmxData, 100), "a changed frame is not posted");
+	check(pModes->IsPending(), "a posted frame is not pending");
+	check(pModes->Poll(), "Poll does not send the pending target");
+	check(pMotor->getPos() == steps(100), "the motor is not at the posted target");
+	check(!pModes->IsPending(), "the target is still pending after Poll");
+	check(!pModes->Poll(), "Poll without a pending target sends a command");
+	check_stats(pModes, 1, 0, 0, "post and poll");
+
+	// The same frame again is no change
+	check(!post(pModes, DmxData, 100), "an unchanged frame is posted");
+	check_stats(pModes, 1, 0, 0, "unchanged frame");
+
+	// While the motor is busy only the latest target is kept
+	L6470Simulation::SetBusy(BCM2835_SPI_CS0, 0, true);
+
+	check(post(pModes, DmxData, 150), "a frame for a busy motor is not posted");
+	check(post(pModes, DmxData, 200), "a second frame for a busy motor is not posted");
+	check(!pModes->Poll(), "Poll sends a target to a busy motor");
+	check(pModes->IsPending(), "the target is lost while the motor is busy");
+	check_stats(pModes, 1, 1, 0, "busy motor");
+
+	L6470Simulation::SetBusy(BCM2835_SPI_CS0, 0, false);
+
+	check(pModes->Poll(), "Poll does not send the target once the motor is free");
+	check(pMotor->getPos() == steps(200), "the motor is not at the latest target");
+	check_stats(pModes, 2, 1, 0, "coalesced target");
+
+	// Stop drops the pending target, the same frame after Start posts it again
+	L6470Simulation::SetBusy(BCM2835_SPI_CS0, 0, true);
+
+	check(post(pModes, DmxData, 50), "a frame before Stop is not posted");
+	pModes->Stop();
+	check(!pModes->IsPending(), "the target is still pending after Stop");
+	check_stats(pModes, 2, 1, 1, "stop");
+
+	L6470Simulation::SetBusy(BCM2835_SPI_CS0, 0, false);
+	pModes->Start();
+
+	check(post(pModes, DmxData, 50), "the dropped target is not posted again after Start");
+	check(pModes->Poll(), "Poll does not send the re-posted target");
+	check(pMotor->getPos() == steps(50), "the motor is not at the re-posted target");
+	check_stats(pModes, 3, 1, 1, "re-post after start");
+
+	check(!post(pModes, DmxData, 50), "an unchanged frame is posted after the re-post");
+
+	delete pModes;
+	delete pModeParams;
+	delete pMotorParams;
+	delete pMotor;
+
+	printf("dmxmodes_test: %d errors\n", s_nErrors);
+
+	return s_nErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -35,6 +35,12 @@
 #include "motorparams.h"
 #include "modeparams.h"
 
+struct TL6470DmxModesStats {
+	uint32_t nCommanded;	///< Targets sent to the motor
+	uint32_t nCoalesced;	///< Pending targets replaced by a newer one before the motor was free
+	uint32_t nDropped;		///< Pending targets discarded by Stop, re-posted by the next frame
+};
+
 class L6470DmxModes {
 
 public:
@@ -50,6 +56,23 @@ public:
 	bool IsDmxDataChanged(const uint8_t *, uint16_t);
 	void DmxData(const uint8_t *, uint16_t);
 
+	/**
+	 * Mailbox, only the latest DMX target is kept.
+	 * @return true when the DMX data has changed, the target is pending
+	 */
+	bool Post(const uint8_t *pDmxData, uint16_t nLength);
+	/**
+	 * Non-blocking, sends the pending target when the motor is not busy.
+	 * @return true when the target has been sent
+	 */
+	bool Poll(void);
+
+	inline bool IsPending(void) const {
+		return m_bIsPending;
+	}
+
+	void GetStats(struct TL6470DmxModesStats *pStats) const;
+
 	void Start(void);
 	void Stop(void);
 
@@ -78,6 +101,9 @@ private:
 
 private:
 	bool m_bIsStarted;
+	bool m_bIsPending;
+	bool m_bIsDmxDataStale;
+	struct TL6470DmxModesStats m_tStats;
 
 private:
 	uint8_t m_nMotorNumber;
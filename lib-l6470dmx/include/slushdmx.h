@@ -48,6 +48,13 @@ public:
 
 	void SetData(uint8_t nPort, const uint8_t *, uint16_t);
 
+	/**
+	 * Called from the main loop, sends the pending targets to the motors that are not busy
+	 */
+	void Run(void);
+
+	bool GetMotorStats(uint8_t nMotor, struct TL6470DmxModesStats *pStats) const;
+
 public: // RDM
 	bool SetDmxStartAddress(uint16_t nDmxStartAddress);
 	inline uint16_t GetDmxStartAddress(void) {
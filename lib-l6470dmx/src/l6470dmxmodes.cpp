@@ -45,7 +45,7 @@
 
 #include "debug.h"
 
-L6470DmxModes::L6470DmxModes(TL6470DmxModes tMode, uint16_t nDmxStartAddress, L6470 *pL6470, MotorParams *pMotorParams, ModeParams *pModeParams): m_bIsStarted(false), m_nMotorNumber(0), m_nMode(L6470DMXMODE_UNDEFINED), m_pDmxMode(0), m_DmxFootPrint(0) {
+L6470DmxModes::L6470DmxModes(TL6470DmxModes tMode, uint16_t nDmxStartAddress, L6470 *pL6470, MotorParams *pMotorParams, ModeParams *pModeParams): m_bIsStarted(false), m_bIsPending(false), m_bIsDmxDataStale(false), m_nMotorNumber(0), m_nMode(L6470DMXMODE_UNDEFINED), m_pDmxMode(0), m_DmxFootPrint(0) {
 	DEBUG1_ENTRY;
 
 	assert(nDmxStartAddress <= 512);
@@ -55,6 +55,10 @@ L6470DmxModes::L6470DmxModes(TL6470DmxModes tMode, uint16_t nDmxStartAddress, L6
 
 	m_nDmxStartAddress = nDmxStartAddress;
 
+	m_tStats.nCommanded = 0;
+	m_tStats.nCoalesced = 0;
+	m_tStats.nDropped = 0;
+
 	switch (tMode) {
 		case L6470DMXMODE0:
 			m_pDmxMode = new L6470DmxMode0(pL6470, pMotorParams);
@@ -179,6 +183,13 @@ void L6470DmxModes::Start(void) {
 void L6470DmxModes::Stop(void) {
 	DEBUG1_ENTRY;
 
+	if (m_bIsPending) {
+		// The dropped target is still in m_pDmxData; do not let it count as applied
+		m_bIsPending = false;
+		m_bIsDmxDataStale = true;
+		m_tStats.nDropped++;
+	}
+
 	if (!m_bIsStarted) {
 		return;
 	}
@@ -208,7 +219,7 @@ bool L6470DmxModes::BusyCheck(void) {
 bool L6470DmxModes::IsDmxDataChanged(const uint8_t *p) {
 	DEBUG1_ENTRY;
 
-	bool isChanged = false;
+	bool isChanged = m_bIsDmxDataStale;
 	uint16_t lastDmxChannel = m_nDmxStartAddress + m_DmxFootPrint - 1;
 	uint8_t *q = m_pDmxData;
 
@@ -225,6 +236,8 @@ bool L6470DmxModes::IsDmxDataChanged(const uint8_t *p) {
 		q++;
 	}
 
+	m_bIsDmxDataStale = false;
+
 	DEBUG1_EXIT;
 	return isChanged;
 }
@@ -278,3 +291,52 @@ void L6470DmxModes::DmxData(const uint8_t *pDmxData, uint16_t nLength) {
 	DEBUG1_EXIT;
 }
 
+bool L6470DmxModes::Post(const uint8_t *pDmxData, uint16_t nLength) {
+	DEBUG1_ENTRY;
+
+	if (!IsDmxDataChanged(pDmxData, nLength)) {
+		DEBUG1_EXIT;
+		return false;
+	}
+
+	// m_pDmxData holds the new target now
+	if (m_bIsPending) {
+		m_tStats.nCoalesced++;
+	} else {
+		m_bIsPending = true;
+		m_pDmxMode->HandleBusy();
+	}
+
+	DEBUG1_EXIT;
+	return true;
+}
+
+bool L6470DmxModes::Poll(void) {
+	DEBUG1_ENTRY;
+
+	if (!m_bIsPending || m_pDmxMode->BusyCheck()) {
+		DEBUG1_EXIT;
+		return false;
+	}
+
+#ifndef NDEBUG
+	printf("\tMotor : %d\n", m_nMotorNumber);
+#endif
+
+	m_pDmxMode->Data(m_pDmxData);
+
+	m_bIsStarted = true;
+	m_bIsPending = false;
+	m_tStats.nCommanded++;
+
+	DEBUG1_EXIT;
+	return true;
+}
+
+void L6470DmxModes::GetStats(struct TL6470DmxModesStats *pStats) const {
+	assert(pStats != 0);
+
+	pStats->nCommanded = m_tStats.nCommanded;
+	pStats->nCoalesced = m_tStats.nCoalesced;
+	pStats->nDropped = m_tStats.nDropped;
+}
@@ -494,39 +494,41 @@ void SlushDmx::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLength)
 	assert(pData != 0);
 	assert(nLength <= DMX_MAX_CHANNELS);
 
-	bool bIsDmxDataChanged[SLUSH_DMX_MAX_MOTORS];
-
 	for (int i = 0; i < SLUSH_DMX_MAX_MOTORS; i++) {
 		if (m_pL6470DmxModes[i] != 0) {
-			bIsDmxDataChanged[i] = m_pL6470DmxModes[i]->IsDmxDataChanged(pData, nLength);
-
-			if(bIsDmxDataChanged[i]) {
-				m_pL6470DmxModes[i]->HandleBusy();
-			}
-		} else {
-			bIsDmxDataChanged[i] = false;
-		}
 #ifndef NDEBUG
-		printf("bIsDmxDataChanged[%d]=%d\n", i, bIsDmxDataChanged[i]);
+			const bool bIsDmxDataChanged = m_pL6470DmxModes[i]->Post(pData, nLength);
+			printf("bIsDmxDataChanged[%d]=%d\n", i, bIsDmxDataChanged);
+#else
+			(void) m_pL6470DmxModes[i]->Post(pData, nLength);
 #endif
-	}
-
-	for (int i = 0; i < SLUSH_DMX_MAX_MOTORS; i++) {
-		if (bIsDmxDataChanged[i]) {
-			while (m_pL6470DmxModes[i]->BusyCheck())
-				;
 		}
 	}
 
+	Run();
+
+	UpdateIOPorts(pData, nLength);
+
+	DEBUG_EXIT;
+}
+
+void SlushDmx::Run(void) {
 	for (int i = 0; i < SLUSH_DMX_MAX_MOTORS; i++) {
-		if (bIsDmxDataChanged[i]) {
-			m_pL6470DmxModes[i]->DmxData(pData, nLength);
+		if (m_pL6470DmxModes[i] != 0) {
+			(void) m_pL6470DmxModes[i]->Poll();
 		}
 	}
+}
 
-	UpdateIOPorts(pData, nLength);
+bool SlushDmx::GetMotorStats(uint8_t nMotor, struct TL6470DmxModesStats *pStats) const {
+	assert(pStats != 0);
 
-	DEBUG_EXIT;
+	if ((nMotor >= SLUSH_DMX_MAX_MOTORS) || (m_pL6470DmxModes[nMotor] == 0)) {
+		return false;
+	}
+
+	m_pL6470DmxModes[nMotor]->GetStats(pStats);
+	return true;
 }
 
 void SlushDmx::UpdateIOPorts(const uint8_t *pData, uint16_t nLength) {
@@ -169,24 +169,32 @@ SparkFunDmx::~SparkFunDmx(void) {
 void SparkFunDmx::Start(uint8_t nPort) {
 	DEBUG_ENTRY;
 
+	AutoDriver::BeginBatch();
+
 	for (int i = 0; i < SPARKFUN_DMX_MAX_MOTORS; i++) {
 		if (m_pL6470DmxModes[i] != 0) {
 			m_pL6470DmxModes[i]->Start();
 		}
 	}
 
+	AutoDriver::EndBatch();
+
 	DEBUG_EXIT;
 }
 
 void SparkFunDmx::Stop(uint8_t nPort) {
 	DEBUG_ENTRY;
 
+	AutoDriver::BeginBatch();
+
 	for (int i = 0; i < SPARKFUN_DMX_MAX_MOTORS; i++) {
 		if (m_pL6470DmxModes[i] != 0) {
 			m_pL6470DmxModes[i]->Stop();
 		}
 	}
 
+	AutoDriver::EndBatch();
+
 	DEBUG_EXIT;
 }
 
@@ -371,37 +379,52 @@ void SparkFunDmx::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLengt
 	assert(pData != 0);
 	assert(nLength <= DMX_MAX_CHANNELS);
 
-	bool bIsDmxDataChanged[SPARKFUN_DMX_MAX_MOTORS];
+	// The commands for all motors go out together, one chain frame per byte position
+	AutoDriver::BeginBatch();
 
 	for (int i = 0; i < SPARKFUN_DMX_MAX_MOTORS; i++) {
 		if (m_pL6470DmxModes[i] != 0) {
-			bIsDmxDataChanged[i] = m_pL6470DmxModes[i]->IsDmxDataChanged(pData, nLength);
-
-			if(bIsDmxDataChanged[i]) {
-				m_pL6470DmxModes[i]->HandleBusy();
-			}
-		} else {
-			bIsDmxDataChanged[i] = false;
-		}
 #ifndef NDEBUG
-		printf("bIsDmxDataChanged[%d]=%d\n", i, bIsDmxDataChanged[i]);
+			const bool bIsDmxDataChanged = m_pL6470DmxModes[i]->Post(pData, nLength);
+			printf("bIsDmxDataChanged[%d]=%d\n", i, bIsDmxDataChanged);
+#else
+			(void) m_pL6470DmxModes[i]->Post(pData, nLength);
 #endif
+		}
 	}
 
 	for (int i = 0; i < SPARKFUN_DMX_MAX_MOTORS; i++) {
-		if (bIsDmxDataChanged[i]) {
-			while (m_pL6470DmxModes[i]->BusyCheck())
-				;
+		if (m_pL6470DmxModes[i] != 0) {
+			(void) m_pL6470DmxModes[i]->Poll();
 		}
 	}
 
+	AutoDriver::EndBatch();
+
+	DEBUG_EXIT;
+}
+
+void SparkFunDmx::Run(void) {
+	AutoDriver::BeginBatch();
+
 	for (int i = 0; i < SPARKFUN_DMX_MAX_MOTORS; i++) {
-		if (bIsDmxDataChanged[i]) {
-			m_pL6470DmxModes[i]->DmxData(pData, nLength);
+		if (m_pL6470DmxModes[i] != 0) {
+			(void) m_pL6470DmxModes[i]->Poll();
 		}
 	}
 
-	DEBUG_EXIT;
+	AutoDriver::EndBatch();
+}
+
+bool SparkFunDmx::GetMotorStats(uint8_t nMotor, struct TL6470DmxModesStats *pStats) const {
+	assert(pStats != 0);
+
+	if ((nMotor >= SPARKFUN_DMX_MAX_MOTORS) || (m_pL6470DmxModes[nMotor] == 0)) {
+		return false;
+	}
+
+	m_pL6470DmxModes[nMotor]->GetStats(pStats);
+	return true;
 }
 
 bool SparkFunDmx::SetDmxStartAddress(uint16_t nDmxStartAddress) {
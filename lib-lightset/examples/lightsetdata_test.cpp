@@ -0,0 +1,214 @@
+/**
+ * @file lightsetdata_test.cpp
+ *
+ * Checks LightSetData::Copy and LightSetData::MergeHtp, and the changed slot range,
+ * against plain byte loops on random universes, and times all three for 24, 100 and 512 slots.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lightsetdata.h"
+
+#define SLOTS_MAX	512
+#define ROUNDS		300000
+#define CALLS		1000000
+
+/*
+ * The byte loops the kernels replaced
+ */
+static bool copy_reference(uint8_t *pDst, const uint8_t *pSrc, uint16_t nLength, uint16_t &nFirstSlot, uint16_t &nLastSlot) {
+	bool bIsChanged = false;
+
+	for (uint16_t i = 0; i < nLength; i++) {
+		if (pDst[i] != pSrc[i]) {
+			pDst[i] = pSrc[i];
+			LightSetData::Widen(nFirstSlot, nLastSlot, i, i);
+			bIsChanged = true;
+		}
+	}
+
+	return bIsChanged;
+}
+
+static bool merge_htp_reference(uint8_t *pDst, const uint8_t *pSourceA, const uint8_t *pSourceB, uint16_t nLength, uint16_t &nFirstSlot, uint16_t &nLastSlot) {
+	bool bIsChanged = false;
+
+	for (uint16_t i = 0; i < nLength; i++) {
+		const uint8_t nValue = (pSourceA[i] > pSourceB[i]) ? pSourceA[i] : pSourceB[i];
+
+		if (pDst[i] != nValue) {
+			pDst[i] = nValue;
+			LightSetData::Widen(nFirstSlot, nLastSlot, i, i);
+			bIsChanged = true;
+		}
+	}
+
+	return bIsChanged;
+}
+
+static int test(void) {
+	// One extra slot, so that a write past nLength is seen
+	static uint8_t a[SLOTS_MAX + 1], b[SLOTS_MAX + 1], dst[SLOTS_MAX + 1], reference[SLOTS_MAX + 1];
+	int nErrors = 0;
+
+	for (uint32_t nRound = 0; (nRound < ROUNDS) && (nErrors < 10); nRound++) {
+		const uint16_t nLength = (uint16_t) (rand() % (SLOTS_MAX + 1));
+
+		for (uint16_t i = 0; i < SLOTS_MAX + 1; i++) {
+			a[i] = (uint8_t) rand();
+			b[i] = (rand() % 3) ? (uint8_t) rand() : a[i];
+			dst[i] = (rand() % 50) ? ((a[i] > b[i]) ? a[i] : b[i]) : (uint8_t) rand();
+		}
+
+		// Every third round, at most one changed slot
+		if ((nRound % 3) == 0) {
+			for (uint16_t i = 0; i < SLOTS_MAX + 1; i++) {
+				dst[i] = (a[i] > b[i]) ? a[i] : b[i];
+			}
+			if ((nLength != 0) && (rand() % 4)) {
+				dst[rand() % nLength] ^= 0x40;
+			}
+		}
+
+		uint16_t nFirst = LIGHTSET_SLOT_NONE, nLast = 0;
+		uint16_t nFirstReference = LIGHTSET_SLOT_NONE, nLastReference = 0;
+
+		memcpy(reference, dst, sizeof(reference));
+
+		bool bIsChanged = LightSetData::MergeHtp(dst, a, b, nLength, nFirst, nLast);
+		bool bIsChangedReference = merge_htp_reference(reference, a, b, nLength, nFirstReference, nLastReference);
+
+		if ((bIsChanged != bIsChangedReference) || (memcmp(dst, reference, sizeof(reference)) != 0) || (nFirst != nFirstReference) || (nLast != nLastReference)) {
+			printf("MergeHtp: length %u, range %u-%u, expected %u-%u\n", nLength, nFirst, nLast, nFirstReference, nLastReference);
+			nErrors++;
+		}
+
+		// A copy of A with up to 2 flipped slots
+		memcpy(dst, a, sizeof(dst));
+
+		if ((nLength != 0) && (rand() % 4)) {
+			dst[rand() % nLength] ^= 0x01;
+			dst[rand() % nLength] ^= 0x80;
+		}
+
+		nFirst = nFirstReference = LIGHTSET_SLOT_NONE;
+		nLast = nLastReference = 0;
+
+		memcpy(reference, dst, sizeof(reference));
+
+		bIsChanged = LightSetData::Copy(dst, a, nLength, nFirst, nLast);
+		bIsChangedReference = copy_reference(reference, a, nLength, nFirstReference, nLastReference);
+
+		if ((bIsChanged != bIsChangedReference) || (memcmp(dst, reference, sizeof(reference)) != 0) || (nFirst != nFirstReference) || (nLast != nLastReference)) {
+			printf("Copy: length %u, range %u-%u, expected %u-%u\n", nLength, nFirst, nLast, nFirstReference, nLastReference);
+			nErrors++;
+		}
+	}
+
+	return nErrors;
+}
+
+static double nanos(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+/*
+ * Source A changes one slot per call, so that every Copy has work to do
+ */
+static void benchmark(void) {
+	static const uint16_t lengths[] = {24, 100, 512};
+	static uint8_t a[SLOTS_MAX], b[SLOTS_MAX], dst[SLOTS_MAX];
+	volatile bool bSink;
+	uint16_t nFirst, nLast;
+
+	for (uint32_t i = 0; i < SLOTS_MAX; i++) {
+		a[i] = (uint8_t) rand();
+		b[i] = (uint8_t) rand();
+	}
+
+	printf("Nanoseconds per call, kernel / byte loop\n");
+
+	for (uint32_t n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++) {
+		const uint16_t nLength = lengths[n];
+		double fTimes[4];
+		double fStart = nanos();
+
+		for (uint32_t i = 0; i < CALLS; i++) {
+			a[i % nLength]++;
+			bSink = LightSetData::MergeHtp(dst, a, b, nLength, nFirst, nLast);
+		}
+
+		fTimes[0] = nanos() - fStart;
+		fStart = nanos();
+
+		for (uint32_t i = 0; i < CALLS; i++) {
+			a[i % nLength]++;
+			bSink = merge_htp_reference(dst, a, b, nLength, nFirst, nLast);
+		}
+
+		fTimes[1] = nanos() - fStart;
+		fStart = nanos();
+
+		for (uint32_t i = 0; i < CALLS; i++) {
+			a[i % nLength]++;
+			bSink = LightSetData::Copy(dst, a, nLength, nFirst, nLast);
+		}
+
+		fTimes[2] = nanos() - fStart;
+		fStart = nanos();
+
+		for (uint32_t i = 0; i < CALLS; i++) {
+			a[i % nLength]++;
+			bSink = copy_reference(dst, a, nLength, nFirst, nLast);
+		}
+
+		fTimes[3] = nanos() - fStart;
+
+		printf("%3u slots: MergeHtp %5.0f/%5.0f ns, Copy %5.0f/%5.0f ns\n", nLength,
+				fTimes[0] / CALLS, fTimes[1] / CALLS, fTimes[2] / CALLS, fTimes[3] / CALLS);
+	}
+
+	(void) bSink;
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	const int nErrors = test();
+
+	printf("lightsetdata_test: %d errors\n", nErrors);
+
+	if ((argc > 1) && (strcmp(argv[1], "-b") == 0)) {
+		benchmark();
+	}
+
+	return (nErrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
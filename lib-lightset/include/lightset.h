@@ -33,6 +33,8 @@ struct TLightSetSlotInfo {
 	uint16_t nCategory;
 };
 
+#define LIGHTSET_SLOT_NONE	0xFFFF	///< Empty changed slot range
+
 enum {
 	DMX_ADDRESS_INVALID = 0xFFFF,
 	DMX_START_ADDRESS_DEFAULT = 1,
@@ -47,6 +49,11 @@ public:
 	virtual void Stop(uint8_t nPort)= 0;
 
 	virtual void SetData(uint8_t nPort, const uint8_t *, uint16_t)= 0;
+	/**
+	 * As SetData, but only the slots [nFirstSlot, nLastSlot] (0 based) have changed since the previous call for nPort.
+	 * The default forwards to SetData.
+	 */
+	virtual void SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nLength, uint16_t nFirstSlot, uint16_t nLastSlot);
 
 	virtual void Print(void);
 
@@ -46,6 +46,7 @@ public:
 	void Stop(uint8_t nPort);
 
 	void SetData(uint8_t nPort, const uint8_t *, uint16_t);
+	void SetDataRange(uint8_t nPort, const uint8_t *, uint16_t, uint16_t nFirstSlot, uint16_t nLastSlot);
 
 public: // RDM
 	bool SetDmxStartAddress(uint16_t nDmxStartAddress);
@@ -0,0 +1,76 @@
+/**
+ * @file lightsetdata.h
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LIGHTSETDATA_H_
+#define LIGHTSETDATA_H_
+
+#include <stdint.h>
+
+#include "lightset.h"
+
+/**
+ * DMX slot kernels shared by the protocol front-ends (Art-Net, sACN E1.31, OSC).
+ *
+ * The implementation is chosen at compile time: 16 byte vectors when the target has NEON or SSE2,
+ * otherwise 32-bit words.
+ */
+class LightSetData {
+public:
+	/**
+	 * Copies nLength slots from pSrc to pDst.
+	 * When pDst has changed, [nFirstSlot, nLastSlot] is widened to include the changed slots (0 based).
+	 * @return true when pDst has changed
+	 */
+	static bool Copy(uint8_t *pDst, const uint8_t *pSrc, uint16_t nLength, uint16_t &nFirstSlot, uint16_t &nLastSlot);
+
+	/**
+	 * Highest Takes Precedence: pDst[i] = MAX(pSourceA[i], pSourceB[i]).
+	 * When pDst has changed, [nFirstSlot, nLastSlot] is widened to include the changed slots (0 based).
+	 * @return true when pDst has changed
+	 */
+	static bool MergeHtp(uint8_t *pDst, const uint8_t *pSourceA, const uint8_t *pSourceB, uint16_t nLength, uint16_t &nFirstSlot, uint16_t &nLastSlot);
+
+	/**
+	 * Adds the slots [nFirst, nLast] to the range [nFirstSlot, nLastSlot]
+	 */
+	inline static void Widen(uint16_t &nFirstSlot, uint16_t &nLastSlot, uint16_t nFirst, uint16_t nLast) {
+		if (nFirst < nFirstSlot) {
+			nFirstSlot = nFirst;
+		}
+		if (nLast > nLastSlot) {
+			nLastSlot = nLast;
+		}
+	}
+
+	/**
+	 * Makes [nFirstSlot, nLastSlot] empty
+	 */
+	inline static void Clear(uint16_t &nFirstSlot, uint16_t &nLastSlot) {
+		nFirstSlot = LIGHTSET_SLOT_NONE;
+		nLastSlot = 0;
+	}
+};
+
+#endif /* LIGHTSETDATA_H_ */
@@ -31,6 +31,10 @@ LightSet::~LightSet(void) {
 
 }
 
+void LightSet::SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nLength, uint16_t nFirstSlot, uint16_t nLastSlot) {
+	SetData(nPort, pData, nLength);
+}
+
 uint16_t LightSet::GetDmxStartAddress(void) {
 	return DMX_START_ADDRESS_DEFAULT;
 }
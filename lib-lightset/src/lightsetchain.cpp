@@ -74,6 +74,14 @@ void LightSetChain::SetData(uint8_t nPort, const uint8_t *pData, uint16_t nSize)
 	}
 }
 
+void LightSetChain::SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nSize, uint16_t nFirstSlot, uint16_t nLastSlot) {
+	assert(pData != 0);
+
+	for (unsigned i = 0; i < m_nSize; i++) {
+		m_pTable[i].pLightSet->SetDataRange(nPort, pData, nSize, nFirstSlot, nLastSlot);
+	}
+}
+
 bool LightSetChain::SetDmxStartAddress(uint16_t nDmxStartAddress) {
 	DEBUG1_ENTRY
 
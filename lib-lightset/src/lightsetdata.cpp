@@ -0,0 +1,180 @@
+/**
+ * @file lightsetdata.cpp
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lightsetdata.h"
+
+#if defined (__ARM_NEON__) || defined (__ARM_NEON) || defined (__SSE2__)
+ #define LIGHTSETDATA_VECTOR
+#endif
+
+#if defined (LIGHTSETDATA_VECTOR)
+/*
+ * GCC vector extensions, so no arm_neon.h / emmintrin.h is needed (bare metal is built with -nostdinc).
+ * These compile to NEON on Cortex-A7 and to SSE2 on x86-64.
+ */
+typedef uint8_t v16u8 __attribute__ ((vector_size (16)));
+#else
+/*
+ * Per byte (a >= b) of two 32-bit words, without carries between the bytes.
+ * Returns 0xFF in each byte where a >= b, 0x00 otherwise.
+ */
+static inline uint32_t MaskGreaterEqual(uint32_t a, uint32_t b) {
+	const uint32_t nLow = ((a | 0x80808080) - (b & 0x7F7F7F7F));
+	const uint32_t nHigh = ((a & ~b) | (~(a ^ b) & nLow)) & 0x80808080;
+
+	return (nHigh >> 7) * 0xFF;
+}
+#endif
+
+/*
+ * The byte offsets of the first and the last non-zero byte of a difference block.
+ * All targets are little endian, so the lowest slot is in the least significant byte.
+ */
+#if defined (LIGHTSETDATA_VECTOR)
+static inline bool Track(v16u8 vDiff, uint32_t nIndex, uint32_t &nFirst, uint32_t &nLast) {
+	uint64_t a[2];
+	memcpy(a, &vDiff, sizeof(a));
+
+	if ((a[0] | a[1]) == 0) {
+		return false;
+	}
+
+	if (nFirst == LIGHTSET_SLOT_NONE) {
+		nFirst = nIndex + (a[0] != 0 ? (__builtin_ctzll(a[0]) >> 3) : 8 + (__builtin_ctzll(a[1]) >> 3));
+	}
+
+	nLast = nIndex + (a[1] != 0 ? 8 + ((63 - __builtin_clzll(a[1])) >> 3) : ((63 - __builtin_clzll(a[0])) >> 3));
+
+	return true;
+}
+#else
+static inline bool Track(uint32_t nDiff, uint32_t nIndex, uint32_t &nFirst, uint32_t &nLast) {
+	if (nDiff == 0) {
+		return false;
+	}
+
+	if (nFirst == LIGHTSET_SLOT_NONE) {
+		nFirst = nIndex + (__builtin_ctz(nDiff) >> 3);
+	}
+
+	nLast = nIndex + ((31 - __builtin_clz(nDiff)) >> 3);
+
+	return true;
+}
+#endif
+
+static inline void TrackSlot(uint32_t nIndex, uint32_t &nFirst, uint32_t &nLast) {
+	if (nFirst == LIGHTSET_SLOT_NONE) {
+		nFirst = nIndex;
+	}
+
+	nLast = nIndex;
+}
+
+bool LightSetData::Copy(uint8_t *pDst, const uint8_t *pSrc, uint16_t nLength, uint16_t &nFirstSlot, uint16_t &nLastSlot) {
+	uint32_t i = 0;
+	uint32_t nFirst = LIGHTSET_SLOT_NONE;
+	uint32_t nLast = 0;
+
+#if defined (LIGHTSETDATA_VECTOR)
+	for (; i + 16 <= nLength; i += 16) {
+		v16u8 vSrc, vDst;
+		memcpy(&vSrc, &pSrc[i], 16);
+		memcpy(&vDst, &pDst[i], 16);
+		memcpy(&pDst[i], &vSrc, 16);
+		Track(vSrc ^ vDst, i, nFirst, nLast);
+	}
+#else
+	for (; i + 4 <= nLength; i += 4) {
+		uint32_t nSrc, nDst;
+		memcpy(&nSrc, &pSrc[i], 4);
+		memcpy(&nDst, &pDst[i], 4);
+		memcpy(&pDst[i], &nSrc, 4);
+		Track(nSrc ^ nDst, i, nFirst, nLast);
+	}
+#endif
+
+	for (; i < nLength; i++) {
+		if (pSrc[i] != pDst[i]) {
+			pDst[i] = pSrc[i];
+			TrackSlot(i, nFirst, nLast);
+		}
+	}
+
+	if (nFirst == LIGHTSET_SLOT_NONE) {
+		return false;
+	}
+
+	Widen(nFirstSlot, nLastSlot, (uint16_t) nFirst, (uint16_t) nLast);
+	return true;
+}
+
+bool LightSetData::MergeHtp(uint8_t *pDst, const uint8_t *pSourceA, const uint8_t *pSourceB, uint16_t nLength, uint16_t &nFirstSlot, uint16_t &nLastSlot) {
+	uint32_t i = 0;
+	uint32_t nFirst = LIGHTSET_SLOT_NONE;
+	uint32_t nLast = 0;
+
+#if defined (LIGHTSETDATA_VECTOR)
+	for (; i + 16 <= nLength; i += 16) {
+		v16u8 vA, vB, vDst;
+		memcpy(&vA, &pSourceA[i], 16);
+		memcpy(&vB, &pSourceB[i], 16);
+		memcpy(&vDst, &pDst[i], 16);
+		const v16u8 vMask = (v16u8) (vA > vB);
+		const v16u8 vMax = (vA & vMask) | (vB & ~vMask);
+		memcpy(&pDst[i], &vMax, 16);
+		Track(vMax ^ vDst, i, nFirst, nLast);
+	}
+#else
+	for (; i + 4 <= nLength; i += 4) {
+		uint32_t nA, nB, nDst;
+		memcpy(&nA, &pSourceA[i], 4);
+		memcpy(&nB, &pSourceB[i], 4);
+		memcpy(&nDst, &pDst[i], 4);
+		const uint32_t nMask = MaskGreaterEqual(nA, nB);
+		const uint32_t nMax = (nA & nMask) | (nB & ~nMask);
+		memcpy(&pDst[i], &nMax, 4);
+		Track(nMax ^ nDst, i, nFirst, nLast);
+	}
+#endif
+
+	for (; i < nLength; i++) {
+		const uint8_t nMax = pSourceA[i] > pSourceB[i] ? pSourceA[i] : pSourceB[i];
+		if (nMax != pDst[i]) {
+			pDst[i] = nMax;
+			TrackSlot(i, nFirst, nLast);
+		}
+	}
+
+	if (nFirst == LIGHTSET_SLOT_NONE) {
+		return false;
+	}
+
+	Widen(nFirstSlot, nLastSlot, (uint16_t) nFirst, (uint16_t) nLast);
+	return true;
+}
@@ -33,6 +33,8 @@
 #define NETWORK_MAC_SIZE		6
 #define NETWORK_HOSTNAME_SIZE	48
 
+#define NETWORK_RECV_BUFFER_SIZE	1500	///< Used by the default RecvFromRef
+
 #ifndef IP2STR
  #define IP2STR(addr) (uint8_t)(addr & 0xFF), (uint8_t)((addr >> 8) & 0xFF), (uint8_t)((addr >> 16) & 0xFF), (uint8_t)((addr >> 24) & 0xFF)
  #define IPSTR "%d.%d.%d.%d"
@@ -48,12 +50,38 @@
  #define MACSTR "%.2x:%.2x:%.2x:%.2x:%.2x:%.2x"
 #endif
 
+struct TNetworkPacket {
+	uint8_t *pBuffer;		///< Receive buffer, owned by the caller
+	uint16_t nSize;			///< Size of the receive buffer
+	uint16_t nLength;		///< Number of bytes received
+	uint32_t nFromIp;		///<
+	uint16_t nFromPort;		///<
+};
+
+enum TNetworkQueuePolicy {
+	NETWORK_QUEUE_DROP_NEWEST,	///< A full receive queue discards the datagram that just arrived
+	NETWORK_QUEUE_DROP_OLDEST	///< A full receive queue discards its oldest datagram
+};
+
+struct TNetworkQueueStats {
+	uint32_t nReceived;			///< Datagrams delivered to the port
+	uint32_t nDropped;			///< Datagrams discarded because the receive queue was full
+	uint16_t nHighWater;		///< Highest number of queued datagrams seen
+	uint16_t nDepth;			///< Number of receive queue entries
+};
+
 class Network {
 public:
 	Network(void);
 	virtual ~Network(void);
 
 	virtual int32_t Begin(uint16_t nPort)=0;
+	/**
+	 * Begin with a receive queue of nQueueDepth datagrams, where the network stack has its own queues.
+	 * The default implementation ignores the queue settings.
+	 * @return -1 when the network stack cannot supply a queue of nQueueDepth datagrams
+	 */
+	virtual int32_t BeginQueue(uint16_t nPort, uint16_t nQueueDepth, TNetworkQueuePolicy tQueuePolicy);
 	virtual void End(void)=0;
 
 	virtual void MacAddressCopyTo(uint8_t *pMacAddress)=0;
@@ -91,10 +119,31 @@ public:
 		return m_aHostName;
 	}
 
-	virtual void JoinGroup(uint32_t nHandle, uint32_t nIp)=0;
+	/**
+	 * @return a negative value when the network stack could not join the group,
+	 * 0 when it joined or when it does not manage group membership
+	 */
+	virtual int32_t JoinGroup(uint32_t nHandle, uint32_t nIp)=0;
 	virtual void LeaveGroup(uint32_t nHandle, uint32_t nIp)=0;
 
 	virtual uint16_t RecvFrom(uint32_t nHandle, uint8_t *pPacket, uint16_t nSize, uint32_t *pFromIp, uint16_t *pFromPort)=0;
+	/**
+	 * Receive up to nCount datagrams in one call.
+	 * @return the number of entries in pPackets that have been filled
+	 */
+	virtual uint16_t RecvFromBatch(uint32_t nHandle, struct TNetworkPacket *pPackets, uint16_t nCount);
+	/**
+	 * Borrow the next datagram without copying it into a caller buffer.
+	 * *ppPacket stays valid, and may be modified in place, until RecvRelease is called for the same handle.
+	 * The default implementation receives into a buffer owned by Network, one datagram at a time.
+	 * @return the number of bytes received, 0 when there is none
+	 */
+	virtual uint16_t RecvFromRef(uint32_t nHandle, uint8_t **ppPacket, uint32_t *pFromIp, uint16_t *pFromPort);
+	virtual void RecvRelease(uint32_t nHandle);
+	/**
+	 * @return false when the receive queue statistics are not available
+	 */
+	virtual bool GetQueueStats(uint32_t nHandle, struct TNetworkQueueStats *pStats);
 	virtual void SendTo(uint32_t nHandle, const uint8_t *pPacket, uint16_t nSize, uint32_t nToIp, uint16_t nRemotePort)=0;
 
 	virtual void SetIp(uint32_t nIp)=0;
@@ -116,6 +165,9 @@ protected:
 	bool m_IsDhcpUsed;
 	char m_aHostName[NETWORK_HOSTNAME_SIZE];
 
+private:
+	uint8_t *m_pRecvBuffer;
+
 private:
 	static Network *s_pThis;
 };
@@ -42,7 +42,7 @@ public:
 
 	void MacAddressCopyTo(uint8_t *pMacAddress);
 
-	void JoinGroup(uint32_t nHandle, uint32_t nIp);
+	int32_t JoinGroup(uint32_t nHandle, uint32_t nIp);
 
 	inline void LeaveGroup(uint32_t nHandle, uint32_t nIp) {
 		// Not supported
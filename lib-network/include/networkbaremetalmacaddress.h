@@ -45,7 +45,8 @@ public:
 	inline void End(void) {
 	}
 
-	inline void JoinGroup(uint32_t nHandle, uint32_t nIp) {
+	inline int32_t JoinGroup(uint32_t nHandle, uint32_t nIp) {
+		return 0;
 	}
 
 	inline void LeaveGroup(uint32_t nHandle, uint32_t nIp) {
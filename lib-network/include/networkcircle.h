@@ -48,8 +48,9 @@ public:
 
 	void MacAddressCopyTo(uint8_t *pMacAddress);
 
-	inline void JoinGroup(uint32_t nHandle, uint32_t nIp) {
-		// Not supported
+	inline int32_t JoinGroup(uint32_t nHandle, uint32_t nIp) {
+		// Not supported, there is no group membership to fail
+		return 0;
 	}
 
 	inline void LeaveGroup(uint32_t nHandle, uint32_t nIp) {
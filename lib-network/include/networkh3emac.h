@@ -32,6 +32,8 @@
 
 #include "networkparams.h"
 
+struct net_stats;
+
 class NetworkH3emac: public Network {
 public:
 	NetworkH3emac(void);
@@ -40,19 +42,28 @@ public:
 	int Init(NetworkParamsStore *pNetworkParamsStore = 0);
 
 	int32_t Begin(uint16_t nPort);
+	int32_t BeginQueue(uint16_t nPort, uint16_t nQueueDepth, TNetworkQueuePolicy tQueuePolicy);
 	void End(void);
 
 	void MacAddressCopyTo(uint8_t *pMacAddress);
 
-	void JoinGroup(uint32_t nHandle, uint32_t nIp);
+	int32_t JoinGroup(uint32_t nHandle, uint32_t nIp);
 	void LeaveGroup(uint32_t nHandle, uint32_t nIp);
 
 	uint16_t RecvFrom(uint32_t nHandle, uint8_t *pPacket, uint16_t nSize, uint32_t *pFromIp, uint16_t *pFromPort);
+	uint16_t RecvFromRef(uint32_t nHandle, uint8_t **ppPacket, uint32_t *pFromIp, uint16_t *pFromPort);
+	void RecvRelease(uint32_t nHandle);
+	bool GetQueueStats(uint32_t nHandle, struct TNetworkQueueStats *pStats);
 	void SendTo(uint32_t nHandle, const uint8_t *pPacket, uint16_t nSize, uint32_t nToIp, uint16_t nRemotePort);
 
 	void SetIp(uint32_t nIp);
 
 	void Run(void);
+	/**
+	 * Each Run handles at most nFrames received frames, and stops after nMicros when nMicros is not 0
+	 */
+	void SetRunBudget(uint32_t nFrames, uint32_t nMicros = 0);
+	void GetRunStats(struct net_stats *pStats);
 
 private:
 };
@@ -46,10 +46,13 @@ public:
 
 	void SetIp(uint32_t nIp);
 
-	void JoinGroup(uint32_t nHandle, uint32_t nIp);
+	int32_t JoinGroup(uint32_t nHandle, uint32_t nIp);
 	void LeaveGroup(uint32_t nHandle, uint32_t nIp);
 
 	uint16_t RecvFrom(uint32_t nHandle, uint8_t *pPacket, uint16_t nSize, uint32_t *pFromIp, uint16_t *pFromPort);
+#if defined (__linux__)
+	uint16_t RecvFromBatch(uint32_t nHandle, struct TNetworkPacket *pPackets, uint16_t nCount);
+#endif
 	void SendTo(uint32_t nHandle, const uint8_t *pPacket, uint16_t nSize, uint32_t nToIp, uint16_t nRemotePort);
 
 private:
@@ -82,8 +82,9 @@ void NetworkBaremetal::MacAddressCopyTo(uint8_t* pMacAddress) {
 	}
 }
 
-void NetworkBaremetal::JoinGroup(uint32_t nHandle, uint32_t nIp) {
+int32_t NetworkBaremetal::JoinGroup(uint32_t nHandle, uint32_t nIp) {
 	wifi_udp_joingroup(nIp);
+	return 0;
 }
 
 uint16_t NetworkBaremetal::RecvFrom(uint32_t nHandle, uint8_t* packet, uint16_t size,	uint32_t* from_ip, uint16_t* from_port) {
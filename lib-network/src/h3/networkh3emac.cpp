@@ -120,6 +120,16 @@ int32_t NetworkH3emac::Begin(uint16_t nPort) {
 	DEBUG_EXIT
 }
 
+int32_t NetworkH3emac::BeginQueue(uint16_t nPort, uint16_t nQueueDepth, TNetworkQueuePolicy tQueuePolicy) {
+	DEBUG_ENTRY
+
+	// The caller decides what to do when the shared queue pool is exhausted
+	const int32_t nIdx = udp_bind_queue(nPort, nQueueDepth, tQueuePolicy == NETWORK_QUEUE_DROP_OLDEST ? UDP_QUEUE_DROP_OLDEST : UDP_QUEUE_DROP_NEWEST);
+
+	DEBUG_EXIT
+	return nIdx;
+}
+
 void NetworkH3emac::End(void) {
 }
 
@@ -133,12 +143,13 @@ void NetworkH3emac::MacAddressCopyTo(uint8_t* pMacAddress) {
 	DEBUG_EXIT
 }
 
-void NetworkH3emac::JoinGroup(uint32_t nHandle, uint32_t nIp) {
+int32_t NetworkH3emac::JoinGroup(uint32_t nHandle, uint32_t nIp) {
 	DEBUG_ENTRY
 
-	igmp_join(nIp);
+	const int nIndex = igmp_join(nIp);
 
 	DEBUG_EXIT
+	return nIndex < 0 ? nIndex : 0;
 }
 
 void NetworkH3emac::LeaveGroup(uint32_t nHandle, uint32_t nIp) {
@@ -153,6 +164,29 @@ uint16_t NetworkH3emac::RecvFrom(uint32_t nHandle, uint8_t* packet, uint16_t siz
 	return udp_recv(nHandle, packet, size, from_ip, from_port);
 }
 
+uint16_t NetworkH3emac::RecvFromRef(uint32_t nHandle, uint8_t **ppPacket, uint32_t *pFromIp, uint16_t *pFromPort) {
+	return udp_recv_ref(nHandle, ppPacket, pFromIp, pFromPort);
+}
+
+void NetworkH3emac::RecvRelease(uint32_t nHandle) {
+	udp_release(nHandle);
+}
+
+bool NetworkH3emac::GetQueueStats(uint32_t nHandle, struct TNetworkQueueStats *pStats) {
+	assert(pStats != 0);
+
+	struct udp_queue_stats tStats;
+
+	udp_get_queue_stats(nHandle, &tStats);
+
+	pStats->nReceived = tStats.received;
+	pStats->nDropped = tStats.dropped;
+	pStats->nHighWater = tStats.high_water;
+	pStats->nDepth = tStats.depth;
+
+	return true;
+}
+
 void NetworkH3emac::SendTo(uint32_t nHandle, const uint8_t* packet, uint16_t size, uint32_t to_ip, uint16_t remote_port) {
 	udp_send(nHandle, packet, size, to_ip, remote_port);
 }
@@ -171,3 +205,11 @@ void NetworkH3emac::SetIp(uint32_t nIp) {
 void NetworkH3emac::Run(void) {
 	net_handle();
 }
+
+void NetworkH3emac::SetRunBudget(uint32_t nFrames, uint32_t nMicros) {
+	net_set_handle_budget(nFrames, nMicros);
+}
+
+void NetworkH3emac::GetRunStats(struct net_stats *pStats) {
+	net_get_stats(pStats);
+}
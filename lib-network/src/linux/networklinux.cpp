@@ -37,6 +37,8 @@
 
 #include "networklinux.h"
 
+#define RECV_BATCH_MAX	64
+
 NetworkLinux::NetworkLinux(void) {
 	for (unsigned i = 0; i < sizeof(m_aIfName); i++) {
 		m_aIfName[i] = '\0';
@@ -176,7 +178,7 @@ void NetworkLinux::SetIp(uint32_t nIp) {
 #endif
 }
 
-void NetworkLinux::JoinGroup(uint32_t nHandle, uint32_t ip) {
+int32_t NetworkLinux::JoinGroup(uint32_t nHandle, uint32_t ip) {
 	struct ip_mreq mreq;
 
 	mreq.imr_multiaddr.s_addr = ip;
@@ -184,7 +186,10 @@ void NetworkLinux::JoinGroup(uint32_t nHandle, uint32_t ip) {
 
 	if (setsockopt(nHandle, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
 		perror("setsockopt(IP_ADD_MEMBERSHIP)");
+		return -1;
 	}
+
+	return 0;
 }
 
 void NetworkLinux::LeaveGroup(uint32_t nHandle, uint32_t ip) {
@@ -223,6 +228,50 @@ uint16_t NetworkLinux::RecvFrom(uint32_t nHandle, uint8_t* pPacket, uint16_t nSi
 	return recv_len;
 }
 
+#if defined (__linux__)
+uint16_t NetworkLinux::RecvFromBatch(uint32_t nHandle, struct TNetworkPacket *pPackets, uint16_t nCount) {
+	assert(nHandle != -1);
+	assert(pPackets != NULL);
+
+	struct mmsghdr msgs[RECV_BATCH_MAX];
+	struct iovec iovecs[RECV_BATCH_MAX];
+	struct sockaddr_in si_other[RECV_BATCH_MAX];
+
+	if (nCount > RECV_BATCH_MAX) {
+		nCount = RECV_BATCH_MAX;
+	}
+
+	memset(msgs, 0, nCount * sizeof(struct mmsghdr));
+
+	for (unsigned i = 0; i < nCount; i++) {
+		iovecs[i].iov_base = (void *) pPackets[i].pBuffer;
+		iovecs[i].iov_len = pPackets[i].nSize;
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = (void *) &si_other[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+	}
+
+	// Wait (SO_RCVTIMEO) for the first datagram only, then take what is already queued
+	const int nReceived = recvmmsg(nHandle, msgs, nCount, MSG_WAITFORONE, NULL);
+
+	if (nReceived == -1) {
+		if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+			perror("recvmmsg");
+		}
+		return 0;
+	}
+
+	for (int i = 0; i < nReceived; i++) {
+		pPackets[i].nLength = (uint16_t) msgs[i].msg_len;
+		pPackets[i].nFromIp = si_other[i].sin_addr.s_addr;
+		pPackets[i].nFromPort = ntohs(si_other[i].sin_port);
+	}
+
+	return (uint16_t) nReceived;
+}
+#endif
+
 void NetworkLinux::SendTo(uint32_t nHandle, const uint8_t* pPacket, uint16_t nSize, uint32_t nToIp, uint16_t nRemotePort) {
 	assert(nHandle != -1);
 
@@ -24,6 +24,7 @@
  */
 
 #include <stdio.h>
+#include <assert.h>
 
 #include "network.h"
 
@@ -35,7 +36,8 @@ Network::Network(void) :
 	m_nNetmask(0),
 	m_nBroadcastIp(0),
 	m_IsDhcpCapable(true),
-	m_IsDhcpUsed(false)
+	m_IsDhcpUsed(false),
+	m_pRecvBuffer(0)
 {
 	s_pThis = this;
 
@@ -56,6 +58,11 @@ Network::~Network(void) {
 	m_IsDhcpUsed = false;
 	m_aHostName[0] = '\0';
 
+	if (m_pRecvBuffer != 0) {
+		delete[] m_pRecvBuffer;
+		m_pRecvBuffer = 0;
+	}
+
 	s_pThis = 0;
 }
 
@@ -69,3 +76,44 @@ void Network::Print(void) {
 		printf(" DHCP       : %s\n", m_IsDhcpUsed ? "Yes" : "No");
 	}
 }
+
+uint16_t Network::RecvFromBatch(uint32_t nHandle, struct TNetworkPacket *pPackets, uint16_t nCount) {
+	uint16_t nReceived;
+
+	for (nReceived = 0; nReceived < nCount; nReceived++) {
+		struct TNetworkPacket *p = &pPackets[nReceived];
+
+		p->nLength = RecvFrom(nHandle, p->pBuffer, p->nSize, &p->nFromIp, &p->nFromPort);
+
+		if (p->nLength == 0) {
+			break;
+		}
+	}
+
+	return nReceived;
+}
+
+uint16_t Network::RecvFromRef(uint32_t nHandle, uint8_t **ppPacket, uint32_t *pFromIp, uint16_t *pFromPort) {
+	assert(ppPacket != 0);
+
+	if (m_pRecvBuffer == 0) {
+		m_pRecvBuffer = new uint8_t[NETWORK_RECV_BUFFER_SIZE];
+		assert(m_pRecvBuffer != 0);
+	}
+
+	*ppPacket = m_pRecvBuffer;
+
+	return RecvFrom(nHandle, m_pRecvBuffer, NETWORK_RECV_BUFFER_SIZE, pFromIp, pFromPort);
+}
+
+void Network::RecvRelease(uint32_t nHandle) {
+	// The buffer is reused by the next RecvFromRef
+}
+
+int32_t Network::BeginQueue(uint16_t nPort, uint16_t nQueueDepth, TNetworkQueuePolicy tQueuePolicy) {
+	return Begin(nPort);
+}
+
+bool Network::GetQueueStats(uint32_t nHandle, struct TNetworkQueueStats *pStats) {
+	return false;
+}
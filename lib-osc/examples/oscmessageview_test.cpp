@@ -0,0 +1,232 @@
+/**
+ * @file oscmessageview_test.cpp
+ *
+ * Checks that OSCMessageView gives the results and arguments of OSCMessage,
+ * for valid and truncated messages, and times both.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "oscmessage.h"
+#include "oscmessageview.h"
+#include "oscblob.h"
+
+#define BUFFER_SIZE		1024
+#define MESSAGES		2000000
+
+static const uint8_t s_blob[] = {1, 2, 3, 4, 5};
+
+static unsigned padded(unsigned nLength) {
+	return 4 * (nLength / 4 + 1);
+}
+
+static void put_uint32(char *pBuffer, uint32_t nValue) {
+	nValue = __builtin_bswap32(nValue);
+	memcpy(pBuffer, &nValue, sizeof(uint32_t));
+}
+
+/*
+ * An OSC message with an int 42, a float 0.5, a string "hello" or a 5-byte blob per type tag
+ */
+static unsigned build(char *pBuffer, const char *pPath, const char *pTypes) {
+	unsigned nLength;
+	float f = 0.5f;
+	uint32_t u;
+
+	memset(pBuffer, 0, BUFFER_SIZE);
+
+	strcpy(pBuffer, pPath);
+	nLength = padded((unsigned) strlen(pPath));
+
+	strcpy(&pBuffer[nLength], pTypes);
+	nLength += padded((unsigned) strlen(pTypes));
+
+	for (const char *p = &pTypes[1]; *p != '\0'; p++) {
+		switch (*p) {
+		case 'i':
+			put_uint32(&pBuffer[nLength], 42);
+			nLength += 4;
+			break;
+		case 'f':
+			memcpy(&u, &f, sizeof(uint32_t));
+			put_uint32(&pBuffer[nLength], u);
+			nLength += 4;
+			break;
+		case 's':
+			strcpy(&pBuffer[nLength], "hello");
+			nLength += padded(5);
+			break;
+		case 'b':
+			put_uint32(&pBuffer[nLength], sizeof(s_blob));
+			memcpy(&pBuffer[nLength + 4], s_blob, sizeof(s_blob));
+			nLength += 4 + 8;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return nLength;
+}
+
+static bool compare(OSCMessage& message, const OSCMessageView& view) {
+	if (message.GetResult() != view.GetResult()) {
+		return false;
+	}
+
+	if (view.GetResult() != OSC_OK) {
+		return true;
+	}
+
+	if (message.GetArgc() != view.GetArgc()) {
+		return false;
+	}
+
+	for (unsigned i = 0; i < (unsigned) view.GetArgc(); i++) {
+		if (message.GetType(i) != view.GetType(i)) {
+			return false;
+		}
+
+		switch (view.GetType(i)) {
+		case OSC_INT32:
+			if (message.GetInt(i) != view.GetInt(i)) {
+				return false;
+			}
+			break;
+		case OSC_FLOAT:
+			if (message.GetFloat(i) != view.GetFloat(i)) {
+				return false;
+			}
+			break;
+		case OSC_STRING:
+			if (strcmp(message.GetString(i), view.GetString(i)) != 0) {
+				return false;
+			}
+			break;
+		case OSC_BLOB: {
+			OSCBlob blob = message.GetBlob(i);
+			OSCBlob blob_view = view.GetBlob(i);
+			if ((blob.GetDataSize() != blob_view.GetDataSize()) || (memcmp(blob.GetDataPtr(), blob_view.GetDataPtr(), sizeof(s_blob)) != 0)) {
+				return false;
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
+
+static double nanos(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+/*
+ * OSCMessage converts the arguments in place, so every message is built again.
+ * The time of building alone is subtracted.
+ */
+static void benchmark(void) {
+	char buffer[BUFFER_SIZE];
+	volatile float fSink = 0;
+	const unsigned nLength = build(buffer, "/dmx1", ",if");
+
+	double fStart = nanos();
+
+	for (unsigned i = 0; i < MESSAGES; i++) {
+		OSCMessage message(buffer, nLength);
+		fSink = fSink + message.GetFloat(1) + (float) message.GetInt(0);
+		build(buffer, "/dmx1", ",if");
+	}
+
+	const double fMessage = nanos() - fStart;
+
+	fStart = nanos();
+
+	for (unsigned i = 0; i < MESSAGES; i++) {
+		OSCMessageView view(buffer, nLength);
+		fSink = fSink + view.GetFloat(1) + (float) view.GetInt(0);
+		build(buffer, "/dmx1", ",if");
+	}
+
+	const double fView = nanos() - fStart;
+
+	fStart = nanos();
+
+	for (unsigned i = 0; i < MESSAGES; i++) {
+		build(buffer, "/dmx1", ",if");
+	}
+
+	const double fBuild = nanos() - fStart;
+
+	printf("OSCMessage     %6.2f M msg/s\n", MESSAGES / (fMessage - fBuild) * 1e3);
+	printf("OSCMessageView %6.2f M msg/s\n", MESSAGES / (fView - fBuild) * 1e3);
+}
+
+int main(int argc, char **argv) {
+	static const char *types[] = {",ii", ",if", ",f", ",b", ",s", ",sif", ","};
+	char buffer[BUFFER_SIZE];
+	char message_buffer[BUFFER_SIZE];
+	char view_buffer[BUFFER_SIZE];
+	int nErrors = 0;
+
+	// Truncated by 0, 1 and 4 bytes
+	static const unsigned truncate[] = {0, 1, 4};
+
+	for (unsigned t = 0; t < sizeof(truncate) / sizeof(truncate[0]); t++) {
+		for (unsigned i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+			const unsigned nLength = build(buffer, "/dmx1/12", types[i]) - truncate[t];
+
+			memcpy(message_buffer, buffer, BUFFER_SIZE);
+			memcpy(view_buffer, buffer, BUFFER_SIZE);
+
+			OSCMessage message(message_buffer, nLength);
+			OSCMessageView view(view_buffer, nLength);
+
+			const bool bEqual = compare(message, view);
+			const bool bUnchanged = (memcmp(buffer, view_buffer, BUFFER_SIZE) == 0);
+
+			if (!bEqual || !bUnchanged) {
+				printf("'%s' length %u: result %d/%d%s%s\n", types[i], nLength, message.GetResult(), view.GetResult(), bEqual ? "" : ", differs", bUnchanged ? "" : ", buffer modified");
+				nErrors++;
+			}
+		}
+	}
+
+	printf("oscmessageview_test: %d errors\n", nErrors);
+
+	if ((argc > 1) && (strcmp(argv[1], "-b") == 0)) {
+		benchmark();
+	}
+
+	return (nErrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
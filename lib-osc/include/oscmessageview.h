@@ -0,0 +1,83 @@
+/**
+ * @file oscmessageview.h
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef OSCMESSAGEVIEW_H_
+#define OSCMESSAGEVIEW_H_
+
+#include <stdint.h>
+
+#include "osc.h"
+#include "oscblob.h"
+#include "oscmessage.h"
+
+#define OSC_MESSAGE_VIEW_MAX_ARGS	16
+
+/**
+ * Read-only OSC message parsed in place over the receive buffer.
+ * Arguments are converted from network byte order when read, the buffer is not modified and no heap is used.
+ */
+class OSCMessageView {
+public:
+	OSCMessageView(const void *pData, unsigned nLength);
+	~OSCMessageView(void);
+
+	inline int GetResult(void) const {
+		return m_Result;
+	}
+
+	inline const char *GetPath(void) const {
+		return m_pPath;
+	}
+
+	inline int GetArgc(void) const {
+		return m_nArgc;
+	}
+
+	inline osc_type GetType(unsigned nArg) const {
+		if (nArg >= m_nArgc) {
+			return OSC_UNKNOWN;
+		}
+
+		return (osc_type) m_pTypes[nArg];
+	}
+
+	float GetFloat(unsigned nArg) const;
+	int GetInt(unsigned nArg) const;
+	const char *GetString(unsigned nArg) const;
+	OSCBlob GetBlob(unsigned nArg) const;
+
+private:
+	static int ArgValidate(osc_type, const char *, unsigned);
+	uint32_t GetUint32(unsigned nArg) const;
+
+private:
+	const char *m_pPath;
+	const char *m_pTypes;	///< Type tags without the leading ','
+	unsigned m_nArgc;
+	const char *m_pArgv[OSC_MESSAGE_VIEW_MAX_ARGS];
+	int m_Result;
+};
+
+#endif /* OSCMESSAGEVIEW_H_ */
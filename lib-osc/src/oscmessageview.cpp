@@ -0,0 +1,198 @@
+/**
+ * @file oscmessageview.cpp
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "oscmessageview.h"
+#include "oscmessage.h"
+#include "oscstring.h"
+#include "oscblob.h"
+#include "osc.h"
+
+typedef union pcast32 {
+	int32_t i;
+	float f;
+	uint32_t nl;
+} osc_pcast32;
+
+OSCMessageView::OSCMessageView(const void *pData, unsigned nLength) :
+	m_pPath(0),
+	m_pTypes(0),
+	m_nArgc(0),
+	m_Result(OSC_INTERNAL_ERROR)
+{
+	assert(pData != 0);
+
+	const char *p = (const char *) pData;
+	int remain = nLength;
+
+	if (nLength == 0) {
+		m_Result = OSC_INVALID__INVALID_SIZE;
+		return;
+	}
+
+	int len = OSCString::Validate((void *) p, remain);
+
+	if (len < 0) {
+		m_Result = OSC_INVALID_PATH;
+		return;
+	}
+
+	const char *pPath = p;
+	p += len;
+	remain -= len;
+
+	if (remain <= 0) {
+		m_Result = OSC_NO_TYPE_TAG;
+		return;
+	}
+
+	len = OSCString::Validate((void *) p, remain);
+
+	if (len < 0) {
+		m_Result = OSC_INVALID_TYPE;
+		return;
+	}
+
+	if (p[0] != ',') {
+		m_Result = OSC_INVALID_TYPE_TAG;
+		return;
+	}
+
+	const char *pTypes = p + 1;
+	const unsigned nArgc = strlen(pTypes);
+
+	if (nArgc > OSC_MESSAGE_VIEW_MAX_ARGS) {
+		m_Result = OSC_INVALID_ARGUMENT;
+		return;
+	}
+
+	p += len;
+	remain -= len;
+
+	for (unsigned i = 0; i < nArgc; i++) {
+		len = ArgValidate((osc_type) pTypes[i], p, remain);
+
+		if (len < 0) {
+			m_Result = OSC_INVALID_ARGUMENT;
+			return;
+		}
+
+		m_pArgv[i] = len ? p : 0;
+
+		p += len;
+		remain -= len;
+	}
+
+	if (remain != 0) {
+		m_Result = OSC_INVALID_SIZE;
+		return;
+	}
+
+	m_pPath = pPath;
+	m_pTypes = pTypes;
+	m_nArgc = nArgc;
+	m_Result = OSC_OK;
+}
+
+OSCMessageView::~OSCMessageView(void) {
+}
+
+int OSCMessageView::ArgValidate(osc_type type, const char *pData, unsigned nSize) {
+	switch (type) {
+	case OSC_TRUE:
+	case OSC_FALSE:
+	case OSC_NIL:
+	case OSC_INFINITUM:
+		return 0;
+	case OSC_INT32:
+	case OSC_FLOAT:
+	case OSC_MIDI:
+	case OSC_CHAR:
+		return nSize >= 4 ? 4 : -OSC_INVALID_SIZE;
+	case OSC_INT64:
+	case OSC_TIMETAG:
+	case OSC_DOUBLE:
+		return nSize >= 8 ? 8 : -OSC_INVALID_SIZE;
+	case OSC_STRING:
+	case OSC_SYMBOL:
+		return OSCString::Validate((void *) pData, nSize);
+	case OSC_BLOB:
+		if (nSize < 4) {
+			return -OSC_INVALID_SIZE;
+		}
+		return OSCBlob::Validate((void *) pData, nSize);
+	default:
+		return -OSC_INVALID_TYPE;
+	}
+
+	return -OSC_INTERNAL_ERROR;
+}
+
+uint32_t OSCMessageView::GetUint32(unsigned nArg) const {
+	const uint8_t *p = (const uint8_t *) m_pArgv[nArg];
+
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
+float OSCMessageView::GetFloat(unsigned nArg) const {
+	if ((nArg >= m_nArgc) || (m_pArgv[nArg] == 0)) {
+		return 0;
+	}
+
+	osc_pcast32 val32;
+	val32.nl = GetUint32(nArg);
+
+	return val32.f;
+}
+
+int OSCMessageView::GetInt(unsigned nArg) const {
+	if ((nArg >= m_nArgc) || (m_pArgv[nArg] == 0)) {
+		return 0;
+	}
+
+	osc_pcast32 val32;
+	val32.nl = GetUint32(nArg);
+
+	return val32.i;
+}
+
+const char *OSCMessageView::GetString(unsigned nArg) const {
+	if (nArg >= m_nArgc) {
+		return 0;
+	}
+
+	return m_pArgv[nArg];
+}
+
+OSCBlob OSCMessageView::GetBlob(unsigned nArg) const {
+	if ((nArg >= m_nArgc) || (m_pArgv[nArg] == 0)) {
+		return OSCBlob(0, 0);
+	}
+
+	return OSCBlob(m_pArgv[nArg] + 4, (int) GetUint32(nArg));
+}
@@ -0,0 +1,356 @@
+/**
+ * @file oscbundle_test.cpp
+ *
+ * Sends OSC bundles to OscServer over the loopback interface and checks
+ * what reaches the LightSet output.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "hardwarelinux.h"
+#include "networklinux.h"
+
+#include "oscserver.h"
+
+#include "lightset.h"
+
+#define PORT_INCOMING		18000
+#define PORT_OUTGOING		19000
+#define BUFFER_SIZE			1024
+#define HISTORY_SIZE		16
+#define NTP_UNIX_OFFSET		2208988800U
+#define IMMEDIATELY			0, 1	///< The OSC time tag for "immediately"
+
+class RecordingOutput: public LightSet {
+public:
+	RecordingOutput(void) {
+		Reset();
+	}
+
+	void Start(uint8_t nPort) {
+	}
+
+	void Stop(uint8_t nPort) {
+	}
+
+	void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength) {
+		memcpy(m_aData, pData, nLength);
+
+		if (m_nCalls < HISTORY_SIZE) {
+			m_aHistory[m_nCalls] = pData[6];
+		}
+
+		m_nCalls++;
+	}
+
+	void Reset(void) {
+		m_nCalls = 0;
+		memset(m_aHistory, 0, sizeof(m_aHistory));
+	}
+
+	uint32_t GetCalls(void) const {
+		return m_nCalls;
+	}
+
+	/**
+	 * @return Channel 7 in the output call nIndex
+	 */
+	uint8_t GetHistory(uint32_t nIndex) const {
+		return m_aHistory[nIndex];
+	}
+
+	uint8_t GetChannel(uint16_t nChannel) const {
+		return m_aData[nChannel - 1];
+	}
+
+private:
+	uint32_t m_nCalls;
+	uint8_t m_aHistory[HISTORY_SIZE];
+	uint8_t m_aData[512];
+};
+
+static OscServer *s_pServer;
+static RecordingOutput s_Output;
+static int s_nSocket;
+static int s_nErrors;
+
+static void check(bool bCondition, const char *pWhat) {
+	if (!bCondition) {
+		printf("FAIL: %s\n", pWhat);
+		s_nErrors++;
+	}
+}
+
+static void put_uint32(uint8_t *p, uint32_t nValue) {
+	p[0] = (uint8_t) (nValue >> 24);
+	p[1] = (uint8_t) (nValue >> 16);
+	p[2] = (uint8_t) (nValue >> 8);
+	p[3] = (uint8_t) nValue;
+}
+
+static uint32_t now(void) {
+	return (uint32_t) time(0) + NTP_UNIX_OFFSET;
+}
+
+/**
+ * /dmx1/N with one int argument
+ */
+static unsigned message(uint8_t *p, uint16_t nChannel, uint8_t nValue) {
+	memset(p, 0, 20);
+	snprintf((char *) p, 12, "/dmx1/%u", nChannel);
+
+	const unsigned nPath = 4 * (strlen((const char *) p) / 4 + 1);
+
+	memcpy(&p[nPath], ",i\0\0", 4);
+	put_uint32(&p[nPath + 4], nValue);
+
+	return nPath + 8;
+}
+
+static unsigned bundle(uint8_t *p, uint32_t nSeconds, uint32_t nFraction) {
+	memcpy(p, "#bundle\0", 8);
+	put_uint32(&p[8], nSeconds);
+	put_uint32(&p[12], nFraction);
+
+	return 16;
+}
+
+static unsigned element(uint8_t *p, const uint8_t *pContent, unsigned nLength) {
+	put_uint32(p, nLength);
+	memmove(&p[4], pContent, nLength);
+
+	return 4 + nLength;
+}
+
+/**
+ * A message for nChannel inside nLevels bundles
+ */
+static unsigned nest(uint8_t *p, unsigned nLevels, uint16_t nChannel, uint8_t nValue) {
+	uint8_t c[BUFFER_SIZE];
+	unsigned n = message(p, nChannel, nValue);
+
+	for (unsigned i = 0; i < nLevels; i++) {
+		unsigned nLength = bundle(c, IMMEDIATELY);
+		nLength += element(&c[nLength], p, n);
+		memcpy(p, c, nLength);
+		n = nLength;
+	}
+
+	return n;
+}
+
+/**
+ * @return what OscServer::Run returns for the datagram, a late /ping from Start is skipped
+ */
+static int send(const uint8_t *p, unsigned nLength) {
+	struct sockaddr_in si;
+
+	memset(&si, 0, sizeof(si));
+	si.sin_family = AF_INET;
+	si.sin_port = htons(PORT_INCOMING);
+	si.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	sendto(s_nSocket, p, nLength, 0, (struct sockaddr *) &si, sizeof(si));
+
+	const uint32_t nStart = Hardware::Get()->Millis();
+	int nResult;
+
+	do {
+		nResult = s_pServer->Run();
+	} while ((nResult != -1) && (nResult != (int) nLength) && ((Hardware::Get()->Millis() - nStart) < 1000));
+
+	return nResult;
+}
+
+static void test_immediate(void) {
+	uint8_t b[BUFFER_SIZE], m[64];
+	unsigned n;
+
+	// Flat, both channels in one output update
+	s_Output.Reset();
+	n = bundle(b, IMMEDIATELY);
+	n += element(&b[n], m, message(m, 1, 10));
+	n += element(&b[n], m, message(m, 2, 20));
+	send(b, n);
+
+	check((s_Output.GetChannel(1) == 10) && (s_Output.GetChannel(2) == 20), "flat: channels 1 and 2");
+	check(s_Output.GetCalls() == 1, "flat: one output update");
+
+	// Nested
+	uint8_t inner[64];
+	const unsigned nInner = bundle(inner, IMMEDIATELY);
+	const unsigned nInnerLength = nInner + element(&inner[nInner], m, message(m, 3, 30));
+
+	s_Output.Reset();
+	n = bundle(b, IMMEDIATELY);
+	n += element(&b[n], inner, nInnerLength);
+	n += element(&b[n], m, message(m, 4, 40));
+	send(b, n);
+
+	check((s_Output.GetChannel(3) == 30) && (s_Output.GetChannel(4) == 40), "nested: channels 3 and 4");
+	check(s_Output.GetCalls() == 1, "nested: one output update");
+
+	// Nested as deep as allowed, and one deeper
+	n = nest(b, OSCSERVER_BUNDLE_DEPTH_MAX, 5, 55);
+	send(b, n);
+
+	check(s_Output.GetChannel(5) == 55, "deepest: channel 5");
+
+	n = nest(b, OSCSERVER_BUNDLE_DEPTH_MAX + 1, 5, 99);
+	send(b, n);
+
+	check(s_Output.GetChannel(5) == 55, "too deep: channel 5 is not set");
+
+	// A time tag in the past and one beyond OSCSERVER_BUNDLE_DELAY_MAX_MILLIS are executed immediately
+	n = bundle(b, now() - 10, 0);
+	n += element(&b[n], m, message(m, 5, 50));
+	send(b, n);
+
+	check(s_Output.GetChannel(5) == 50, "past: channel 5");
+
+	n = bundle(b, now() + 3600, 0);
+	n += element(&b[n], m, message(m, 6, 60));
+	send(b, n);
+
+	check(s_Output.GetChannel(6) == 60, "far future: channel 6");
+}
+
+static void test_scheduled(void) {
+	uint8_t b[BUFFER_SIZE], m[64];
+	unsigned n;
+
+	n = bundle(b, now() + 2, 0);
+	n += element(&b[n], m, message(m, 8, 80));
+	send(b, n);
+
+	check(s_Output.GetChannel(8) != 80, "future: channel 8 waits for its time tag");
+
+	const uint32_t nStart = Hardware::Get()->Millis();
+
+	while ((s_Output.GetChannel(8) != 80) && ((Hardware::Get()->Millis() - nStart) < 4000)) {
+		s_pServer->Run();
+	}
+
+	check(s_Output.GetChannel(8) == 80, "future: channel 8 is set at its time tag");
+
+	// Two bundles that become due in the same Run, queued in the opposite order
+	const uint32_t nSeconds = now();
+
+	s_Output.Reset();
+
+	n = bundle(b, nSeconds + 3, 0);
+	n += element(&b[n], m, message(m, 7, 1));
+	send(b, n);
+
+	n = bundle(b, nSeconds + 2, 0);
+	n += element(&b[n], m, message(m, 7, 2));
+	send(b, n);
+
+	check(s_Output.GetCalls() == 0, "order: both bundles are scheduled");
+
+	usleep(4500 * 1000);
+	s_pServer->Run();
+
+	check(s_Output.GetCalls() == 2, "order: both bundles are executed");
+	check((s_Output.GetHistory(0) == 2) && (s_Output.GetHistory(1) == 1), "order: the earlier time tag is executed first");
+	check(s_Output.GetChannel(7) == 1, "order: the later time tag has the last word");
+}
+
+static void test_malformed(void) {
+	uint8_t b[BUFFER_SIZE], m[64];
+	unsigned n;
+
+	// The element after the valid one claims more bytes than there are
+	unsigned nSize;
+
+	n = bundle(b, IMMEDIATELY);
+	n += element(&b[n], m, message(m, 9, 90));
+	nSize = n;
+	n += element(&b[n], m, message(m, 10, 100));
+	put_uint32(&b[nSize], 64);
+	send(b, n);
+
+	check(s_Output.GetChannel(9) == 90, "truncated: the element before is executed");
+	check(s_Output.GetChannel(10) != 100, "truncated: the element is not executed");
+
+	n = bundle(b, IMMEDIATELY);
+	n += element(&b[n], m, message(m, 11, 110));
+	nSize = n;
+	n += element(&b[n], m, message(m, 12, 120));
+	put_uint32(&b[nSize], 0xFFFFFFF0);
+	send(b, n);
+
+	check(s_Output.GetChannel(11) == 110, "oversized: the element before is executed");
+	check(s_Output.GetChannel(12) != 120, "oversized: the element is not executed");
+
+	n = bundle(b, IMMEDIATELY);
+	n += element(&b[n], m, message(m, 13, 130));
+	put_uint32(&b[16], 6);
+	send(b, n);
+
+	check(s_Output.GetChannel(13) != 130, "unaligned size: the element is not executed");
+
+	// Shorter than "#bundle\0" and the time tag
+	bundle(b, IMMEDIATELY);
+	check(send(b, 10) == -1, "short header: rejected");
+}
+
+int main(int argc, char **argv) {
+	HardwareLinux hw;
+	NetworkLinux nw;
+	OscServer server;
+
+	if (nw.Init("lo") < 0) {
+		fprintf(stderr, "Not able to start the network on lo\n");
+		return EXIT_FAILURE;
+	}
+
+	if ((s_nSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0) {
+		perror("socket");
+		return EXIT_FAILURE;
+	}
+
+	s_pServer = &server;
+
+	server.SetPortIncoming(PORT_INCOMING);
+	server.SetPortOutgoing(PORT_OUTGOING);
+	server.SetOutput(&s_Output);
+	server.Start();
+
+	test_immediate();
+	test_malformed();
+	test_scheduled();
+
+	close(s_nSocket);
+
+	printf("oscbundle_test: %d errors\n", s_nErrors);
+
+	return (s_nErrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -27,6 +27,7 @@
 #define OSCSERVER_H_
 
 #include <stdint.h>
+#include <time.h>
 
 #include "lightset.h"
 
@@ -35,6 +36,17 @@
 
 #define OSCSERVER_PATH_LENGTH_MAX	128
 
+#define OSCSERVER_BUNDLE_QUEUE_SIZE			4		///< Bundles waiting for their time tag
+#define OSCSERVER_BUNDLE_DEPTH_MAX			4		///< Nested bundles
+#define OSCSERVER_BUNDLE_DELAY_MAX_MILLIS	60000	///< Later time tags are taken as unsynchronised clocks and executed immediately
+
+struct TOscServerBundle {
+	uint32_t nMillis;		///< Execution time, Hardware::Millis()
+	uint32_t nRemoteIp;
+	uint16_t nLength;		///< Length of the bundle elements, 0 is unused
+	uint8_t *pElements;
+};
+
 class OscServer {
 public:
 	OscServer(void);
@@ -64,6 +76,13 @@ public:
 private:
 	int GetChannel(const char *p);
 	bool IsDmxDataChanged(const uint8_t *pData, uint16_t nStartChannel, uint16_t nLength);
+	void SetLightSetData(uint16_t nLength);
+	int HandleMessage(const uint8_t *pMessage, unsigned nLength, uint32_t nRemoteIp);
+	int HandleBundle(const uint8_t *pBundle, unsigned nLength, uint32_t nRemoteIp, unsigned nDepth);
+	int HandleBundleElements(const uint8_t *pElements, unsigned nLength, uint32_t nRemoteIp, unsigned nDepth);
+	int32_t GetMillisUntil(uint32_t nSeconds, uint32_t nFraction);
+	bool ScheduleBundle(const uint8_t *pElements, unsigned nLength, uint32_t nRemoteIp, uint32_t nMillis);
+	void RunScheduledBundles(void);
 
 private:
 	uint16_t m_nPortIncoming;
@@ -71,12 +90,18 @@ private:
 	int32_t m_nHandle;
 	bool m_bPartialTransmission;
 	uint16_t m_nLastChannel;
+	uint16_t m_nFirstSlot;
+	uint16_t m_nLastSlot;
 	char m_aPath[OSCSERVER_PATH_LENGTH_MAX];
 	char m_aPathSecond[OSCSERVER_PATH_LENGTH_MAX];
 	LightSet *m_pLightSet;
 	uint8_t *m_pBuffer;
 	uint8_t *m_pData;
 	uint8_t *m_pOsc;
+	TOscServerBundle m_aBundles[OSCSERVER_BUNDLE_QUEUE_SIZE];
+	uint32_t m_nBundlesScheduled;
+	time_t m_nSecondsPrevious;
+	uint32_t m_nMillisAtSecond;	///< Millis() when Hardware::GetTime() last changed
 };
 
 #endif /* OSCSERVER_H_ */
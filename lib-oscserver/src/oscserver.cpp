@@ -30,12 +30,14 @@
 
 #include "oscserver.h"
 #include "osc.h"
-#include "oscmessage.h"
+#include "oscmessageview.h"
 #include "oscsend.h"
 #include "oscblob.h"
 
 #include "lightset.h"
+#include "lightsetdata.h"
 #include "network.h"
+#include "hardware.h"
 
 #include "debug.h"
 
@@ -44,6 +46,17 @@
 #define OSCSERVER_DEFAULT_PATH_PRIMARY		"/dmx1"
 #define OSCSERVER_DEFAULT_PATH_SECONDARY	OSCSERVER_DEFAULT_PATH_PRIMARY"/*"
 
+#define OSCSERVER_BUNDLE_TAG				"#bundle"
+#define OSCSERVER_BUNDLE_HEADER_SIZE		16		///< "#bundle\0" and time tag
+#define OSCSERVER_NTP_UNIX_OFFSET			2208988800U	///< Seconds from 1900 to 1970
+
+/**
+ * OSC is big-endian and the bundle fields are not 4-byte aligned in memory
+ */
+static inline uint32_t get_uint32(const uint8_t *p) {
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
 enum {
 	DMX_UNIVERSE = 512,
 	DMX_MAX_VALUE = 255
@@ -55,7 +68,12 @@ OscServer::OscServer(void):
 	m_nHandle(-1),
 	m_bPartialTransmission(false),
 	m_nLastChannel(0),
-	m_pLightSet(0)
+	m_nFirstSlot(LIGHTSET_SLOT_NONE),
+	m_nLastSlot(0),
+	m_pLightSet(0),
+	m_nBundlesScheduled(0),
+	m_nSecondsPrevious(0),
+	m_nMillisAtSecond(0)
 {
 	memset(m_aPath, 0, sizeof(m_aPath));
 	strcpy(m_aPath, OSCSERVER_DEFAULT_PATH_PRIMARY);
@@ -75,6 +93,14 @@ OscServer::OscServer(void):
 
 	m_pOsc  = new uint8_t[DMX_UNIVERSE];
 	assert(m_pOsc != 0);
+
+	for (unsigned i = 0; i < OSCSERVER_BUNDLE_QUEUE_SIZE; i++) {
+		m_aBundles[i].nMillis = 0;
+		m_aBundles[i].nRemoteIp = 0;
+		m_aBundles[i].nLength = 0;
+		m_aBundles[i].pElements = new uint8_t[OSCSERVER_MAX_BUFFER];
+		assert(m_aBundles[i].pElements != 0);
+	}
 }
 
 OscServer::~OscServer(void) {
@@ -87,6 +113,11 @@ OscServer::~OscServer(void) {
 	delete[] m_pOsc;
 	m_pOsc = 0;
 
+	for (unsigned i = 0; i < OSCSERVER_BUNDLE_QUEUE_SIZE; i++) {
+		delete[] m_aBundles[i].pElements;
+		m_aBundles[i].pElements = 0;
+	}
+
 	if (m_pLightSet != 0) {
 		m_pLightSet->Stop(0);
 		m_pLightSet = 0;
@@ -193,85 +224,105 @@ int OscServer::GetChannel(const char* p) {
 
 bool OscServer::IsDmxDataChanged(const uint8_t* pData, uint16_t nStartChannel, uint16_t nLength) {
 	assert(nLength <= DMX_UNIVERSE);
+	assert(nStartChannel + nLength - 1 <= DMX_UNIVERSE);
 
-	bool isChanged = false;
-
-	const uint8_t *src = pData;
-	uint8_t *dst = (uint8_t *)&m_pData[--nStartChannel];
+	uint16_t nFirstSlot = LIGHTSET_SLOT_NONE;
+	uint16_t nLastSlot = 0;
 
-	uint16_t nEnd = nStartChannel + nLength;
-
-	assert(nEnd <= DMX_UNIVERSE);
-
-	for (unsigned i = nStartChannel; i < nEnd; i++) {
-		if (*dst != *src) {
-			*dst = *src;
-			isChanged = true;
-		}
-		dst++;
-		src++;
+	if (!LightSetData::Copy(&m_pData[nStartChannel - 1], pData, nLength, nFirstSlot, nLastSlot)) {
+		return false;
 	}
 
-	return isChanged;
-}
+	LightSetData::Widen(m_nFirstSlot, m_nLastSlot, nStartChannel - 1 + nFirstSlot, nStartChannel - 1 + nLastSlot);
 
-int OscServer::Run(void) {
-	uint32_t nRemoteIp;
-	uint16_t nRemotePort;
+	return true;
+}
 
-	const int nBytesReceived = Network::Get()->RecvFrom(m_nHandle, m_pBuffer, OSCSERVER_MAX_BUFFER, &nRemoteIp, &nRemotePort);
+void OscServer::SetLightSetData(uint16_t nLength) {
+	m_pLightSet->SetDataRange(0, m_pData, nLength, m_nFirstSlot, m_nLastSlot);
+	LightSetData::Clear(m_nFirstSlot, m_nLastSlot);
+}
 
-	if (nBytesReceived == 0) {
+int OscServer::HandleMessage(const uint8_t *pMessage, unsigned nLength, uint32_t nRemoteIp) {
+	if (OSC::isMatch((const char*) pMessage, "/ping")) {
+		DEBUG_PUTS("ping received");
+		OSCSend MsgSend(m_nHandle, nRemoteIp, m_nPortOutgoing, "/pong", 0);
 		return 0;
 	}
 
-	if (OSC::isMatch((const char*) m_pBuffer, "/ping")) {
-		DEBUG_PUTS("ping received");
-		OSCSend MsgSend(m_nHandle, nRemoteIp, m_nPortOutgoing, "/pong", 0);
-	} else {
-		OSCMessage Msg((char *) m_pBuffer, nBytesReceived);
+	OSCMessageView Msg(pMessage, nLength);
 
-		DEBUG_PRINTF("[%d] path : %s", nBytesReceived, OSC::GetPath((char*) m_pBuffer, nBytesReceived));
+	DEBUG_PRINTF("[%d] path : %s", nLength, OSC::GetPath((char*) pMessage, nLength));
 
-		if (OSC::isMatch((const char*) m_pBuffer, m_aPath)) {
-			const int nArgc = Msg.GetArgc();
+	if (OSC::isMatch((const char*) pMessage, m_aPath)) {
+		const int nArgc = Msg.GetArgc();
 
-			if ((nArgc == 1) && (Msg.GetType(0) == OSC_BLOB)) {
-				DEBUG_PUTS("Blob received");
+		if ((nArgc == 1) && (Msg.GetType(0) == OSC_BLOB)) {
+			DEBUG_PUTS("Blob received");
 
-				OSCBlob blob = Msg.GetBlob(0);
-				const int size = (int) blob.GetDataSize();
+			OSCBlob blob = Msg.GetBlob(0);
+			const int size = (int) blob.GetDataSize();
 
-				if (size <= DMX_UNIVERSE) {
-					const uint8_t *ptr = (const uint8_t *) blob.GetDataPtr();
-					if (IsDmxDataChanged(ptr, 1, size)) {
-						if ((!m_bPartialTransmission) || (size == DMX_UNIVERSE)) {
-							m_pLightSet->SetData(0, m_pData, DMX_UNIVERSE);
-						} else {
-							m_nLastChannel = size > m_nLastChannel ? size : m_nLastChannel;
-							m_pLightSet->SetData(0, m_pData, m_nLastChannel);
-						}
+			if (size <= DMX_UNIVERSE) {
+				const uint8_t *ptr = (const uint8_t *) blob.GetDataPtr();
+				if (IsDmxDataChanged(ptr, 1, size)) {
+					if ((!m_bPartialTransmission) || (size == DMX_UNIVERSE)) {
+						return DMX_UNIVERSE;
+					} else {
+						m_nLastChannel = size > m_nLastChannel ? size : m_nLastChannel;
+						return m_nLastChannel;
 					}
-				} else {
-					DEBUG_PUTS("Too many channels");
-					return -1;
 				}
-			} else if ((nArgc == 2) && (Msg.GetType(0) == OSC_INT32)) {
-				uint16_t nChannel = (uint16_t) (1 + Msg.GetInt(0));
+			} else {
+				DEBUG_PUTS("Too many channels");
+				return -1;
+			}
+		} else if ((nArgc == 2) && (Msg.GetType(0) == OSC_INT32)) {
+			uint16_t nChannel = (uint16_t) (1 + Msg.GetInt(0));
 
-				if ((nChannel < 1) || (nChannel > DMX_UNIVERSE)) {
-					DEBUG_PRINTF("Invalid channel [%d]", nChannel);
-					return -1;
+			if ((nChannel < 1) || (nChannel > DMX_UNIVERSE)) {
+				DEBUG_PRINTF("Invalid channel [%d]", nChannel);
+				return -1;
+			}
+
+			uint8_t nData;
+
+			if (Msg.GetType(1) == OSC_INT32) {
+				DEBUG_PUTS("ii received");
+				nData = (uint8_t) Msg.GetInt(1);
+			} else if (Msg.GetType(1) == OSC_FLOAT) {
+				DEBUG_PUTS("if received");
+				nData = (uint8_t) (Msg.GetFloat(1) * DMX_MAX_VALUE);
+			} else {
+				return -1;
+			}
+
+			DEBUG_PRINTF("Channel = %d, Data = %.2x", nChannel, nData);
+
+			if (IsDmxDataChanged(&nData, nChannel, 1)) {
+				if (!m_bPartialTransmission) {
+					return DMX_UNIVERSE;
+				} else {
+					m_nLastChannel = nChannel > m_nLastChannel ? nChannel : m_nLastChannel;
+					return m_nLastChannel;
 				}
+			}
+		}
+	} else if (OSC::isMatch((const char*) pMessage, m_aPathSecond)) {
+		const int nArgc = Msg.GetArgc();
+
+		if (nArgc == 1) { // /path/N 'i' or 'f'
+			const uint16_t nChannel = GetChannel((const char*) pMessage);
 
+			if (nChannel >= 1 && nChannel <= DMX_UNIVERSE) {
 				uint8_t nData;
 
-				if (Msg.GetType(1) == OSC_INT32) {
-					DEBUG_PUTS("ii received");
-					nData = (uint8_t) Msg.GetInt(1);
-				} else if (Msg.GetType(1) == OSC_FLOAT) {
-					DEBUG_PUTS("if received");
-					nData = (uint8_t) (Msg.GetFloat(1) * DMX_MAX_VALUE);
+				if (Msg.GetType(0) == OSC_INT32) {
+					DEBUG_PUTS("i received");
+					nData = (uint8_t) Msg.GetInt(0);
+				} else if (Msg.GetType(0) == OSC_FLOAT) {
+					DEBUG_PUTS("f received");
+					nData = (uint8_t) (Msg.GetFloat(0) * DMX_MAX_VALUE);
 				} else {
 					return -1;
 				}
@@ -280,51 +331,204 @@ int OscServer::Run(void) {
 
 				if (IsDmxDataChanged(&nData, nChannel, 1)) {
 					if (!m_bPartialTransmission) {
-						m_pLightSet->SetData(0, m_pData, DMX_UNIVERSE);
+						return DMX_UNIVERSE;
 					} else {
 						m_nLastChannel = nChannel > m_nLastChannel ? nChannel : m_nLastChannel;
-						m_pLightSet->SetData(0, m_pData, m_nLastChannel);
+						return m_nLastChannel;
 					}
 				}
+			} else {
+				return -1;
 			}
-		} else if (OSC::isMatch((const char*) m_pBuffer, m_aPathSecond)) {
-			const int nArgc = Msg.GetArgc();
+		} else {
+			return -1;
+		}
+	}
 
-			if (nArgc == 1) { // /path/N 'i' or 'f'
-				const uint16_t nChannel = GetChannel((const char*) m_pBuffer);
+	return 0;
+}
 
-				if (nChannel >= 1 && nChannel <= DMX_UNIVERSE) {
-					uint8_t nData;
+/**
+ * Returns the milliseconds until the OSC time tag, 0 for "immediately" or a time tag in the past
+ */
+int32_t OscServer::GetMillisUntil(uint32_t nSeconds, uint32_t nFraction) {
+	if ((nSeconds == 0) && (nFraction <= 1)) {
+		return 0;
+	}
 
-					if (Msg.GetType(0) == OSC_INT32) {
-						DEBUG_PUTS("i received");
-						nData = (uint8_t) Msg.GetInt(0);
-					} else if (Msg.GetType(0) == OSC_FLOAT) {
-						DEBUG_PUTS("f received");
-						nData = (uint8_t) (Msg.GetFloat(0) * DMX_MAX_VALUE);
-					} else {
-						return -1;
-					}
+	const uint32_t nNowSeconds = (uint32_t) m_nSecondsPrevious + OSCSERVER_NTP_UNIX_OFFSET;
+	uint32_t nNowMillis = Hardware::Get()->Millis() - m_nMillisAtSecond;
 
-					DEBUG_PRINTF("Channel = %d, Data = %.2x", nChannel, nData);
+	if (nNowMillis > 999) {
+		nNowMillis = 999;
+	}
 
-					if (IsDmxDataChanged(&nData, nChannel, 1)) {
-						if (!m_bPartialTransmission) {
-							m_pLightSet->SetData(0, m_pData, DMX_UNIVERSE);
-						} else {
-							m_nLastChannel = nChannel > m_nLastChannel ? nChannel : m_nLastChannel;
-							m_pLightSet->SetData(0, m_pData, m_nLastChannel);
-						}
-					}
-				} else {
-					return -1;
-				}
-			} else {
-				return -1;
+	const int32_t nDeltaSeconds = (int32_t) (nSeconds - nNowSeconds);
+
+	if (nDeltaSeconds < 0) {
+		return 0;
+	}
+
+	if (nDeltaSeconds > (OSCSERVER_BUNDLE_DELAY_MAX_MILLIS / 1000)) {
+		return 0;
+	}
+
+	const int32_t nMillis = (nDeltaSeconds * 1000) + (int32_t) (((uint64_t) nFraction * 1000) >> 32) - (int32_t) nNowMillis;
+
+	return nMillis > 0 ? nMillis : 0;
+}
+
+bool OscServer::ScheduleBundle(const uint8_t *pElements, unsigned nLength, uint32_t nRemoteIp, uint32_t nMillis) {
+	for (unsigned i = 0; i < OSCSERVER_BUNDLE_QUEUE_SIZE; i++) {
+		if (m_aBundles[i].nLength == 0) {
+			memcpy(m_aBundles[i].pElements, pElements, nLength);
+			m_aBundles[i].nMillis = nMillis;
+			m_aBundles[i].nRemoteIp = nRemoteIp;
+			m_aBundles[i].nLength = nLength;
+			m_nBundlesScheduled++;
+			return true;
+		}
+	}
+
+	DEBUG_PUTS("Bundle queue full");
+	return false;
+}
+
+/**
+ * Returns the LightSet length to be updated (0 when nothing changed) or -1 for a malformed bundle
+ */
+int OscServer::HandleBundle(const uint8_t *pBundle, unsigned nLength, uint32_t nRemoteIp, unsigned nDepth) {
+	if ((nLength < OSCSERVER_BUNDLE_HEADER_SIZE) || (memcmp(pBundle, OSCSERVER_BUNDLE_TAG, sizeof(OSCSERVER_BUNDLE_TAG)) != 0)) {
+		return -1;
+	}
+
+	if (nDepth >= OSCSERVER_BUNDLE_DEPTH_MAX) {
+		DEBUG_PUTS("Bundle nested too deep");
+		return -1;
+	}
+
+	const uint32_t nSeconds = get_uint32(&pBundle[8]);
+	const uint32_t nFraction = get_uint32(&pBundle[12]);
+
+	const int32_t nMillis = GetMillisUntil(nSeconds, nFraction);
+
+	if (nMillis > 0) {
+		if (ScheduleBundle(&pBundle[OSCSERVER_BUNDLE_HEADER_SIZE], nLength - OSCSERVER_BUNDLE_HEADER_SIZE, nRemoteIp, Hardware::Get()->Millis() + nMillis)) {
+			return 0;
+		}
+	}
+
+	return HandleBundleElements(&pBundle[OSCSERVER_BUNDLE_HEADER_SIZE], nLength - OSCSERVER_BUNDLE_HEADER_SIZE, nRemoteIp, nDepth);
+}
+
+int OscServer::HandleBundleElements(const uint8_t *pElements, unsigned nLength, uint32_t nRemoteIp, unsigned nDepth) {
+	int nLightSetLength = 0;
+
+	while (nLength >= 4) {
+		const uint32_t nSize = get_uint32(pElements);
+
+		pElements += 4;
+		nLength -= 4;
+
+		if ((nSize == 0) || ((nSize & 3) != 0) || (nSize > nLength)) {
+			DEBUG_PRINTF("Invalid bundle element size %u", (unsigned) nSize);
+			break;
+		}
+
+		int nResult;
+
+		if (pElements[0] == '#') {
+			nResult = HandleBundle(pElements, nSize, nRemoteIp, nDepth + 1);
+		} else {
+			nResult = HandleMessage(pElements, nSize, nRemoteIp);
+		}
+
+		if (nResult > nLightSetLength) {
+			nLightSetLength = nResult;
+		}
+
+		pElements += nSize;
+		nLength -= nSize;
+	}
+
+	return nLightSetLength;
+}
+
+/**
+ * The due bundles are executed in time tag order, not in queue order
+ */
+void OscServer::RunScheduledBundles(void) {
+	const uint32_t nNow = Hardware::Get()->Millis();
+
+	for (;;) {
+		TOscServerBundle *pBundle = 0;
+
+		for (unsigned i = 0; i < OSCSERVER_BUNDLE_QUEUE_SIZE; i++) {
+			TOscServerBundle *p = &m_aBundles[i];
+
+			if ((p->nLength == 0) || ((int32_t) (nNow - p->nMillis) < 0)) {
+				continue;
 			}
+
+			if ((pBundle == 0) || ((int32_t) (p->nMillis - pBundle->nMillis) < 0)) {
+				pBundle = p;
+			}
+		}
+
+		if (pBundle == 0) {
+			return;
 		}
+
+		const unsigned nLength = pBundle->nLength;
+
+		pBundle->nLength = 0;
+		m_nBundlesScheduled--;
+
+		const int nLightSetLength = HandleBundleElements(pBundle->pElements, nLength, pBundle->nRemoteIp, 0);
+
+		if (nLightSetLength > 0) {
+			SetLightSetData(nLightSetLength);
+		}
+	}
+}
+
+int OscServer::Run(void) {
+	uint32_t nRemoteIp;
+	uint16_t nRemotePort;
+
+	const time_t nSeconds = Hardware::Get()->GetTime();
+
+	if (nSeconds != m_nSecondsPrevious) {
+		m_nSecondsPrevious = nSeconds;
+		m_nMillisAtSecond = Hardware::Get()->Millis();
+	}
+
+	if (m_nBundlesScheduled != 0) {
+		RunScheduledBundles();
+	}
+
+	const int nBytesReceived = Network::Get()->RecvFrom(m_nHandle, m_pBuffer, OSCSERVER_MAX_BUFFER, &nRemoteIp, &nRemotePort);
+
+	if (nBytesReceived == 0) {
+		return 0;
+	}
+
+	int nLightSetLength;
+
+	if (m_pBuffer[0] == '#') {
+		// All the channel updates in a bundle result in a single LightSet update
+		nLightSetLength = HandleBundle(m_pBuffer, nBytesReceived, nRemoteIp, 0);
+	} else {
+		nLightSetLength = HandleMessage(m_pBuffer, nBytesReceived, nRemoteIp);
+	}
+
+	if (nLightSetLength < 0) {
+		return -1;
+	}
+
+	if (nLightSetLength > 0) {
+		SetLightSetData(nLightSetLength);
 	}
 
 	return nBytesReceived;
 }
-
@@ -0,0 +1,77 @@
+/**
+ * @file pca9685simulation.h
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LINUX_PCA9685SIMULATION_H_
+#define LINUX_PCA9685SIMULATION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The subset of the bcm2835 I2C API used by PCA9685
+ */
+#define BCM2835_I2C_CLOCK_DIVIDER_626	626
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int bcm2835_init(void);
+extern void bcm2835_delayMicroseconds(uint64_t);
+
+extern void bcm2835_i2c_begin(void);
+extern void bcm2835_i2c_setSlaveAddress(uint8_t);
+extern void bcm2835_i2c_setClockDivider(uint16_t);
+extern uint8_t bcm2835_i2c_write(const char *, uint32_t);
+extern uint8_t bcm2835_i2c_read(char *, uint32_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+struct TPCA9685SimulationStats {
+	uint32_t nSetup;		///< setSlaveAddress and setClockDivider calls
+	uint32_t nTransactions;	///< START to STOP, write and read
+	uint32_t nBytes;		///< Bytes on the bus, the slave address byte included
+};
+
+/**
+ * A simulated I2C bus with a PCA9685 on every address.
+ * The devices keep their registers and follow the MODE1 Auto-Increment bit.
+ */
+class PCA9685Simulation {
+public:
+	static void Reset(void);
+
+	/**
+	 * @return The output duty cycle of the channel, 0 to 4096, as the LEDn registers define it
+	 */
+	static uint16_t GetOutput(uint8_t nAddress, uint8_t nChannel);
+
+	static void GetStats(struct TPCA9685SimulationStats *pStats);
+	static void ResetStats(void);
+};
+
+#endif /* LINUX_PCA9685SIMULATION_H_ */
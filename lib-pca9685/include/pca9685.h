@@ -77,6 +77,12 @@ public:
 	void Write(uint16_t, uint16_t);
 	void Read(uint16_t *, uint16_t *);
 
+	/**
+	 * Writes consecutive LEDn channels in one Auto-Increment transfer.
+	 * Channel 16 is ALL_LED, with a count of 1.
+	 */
+	void Write(uint8_t nChannel, const uint16_t *pOn, const uint16_t *pOff, uint8_t nCount);
+
 	void Write(uint8_t, uint16_t);
 	void Write(uint16_t);
 
@@ -103,6 +109,7 @@ private:
 	uint16_t I2cReadReg16(uint8_t);
 
 	void I2cWriteReg(uint8_t, uint16_t, uint16_t);
+	void I2cWriteReg(uint8_t, const uint16_t *, const uint16_t *, uint8_t);
 
 private:
 	uint8_t m_nAddress;
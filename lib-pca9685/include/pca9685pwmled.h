@@ -40,6 +40,11 @@ public:
 	void Set(uint8_t nChannel, uint16_t nData);
 	void Set(uint8_t nChannel, uint8_t nData);
 
+	/**
+	 * Sets nCount consecutive channels in one I2C transaction. Channel 16 is ALL_LED.
+	 */
+	void Set(uint8_t nChannel, const uint8_t *pData, uint8_t nCount);
+
 private:
 };
 
@@ -0,0 +1,221 @@
+/**
+ * @file pca9685simulation.cpp
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * A recording I2C backend, so that the PCA9685 bus traffic can be measured
+ * on a Linux host. Every slave address holds a simulated PCA9685 that keeps
+ * its registers, follows the MODE1 Auto-Increment bit and loads all LEDn
+ * registers on a write to the ALL_LED registers.
+ */
+
+#if defined(__linux__) && !defined(RASPPI)
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "linux/pca9685simulation.h"
+
+#define SIMULATION_ADDRESSES	128
+#define SIMULATION_REGISTERS	256
+
+#define REG_MODE1			0x00
+#define REG_MODE2			0x01
+#define REG_LED0_ON_L		0x06
+#define REG_LED15_OFF_H		0x45
+#define REG_ALL_LED_ON_L	0xFA
+#define REG_ALL_LED_OFF_H	0xFD
+#define REG_PRE_SCALE		0xFE
+
+#define MODE1_SLEEP			(1 << 4)
+#define MODE1_AI			(1 << 5)
+
+#define LED_FULL			0x10	///< Bit 4 of LEDn_ON_H and LEDn_OFF_H
+
+struct TPCA9685Device {
+	uint8_t Registers[SIMULATION_REGISTERS];
+	uint8_t nPointer;
+};
+
+static struct TPCA9685Device s_Devices[SIMULATION_ADDRESSES];
+static struct TPCA9685SimulationStats s_Stats;
+static uint8_t s_nAddress;
+static bool s_IsInitialized;
+
+static void reset(struct TPCA9685Device *pDevice) {
+	memset(pDevice, 0, sizeof(struct TPCA9685Device));
+
+	pDevice->Registers[REG_MODE1] = 0x11;	// SLEEP, ALLCALL
+	pDevice->Registers[REG_MODE2] = 0x04;	// OUTDRV
+	pDevice->Registers[REG_PRE_SCALE] = 0x1E;
+
+	for (uint32_t i = 0; i < 16; i++) {
+		pDevice->Registers[REG_LED0_ON_L + 3 + (i << 2)] = LED_FULL;
+	}
+}
+
+static void init(void) {
+	if (s_IsInitialized) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < SIMULATION_ADDRESSES; i++) {
+		reset(&s_Devices[i]);
+	}
+
+	s_IsInitialized = true;
+}
+
+static void write_register(struct TPCA9685Device *pDevice, uint8_t nRegister, uint8_t nData) {
+	if ((nRegister >= REG_ALL_LED_ON_L) && (nRegister <= REG_ALL_LED_OFF_H)) {
+		// The ALL_LED registers are write only, they load the same byte of every LEDn
+		for (uint32_t i = 0; i < 16; i++) {
+			pDevice->Registers[REG_LED0_ON_L + (nRegister - REG_ALL_LED_ON_L) + (i << 2)] = nData;
+		}
+		return;
+	}
+
+	if ((nRegister == REG_PRE_SCALE) && ((pDevice->Registers[REG_MODE1] & MODE1_SLEEP) == 0)) {
+		return;	// PRE_SCALE can only be set when SLEEP is set
+	}
+
+	if ((nRegister > REG_LED15_OFF_H) && (nRegister < REG_ALL_LED_ON_L)) {
+		return;	// Reserved
+	}
+
+	pDevice->Registers[nRegister] = nData;
+}
+
+static void next_register(struct TPCA9685Device *pDevice) {
+	if (pDevice->Registers[REG_MODE1] & MODE1_AI) {
+		pDevice->nPointer++;
+	}
+}
+
+extern "C" {
+
+int bcm2835_init(void) {
+	init();
+	return 1;
+}
+
+void bcm2835_delayMicroseconds(uint64_t nMicros) {
+}
+
+void bcm2835_i2c_begin(void) {
+	init();
+}
+
+void bcm2835_i2c_setSlaveAddress(uint8_t nAddress) {
+	assert(nAddress < SIMULATION_ADDRESSES);
+
+	s_nAddress = nAddress;
+	s_Stats.nSetup++;
+}
+
+void bcm2835_i2c_setClockDivider(uint16_t nDivider) {
+	s_Stats.nSetup++;
+}
+
+uint8_t bcm2835_i2c_write(const char *pBuffer, uint32_t nLength) {
+	assert(pBuffer != 0);
+	assert(nLength != 0);
+
+	init();
+
+	struct TPCA9685Device *pDevice = &s_Devices[s_nAddress];
+
+	pDevice->nPointer = (uint8_t) pBuffer[0];
+
+	for (uint32_t i = 1; i < nLength; i++) {
+		write_register(pDevice, pDevice->nPointer, (uint8_t) pBuffer[i]);
+		next_register(pDevice);
+	}
+
+	s_Stats.nTransactions++;
+	s_Stats.nBytes += 1 + nLength;
+
+	return 0;
+}
+
+uint8_t bcm2835_i2c_read(char *pBuffer, uint32_t nLength) {
+	assert(pBuffer != 0);
+
+	init();
+
+	struct TPCA9685Device *pDevice = &s_Devices[s_nAddress];
+
+	for (uint32_t i = 0; i < nLength; i++) {
+		const uint8_t nRegister = pDevice->nPointer;
+		const bool isAllLed = (nRegister >= REG_ALL_LED_ON_L) && (nRegister <= REG_ALL_LED_OFF_H);
+
+		pBuffer[i] = isAllLed ? 0 : (char) pDevice->Registers[nRegister];
+		next_register(pDevice);
+	}
+
+	s_Stats.nTransactions++;
+	s_Stats.nBytes += 1 + nLength;
+
+	return 0;
+}
+
+}
+
+void PCA9685Simulation::Reset(void) {
+	s_IsInitialized = false;
+	init();
+}
+
+uint16_t PCA9685Simulation::GetOutput(uint8_t nAddress, uint8_t nChannel) {
+	assert(nAddress < SIMULATION_ADDRESSES);
+	assert(nChannel < 16);
+
+	const uint8_t *pLed = &s_Devices[nAddress].Registers[REG_LED0_ON_L + (nChannel << 2)];
+
+	if (pLed[3] & LED_FULL) {
+		return 0;	// Full OFF has priority
+	}
+
+	if (pLed[1] & LED_FULL) {
+		return 4096;
+	}
+
+	const uint16_t nOn = (uint16_t) ((pLed[1] & 0x0F) << 8) | pLed[0];
+	const uint16_t nOff = (uint16_t) ((pLed[3] & 0x0F) << 8) | pLed[2];
+
+	return (uint16_t) ((nOff - nOn) & 0x0FFF);
+}
+
+void PCA9685Simulation::GetStats(struct TPCA9685SimulationStats *pStats) {
+	assert(pStats != 0);
+
+	memcpy(pStats, &s_Stats, sizeof(struct TPCA9685SimulationStats));
+}
+
+void PCA9685Simulation::ResetStats(void) {
+	memset(&s_Stats, 0, sizeof(struct TPCA9685SimulationStats));
+}
+
+#endif
@@ -29,11 +29,13 @@
 #endif
 #include <assert.h>
 
-#include "bcm2835.h"
-
-#if defined(__linux__)
+#if defined(__linux__) && !defined(RASPPI)
+ #include "linux/pca9685simulation.h"
 #else
- #include "bcm2835_i2c.h"
+ #include "bcm2835.h"
+ #if !defined(__linux__)
+  #include "bcm2835_i2c.h"
+ #endif
 #endif
 
 #include "pca9685.h"
@@ -219,6 +221,24 @@ void PCA9685::Write(uint8_t nChannel, uint16_t nValue) {
 	Write (nChannel, (uint16_t) 0, nValue);
 }
 
+void PCA9685::Write(uint8_t nChannel, const uint16_t *pOn, const uint16_t *pOff, uint8_t nCount) {
+	assert(pOn != 0);
+	assert(pOff != 0);
+	assert(nCount != 0);
+
+	uint8_t reg;
+
+	if (nChannel <= 15) {
+		assert(nChannel + nCount <= PCA9685_PWM_CHANNELS);
+		reg = PCA9685_REG_LED0_ON_L + (nChannel << 2);
+	} else {
+		assert(nCount == 1);
+		reg = PCA9685_REG_ALL_LED_ON_L;
+	}
+
+	I2cWriteReg(reg, pOn, pOff, nCount);
+}
+
 void PCA9685::Write(uint16_t nOn, uint16_t nOff) {
 	Write((uint8_t) 16, nOn, nOff);
 }
@@ -443,3 +463,21 @@ void PCA9685::I2cWriteReg(uint8_t reg, uint16_t data, uint16_t data2) {
 	bcm2835_i2c_write((char *) buffer, 5);
 }
 
+void PCA9685::I2cWriteReg(uint8_t reg, const uint16_t *pOn, const uint16_t *pOff, uint8_t nCount) {
+	uint8_t buffer[1 + (PCA9685_PWM_CHANNELS * 4)];
+	uint8_t *p = &buffer[1];
+
+	buffer[0] = reg;
+
+	for (uint8_t i = 0; i < nCount; i++) {
+		*p++ = (uint8_t) (pOn[i] & 0xFF);
+		*p++ = (uint8_t) (pOn[i] >> 8);
+		*p++ = (uint8_t) (pOff[i] & 0xFF);
+		*p++ = (uint8_t) (pOff[i] >> 8);
+	}
+
+	I2cSetup();
+
+	bcm2835_i2c_write((char *) buffer, 1 + (4 * nCount));
+}
+
@@ -24,6 +24,7 @@
  */
 
 #include <stdint.h>
+#include <assert.h>
 
 #include "pca9685pwmled.h"
 
@@ -59,3 +60,29 @@ void PCA9685PWMLed::Set(uint8_t nChannel, uint8_t nData) {
 		Write(nChannel, nValue);
 	}
 }
+
+void PCA9685PWMLed::Set(uint8_t nChannel, const uint8_t *pData, uint8_t nCount) {
+	assert(pData != 0);
+	assert(nCount <= PCA9685_PWM_CHANNELS);
+
+	uint16_t On[PCA9685_PWM_CHANNELS];
+	uint16_t Off[PCA9685_PWM_CHANNELS];
+
+	// The full LEDn register contents, so no read-modify-write of the ON/OFF bits
+	for (uint8_t i = 0; i < nCount; i++) {
+		const uint8_t nData = pData[i];
+
+		if (nData == MAX_8BIT) {
+			On[i] = 0x1000;
+			Off[i] = 0;
+		} else if (nData == 0) {
+			On[i] = 0;
+			Off[i] = 0x1000;
+		} else {
+			On[i] = 0;
+			Off[i] = (uint16_t) (nData << 4) | (uint16_t) (nData >> 4);
+		}
+	}
+
+	Write(nChannel, On, Off, nCount);
+}
@@ -0,0 +1,168 @@
+/**
+ * @file dmxled_bench.cpp
+ *
+ * I2C traffic of PCA9685DmxLed::SetData on the simulated bus, against one PCA9685PWMLed::Set per changed channel.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "pca9685dmxled.h"
+#include "pca9685pwmled.h"
+
+#include "linux/pca9685simulation.h"
+
+#define BOARDS		8
+#define CHANNELS	(BOARDS * PCA9685_PWM_CHANNELS)
+#define FRAMES		100
+
+static uint8_t s_DmxData[512];
+static uint8_t s_DmxPrevious[CHANNELS];
+
+static int s_nErrors;
+
+static void next_frame(int nTest, int nFrame) {
+	switch (nTest) {
+	case 0:
+		memset(s_DmxData, (nFrame * 7) & 0xFF, CHANNELS);
+		break;
+	case 1:
+		for (int i = 0; i < CHANNELS; i++) {
+			s_DmxData[i] = (uint8_t) (nFrame * 3 + i * 11);
+		}
+		break;
+	case 2:
+		for (int nFixture = 0; nFixture < BOARDS; nFixture++) {
+			for (int i = 0; i < 3; i++) {
+				s_DmxData[nFixture * PCA9685_PWM_CHANNELS + i] = (uint8_t) rand();
+			}
+		}
+		break;
+	default:
+		for (int i = 0; i < 10; i++) {
+			s_DmxData[rand() % CHANNELS] = (uint8_t) rand();
+		}
+		break;
+	}
+}
+
+// PCA9685DmxLed::SetData before the burst writes: one Set per changed channel
+static void set_per_channel(PCA9685PWMLed **pPWMLed) {
+	for (int i = 0; i < CHANNELS; i++) {
+		if (s_DmxData[i] != s_DmxPrevious[i]) {
+			pPWMLed[i / PCA9685_PWM_CHANNELS]->Set(CHANNEL(i % PCA9685_PWM_CHANNELS), s_DmxData[i]);
+			s_DmxPrevious[i] = s_DmxData[i];
+		}
+	}
+}
+
+static uint32_t check_outputs(uint32_t nHash) {
+	for (int i = 0; i < CHANNELS; i++) {
+		const uint8_t nData = s_DmxData[i];
+		const uint16_t nExpected = (nData == 0) ? 0 : (nData == 0xFF) ? 4096 : (uint16_t) ((nData << 4) | (nData >> 4));
+		const uint16_t nOutput = PCA9685Simulation::GetOutput(PCA9685_I2C_ADDRESS_DEFAULT + i / PCA9685_PWM_CHANNELS, i % PCA9685_PWM_CHANNELS);
+
+		if (nOutput != nExpected) {
+			if (s_nErrors++ < 8) {
+				printf("FAIL: channel %d output %u, expected %u\n", i, nOutput, nExpected);
+			}
+		}
+
+		nHash = (nHash ^ nOutput) * 16777619;
+	}
+
+	return nHash;
+}
+
+int main(int argc, char **argv) {
+	const char *pName[4] = { "master fade, all equal:", "rainbow, all differ:", "8 RGB fixtures (24 ch):", "10 random channels:" };
+	struct TPCA9685SimulationStats Stats[2][4];
+	uint32_t nHash[2];
+
+	printf("%d boards (%d channels), %d frames each, per frame\n", BOARDS, CHANNELS, FRAMES);
+
+	for (int nRun = 0; nRun < 2; nRun++) {
+		PCA9685Simulation::Reset();
+
+		PCA9685DmxLed *pDmxLed = 0;
+		PCA9685PWMLed *pPWMLed[BOARDS];
+
+		if (nRun == 0) {
+			for (int i = 0; i < BOARDS; i++) {
+				pPWMLed[i] = new PCA9685PWMLed(PCA9685_I2C_ADDRESS_DEFAULT + i);
+			}
+		} else {
+			pDmxLed = new PCA9685DmxLed;
+			pDmxLed->SetBoardInstances(BOARDS);
+			pDmxLed->Start(0);
+		}
+
+		memset(s_DmxData, 0, sizeof(s_DmxData));
+		memset(s_DmxPrevious, 0, sizeof(s_DmxPrevious));
+		srand(1);
+		nHash[nRun] = 2166136261;
+
+		for (int nTest = 0; nTest < 4; nTest++) {
+			PCA9685Simulation::ResetStats();
+
+			for (int nFrame = 0; nFrame < FRAMES; nFrame++) {
+				next_frame(nTest, nFrame);
+
+				if (nRun == 0) {
+					set_per_channel(pPWMLed);
+				} else {
+					pDmxLed->SetData(0, s_DmxData, sizeof(s_DmxData));
+				}
+
+				nHash[nRun] = check_outputs(nHash[nRun]);
+			}
+
+			PCA9685Simulation::GetStats(&Stats[nRun][nTest]);
+		}
+
+		if (nRun == 0) {
+			for (int i = 0; i < BOARDS; i++) {
+				delete pPWMLed[i];
+			}
+		} else {
+			delete pDmxLed;
+		}
+	}
+
+	for (int nTest = 0; nTest < 4; nTest++) {
+		printf("  %-25s %6.1f trans, %6.1f bytes -> %5.1f trans, %6.1f bytes\n", pName[nTest],
+				(float) Stats[0][nTest].nTransactions / FRAMES, (float) Stats[0][nTest].nBytes / FRAMES,
+				(float) Stats[1][nTest].nTransactions / FRAMES, (float) Stats[1][nTest].nBytes / FRAMES);
+	}
+
+	if (nHash[0] != nHash[1]) {
+		printf("FAIL: output hash %08x, per channel %08x\n", nHash[1], nHash[0]);
+		s_nErrors++;
+	}
+
+	printf("dmxled_bench: %d errors\n", s_nErrors);
+
+	return (s_nErrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -104,29 +104,66 @@ void PCA9685DmxLed::SetData(uint8_t nPort, const uint8_t* pDmxData, uint16_t nLe
 		Start();
 	}
 
-	uint8_t *p = (uint8_t *)pDmxData + m_nDmxStartAddress - 1;
+	const uint8_t *p = pDmxData + m_nDmxStartAddress - 1;
 	uint8_t *q = m_pDmxData;
 
 	uint16_t nChannel = m_nDmxStartAddress;
 
 	for (unsigned j = 0; j < m_nBoardInstances; j++) {
+		uint8_t nCount = 0;
+		bool isDirty = false;
+		bool isSame = true;
+
 		for (unsigned i = 0; i < PCA9685_PWM_CHANNELS; i++) {
 			if ((nChannel >= (m_nDmxFootprint + m_nDmxStartAddress)) || (nChannel > nLength)) {
-				j = m_nBoardInstances;
 				break;
 			}
-			if (*p != *q) {
-				uint8_t value = *p;
+			isDirty |= (p[i] != q[i]);
+			isSame &= (p[i] == p[0]);
+			nChannel++;
+			nCount++;
+		}
+
+		if (isDirty) {
+			if ((nCount == PCA9685_PWM_CHANNELS) && isSame) {
+				// All LEDs of the board share the value, one ALL_LED write
+#ifndef NDEBUG
+				printf("m_pPWMLed[%d]->Set(CHANNEL(16), %d)\n", (int) j, (int) p[0]);
+#endif
+				m_pPWMLed[j]->Set(CHANNEL(16), p, 1);
+			} else {
+				// One Auto-Increment burst per run of changed channels
+				uint8_t i = 0;
+
+				while (i < nCount) {
+					if (p[i] == q[i]) {
+						i++;
+						continue;
+					}
+
+					const uint8_t nFirst = i;
+
+					while ((i < nCount) && (p[i] != q[i])) {
+						i++;
+					}
 #ifndef NDEBUG
-				printf("m_pPWMLed[%d]->SetDmx(CHANNEL(%d), %d)\n", (int) j, (int) i, (int) value);
+					printf("m_pPWMLed[%d]->Set(CHANNEL(%d), %d channels)\n", (int) j, (int) nFirst, (int) (i - nFirst));
 #endif
-				m_pPWMLed[j]->Set(CHANNEL(i), value);
+					m_pPWMLed[j]->Set(CHANNEL(nFirst), &p[nFirst], i - nFirst);
+				}
+			}
+
+			for (unsigned i = 0; i < nCount; i++) {
+				q[i] = p[i];
 			}
-			*q = *p;
-			p++;
-			q++;
-			nChannel++;
 		}
+
+		if (nCount < PCA9685_PWM_CHANNELS) {
+			break;
+		}
+
+		p += PCA9685_PWM_CHANNELS;
+		q += PCA9685_PWM_CHANNELS;
 	}
 }
 
@@ -0,0 +1,343 @@
+/**
+ * @file discovery_test.cpp
+ *
+ * Runs RDMDiscovery and ArtNetRdmController against the simulated responders
+ * of the Linux Rdm backend and checks the resulting TOD.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hardwarelinux.h"
+#include "networklinux.h"
+
+#include "rdmdiscovery.h"
+#include "artnetdiscovery.h"
+
+#include "rdm.h"
+#include "rdm_e120.h"
+
+#include "linux/rdmsimulation.h"
+
+#define RESPONDERS			24
+#define DEADLINE_MILLIS		20000	///< A discovery that loops on a responder never finishes
+
+static int s_nErrors;
+
+static void check(bool bCondition, const char *pWhat) {
+	if (!bCondition) {
+		printf("FAIL: %s\n", pWhat);
+		s_nErrors++;
+	}
+}
+
+/**
+ * The requests that occupy the line for a response: DISC_UNIQUE_BRANCH and DISC_MUTE
+ */
+static uint32_t get_requests(uint8_t nPort) {
+	struct TRdmSimulationStats tStats;
+
+	RdmSimulation::GetStats(nPort, &tStats);
+
+	return tStats.nDiscUniqueBranch + tStats.nMute;
+}
+
+/**
+ * The TOD holds every simulated responder of the port, except pExcluded
+ */
+static bool is_tod(const RDMTod &tod, uint8_t nPort, const uint8_t *pExcluded = 0) {
+	uint32_t nExpected = 0;
+
+	for (uint32_t i = 0; i < RdmSimulation::GetResponders(nPort); i++) {
+		const uint8_t *pUid = RdmSimulation::GetResponderUid(nPort, i);
+
+		if ((pExcluded != 0) && (memcmp(pUid, pExcluded, RDM_UID_SIZE) == 0)) {
+			if (tod.Exist(pUid)) {
+				return false;
+			}
+			continue;
+		}
+
+		if (!tod.Exist(pUid)) {
+			return false;
+		}
+
+		nExpected++;
+	}
+
+	return tod.GetUidCount() == nExpected;
+}
+
+static bool run(RDMDiscovery &discovery) {
+	const uint32_t nStart = Hardware::Get()->Millis();
+
+	while (discovery.Run() != RDM_DISCOVERY_DONE) {
+		if ((Hardware::Get()->Millis() - nStart) > DEADLINE_MILLIS) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void test_full(void) {
+	RDMDiscovery discovery(0);
+
+	RdmSimulation::SetResponders(0, RESPONDERS, 0x1234);
+	RdmSimulation::ResetStats(0);
+
+	discovery.Full();
+
+	struct TRdmSimulationStats tStats;
+	RdmSimulation::GetStats(0, &tStats);
+
+	check(is_tod(discovery, 0), "full: the TOD holds all responders");
+	check(discovery.IsTodChanged(), "full: the TOD is changed");
+	check(tStats.nCollisions != 0, "full: the responders collide");
+	check(tStats.nUnMute == RDM_DISCOVERY_UNMUTE_COUNT, "full: un-mute broadcasts");
+}
+
+/**
+ * No DISC_UNIQUE_BRANCH or DISC_MUTE is sent during a pause, and a slice does not
+ * hold the line longer than its budget plus the responses already waited for
+ */
+static void test_sliced(void) {
+	RDMDiscovery discovery(1);
+
+	RdmSimulation::SetResponders(1, RESPONDERS, 0x5678);
+
+	discovery.SetBudget(RDM_DISCOVERY_SLICE_MILLIS, RDM_DISCOVERY_PAUSE_MILLIS);
+	discovery.Start(false);
+
+	const uint32_t nStart = Hardware::Get()->Millis();
+	uint32_t nBusyMillis = nStart;
+	uint32_t nBusyMax = 0;
+	uint32_t nPauses = 0;
+	bool IsPauseRespected = true;
+	TRdmDiscoveryState tState = discovery.GetState();
+
+	while (tState != RDM_DISCOVERY_DONE) {
+		const uint32_t nRequests = get_requests(1);
+		const TRdmDiscoveryState tPrevious = tState;
+
+		tState = discovery.Run();
+
+		const uint32_t nMillis = Hardware::Get()->Millis();
+
+		if ((tPrevious == RDM_DISCOVERY_PAUSE) && (tState == RDM_DISCOVERY_PAUSE) && (get_requests(1) != nRequests)) {
+			IsPauseRespected = false;
+		}
+
+		if (tPrevious != RDM_DISCOVERY_BUSY) {
+			nBusyMillis = nMillis;
+		} else if ((nMillis - nBusyMillis) > nBusyMax) {
+			nBusyMax = nMillis - nBusyMillis;
+		}
+
+		if ((tPrevious == RDM_DISCOVERY_BUSY) && (tState == RDM_DISCOVERY_PAUSE)) {
+			nPauses++;
+		}
+
+		if ((nMillis - nStart) > DEADLINE_MILLIS) {
+			break;
+		}
+	}
+
+	check(tState == RDM_DISCOVERY_DONE, "sliced: the discovery finishes");
+	check(is_tod(discovery, 1), "sliced: the TOD holds all responders");
+	check(nPauses > 1, "sliced: the line is given back for DMX");
+	check(IsPauseRespected, "sliced: no discovery request during a pause");
+	check(nBusyMax <= RDM_DISCOVERY_SLICE_MILLIS + 3 * (RDM_DISCOVERY_RECEIVE_TIME_OUT + 1), "sliced: a slice keeps to its budget");
+
+	printf("sliced: %u pauses, longest slice %u ms\n", nPauses, nBusyMax);
+}
+
+static void test_incremental(void) {
+	RDMDiscovery discovery(0);
+	uint8_t Uid[RDM_UID_SIZE];
+
+	RdmSimulation::SetResponders(0, RESPONDERS, 0x9abc);
+	discovery.SetBudget(RDM_DISCOVERY_SLICE_MILLIS, 0);
+	discovery.Full();
+	discovery.ClearTodChanged();
+
+	// Nothing changed, the known devices are muted and the branch search is a single request
+	RdmSimulation::ResetStats(0);
+	discovery.Start(true);
+	check(run(discovery), "incremental: unchanged, the discovery finishes");
+
+	struct TRdmSimulationStats tStats;
+	RdmSimulation::GetStats(0, &tStats);
+
+	check(is_tod(discovery, 0), "incremental: unchanged, the TOD holds all responders");
+	check(!discovery.IsTodChanged(), "incremental: unchanged, the TOD is not changed");
+	check(tStats.nDiscUniqueBranch == 1, "incremental: unchanged, one DISC_UNIQUE_BRANCH");
+
+	// 2 responders are removed and 3 added
+	memcpy(Uid, RdmSimulation::GetResponderUid(0, 0), RDM_UID_SIZE);
+	RdmSimulation::RemoveResponder(0, Uid);
+	memcpy(Uid, RdmSimulation::GetResponderUid(0, 5), RDM_UID_SIZE);
+	RdmSimulation::RemoveResponder(0, Uid);
+
+	Uid[0] = 0x7F;
+	Uid[1] = 0xF0;
+	Uid[2] = 0xA5;
+	Uid[3] = 0x00;
+	Uid[4] = 0x00;
+
+	for (uint8_t i = 1; i <= 3; i++) {
+		Uid[5] = i;
+		RdmSimulation::AddResponder(0, Uid);
+	}
+
+	discovery.Start(true);
+	check(run(discovery), "incremental: changed, the discovery finishes");
+	check(is_tod(discovery, 0), "incremental: changed, the TOD holds the responders on the line");
+	check(discovery.IsTodChanged(), "incremental: changed, the TOD is changed");
+}
+
+/**
+ * One responder ignores DISC_MUTE, another acknowledges it but keeps answering
+ * DISC_UNIQUE_BRANCH. The discovery must not loop on either of them.
+ */
+static void test_non_muting(void) {
+	RDMDiscovery discovery(2);
+	uint8_t Ignored[RDM_UID_SIZE];
+	uint8_t NotKept[RDM_UID_SIZE];
+
+	RdmSimulation::SetResponders(2, RESPONDERS, 0xdef0);
+
+	memcpy(Ignored, RdmSimulation::GetResponderUid(2, 3), RDM_UID_SIZE);
+	memcpy(NotKept, RdmSimulation::GetResponderUid(2, 7), RDM_UID_SIZE);
+
+	RdmSimulation::SetMute(2, Ignored, RDM_SIMULATION_MUTE_IGNORED);
+	RdmSimulation::SetMute(2, NotKept, RDM_SIMULATION_MUTE_NOT_KEPT);
+
+	discovery.SetBudget(RDM_DISCOVERY_SLICE_MILLIS, 0);
+	discovery.Start(false);
+
+	check(run(discovery), "non-muting: the full discovery finishes");
+	check(is_tod(discovery, 2, Ignored), "non-muting: the TOD holds the responders that acknowledge the mute");
+
+	discovery.Start(true);
+
+	check(run(discovery), "non-muting: the incremental discovery finishes");
+	check(is_tod(discovery, 2, Ignored), "non-muting: the incremental TOD is the same");
+
+	RdmSimulation::SetMute(2, Ignored, RDM_SIMULATION_MUTE);
+	RdmSimulation::SetMute(2, NotKept, RDM_SIMULATION_MUTE);
+}
+
+/**
+ * A queued ArtRdm transaction goes before the next discovery request
+ */
+static void test_controller(void) {
+	ArtNetRdmController controller;
+	struct TArtNetRdmResponse tResponse;
+
+	RdmSimulation::SetResponders(3, RESPONDERS, 0x1357);
+	RdmSimulation::ResetStats(3);
+
+	controller.SetDiscoveryBudget(RDM_DISCOVERY_SLICE_MILLIS, RDM_DISCOVERY_PAUSE_MILLIS);
+	controller.StartDiscovery(3);
+
+	const uint32_t nStart = Hardware::Get()->Millis();
+
+	while (((get_requests(3) < 4) || (controller.GetDiscoveryState(3) != ARTNET_RDM_DISCOVERY_BUSY)) && ((Hardware::Get()->Millis() - nStart) < DEADLINE_MILLIS)) {
+		controller.Run(&tResponse);
+	}
+
+	check(controller.GetDiscoveryState(3) == ARTNET_RDM_DISCOVERY_BUSY, "controller: the discovery holds the line");
+
+	// GET DEVICE_LABEL, the ArtRdm data is without the start code
+	uint8_t Request[sizeof(struct TRdmMessage) + RDM_MESSAGE_CHECKSUM_SIZE];
+	struct TRdmMessage *pRequest = (struct TRdmMessage *) Request;
+	const uint8_t *pUid = RdmSimulation::GetResponderUid(3, 0);
+
+	memset(Request, 0, sizeof(Request));
+	pRequest->start_code = E120_SC_RDM;
+	pRequest->sub_start_code = E120_SC_SUB_MESSAGE;
+	pRequest->message_length = RDM_MESSAGE_MINIMUM_SIZE;
+	memcpy(pRequest->destination_uid, pUid, RDM_UID_SIZE);
+	pRequest->slot16.port_id = 1;
+	pRequest->command_class = E120_GET_COMMAND;
+	pRequest->param_id[0] = (uint8_t) (E120_DEVICE_LABEL >> 8);
+	pRequest->param_id[1] = (uint8_t) E120_DEVICE_LABEL;
+
+	uint16_t nChecksum = 0;
+
+	for (unsigned i = 0; i < pRequest->message_length; i++) {
+		nChecksum += Request[i];
+	}
+
+	Request[pRequest->message_length] = (uint8_t) (nChecksum >> 8);
+	Request[pRequest->message_length + 1] = (uint8_t) nChecksum;
+
+	const uint32_t nRequests = get_requests(3);
+
+	check(controller.Submit(3, &Request[1], 0x0a000001), "controller: Submit");
+
+	bool IsResponse = false;
+
+	while (!IsResponse && ((Hardware::Get()->Millis() - nStart) < DEADLINE_MILLIS)) {
+		IsResponse = controller.Run(&tResponse);
+	}
+
+	check(IsResponse && (tResponse.nPort == 3) && (tResponse.nIpAddress == 0x0a000001), "controller: the ArtRdm transaction completes");
+
+	const struct TRdmMessage *pResponse = (const struct TRdmMessage *) tResponse.pRdmData;
+
+	check(IsResponse && (pResponse != 0) && (memcmp(pResponse->source_uid, pUid, RDM_UID_SIZE) == 0) && (pResponse->slot16.response_type == E120_RESPONSE_TYPE_ACK), "controller: the responder acknowledges");
+	// The mute of a DISC_UNIQUE_BRANCH answer belongs to the exchange that was on the line
+	check(get_requests(3) <= nRequests + 1, "controller: no new discovery request before the ArtRdm transaction");
+
+	while ((controller.GetDiscoveryState(3) != ARTNET_RDM_DISCOVERY_DONE) && ((Hardware::Get()->Millis() - nStart) < DEADLINE_MILLIS)) {
+		controller.Run(&tResponse);
+	}
+
+	check(controller.GetDiscoveryState(3) == ARTNET_RDM_DISCOVERY_DONE, "controller: the discovery finishes");
+	check(controller.GetUidCount(3) == RESPONDERS, "controller: the TOD holds all responders");
+}
+
+int main(int argc, char **argv) {
+	HardwareLinux hw;
+	NetworkLinux nw;
+
+	// The RDM controller takes its UID from the MAC address
+	if (nw.Init("lo") < 0) {
+		fprintf(stderr, "Not able to start the network on lo\n");
+		return EXIT_FAILURE;
+	}
+
+	test_full();
+	test_sliced();
+	test_incremental();
+	test_non_muting();
+	test_controller();
+
+	printf("discovery_test: %d errors\n", s_nErrors);
+
+	return (s_nErrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file rdmtod_bench.cpp
+ *
+ * Times AddUid, Exist and Delete of RDMTod against the linear scan
+ * it replaced, for tables of 200, 1000 and 10000 UIDs.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rdmtod.h"
+
+#define EXIST_ROUNDS	10
+
+/*
+ * The table without the hash index: a dense array, searched from the start
+ */
+class LinearTod {
+public:
+	LinearTod(uint16_t nSize) : m_nSize(nSize), m_nEntries(0) {
+		m_pTable = new TRdmTod[nSize];
+	}
+
+	~LinearTod(void) {
+		delete[] m_pTable;
+	}
+
+	bool Exist(const uint8_t *pUid) const {
+		for (uint32_t i = 0; i < m_nEntries; i++) {
+			if (memcmp(&m_pTable[i], pUid, RDM_UID_SIZE) == 0) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool AddUid(const uint8_t *pUid) {
+		if ((m_nEntries == m_nSize) || Exist(pUid)) {
+			return false;
+		}
+
+		memcpy(&m_pTable[m_nEntries++], pUid, RDM_UID_SIZE);
+
+		return true;
+	}
+
+	bool Delete(const uint8_t *pUid) {
+		uint32_t i;
+
+		for (i = 0; i < m_nEntries; i++) {
+			if (memcmp(&m_pTable[i], pUid, RDM_UID_SIZE) == 0) {
+				break;
+			}
+		}
+
+		if (i == m_nEntries) {
+			return false;
+		}
+
+		for (; i + 1 < m_nEntries; i++) {
+			memcpy(&m_pTable[i], &m_pTable[i + 1], RDM_UID_SIZE);
+		}
+
+		m_nEntries--;
+
+		return true;
+	}
+
+private:
+	uint16_t m_nSize;
+	uint16_t m_nEntries;
+	TRdmTod *m_pTable;
+};
+
+struct TTimes {
+	double fAdd;
+	double fExist;
+	double fDelete;
+};
+
+static double nanos(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static void make_uid(uint32_t nDevice, uint8_t *pUid) {
+	pUid[0] = 0x7F;
+	pUid[1] = 0xF0;
+	pUid[2] = (uint8_t) (nDevice >> 24);
+	pUid[3] = (uint8_t) (nDevice >> 16);
+	pUid[4] = (uint8_t) (nDevice >> 8);
+	pUid[5] = (uint8_t) nDevice;
+}
+
+/*
+ * Nanoseconds per operation: N additions, N lookups EXIST_ROUNDS times, N/2 deletions
+ */
+template<class T> static void run(T& tod, uint16_t nSize, struct TTimes& times) {
+	uint8_t uid[RDM_UID_SIZE];
+	volatile uint32_t nFound = 0;
+
+	double fStart = nanos();
+
+	for (uint32_t i = 0; i < nSize; i++) {
+		make_uid(i * 7, uid);
+		tod.AddUid(uid);
+	}
+
+	times.fAdd = (nanos() - fStart) / nSize;
+
+	fStart = nanos();
+
+	for (uint32_t nRound = 0; nRound < EXIST_ROUNDS; nRound++) {
+		for (uint32_t i = 0; i < nSize; i++) {
+			make_uid(i * 7, uid);
+			nFound += tod.Exist(uid);
+		}
+	}
+
+	times.fExist = (nanos() - fStart) / nSize / EXIST_ROUNDS;
+
+	fStart = nanos();
+
+	for (uint32_t i = 0; i < nSize; i += 2) {
+		make_uid(i * 7, uid);
+		tod.Delete(uid);
+	}
+
+	times.fDelete = (nanos() - fStart) / (nSize / 2);
+}
+
+int main(void) {
+	static const uint16_t sizes[] = {200, 1000, 10000};
+
+	printf("Nanoseconds per operation, hash / linear\n");
+
+	for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		RDMTod hash(sizes[i]);
+		LinearTod linear(sizes[i]);
+		struct TTimes hash_times;
+		struct TTimes linear_times;
+
+		run(hash, sizes[i], hash_times);
+		run(linear, sizes[i], linear_times);
+
+		printf("N=%5u add %6.0f/%6.0f ns, exist %6.0f/%6.0f ns, delete %6.0f/%6.0f ns\n", sizes[i],
+				hash_times.fAdd, linear_times.fAdd,
+				hash_times.fExist, linear_times.fExist,
+				hash_times.fDelete, linear_times.fDelete);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file rdmtod_test.cpp
+ *
+ * Runs random AddUid, Delete and Exist calls against a plain reference set
+ * and checks that RDMTod gives the same answers.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rdmtod.h"
+
+#define TOD_SIZE		4000
+#define OPERATIONS		400000
+
+/*
+ * The UIDs are taken from 3 manufacturers of 6000 devices each,
+ * so that the table fills up and the hash chains are shared.
+ */
+#define MANUFACTURERS	3
+#define DEVICES			6000
+#define KEYS			(MANUFACTURERS * DEVICES)
+
+static bool s_reference[KEYS];
+static uint32_t s_reference_count;
+
+static void make_uid(uint32_t nKey, uint8_t *pUid) {
+	const uint16_t nManufacturer = (uint16_t) (0x7F00 + nKey / DEVICES);
+	const uint32_t nDevice = nKey % DEVICES;
+
+	pUid[0] = (uint8_t) (nManufacturer >> 8);
+	pUid[1] = (uint8_t) nManufacturer;
+	pUid[2] = (uint8_t) (nDevice >> 24);
+	pUid[3] = (uint8_t) (nDevice >> 16);
+	pUid[4] = (uint8_t) (nDevice >> 8);
+	pUid[5] = (uint8_t) nDevice;
+}
+
+static uint32_t get_key(const uint8_t *pUid) {
+	const uint32_t nManufacturer = (uint32_t) ((pUid[0] << 8) | pUid[1]) - 0x7F00;
+	const uint32_t nDevice = (uint32_t) ((pUid[2] << 24) | (pUid[3] << 16) | (pUid[4] << 8) | pUid[5]);
+
+	return nManufacturer * DEVICES + nDevice;
+}
+
+int main(int argc, char **argv) {
+	RDMTod tod(TOD_SIZE);
+	uint8_t uid[RDM_UID_SIZE];
+	int nErrors = 0;
+
+	srand((argc > 1) ? (unsigned) atoi(argv[1]) : 1);
+
+	for (uint32_t i = 0; (i < OPERATIONS) && (nErrors < 10); i++) {
+		const uint32_t nKey = (uint32_t) rand() % KEYS;
+		const char *pOperation = 0;
+
+		make_uid(nKey, uid);
+
+		switch (rand() % 3) {
+		case 0: {
+			const bool bAdd = (!s_reference[nKey]) && (s_reference_count < TOD_SIZE);
+			if (bAdd) {
+				s_reference[nKey] = true;
+				s_reference_count++;
+			}
+			if (tod.AddUid(uid) != bAdd) {
+				pOperation = "AddUid";
+			}
+			break;
+		}
+		case 1: {
+			const bool bDelete = s_reference[nKey];
+			if (bDelete) {
+				s_reference[nKey] = false;
+				s_reference_count--;
+			}
+			if (tod.Delete(uid) != bDelete) {
+				pOperation = "Delete";
+			}
+			break;
+		}
+		default:
+			if (tod.Exist(uid) != s_reference[nKey]) {
+				pOperation = "Exist";
+			}
+			break;
+		}
+
+		if (tod.GetUidCount() != s_reference_count) {
+			pOperation = "GetUidCount";
+		}
+
+		if (pOperation != 0) {
+			printf("operation %u: %s differs, key %u\n", i, pOperation, nKey);
+			nErrors++;
+		}
+	}
+
+	// The table holds exactly the reference set
+	for (uint16_t i = 0; i < tod.GetUidCount(); i++) {
+		const uint32_t nKey = get_key(tod.GetUid(i));
+
+		if ((nKey >= KEYS) || !s_reference[nKey]) {
+			printf("GetUid(%u): key %u is not in the reference set\n", i, nKey);
+			nErrors++;
+		}
+	}
+
+	// A paged copy returns every UID once
+	uint8_t table[TOD_TABLE_SIZE * RDM_UID_SIZE];
+	uint32_t nCopied = 0;
+	uint16_t nCount;
+
+	while ((nCount = tod.Copy(table, (uint16_t) nCopied, TOD_TABLE_SIZE)) != 0) {
+		if (memcmp(table, tod.GetUid((uint16_t) nCopied), (size_t) nCount * RDM_UID_SIZE) != 0) {
+			printf("Copy(%u): differs from GetUid\n", nCopied);
+			nErrors++;
+		}
+		nCopied += nCount;
+	}
+
+	if (nCopied != s_reference_count) {
+		printf("Copy: %u UIDs, expected %u\n", nCopied, s_reference_count);
+		nErrors++;
+	}
+
+	printf("rdmtod_test: %d operations, %u UIDs, %d errors\n", OPERATIONS, s_reference_count, nErrors);
+
+	return (nErrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -3,6 +3,7 @@
 #define ARTNETDISCOVERY_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "artnetrdm.h"
 
@@ -12,22 +13,69 @@
 #include "dmx.h"
 #include "rdm.h"
 
+#define ARTNET_RDM_QUEUE_DEPTH			4		///< ArtRdm requests queued per port
+#define ARTNET_RDM_RECEIVE_TIME_OUT		20		///< Milliseconds
+
+struct TRdmTransaction {
+	uint8_t RdmData[sizeof(struct TRdmMessage) + RDM_MESSAGE_CHECKSUM_SIZE];	///< Including the start code
+	uint16_t nLength;
+	uint32_t nIpAddress;
+};
+
+struct TRdmTransactionQueue {
+	struct TRdmTransaction Entries[ARTNET_RDM_QUEUE_DEPTH];
+	uint32_t nSentMillis;		///< When the head entry was sent
+	uint8_t nHead;
+	uint8_t nCount;
+	bool IsSent;				///< The head entry is waiting for its response
+};
+
 class ArtNetRdmController: public ArtNetRdm {
 public:
-	ArtNetRdmController(void);
+	ArtNetRdmController(uint16_t nTodSize = TOD_TABLE_SIZE);
 	~ArtNetRdmController(void);
 
 	void Full(uint8_t nPort = 0);
-	const uint8_t GetUidCount(uint8_t nPort = 0);
-	void Copy(uint8_t nPort, uint8_t *pTod);
+	const uint16_t GetUidCount(uint8_t nPort = 0);
+	uint16_t Copy(uint8_t nPort, uint8_t *pTod, uint16_t nOffset, uint16_t nCount);
 	const uint8_t *Handler(uint8_t nPort, const uint8_t *pRdmData);
 
+	bool IsAsync(void) {
+		return true;
+	}
+	bool Submit(uint8_t nPort, const uint8_t *pRdmData, uint32_t nIpAddress);
+	bool Run(struct TArtNetRdmResponse *pResponse);
+
+	bool StartDiscovery(uint8_t nPort);
+	TArtNetRdmDiscovery GetDiscoveryState(uint8_t nPort);
+	bool IsTodChanged(uint8_t nPort);
+
+	/**
+	 * @param nSliceMillis The time a non-blocking discovery holds the line
+	 * @param nPauseMillis The time the line is given back for DMX in between
+	 */
+	void SetDiscoveryBudget(uint32_t nSliceMillis, uint32_t nPauseMillis);
+	/**
+	 * Background incremental discovery of all ports
+	 * @param nIntervalMillis 0 is disabled
+	 */
+	void SetIncrementalDiscovery(uint32_t nIntervalMillis) {
+		m_nIncrementalMillis = nIntervalMillis;
+	}
+
 	void DumpTod(uint8_t nPort = 0);
 
+private:
+	void Send(uint8_t nPort);
+
 private:
 	RDMDiscovery *m_Discovery[DMX_MAX_UARTS];
 	RDMDeviceController m_Controller;
 	struct TRdmMessage *m_pRdmCommand;
+	struct TRdmTransactionQueue *m_pQueue[DMX_MAX_UARTS];
+	uint8_t m_nRunPort;		///< Round robin, the port Run checks first
+	uint32_t m_nIncrementalMillis;
+	uint32_t m_nDiscoveryMillis[DMX_MAX_UARTS];	///< When the latest discovery was started
 };
 
 #endif /* ARTNETDISCOVERY_H_ */
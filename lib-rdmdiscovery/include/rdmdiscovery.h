@@ -34,19 +34,74 @@
 #include "rdmmessage.h"
 #include "rdmtod.h"
 
+#define RDM_DISCOVERY_RECEIVE_TIME_OUT		3		///< Milliseconds, E1.20 Table 3-2 2.8 ms rounded up
+#define RDM_DISCOVERY_UNMUTE_COUNT			3		///< Full discovery starts with un-mute broadcasts
+#define RDM_DISCOVERY_UNMUTE_SPACING		100		///< Milliseconds, the line is free for DMX in between
+#define RDM_DISCOVERY_VERIFY_RETRIES		1		///< A known UID is removed after this many more unanswered mutes
+#define RDM_DISCOVERY_SLICE_MILLIS			10		///< Default time the discovery holds the line
+#define RDM_DISCOVERY_PAUSE_MILLIS			25		///< Default time the line is given back, one DMX frame at 40 Hz
+#define RDM_DISCOVERY_STACK_SIZE			50		///< A 48-bit binary search keeps at most 48 siblings + 1
+
+enum TRdmDiscoveryState {
+	RDM_DISCOVERY_DONE,		///< Not running
+	RDM_DISCOVERY_BUSY,		///< A discovery slice holds the line
+	RDM_DISCOVERY_PAUSE		///< Between slices, the line is free for DMX frames
+};
+
+struct TRdmDiscoveryBranch {
+	uint64_t nLowerBound;
+	uint64_t nUpperBound;
+};
+
 class RDMDiscovery: public RDMTod {
 public:
-	RDMDiscovery(uint8_t nPort = 0);
+	RDMDiscovery(uint8_t nPort = 0, uint16_t nTodSize = TOD_TABLE_SIZE);
 	~RDMDiscovery(void);
 
 	void SetUid(const uint8_t *);
 	const char *GetUid(void);
 
+	/**
+	 * Blocking, returns when the discovery has completed
+	 */
 	void Full(void);
 
+	/**
+	 * Non-blocking, Run must be called from the main loop until it returns RDM_DISCOVERY_DONE.
+	 * @param bIncremental false: the TOD is rebuilt, true: known UIDs are verified and branching is only done for new devices
+	 */
+	void Start(bool bIncremental = false);
+	TRdmDiscoveryState Run(void);
+	TRdmDiscoveryState GetState(void) const;
+	/**
+	 * Lets another RDM transaction use the line, the discovery does not send a new request.
+	 * @return false while a discovery request is still waiting for its response
+	 */
+	bool Pause(void);
+
+	/**
+	 * @param nSliceMillis The time the discovery holds the line
+	 * @param nPauseMillis The time the line is given back for DMX, 0 runs the discovery without pauses
+	 */
+	void SetBudget(uint32_t nSliceMillis, uint32_t nPauseMillis);
+
+	bool IsTodChanged(void) const {
+		return m_IsTodChanged;
+	}
+	void ClearTodChanged(void) {
+		m_IsTodChanged = false;
+	}
+
 private:
-	bool FindDevices(uint64_t, uint64_t);
-	bool QuickFind(const uint8_t *);
+	bool Step(void);
+	bool IsWaiting(void) const;
+	bool IsTimeOut(void) const;
+
+	void SendMute(const uint8_t *pUid);
+	void SendDiscUniqueBranch(void);
+	bool IsMuteResponse(const uint8_t *pResponse, const uint8_t *pUid) const;
+	bool Push(uint64_t nLowerBound, uint64_t nUpperBound);
+	void Split(void);
 
 	bool IsValidDiscoveryResponse(const uint8_t *, uint8_t *);
 
@@ -56,11 +111,39 @@ private:
 	const uint64_t ConvertUid(const uint8_t *);
 
 private:
+	enum TStep {
+		STEP_IDLE,
+		STEP_UNMUTE,
+		STEP_UNMUTE_WAIT,
+		STEP_VERIFY,
+		STEP_VERIFY_WAIT,
+		STEP_BRANCH,
+		STEP_BRANCH_WAIT,
+		STEP_MUTE_WAIT
+	};
+
 	uint8_t m_nPort;
 	uint8_t m_Uid[RDM_UID_SIZE];
 	RDMMessage m_UnMute;
 	RDMMessage m_Mute;
 	RDMMessage m_DiscUniqueBranch;
+
+	TStep m_tStep;
+	bool m_IsIncremental;
+	bool m_IsQuickFind;				///< The mute follows a valid DUB response, the branch is tried again
+	bool m_IsPaused;
+	bool m_IsTodChanged;
+	uint8_t m_nUnMuteCount;
+	uint16_t m_nVerifyIndex;
+	uint8_t m_nVerifyRetries;
+	uint8_t m_MuteUid[RDM_UID_SIZE];
+	uint32_t m_nStepMillis;			///< When the request was sent, or the wait started
+	uint32_t m_nSliceMillis;		///< When the slice or the pause started
+	uint32_t m_nBudgetSliceMillis;
+	uint32_t m_nBudgetPauseMillis;
+	struct TRdmDiscoveryBranch m_tBranch;
+	struct TRdmDiscoveryBranch *m_pStack;
+	uint8_t m_nStackTop;
 };
 
 #endif /* RDMDISCOVERY_H_ */
@@ -31,30 +31,54 @@
 
 #include "rdm.h"
 
-#define TOD_TABLE_SIZE	200
+#define TOD_TABLE_SIZE		200		///< Default, one ArtTodData packet
+#define TOD_TABLE_SIZE_MAX	32768	///< ArtTodData BlockCount is 8-bit, 256 x 200 UIDs
+
+#define TOD_INDEX_NONE		0xFFFF
 
 struct TRdmTod {
 	uint8_t uid[RDM_UID_SIZE];
 };
 
+/**
+ * The UIDs are stored in order of arrival. A hash index on top gives
+ * constant time Exist, AddUid and Delete.
+ */
 class RDMTod {
 public:
-	 RDMTod(void);
+	 RDMTod(uint16_t nSize = TOD_TABLE_SIZE);
 	 ~RDMTod(void);
 
 	 void Reset(void);
 	 bool AddUid(const uint8_t *pUid);
-	 uint8_t GetUidCount(void) const;
-	 void Copy(uint8_t *pTable);
+	 uint16_t GetUidCount(void) const;
+	 uint16_t GetSize(void) const {
+		 return m_nSize;
+	 }
+	 const uint8_t *GetUid(uint16_t nIndex) const;
+	 /**
+	  * @return The number of UIDs copied, at most nCount
+	  */
+	 uint16_t Copy(uint8_t *pTable, uint16_t nOffset, uint16_t nCount) const;
 
 	 bool Delete(const uint8_t *pUid);
-	 bool Exist(const uint8_t *pUid);
+	 bool Exist(const uint8_t *pUid) const;
 
 	 void Dump(void);
-	 void Dump(uint8_t nCount);
+	 void Dump(uint16_t nCount);
+
+private:
+	 uint32_t Hash(const uint8_t *pUid) const;
+	 uint16_t Find(const uint8_t *pUid) const;
+	 void Unlink(uint16_t nIndex);
+
 private:
-	 uint8_t m_nEntries;
+	 uint16_t m_nSize;
+	 uint16_t m_nEntries;
+	 uint32_t m_nHashShift;
 	 TRdmTod *m_pTable;
+	 uint16_t *m_pBuckets;	///< First entry of each chain
+	 uint16_t *m_pNext;		///< Next entry in the chain, per table entry
 };
 
 #endif /* RDMTOD_H_ */
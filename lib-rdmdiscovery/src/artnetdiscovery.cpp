@@ -36,15 +36,25 @@
 
 #include "rdmdiscovery.h"
 
+#include "hardware.h"
+
 #include "debug.h"
 
-ArtNetRdmController::ArtNetRdmController(void) : m_pRdmCommand(0){
+ArtNetRdmController::ArtNetRdmController(uint16_t nTodSize) : m_pRdmCommand(0), m_nRunPort(0), m_nIncrementalMillis(0) {
 	m_Controller.Load();
 
 	for (unsigned i = 0 ; i < DMX_MAX_UARTS; i++) {
-		m_Discovery[i] = new RDMDiscovery(i);
+		m_Discovery[i] = new RDMDiscovery(i, nTodSize);
 		assert(m_Discovery[i] != 0);
 		m_Discovery[i]->SetUid(m_Controller.GetUID());
+
+		m_pQueue[i] = new TRdmTransactionQueue;
+		assert(m_pQueue[i] != 0);
+		m_pQueue[i]->nHead = 0;
+		m_pQueue[i]->nCount = 0;
+		m_pQueue[i]->IsSent = false;
+
+		m_nDiscoveryMillis[i] = 0;
 	}
 
 	m_pRdmCommand = new struct TRdmMessage;
@@ -60,35 +70,54 @@ ArtNetRdmController::~ArtNetRdmController(void) {
 			delete m_Discovery[i];
 			m_Discovery[i] = 0;
 		}
+
+		if (m_pQueue[i] != 0) {
+			delete m_pQueue[i];
+			m_pQueue[i] = 0;
+		}
 	}
 }
 
 void ArtNetRdmController::Full(uint8_t nPort) {
-	assert(nPort < DMX_MAX_UARTS);
+	if (nPort >= DMX_MAX_UARTS) {
+		return;
+	}
 
 	DEBUG_PRINTF("nPort=%d", nPort);
 
 	m_Discovery[nPort]->Full();
+	m_nDiscoveryMillis[nPort] = Hardware::Get()->Millis();
+
+	// Discovery has consumed the response of a transaction in progress, send it again
+	m_pQueue[nPort]->IsSent = false;
 }
 
-const uint8_t ArtNetRdmController::GetUidCount(uint8_t nPort) {
-	assert(nPort < DMX_MAX_UARTS);
+const uint16_t ArtNetRdmController::GetUidCount(uint8_t nPort) {
+	if (nPort >= DMX_MAX_UARTS) {
+		return 0;
+	}
 
 	DEBUG_PRINTF("nPort=%d", nPort);
 
 	return m_Discovery[nPort]->GetUidCount();
 }
 
-void ArtNetRdmController::Copy(uint8_t nPort, uint8_t *pTod) {
-	assert(nPort < DMX_MAX_UARTS);
+uint16_t ArtNetRdmController::Copy(uint8_t nPort, uint8_t *pTod, uint16_t nOffset, uint16_t nCount) {
+	if (nPort >= DMX_MAX_UARTS) {
+		return 0;
+	}
+
+	DEBUG_PRINTF("nPort=%d, nOffset=%d", nPort, nOffset);
 
-	DEBUG_PRINTF("nPort=%d", nPort);
+	m_Discovery[nPort]->ClearTodChanged();
 
-	m_Discovery[nPort]->Copy(pTod);
+	return m_Discovery[nPort]->Copy(pTod, nOffset, nCount);
 }
 
 void ArtNetRdmController::DumpTod(uint8_t nPort) {
-	assert(nPort < DMX_MAX_UARTS);
+	if (nPort >= DMX_MAX_UARTS) {
+		return;
+	}
 
 	DEBUG_PRINTF("nPort=%d", nPort);
 
@@ -96,9 +125,8 @@ void ArtNetRdmController::DumpTod(uint8_t nPort) {
 }
 
 const uint8_t *ArtNetRdmController::Handler(uint8_t nPort, const uint8_t *pRdmData) {
-	assert(nPort < DMX_MAX_UARTS);
-
-	if (pRdmData == 0) {
+	// The port index comes from the network, the node may have more ports than RDM capable outputs
+	if ((nPort >= DMX_MAX_UARTS) || (pRdmData == 0)) {
 		return 0;
 	}
 
@@ -125,3 +153,158 @@ const uint8_t *ArtNetRdmController::Handler(uint8_t nPort, const uint8_t *pRdmDa
 	return pResponse;
 
 }
+
+bool ArtNetRdmController::Submit(uint8_t nPort, const uint8_t *pRdmData, uint32_t nIpAddress) {
+	assert(pRdmData != 0);
+
+	// The port index comes from the network, the node may have more ports than RDM capable outputs
+	if (nPort >= DMX_MAX_UARTS) {
+		return false;
+	}
+
+	struct TRdmTransactionQueue *pQueue = m_pQueue[nPort];
+
+	if (pQueue->nCount == ARTNET_RDM_QUEUE_DEPTH) {
+		DEBUG_PRINTF("nPort=%d, queue is full", nPort);
+		return false;
+	}
+
+	const TRdmMessageNoSc *p = (TRdmMessageNoSc *) (pRdmData);
+	struct TRdmTransaction *pEntry = &pQueue->Entries[(pQueue->nHead + pQueue->nCount) % ARTNET_RDM_QUEUE_DEPTH];
+
+	pEntry->RdmData[0] = E120_SC_RDM;
+	memcpy(&pEntry->RdmData[1], pRdmData, p->message_length + 1);
+	pEntry->nLength = p->message_length + 2;
+	pEntry->nIpAddress = nIpAddress;
+
+	pQueue->nCount++;
+
+	if ((pQueue->nCount == 1) && (m_Discovery[nPort]->GetState() != RDM_DISCOVERY_BUSY)) {
+		Send(nPort);
+	}
+
+	return true;
+}
+
+bool ArtNetRdmController::Run(struct TArtNetRdmResponse *pResponse) {
+	assert(pResponse != 0);
+
+	for (unsigned n = 0; n < DMX_MAX_UARTS; n++) {
+		const uint8_t nPort = (m_nRunPort + n) % DMX_MAX_UARTS;
+		struct TRdmTransactionQueue *pQueue = m_pQueue[nPort];
+		RDMDiscovery *pDiscovery = m_Discovery[nPort];
+
+		// Queued transactions go first, a discovery in progress only resumes when the queue is empty
+		if (pQueue->nCount == 0) {
+			if (pDiscovery->GetState() != RDM_DISCOVERY_DONE) {
+				pDiscovery->Run();
+			} else if ((m_nIncrementalMillis != 0) && ((Hardware::Get()->Millis() - m_nDiscoveryMillis[nPort]) >= m_nIncrementalMillis)) {
+				pDiscovery->Start(true);
+				m_nDiscoveryMillis[nPort] = Hardware::Get()->Millis();
+			}
+			continue;
+		}
+
+		// A discovery request on the line is completed first, then the discovery pauses
+		if ((pDiscovery->GetState() == RDM_DISCOVERY_BUSY) && !pDiscovery->Pause()) {
+			continue;
+		}
+
+		if (!pQueue->IsSent) {
+			Send(nPort);
+			continue;
+		}
+
+		// The time-out is checked before the receive, a late response is not missed
+		const bool IsTimeOut = ((Hardware::Get()->Millis() - pQueue->nSentMillis) > ARTNET_RDM_RECEIVE_TIME_OUT);
+		const uint8_t *pRdmData = RDMMessage::Receive(nPort);
+
+		if ((pRdmData == 0) && !IsTimeOut) {
+			continue;
+		}
+
+#ifndef NDEBUG
+		if (pRdmData != 0) {
+			RDMMessage::Print(pRdmData);
+		}
+#endif
+
+		pResponse->pRdmData = pRdmData;
+		pResponse->nIpAddress = pQueue->Entries[pQueue->nHead].nIpAddress;
+		pResponse->nPort = nPort;
+
+		pQueue->nHead = (pQueue->nHead + 1) % ARTNET_RDM_QUEUE_DEPTH;
+		pQueue->nCount--;
+		pQueue->IsSent = false;	// The next entry is sent on the following Run, after the reply has gone out
+
+		m_nRunPort = (nPort + 1) % DMX_MAX_UARTS;
+
+		return true;
+	}
+
+	return false;
+}
+
+void ArtNetRdmController::Send(uint8_t nPort) {
+	struct TRdmTransactionQueue *pQueue = m_pQueue[nPort];
+	const struct TRdmTransaction *pEntry = &pQueue->Entries[pQueue->nHead];
+
+	while (0 != RDMMessage::Receive(nPort)) {
+		// Discard late responses
+	}
+
+#ifndef NDEBUG
+	RDMMessage::Print(pEntry->RdmData);
+#endif
+
+	RDMMessage::SendRaw(nPort, pEntry->RdmData, pEntry->nLength);
+
+	pQueue->nSentMillis = Hardware::Get()->Millis();
+	pQueue->IsSent = true;
+}
+
+bool ArtNetRdmController::StartDiscovery(uint8_t nPort) {
+	if (nPort >= DMX_MAX_UARTS) {
+		return false;
+	}
+
+	DEBUG_PRINTF("nPort=%d", nPort);
+
+	m_Discovery[nPort]->Start(false);
+	m_nDiscoveryMillis[nPort] = Hardware::Get()->Millis();
+
+	return true;
+}
+
+TArtNetRdmDiscovery ArtNetRdmController::GetDiscoveryState(uint8_t nPort) {
+	if (nPort >= DMX_MAX_UARTS) {
+		return ARTNET_RDM_DISCOVERY_DONE;
+	}
+
+	switch (m_Discovery[nPort]->GetState()) {
+	case RDM_DISCOVERY_BUSY:
+		return ARTNET_RDM_DISCOVERY_BUSY;
+		break;
+	case RDM_DISCOVERY_PAUSE:
+		return ARTNET_RDM_DISCOVERY_PAUSE;
+		break;
+	default:
+		break;
+	}
+
+	return ARTNET_RDM_DISCOVERY_DONE;
+}
+
+bool ArtNetRdmController::IsTodChanged(uint8_t nPort) {
+	if (nPort >= DMX_MAX_UARTS) {
+		return false;
+	}
+
+	return m_Discovery[nPort]->IsTodChanged();
+}
+
+void ArtNetRdmController::SetDiscoveryBudget(uint32_t nSliceMillis, uint32_t nPauseMillis) {
+	for (unsigned i = 0; i < DMX_MAX_UARTS; i++) {
+		m_Discovery[i]->SetBudget(nSliceMillis, nPauseMillis);
+	}
+}
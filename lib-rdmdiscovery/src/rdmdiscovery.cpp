@@ -29,6 +29,7 @@
 #ifndef NDEBUG
 #include <stdio.h>
 #endif
+#include <assert.h>
 
 #include "rdm.h"
 #include "rdm_e120.h"
@@ -36,10 +37,6 @@
 
 #include "hardware.h"
 
-extern "C" {
- void udelay(uint32_t us);
-}
-
 static uint8_t pdl[2][RDM_UID_SIZE];
 
 typedef union cast {
@@ -49,9 +46,25 @@ typedef union cast {
 
 static _cast uuid_cast;
 
-#define RECEIVE_TIME_OUT (2800*100) //TODO
-
-RDMDiscovery::RDMDiscovery(uint8_t nPort) : m_nPort(nPort) {
+#define UID_UPPER_BOUND	0xfffffffffffe
+
+RDMDiscovery::RDMDiscovery(uint8_t nPort, uint16_t nTodSize) :
+	RDMTod(nTodSize),
+	m_nPort(nPort),
+	m_tStep(STEP_IDLE),
+	m_IsIncremental(false),
+	m_IsQuickFind(false),
+	m_IsPaused(false),
+	m_IsTodChanged(false),
+	m_nUnMuteCount(0),
+	m_nVerifyIndex(0),
+	m_nVerifyRetries(0),
+	m_nStepMillis(0),
+	m_nSliceMillis(0),
+	m_nBudgetSliceMillis(RDM_DISCOVERY_SLICE_MILLIS),
+	m_nBudgetPauseMillis(RDM_DISCOVERY_PAUSE_MILLIS),
+	m_nStackTop(0)
+{
 	m_UnMute.SetDstUid(UID_ALL);
 	m_UnMute.SetCc(E120_DISCOVERY_COMMAND);
 	m_UnMute.SetPid(E120_DISC_UN_MUTE);
@@ -62,9 +75,13 @@ RDMDiscovery::RDMDiscovery(uint8_t nPort) : m_nPort(nPort) {
 	m_DiscUniqueBranch.SetDstUid(UID_ALL);
 	m_DiscUniqueBranch.SetCc(E120_DISCOVERY_COMMAND);
 	m_DiscUniqueBranch.SetPid(E120_DISC_UNIQUE_BRANCH);
+
+	m_pStack = new TRdmDiscoveryBranch[RDM_DISCOVERY_STACK_SIZE];
+	assert(m_pStack != 0);
 }
 
 RDMDiscovery::~RDMDiscovery(void) {
+	delete[] m_pStack;
 }
 
 void RDMDiscovery::SetUid(const uint8_t *uid) {
@@ -80,97 +97,311 @@ const char *RDMDiscovery::GetUid(void) {
 }
 
 void RDMDiscovery::Full(void) {
-	struct TRdmMessage *response;
+	Start(false);
+
+	while (Step()) {
+		Hardware::Get()->WatchdogFeed();
+	}
+}
+
+void RDMDiscovery::Start(bool bIncremental) {
+	m_IsIncremental = bIncremental;
 
-	Reset();
+	if (!bIncremental) {
+		Reset();
+		m_IsTodChanged = true;
+	}
+
+	m_nUnMuteCount = bIncremental ? 1 : RDM_DISCOVERY_UNMUTE_COUNT;
+	m_nVerifyIndex = 0;
+	m_nVerifyRetries = 0;
+	m_nStackTop = 0;
+
+	m_IsPaused = false;
+	m_nSliceMillis = Hardware::Get()->Millis();
+
+	m_tStep = STEP_UNMUTE;
+}
+
+void RDMDiscovery::SetBudget(uint32_t nSliceMillis, uint32_t nPauseMillis) {
+	m_nBudgetSliceMillis = nSliceMillis;
+	m_nBudgetPauseMillis = nPauseMillis;
+}
 
-	m_UnMute.Send(m_nPort);
-	m_UnMute.ReceiveTimeOut(m_nPort, 2800);
+TRdmDiscoveryState RDMDiscovery::GetState(void) const {
+	if (m_tStep == STEP_IDLE) {
+		return RDM_DISCOVERY_DONE;
+	}
+
+	if (m_IsPaused || (m_tStep == STEP_UNMUTE_WAIT)) {
+		return RDM_DISCOVERY_PAUSE;
+	}
+
+	return RDM_DISCOVERY_BUSY;
+}
+
+TRdmDiscoveryState RDMDiscovery::Run(void) {
+	if (m_tStep == STEP_IDLE) {
+		return RDM_DISCOVERY_DONE;
+	}
+
+	const uint32_t nMillis = Hardware::Get()->Millis();
+
+	if (m_IsPaused) {
+		if ((nMillis - m_nSliceMillis) < m_nBudgetPauseMillis) {
+			return RDM_DISCOVERY_PAUSE;
+		}
+
+		m_IsPaused = false;
+		m_nSliceMillis = nMillis;
+	}
+
+	// A new request is only sent when there is time left in the slice
+	if (!IsWaiting() && (m_nBudgetPauseMillis != 0) && ((nMillis - m_nSliceMillis) >= m_nBudgetSliceMillis)) {
+		m_IsPaused = true;
+		m_nSliceMillis = nMillis;
+		return RDM_DISCOVERY_PAUSE;
+	}
 
-	Hardware::Get()->WatchdogFeed();
-	udelay(100000);
+	Step();
 
-	m_UnMute.Send(m_nPort);
-	m_UnMute.ReceiveTimeOut(m_nPort, 2800);
+	return GetState();
+}
 
-	Hardware::Get()->WatchdogFeed();
-	udelay(100000);
+/**
+ * The discovery resumes from Run after the pause of the budget
+ */
+bool RDMDiscovery::Pause(void) {
+	if (m_tStep == STEP_IDLE) {
+		return true;
+	}
 
-	m_UnMute.Send(m_nPort);
-	response = (struct TRdmMessage *) m_Mute.ReceiveTimeOut(m_nPort, RECEIVE_TIME_OUT);
+	if (IsWaiting()) {
+		Step();
 
-	if (response != 0) {
-		FindDevices(ConvertUid((const uint8_t *)response->source_uid), ConvertUid((const uint8_t *)response->source_uid));
+		if (IsWaiting()) {
+			return false;
+		}
 	}
 
-	FindDevices(0x000000000000, 0xfffffffffffe);
+	m_IsPaused = true;
+	m_nSliceMillis = Hardware::Get()->Millis();
+
+	return true;
+}
 
-	Dump();
+bool RDMDiscovery::IsWaiting(void) const {
+	return (m_tStep == STEP_VERIFY_WAIT) || (m_tStep == STEP_BRANCH_WAIT) || (m_tStep == STEP_MUTE_WAIT);
 }
 
-bool RDMDiscovery::FindDevices(uint64_t LowerBound, uint64_t UpperBound) {
-	struct TRdmMessage *response;
+bool RDMDiscovery::IsTimeOut(void) const {
+	return (Hardware::Get()->Millis() - m_nStepMillis) > RDM_DISCOVERY_RECEIVE_TIME_OUT;
+}
+
+/**
+ * Advances the discovery by one request or response, never waits.
+ * @return false when the discovery has completed
+ */
+bool RDMDiscovery::Step(void) {
+	const uint8_t *pResponse;
 	uint8_t uid[RDM_UID_SIZE];
-	bool bDeviceFound = false;
-	uint64_t MidPosition;
+	bool IsExpired;
+
+	switch (m_tStep) {
+	case STEP_UNMUTE:
+		m_UnMute.Send(m_nPort);
+		m_nUnMuteCount--;
+		m_nStepMillis = Hardware::Get()->Millis();
+		m_tStep = STEP_UNMUTE_WAIT;
+		break;
+	case STEP_UNMUTE_WAIT:
+		while (0 != RDMMessage::Receive(m_nPort)) {
+			// A broadcast is not answered
+		}
 
-	Hardware::Get()->WatchdogFeed();
+		if ((Hardware::Get()->Millis() - m_nStepMillis) < (m_nUnMuteCount != 0 ? RDM_DISCOVERY_UNMUTE_SPACING : RDM_DISCOVERY_RECEIVE_TIME_OUT)) {
+			break;
+		}
 
+		if (m_nUnMuteCount != 0) {
+			m_tStep = STEP_UNMUTE;
+		} else if (m_IsIncremental) {
+			m_tStep = STEP_VERIFY;
+		} else {
+			Push(0, UID_UPPER_BOUND);
+			m_tStep = STEP_BRANCH;
+		}
+		break;
+	case STEP_VERIFY:
+		if (m_nVerifyIndex >= GetUidCount()) {
+			// The known devices are muted now, only new devices answer
+			Push(0, UID_UPPER_BOUND);
+			m_tStep = STEP_BRANCH;
+			break;
+		}
+
+		SendMute(RDMTod::GetUid(m_nVerifyIndex));
+		m_tStep = STEP_VERIFY_WAIT;
+		break;
+	case STEP_VERIFY_WAIT:
+		IsExpired = IsTimeOut();	// Before the receive, a late response is not missed
+		pResponse = RDMMessage::Receive(m_nPort);
+
+		if ((pResponse == 0) && !IsExpired) {
+			break;
+		}
+
+		if ((pResponse != 0) && IsMuteResponse(pResponse, m_MuteUid)) {
+			m_nVerifyIndex++;
+			m_nVerifyRetries = 0;
+		} else if (m_nVerifyRetries++ == RDM_DISCOVERY_VERIFY_RETRIES) {
 #ifndef NDEBUG
-	printf("FindDevices : ");
-	PrintUid(LowerBound);
-	printf(" - ");
-	PrintUid(UpperBound);
-	printf("\n");
+			printf("Lost : ");
+			PrintUid(m_MuteUid);
+			printf("\n");
 #endif
+			Delete(m_MuteUid);	// The last entry moves to m_nVerifyIndex
+			m_IsTodChanged = true;
+			m_nVerifyRetries = 0;
+		}
 
-	if (LowerBound == UpperBound) {
-		memcpy(uid, ConvertUid(LowerBound), RDM_UID_SIZE);
-
-		m_Mute.SetDstUid(uid);
-		m_Mute.Send(m_nPort);
+		m_tStep = STEP_VERIFY;
+		break;
+	case STEP_BRANCH:
+		if (m_nStackTop == 0) {
+			m_tStep = STEP_IDLE;
+#ifndef NDEBUG
+			Dump();
+#endif
+			return false;
+		}
 
-		response = (struct TRdmMessage *) m_Mute.ReceiveTimeOut(m_nPort, RECEIVE_TIME_OUT);
+		m_tBranch = m_pStack[--m_nStackTop];
 
-		if (response != 0) {
-			if ((response->command_class == E120_DISCOVERY_COMMAND_RESPONSE) && (memcmp(uid, response->source_uid, RDM_UID_SIZE) == 0)) {
-				AddUid(uid);
-			}
+		if (m_tBranch.nLowerBound == m_tBranch.nUpperBound) {
+			m_IsQuickFind = false;
+			SendMute(ConvertUid(m_tBranch.nLowerBound));
+			m_tStep = STEP_MUTE_WAIT;
 		} else {
-			return true;
+			SendDiscUniqueBranch();
+			m_tStep = STEP_BRANCH_WAIT;
 		}
-	} else {
-		memcpy(pdl[0], ConvertUid(LowerBound), RDM_UID_SIZE);
-		memcpy(pdl[1], ConvertUid(UpperBound), RDM_UID_SIZE);
+		break;
+	case STEP_BRANCH_WAIT:
+		IsExpired = IsTimeOut();	// Before the receive, a late response is not missed
+		pResponse = RDMMessage::Receive(m_nPort);
 
-		m_DiscUniqueBranch.SetPd((const uint8_t *)pdl, 2* RDM_UID_SIZE);
-		m_DiscUniqueBranch.Send(m_nPort);
-
-		response = (struct TRdmMessage *) m_DiscUniqueBranch.ReceiveTimeOut(m_nPort, RECEIVE_TIME_OUT);
+		if ((pResponse == 0) && !IsExpired) {
+			break;
+		}
 
-		if (response != 0) {
-			bDeviceFound = true;
+		if (pResponse == 0) {
+			// No devices in this branch
+			m_tStep = STEP_BRANCH;
+		} else if (IsValidDiscoveryResponse(pResponse, uid)) {
+			// A single device, mute it and try the branch again
+			m_IsQuickFind = true;
+			SendMute(uid);
+			m_tStep = STEP_MUTE_WAIT;
+		} else {
+			// Collision
+			Split();
+			m_tStep = STEP_BRANCH;
+		}
+		break;
+	case STEP_MUTE_WAIT:
+		IsExpired = IsTimeOut();	// Before the receive, a late response is not missed
+		pResponse = RDMMessage::Receive(m_nPort);
 
-			if (IsValidDiscoveryResponse((const uint8_t *)response, uid)) {
-				bDeviceFound = QuickFind(uid);
-			}
+		if ((pResponse == 0) && !IsExpired) {
+			break;
+		}
 
-			if (bDeviceFound) {
-				MidPosition = ((LowerBound & (0x0000800000000000 - 1)) + (UpperBound & (0x0000800000000000 - 1))) / 2
-						+ (UpperBound & (0x0000800000000000) ? 0x0000400000000000 : 0 )
-						+ (LowerBound & (0x0000800000000000) ? 0x0000400000000000 : 0 );
+		if ((pResponse != 0) && IsMuteResponse(pResponse, m_MuteUid)) {
+			const bool IsAdded = AddUid(m_MuteUid);
 
-				bDeviceFound = FindDevices(LowerBound, MidPosition);
-				bDeviceFound |= FindDevices(MidPosition + 1, UpperBound);
+			if (IsAdded) {
+				m_IsTodChanged = true;
+			}
 
-				if (bDeviceFound) {
-					return true;
+			if (m_IsQuickFind) {
+				if (IsAdded) {
+					// Try the branch again, there can be more devices
+					Push(m_tBranch.nLowerBound, m_tBranch.nUpperBound);
+				} else {
+					// A known device answered, it acknowledges the mute but does not keep it
+					Split();
 				}
 			}
+		} else if (m_IsQuickFind) {
+			// The device did not mute, it would answer this branch forever
+			Split();
 		}
+
+		m_tStep = STEP_BRANCH;
+		break;
+	case STEP_IDLE:
+	default:
+		return false;
+		break;
+	}
+
+	return true;
+}
+
+void RDMDiscovery::SendMute(const uint8_t *pUid) {
+	memcpy(m_MuteUid, pUid, RDM_UID_SIZE);
+
+	m_Mute.SetDstUid(m_MuteUid);
+	m_Mute.Send(m_nPort);
+
+	m_nStepMillis = Hardware::Get()->Millis();
+}
+
+void RDMDiscovery::SendDiscUniqueBranch(void) {
+#ifndef NDEBUG
+	printf("FindDevices : ");
+	PrintUid(m_tBranch.nLowerBound);
+	printf(" - ");
+	PrintUid(m_tBranch.nUpperBound);
+	printf("\n");
+#endif
+
+	memcpy(pdl[0], ConvertUid(m_tBranch.nLowerBound), RDM_UID_SIZE);
+	memcpy(pdl[1], ConvertUid(m_tBranch.nUpperBound), RDM_UID_SIZE);
+
+	m_DiscUniqueBranch.SetPd((const uint8_t *)pdl, 2 * RDM_UID_SIZE);
+	m_DiscUniqueBranch.Send(m_nPort);
+
+	m_nStepMillis = Hardware::Get()->Millis();
+}
+
+bool RDMDiscovery::IsMuteResponse(const uint8_t *pResponse, const uint8_t *pUid) const {
+	const struct TRdmMessage *p = (const struct TRdmMessage *) pResponse;
+
+	return (p->start_code == E120_SC_RDM) && (p->command_class == E120_DISCOVERY_COMMAND_RESPONSE) && (memcmp(pUid, p->source_uid, RDM_UID_SIZE) == 0);
+}
+
+bool RDMDiscovery::Push(uint64_t nLowerBound, uint64_t nUpperBound) {
+	assert(m_nStackTop < RDM_DISCOVERY_STACK_SIZE);
+
+	if (m_nStackTop == RDM_DISCOVERY_STACK_SIZE) {
+		return false;
 	}
 
-	return false;
+	m_pStack[m_nStackTop].nLowerBound = nLowerBound;
+	m_pStack[m_nStackTop].nUpperBound = nUpperBound;
+	m_nStackTop++;
+
+	return true;
+}
+
+void RDMDiscovery::Split(void) {
+	const uint64_t nMidPosition = m_tBranch.nLowerBound + (m_tBranch.nUpperBound - m_tBranch.nLowerBound) / 2;
+
+	// The lower half is searched first
+	Push(nMidPosition + 1, m_tBranch.nUpperBound);
+	Push(m_tBranch.nLowerBound, nMidPosition);
 }
 
 const uint8_t *RDMDiscovery::ConvertUid(const uint64_t uid) {
@@ -233,39 +464,3 @@ bool RDMDiscovery::IsValidDiscoveryResponse(const uint8_t *response, uint8_t *ui
 
 	return bIsValid;
 }
-
-bool RDMDiscovery::QuickFind(const uint8_t *uid) {
-	uint8_t *response;
-	struct TRdmMessage *p;
-	uint8_t r_uid[RDM_UID_SIZE];
-
-#ifndef NDEBUG
-	printf("QuickFind : ");
-	PrintUid((uint8_t *)uid);
-	printf("\n");
-#endif
-
-	m_Mute.SetDstUid(uid);
-	m_Mute.Send(m_nPort);
-
-	response = (uint8_t *) m_Mute.ReceiveTimeOut(m_nPort, RECEIVE_TIME_OUT);
-
-	if (response != 0) {
-		p = (struct TRdmMessage *) response;
-		if ((p->command_class == E120_DISCOVERY_COMMAND_RESPONSE) && (memcmp(uid, p->source_uid, RDM_UID_SIZE) == 0)) {
-			AddUid(uid);
-		}
-	}
-
-	m_DiscUniqueBranch.Send(m_nPort);
-
-	response = (uint8_t *) m_DiscUniqueBranch.ReceiveTimeOut(m_nPort, RECEIVE_TIME_OUT);
-
-	if ((response != 0) && (IsValidDiscoveryResponse(response, r_uid))) {
-		QuickFind(r_uid);
-	} else {
-		return true;
-	}
-
-	return false;
-}
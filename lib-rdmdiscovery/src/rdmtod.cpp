@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <assert.h>
 #ifndef NDEBUG
  #include <stdio.h>
 #endif
@@ -36,37 +37,96 @@
  #define ALIGNED __attribute__ ((aligned (4)))
 #endif
 
-RDMTod::RDMTod(void) : m_nEntries(0) {
-	m_pTable = new TRdmTod[TOD_TABLE_SIZE];
+#define TOD_HASH_BITS_MIN	4
 
-	for (uint32_t i = 0 ; i < TOD_TABLE_SIZE; i++) {
-		memcpy(&m_pTable[i], UID_ALL, RDM_UID_SIZE);
+RDMTod::RDMTod(uint16_t nSize) : m_nSize(nSize), m_nEntries(0) {
+	if (m_nSize == 0) {
+		m_nSize = TOD_TABLE_SIZE;
+	} else if (m_nSize > TOD_TABLE_SIZE_MAX) {
+		m_nSize = TOD_TABLE_SIZE_MAX;
+	}
+
+	uint32_t nBits = TOD_HASH_BITS_MIN;
+
+	while ((1U << nBits) < m_nSize) {
+		nBits++;
+	}
+
+	m_nHashShift = 32 - nBits;
+
+	m_pTable = new TRdmTod[m_nSize];
+	assert(m_pTable != 0);
+
+	m_pNext = new uint16_t[m_nSize];
+	assert(m_pNext != 0);
+
+	m_pBuckets = new uint16_t[1U << nBits];
+	assert(m_pBuckets != 0);
+
+	for (uint32_t i = 0 ; i < (1U << nBits); i++) {
+		m_pBuckets[i] = TOD_INDEX_NONE;
 	}
 }
 
 RDMTod::~RDMTod(void) {
 	m_nEntries = 0;
+	delete[] m_pBuckets;
+	delete[] m_pNext;
 	delete[] m_pTable;
 }
 
-uint8_t RDMTod::GetUidCount(void) const {
-	return m_nEntries;
+uint32_t RDMTod::Hash(const uint8_t *pUid) const {
+	const uint32_t nDevice = ((uint32_t) pUid[2] << 24) | ((uint32_t) pUid[3] << 16) | ((uint32_t) pUid[4] << 8) | (uint32_t) pUid[5];
+	const uint32_t nManufacturer = ((uint32_t) pUid[0] << 8) | (uint32_t) pUid[1];
+
+	// Multiplicative hashing, the device id is often sequential within a manufacturer
+	return ((nDevice ^ (nManufacturer * 0x9E3779B1)) * 2654435761U) >> m_nHashShift;
 }
 
-bool RDMTod::Exist(const uint8_t *pUid) {
-	for (uint32_t i = 0 ; i < m_nEntries; i++) {
-		if (memcmp(&m_pTable[i], pUid, RDM_UID_SIZE) == 0) {
-			return true;
+uint16_t RDMTod::Find(const uint8_t *pUid) const {
+	uint16_t nIndex = m_pBuckets[Hash(pUid)];
+
+	while (nIndex != TOD_INDEX_NONE) {
+		if (memcmp(m_pTable[nIndex].uid, pUid, RDM_UID_SIZE) == 0) {
+			return nIndex;
 		}
+		nIndex = m_pNext[nIndex];
+	}
+
+	return TOD_INDEX_NONE;
+}
+
+void RDMTod::Unlink(uint16_t nIndex) {
+	uint16_t *pLink = &m_pBuckets[Hash(m_pTable[nIndex].uid)];
+
+	while (*pLink != nIndex) {
+		assert(*pLink != TOD_INDEX_NONE);
+		pLink = &m_pNext[*pLink];
+	}
+
+	*pLink = m_pNext[nIndex];
+}
+
+uint16_t RDMTod::GetUidCount(void) const {
+	return m_nEntries;
+}
+
+const uint8_t *RDMTod::GetUid(uint16_t nIndex) const {
+	if (nIndex >= m_nEntries) {
+		return 0;
 	}
 
-	return false;
+	return m_pTable[nIndex].uid;
+}
+
+bool RDMTod::Exist(const uint8_t *pUid) const {
+	return Find(pUid) != TOD_INDEX_NONE;
 }
 
-void RDMTod::Dump(uint8_t nCount) {
+void RDMTod::Dump(uint16_t nCount) {
 #ifndef NDEBUG
-	if (nCount > TOD_TABLE_SIZE) {
-		nCount = TOD_TABLE_SIZE;
+	if (nCount > m_nEntries) {
+		nCount = m_nEntries;
 	}
 
 	for (uint32_t i = 0 ; i < nCount; i++) {
@@ -82,40 +142,46 @@ void RDMTod::Dump(void) {
 }
 
 bool RDMTod::AddUid(const uint8_t *pUid) {
-	if (m_nEntries == TOD_TABLE_SIZE) {
+	if (m_nEntries == m_nSize) {
 		return false;
 	}
 
-	if (Exist(pUid)) {
-		return false;
+	const uint32_t nHash = Hash(pUid);
+
+	for (uint16_t i = m_pBuckets[nHash]; i != TOD_INDEX_NONE; i = m_pNext[i]) {
+		if (memcmp(m_pTable[i].uid, pUid, RDM_UID_SIZE) == 0) {
+			return false;
+		}
 	}
 
-	memcpy(&m_pTable[m_nEntries++], pUid, RDM_UID_SIZE);
+	memcpy(m_pTable[m_nEntries].uid, pUid, RDM_UID_SIZE);
+	m_pNext[m_nEntries] = m_pBuckets[nHash];
+	m_pBuckets[nHash] = m_nEntries;
+	m_nEntries++;
 
 	return true;
 }
 
 bool RDMTod::Delete(const uint8_t *pUid) {
-	bool found = false;
-	uint32_t i;
-
-	for (i = 0 ; i < m_nEntries; i++) {
-		if (memcmp(&m_pTable[i], pUid, RDM_UID_SIZE) == 0) {
-			found = true;
-			break;
-		}
-	}
+	const uint16_t nIndex = Find(pUid);
 
-	if (!found) {
+	if (nIndex == TOD_INDEX_NONE) {
 		return false;
 	}
 
-	if (i == TOD_TABLE_SIZE - 1) {
-		memcpy(&m_pTable[i], UID_ALL, RDM_UID_SIZE);
-	} else {
-		for (; i < m_nEntries; i++) {
-			memcpy(&m_pTable[i], &m_pTable[i + 1], RDM_UID_SIZE);
-		}
+	Unlink(nIndex);
+
+	const uint16_t nLast = m_nEntries - 1;
+
+	// Keep the table dense, the last entry moves into the hole
+	if (nIndex != nLast) {
+		Unlink(nLast);
+
+		memcpy(m_pTable[nIndex].uid, m_pTable[nLast].uid, RDM_UID_SIZE);
+
+		const uint32_t nHash = Hash(m_pTable[nIndex].uid);
+		m_pNext[nIndex] = m_pBuckets[nHash];
+		m_pBuckets[nHash] = nIndex;
 	}
 
 	m_nEntries--;
@@ -123,18 +189,23 @@ bool RDMTod::Delete(const uint8_t *pUid) {
 	return true;
 }
 
-void RDMTod::Copy(uint8_t *pTable) {
-	const uint8_t *src = (const uint8_t *) m_pTable;
-	uint8_t *dst = (uint8_t *) pTable;
+uint16_t RDMTod::Copy(uint8_t *pTable, uint16_t nOffset, uint16_t nCount) const {
+	if (nOffset >= m_nEntries) {
+		return 0;
+	}
 
-	for (uint32_t i = 0; i < (m_nEntries * RDM_UID_SIZE); i++) {
-		*dst++ = *src++;
+	if (nCount > (m_nEntries - nOffset)) {
+		nCount = m_nEntries - nOffset;
 	}
+
+	memcpy(pTable, &m_pTable[nOffset], nCount * RDM_UID_SIZE);
+
+	return nCount;
 }
 
 void RDMTod::Reset(void) {
-	for (uint32_t i = 0 ; i < m_nEntries; i++) {
-		memcpy(&m_pTable[i], UID_ALL, RDM_UID_SIZE);
+	for (uint32_t i = 0 ; i < (1U << (32 - m_nHashShift)); i++) {
+		m_pBuckets[i] = TOD_INDEX_NONE;
 	}
 
 	m_nEntries = 0;
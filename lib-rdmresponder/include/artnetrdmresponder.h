@@ -43,8 +43,8 @@ public:
 	~ArtNetRdmResponder(void);
 
 	void Full(uint8_t nPort);
-	const uint8_t GetUidCount(uint8_t nPort);
-	void Copy(uint8_t nPort, uint8_t *);
+	const uint16_t GetUidCount(uint8_t nPort);
+	uint16_t Copy(uint8_t nPort, uint8_t *pTod, uint16_t nOffset, uint16_t nCount);
 	const uint8_t *Handler(uint8_t nPort, const uint8_t *);
 
 	inline RDMDeviceResponder *GetRDMDeviceResponder(void) {
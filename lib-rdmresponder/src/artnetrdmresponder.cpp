@@ -60,11 +60,15 @@ void ArtNetRdmResponder::Full(uint8_t nPort) {
 	// We are a Responder - no code needed
 }
 
-const uint8_t ArtNetRdmResponder::GetUidCount(uint8_t nPort) {
+const uint16_t ArtNetRdmResponder::GetUidCount(uint8_t nPort) {
 	return 1; // We are a Responder
 }
 
-void ArtNetRdmResponder::Copy(uint8_t nPort, unsigned char *tod) {
+uint16_t ArtNetRdmResponder::Copy(uint8_t nPort, uint8_t *tod, uint16_t nOffset, uint16_t nCount) {
+	if ((nOffset != 0) || (nCount == 0)) {
+		return 0;
+	}
+
 	unsigned char *src = (unsigned char *) m_Responder.GetUID();
 	unsigned char *dst = tod;
 
@@ -73,6 +77,8 @@ void ArtNetRdmResponder::Copy(uint8_t nPort, unsigned char *tod) {
 		dst++;
 		src++;
 	}
+
+	return 1;
 }
 
 const uint8_t *ArtNetRdmResponder::Handler(uint8_t nPort, const uint8_t *pRdmDataNoSC) {
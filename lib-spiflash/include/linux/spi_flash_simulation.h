@@ -0,0 +1,75 @@
+/**
+ * @file spi_flash_simulation.h
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LINUX_SPI_FLASH_SIMULATION_H_
+#define LINUX_SPI_FLASH_SIMULATION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct spi_flash_simulation_stats {
+	uint32_t erases;			///< Sector erases
+	uint32_t programs;			///< Page programs
+	uint32_t bytes_programmed;
+	uint32_t bytes_read;
+	uint32_t bytes_transferred;	///< All bytes on the bus, commands and status polls included
+	uint64_t busy_us;			///< Typical erase and program times of the simulated chip
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The simulated W25Q16 is backed by the file, which is created erased when it does not exist.
+ * Opening it also restores the power.
+ */
+extern int spi_flash_simulation_open(const char *pathname);
+extern void spi_flash_simulation_close(void);
+
+/**
+ * The power fails during the n-th next page program or sector erase: the
+ * first half of it is done, after that all commands are ignored.
+ * 0 disables.
+ */
+extern void spi_flash_simulation_power_fail(uint32_t operations);
+extern bool spi_flash_simulation_is_powered(void);
+
+/**
+ * The chip reports busy (WIP) for the typical program and erase times, and
+ * ignores other commands meanwhile. Default true, false for fast tests.
+ */
+extern void spi_flash_simulation_set_busy(bool busy);
+
+extern uint32_t spi_flash_simulation_get_erases(uint32_t offset);	///< Erase count of the sector
+
+extern void spi_flash_simulation_get_stats(struct spi_flash_simulation_stats *stats);
+extern void spi_flash_simulation_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINUX_SPI_FLASH_SIMULATION_H_ */
@@ -23,6 +23,8 @@
  * THE SOFTWARE.
  */
 
+#if defined(RASPPI)
+
 #include <stdio.h>
 #include <stdint.h>
 #include <unistd.h>
@@ -74,3 +76,5 @@ int spi_xfer(unsigned len, const void *dout, void *din, unsigned long flags) {
 
 	return 0;
 }
+
+#endif
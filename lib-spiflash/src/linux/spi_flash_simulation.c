@@ -0,0 +1,330 @@
+/**
+ * @file spi_flash_simulation.c
+ *
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * A file-backed SPI NOR flash, so that the flash users can be benchmarked and
+ * power-fail tested on a Linux host. It answers the commands of spi_flash.c
+ * as a Winbond W25Q16 does: programming can only clear bits, an erase sets
+ * the 4KB sector to 0xFF.
+ */
+
+#if !defined(RASPPI)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <assert.h>
+
+#include "linux/spi_flash_simulation.h"
+
+#include "../spi_flash_internal.h"
+
+#define SIMULATION_SIZE			(2 * 1024 * 1024)
+#define SIMULATION_SECTOR_SIZE	4096
+#define SIMULATION_PAGE_SIZE	256
+#define SIMULATION_FILE			"spi_flash.bin"
+
+#define TYPICAL_SECTOR_ERASE_US	45000
+#define TYPICAL_PAGE_PROGRAM_US	700
+
+#define STATUS_WEL				0x02
+
+static const uint8_t s_idcode[] = { 0xef, 0x40, 0x15 };	// W25Q16
+
+static uint8_t *s_data;
+static uint32_t s_erases[SIMULATION_SIZE / SIMULATION_SECTOR_SIZE];
+static struct spi_flash_simulation_stats s_stats;
+static int s_fd = -1;
+
+static uint8_t s_tx[4 + SIMULATION_PAGE_SIZE];
+static uint32_t s_tx_len;
+static uint32_t s_rx_len;
+static uint8_t s_status;
+
+static uint32_t s_fail_countdown;
+static bool s_is_powered = true;
+
+static bool s_is_busy_simulated = true;
+static uint64_t s_busy_until_us;
+
+static uint64_t now_us(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t) ts.tv_sec * 1000000) + ((uint64_t) ts.tv_nsec / 1000);
+}
+
+static bool is_busy(void) {
+	return s_is_busy_simulated && (now_us() < s_busy_until_us);
+}
+
+static void set_busy(uint32_t us) {
+	s_busy_until_us = now_us() + us;
+	s_stats.busy_us += us;
+}
+
+static void sync_file(uint32_t offset, uint32_t len) {
+	if (s_fd >= 0) {
+		if (pwrite(s_fd, &s_data[offset], len, offset) != (ssize_t) len) {
+			perror("pwrite");
+		}
+	}
+}
+
+static bool power_fails(void) {
+	if ((s_fail_countdown != 0) && (--s_fail_countdown == 0)) {
+		s_is_powered = false;
+		return true;
+	}
+
+	return false;
+}
+
+static uint32_t get_address(void) {
+	return ((uint32_t) s_tx[1] << 16) | ((uint32_t) s_tx[2] << 8) | s_tx[3];
+}
+
+static void page_program(void) {
+	const uint32_t address = get_address() % SIMULATION_SIZE;
+	const uint32_t page = address & ~(SIMULATION_PAGE_SIZE - 1);
+	uint32_t len = s_tx_len - 4;
+	uint32_t i;
+
+	if (power_fails()) {
+		len /= 2;
+	}
+
+	// The address wraps within the page
+	for (i = 0; i < len; i++) {
+		s_data[page + ((address + i) % SIMULATION_PAGE_SIZE)] &= s_tx[4 + i];
+	}
+
+	sync_file(page, SIMULATION_PAGE_SIZE);
+
+	s_stats.programs++;
+	s_stats.bytes_programmed += len;
+
+	set_busy(TYPICAL_PAGE_PROGRAM_US);
+}
+
+static void sector_erase(void) {
+	const uint32_t sector = (get_address() % SIMULATION_SIZE) & ~(SIMULATION_SECTOR_SIZE - 1);
+	uint32_t len = SIMULATION_SECTOR_SIZE;
+
+	if (power_fails()) {
+		len /= 2;
+	}
+
+	memset(&s_data[sector], 0xFF, len);
+
+	sync_file(sector, SIMULATION_SECTOR_SIZE);
+
+	s_erases[sector / SIMULATION_SECTOR_SIZE]++;
+	s_stats.erases++;
+
+	set_busy(TYPICAL_SECTOR_ERASE_US);
+}
+
+static void execute(void) {
+	if ((s_tx_len == 0) || !s_is_powered || is_busy()) {
+		return;
+	}
+
+	switch (s_tx[0]) {
+	case CMD_WRITE_ENABLE:
+		s_status |= STATUS_WEL;
+		break;
+	case CMD_WRITE_DISABLE:
+		s_status &= ~STATUS_WEL;
+		break;
+	case CMD_PAGE_PROGRAM:
+		if ((s_status & STATUS_WEL) && (s_tx_len > 4)) {
+			page_program();
+		}
+		s_status &= ~STATUS_WEL;
+		break;
+	case CMD_ERASE_4K:
+		if ((s_status & STATUS_WEL) && (s_tx_len >= 4)) {
+			sector_erase();
+		}
+		s_status &= ~STATUS_WEL;
+		break;
+	case CMD_WRITE_STATUS:
+		s_status &= ~STATUS_WEL;
+		break;
+	default:
+		break;
+	}
+}
+
+static void respond(uint8_t *din, uint32_t len) {
+	uint32_t i;
+
+	for (i = 0; i < len; i++, s_rx_len++) {
+		uint8_t data = 0xFF;
+
+		switch (s_tx[0]) {
+		case CMD_READ_ID:
+			data = (s_rx_len < sizeof(s_idcode)) ? s_idcode[s_rx_len] : 0x00;
+			break;
+		case CMD_READ_STATUS:
+			data = is_busy() ? (s_status | STATUS_WIP) : s_status;
+			break;
+		case CMD_READ_ARRAY_SLOW:
+		case CMD_READ_ARRAY_FAST:
+			if (is_busy()) {
+				break;
+			}
+			data = s_data[(get_address() + s_rx_len) % SIMULATION_SIZE];
+			s_stats.bytes_read++;
+			break;
+		default:
+			break;
+		}
+
+		din[i] = data;
+	}
+}
+
+int spi_init(void) {
+	if (s_data == NULL) {
+		return spi_flash_simulation_open(SIMULATION_FILE);
+	}
+
+	return 0;
+}
+
+int spi_xfer(unsigned len, const void *dout, void *din, unsigned long flags) {
+	if (s_data == NULL) {
+		return -1;
+	}
+
+	if (flags & SPI_XFER_BEGIN) {
+		s_tx_len = 0;
+		s_rx_len = 0;
+	}
+
+	s_stats.bytes_transferred += len;
+
+	if (dout != NULL) {
+		const uint8_t *p = (const uint8_t *) dout;
+		uint32_t i;
+
+		for (i = 0; (i < len) && (s_tx_len < sizeof(s_tx)); i++) {
+			s_tx[s_tx_len++] = p[i];
+		}
+	}
+
+	if (din != NULL) {
+		respond((uint8_t *) din, len);
+	}
+
+	if (flags & SPI_XFER_END) {
+		execute();
+	}
+
+	return 0;
+}
+
+int spi_flash_simulation_open(const char *pathname) {
+	assert(pathname != NULL);
+
+	spi_flash_simulation_close();
+
+	s_data = malloc(SIMULATION_SIZE);
+	assert(s_data != NULL);
+
+	if (s_data == NULL) {
+		return -1;
+	}
+
+	memset(s_data, 0xFF, SIMULATION_SIZE);
+
+	s_fd = open(pathname, O_RDWR | O_CREAT, 0644);
+
+	if (s_fd < 0) {
+		perror(pathname);
+		return -1;
+	}
+
+	if (pread(s_fd, s_data, SIMULATION_SIZE, 0) != SIMULATION_SIZE) {
+		memset(s_data, 0xFF, SIMULATION_SIZE);
+		sync_file(0, SIMULATION_SIZE);
+	}
+
+	s_status = 0;
+	s_busy_until_us = 0;
+	s_fail_countdown = 0;
+	s_is_powered = true;
+
+	return 0;
+}
+
+void spi_flash_simulation_close(void) {
+	if (s_fd >= 0) {
+		close(s_fd);
+		s_fd = -1;
+	}
+
+	free(s_data);
+	s_data = NULL;
+}
+
+void spi_flash_simulation_power_fail(uint32_t operations) {
+	s_fail_countdown = operations;
+}
+
+void spi_flash_simulation_set_busy(bool busy) {
+	s_is_busy_simulated = busy;
+}
+
+bool spi_flash_simulation_is_powered(void) {
+	return s_is_powered;
+}
+
+uint32_t spi_flash_simulation_get_erases(uint32_t offset) {
+	assert(offset < SIMULATION_SIZE);
+
+	return s_erases[offset / SIMULATION_SECTOR_SIZE];
+}
+
+void spi_flash_simulation_get_stats(struct spi_flash_simulation_stats *stats) {
+	assert(stats != NULL);
+
+	memcpy(stats, &s_stats, sizeof(struct spi_flash_simulation_stats));
+}
+
+void spi_flash_simulation_reset_stats(void) {
+	memset(&s_stats, 0, sizeof(struct spi_flash_simulation_stats));
+	memset(s_erases, 0, sizeof(s_erases));
+}
+
+#endif
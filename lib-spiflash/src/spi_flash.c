@@ -353,6 +353,22 @@ int spi_flash_cmd_write_status(uint8_t sr) {
 	return 0;
 }
 
+/*
+ * A single status read, for callers that do not want to wait for an erase or program
+ */
+int spi_flash_is_busy(void) {
+	uint8_t status = 0;
+	uint8_t cmd = s_flash.poll_cmd;
+
+	spi_flash_cmd_read(&cmd, 1, &status, 1);
+
+	if (cmd == CMD_FLAG_STATUS) {
+		return (status & STATUS_PEC) == 0;
+	}
+
+	return (status & STATUS_WIP) != 0;
+}
+
 int spi_flash_probe(unsigned int cs, unsigned int max_hz, unsigned int spi_mode) {
 	int shift, i;
 	uint8_t idcode[IDCODE_LEN] = {0, };
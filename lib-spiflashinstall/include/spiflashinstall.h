@@ -47,6 +47,7 @@ private:
 	bool m_bHaveFlashChip;
 	uint32_t m_nEraseSize;
 	uint32_t m_nFlashSize;
+	uint32_t m_nStoreAddress;	///< Start of the SPI flash store, nothing is installed from here
 	uint8_t *m_pFileBuffer;
 	uint8_t *m_pFlashBuffer;
 	FILE *m_pFile;
@@ -32,6 +32,8 @@
 
 #include "spi_flash.h"
 
+#include "spiflashstorelayout.h"
+
 #include "debug.h"
 
 #ifndef ALIGNED
@@ -53,6 +55,7 @@ SpiFlashInstall::SpiFlashInstall(void):
 	m_bHaveFlashChip(false),
 	m_nEraseSize(0),
 	m_nFlashSize(0),
+	m_nStoreAddress(0),
 	m_pFileBuffer(0),
 	m_pFlashBuffer(0),
 	m_pFile(0)
@@ -75,6 +78,7 @@ SpiFlashInstall::SpiFlashInstall(void):
 
 				m_bHaveFlashChip = true;
 				m_nEraseSize = spi_flash_get_sector_size();
+				m_nStoreAddress = m_nFlashSize - (SPI_FLASH_STORE_SECTORS * m_nEraseSize);
 
 				m_pFileBuffer = new uint8_t[m_nEraseSize];
 				assert(m_pFileBuffer != 0);
@@ -223,7 +227,7 @@ void SpiFlashInstall::Write(uint32_t nOffset) {
 	DEBUG_ENTRY
 
 	assert(m_pFile != 0);
-	assert(nOffset < m_nFlashSize);
+	assert(nOffset < m_nStoreAddress);
 	assert(m_pFileBuffer != 0);
 
 	bool bSuccess __attribute__((unused)) = false;
@@ -233,7 +237,8 @@ void SpiFlashInstall::Write(uint32_t nOffset) {
 
 	(void) fseek(m_pFile, 0L, SEEK_SET);
 
-	while (n_Address < m_nFlashSize) {
+	// The last sectors hold the SPI flash store
+	while (n_Address < m_nStoreAddress) {
 		const size_t nBytes = fread(m_pFileBuffer, sizeof(uint8_t), (size_t) m_nEraseSize, m_pFile);
 		nTotalBytes += nBytes;
 
@@ -273,6 +278,14 @@ void SpiFlashInstall::Write(uint32_t nOffset) {
 		n_Address += m_nEraseSize;
 	}
 
+	if (n_Address >= m_nStoreAddress) {
+		if (fgetc(m_pFile) == EOF) {
+			bSuccess = (ferror(m_pFile) == 0);
+		} else {
+			printf("error: the file does not fit below the SPI flash store\n");
+		}
+	}
+
 	if (bSuccess) {
 		printf("%d bytes written\n", (int) nTotalBytes);
 	}
@@ -0,0 +1,377 @@
+/**
+ * @file store_bench.cpp
+ *
+ * Wear, boot time and power loss of SpiFlashStore on the simulated flash, against the single sector store.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "spiflashstore.h"
+#include "spi_flash.h"
+
+#include "linux/spi_flash_simulation.h"
+
+#include "hardwarelinux.h"
+
+#define FILE_NAME		"flash.bin"
+
+#define COMMITS			1000
+#define CUT_COMMITS		60
+
+#define SECTOR_SIZE		4096
+
+/*
+ * The store before the record log: one sector at the end of the flash, erased and
+ * written completely for every commit. The signature, 16 bytes reserved for the
+ * UUID, then the stores in the order of TStore.
+ */
+#define LEGACY_OFFSET_STORES	32
+#define LEGACY_SIZE				(LEGACY_OFFSET_STORES + 96 + 144 + 32 + 32 + 96)
+
+static const uint8_t s_aSignature[] = {'A', 'v', 'V', 0x10};
+static const uint32_t s_aLegacyOffset[STORE_LAST] = {32, 128, 272, 304, 336};
+
+#define STORES	3
+
+static const enum TStore s_aStore[STORES] = { STORE_NETWORK, STORE_ARTNET, STORE_E131 };
+static const uint32_t s_aSize[STORES] = { 96, 144, 96 };
+
+struct TState {
+	uint8_t Data[STORES][144];
+};
+
+static int s_nErrors;
+
+static void make_state(struct TState *pState, uint32_t nSeed) {
+	memset(pState, 0, sizeof(struct TState));
+	srand(nSeed * 7919 + 1);
+
+	for (uint32_t k = 0; k < STORES; k++) {
+		for (uint32_t i = 0; i < s_aSize[k]; i++) {
+			pState->Data[k][i] = (uint8_t) rand();
+		}
+	}
+}
+
+// One store changes per commit, as with an ArtAddress or an RDM SET
+static void change_state(struct TState *pState, uint32_t nCommit) {
+	srand(nCommit);
+
+	const uint32_t k = nCommit % STORES;
+
+	for (uint32_t i = 0; i < 8; i++) {
+		pState->Data[k][4 + (rand() % (s_aSize[k] - 4))] = (uint8_t) rand();
+	}
+}
+
+static bool is_equal(const struct TState *pA, const struct TState *pB) {
+	return memcmp(pA, pB, sizeof(struct TState)) == 0;
+}
+
+// SpiFlashStore prints the detected chip, the power loss test constructs it a few hundred times
+static int s_nStdout = -1;
+
+static void quiet(bool bOn) {
+	fflush(stdout);
+
+	if (bOn) {
+		s_nStdout = dup(STDOUT_FILENO);
+		const int fd = open("/dev/null", O_WRONLY);
+		dup2(fd, STDOUT_FILENO);
+		close(fd);
+	} else if (s_nStdout >= 0) {
+		dup2(s_nStdout, STDOUT_FILENO);
+		close(s_nStdout);
+		s_nStdout = -1;
+	}
+}
+
+static void flash_open(bool bErase) {
+	if (bErase) {
+		unlink(FILE_NAME);
+	}
+
+	spi_flash_simulation_open(FILE_NAME);
+	spi_flash_simulation_set_busy(false);
+	spi_flash_probe(0, 0, 0);
+}
+
+static void store_commit(SpiFlashStore *pStore, const struct TState *pState) {
+	for (uint32_t k = 0; k < STORES; k++) {
+		pStore->Update(s_aStore[k], 0, (void *) pState->Data[k], s_aSize[k], 0);
+	}
+
+	pStore->Commit();
+}
+
+static void store_load(SpiFlashStore *pStore, struct TState *pState) {
+	memset(pState, 0, sizeof(struct TState));
+
+	for (uint32_t k = 0; k < STORES; k++) {
+		pStore->Copy(s_aStore[k], pState->Data[k], s_aSize[k]);
+	}
+}
+
+static uint32_t legacy_address(void) {
+	return spi_flash_get_size() - SECTOR_SIZE;
+}
+
+static void legacy_commit(const struct TState *pState) {
+	uint8_t aSector[LEGACY_SIZE];
+
+	memset(aSector, 0xFF, sizeof(aSector));
+	memcpy(aSector, s_aSignature, sizeof(s_aSignature));
+	memset(&aSector[s_aLegacyOffset[STORE_DMXSEND]], 0, 4);
+	memset(&aSector[s_aLegacyOffset[STORE_SPI]], 0, 4);
+
+	for (uint32_t k = 0; k < STORES; k++) {
+		memcpy(&aSector[s_aLegacyOffset[s_aStore[k]]], pState->Data[k], s_aSize[k]);
+	}
+
+	spi_flash_cmd_erase(legacy_address(), SECTOR_SIZE);
+	spi_flash_cmd_write_multi(legacy_address(), sizeof(aSector), aSector);
+}
+
+static bool legacy_load(struct TState *pState) {
+	uint8_t aSector[SECTOR_SIZE];
+
+	spi_flash_cmd_read_fast(legacy_address(), sizeof(aSector), aSector);
+
+	memset(pState, 0, sizeof(struct TState));
+
+	for (uint32_t k = 0; k < STORES; k++) {
+		memcpy(pState->Data[k], &aSector[s_aLegacyOffset[s_aStore[k]]], s_aSize[k]);
+	}
+
+	return memcmp(aSector, s_aSignature, sizeof(s_aSignature)) == 0;
+}
+
+static uint32_t max_sector_erases(void) {
+	uint32_t nMax = 0;
+
+	for (uint32_t nOffset = 0; nOffset < spi_flash_get_size(); nOffset += SECTOR_SIZE) {
+		const uint32_t nErases = spi_flash_simulation_get_erases(nOffset);
+
+		if (nErases > nMax) {
+			nMax = nErases;
+		}
+	}
+
+	return nMax;
+}
+
+static void print_wear(const char *pName) {
+	struct spi_flash_simulation_stats Stats;
+
+	spi_flash_simulation_get_stats(&Stats);
+
+	printf("  %s: %u erases (at most %u per sector), %u bytes, %.1f ms busy per commit\n", pName,
+			Stats.erases, max_sector_erases(), Stats.bytes_programmed, (double) Stats.busy_us / 1000 / COMMITS);
+}
+
+static void test_wear(void) {
+	struct TState State, Loaded;
+	struct spi_flash_simulation_stats Stats;
+
+	printf("%d commits that each change one store:\n", COMMITS);
+
+	flash_open(true);
+	make_state(&State, 0);
+	legacy_commit(&State);
+	spi_flash_simulation_reset_stats();
+
+	for (uint32_t n = 1; n <= COMMITS; n++) {
+		change_state(&State, n);
+		legacy_commit(&State);
+	}
+
+	print_wear("old");
+
+	flash_open(true);
+	quiet(true);
+	SpiFlashStore *pStore = new SpiFlashStore;
+	quiet(false);
+	make_state(&State, 0);
+	store_commit(pStore, &State);
+	spi_flash_simulation_reset_stats();
+
+	for (uint32_t n = 1; n <= COMMITS; n++) {
+		change_state(&State, n);
+		store_commit(pStore, &State);
+	}
+
+	print_wear("new");
+	delete pStore;
+
+	spi_flash_simulation_reset_stats();
+	quiet(true);
+	pStore = new SpiFlashStore;
+	quiet(false);
+	spi_flash_simulation_get_stats(&Stats);
+	store_load(pStore, &Loaded);
+	delete pStore;
+
+	printf("  cold boot reads %u bytes instead of %d\n", Stats.bytes_read, SECTOR_SIZE);
+
+	if (!is_equal(&Loaded, &State)) {
+		printf("FAIL: the stores after the cold boot are not the last commit\n");
+		s_nErrors++;
+	}
+}
+
+/*
+ * The power fails during the n-th flash operation of CUT_COMMITS commits, for
+ * every n until the commits complete. At the next boot the settings must be
+ * those of the last completed commit, or of the interrupted one.
+ */
+static void test_power_loss(bool IsLegacy) {
+	uint32_t nCutPoints = 0;
+	uint32_t nGood = 0;
+
+	for (uint32_t nOperation = 1; ; nOperation++) {
+		struct TState State, Previous, Loaded;
+		SpiFlashStore *pStore = 0;
+
+		flash_open(true);
+		make_state(&State, 0);
+
+		quiet(true);
+		if (IsLegacy) {
+			legacy_commit(&State);
+		} else {
+			pStore = new SpiFlashStore;
+			store_commit(pStore, &State);
+		}
+
+		spi_flash_simulation_power_fail(nOperation);
+
+		for (uint32_t n = 1; (n <= CUT_COMMITS) && spi_flash_simulation_is_powered(); n++) {
+			Previous = State;
+			change_state(&State, n);
+
+			if (IsLegacy) {
+				legacy_commit(&State);
+			} else {
+				store_commit(pStore, &State);
+			}
+		}
+
+		delete pStore;
+
+		const bool IsCut = !spi_flash_simulation_is_powered();
+
+		if (!IsCut) {
+			quiet(false);
+			break;
+		}
+
+		nCutPoints++;
+
+		// The board powers up again
+		flash_open(false);
+
+		bool IsValid;
+
+		if (IsLegacy) {
+			IsValid = legacy_load(&Loaded);
+		} else {
+			pStore = new SpiFlashStore;
+			store_load(pStore, &Loaded);
+			delete pStore;
+			IsValid = true;
+		}
+		quiet(false);
+
+		if (IsValid && (is_equal(&Loaded, &State) || is_equal(&Loaded, &Previous))) {
+			nGood++;
+		}
+	}
+
+	printf("  %s: %u of %u cut points booted to the last or the interrupted commit\n", IsLegacy ? "old" : "new", nGood, nCutPoints);
+
+	if (!IsLegacy && (nGood != nCutPoints)) {
+		printf("FAIL: settings lost or corrupt after a power loss\n");
+		s_nErrors++;
+	}
+}
+
+static void test_import(void) {
+	struct TState State, Loaded;
+
+	flash_open(true);
+	make_state(&State, 42);
+	legacy_commit(&State);
+	spi_flash_simulation_reset_stats();
+
+	quiet(true);
+	SpiFlashStore *pStore = new SpiFlashStore;
+	store_load(pStore, &Loaded);
+	pStore->Commit();
+	delete pStore;
+
+	pStore = new SpiFlashStore;
+	quiet(false);
+
+	if (!is_equal(&Loaded, &State)) {
+		printf("FAIL: the old format is not imported\n");
+		s_nErrors++;
+	}
+
+	store_load(pStore, &Loaded);
+	delete pStore;
+
+	if (!is_equal(&Loaded, &State)) {
+		printf("FAIL: the stores are lost after the conversion\n");
+		s_nErrors++;
+	}
+
+	struct spi_flash_simulation_stats Stats;
+	spi_flash_simulation_get_stats(&Stats);
+
+	printf("The old format imports, the conversion needs %u erase(s)\n", Stats.erases);
+}
+
+int main(int argc, char **argv) {
+	HardwareLinux hw;
+
+	test_wear();
+
+	printf("Power cut at every flash operation of %d commits:\n", CUT_COMMITS);
+
+	test_power_loss(true);
+	test_power_loss(false);
+
+	test_import();
+
+	spi_flash_simulation_close();
+	unlink(FILE_NAME);
+
+	printf("store_bench: %d errors\n", s_nErrors);
+
+	return (s_nErrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -37,7 +37,14 @@
 #endif
 #include "storee131.h"
 
-#define SPI_FLASH_STORE_SIZE	4096
+#include "reboothandler.h"
+
+#include "spiflashstorelayout.h"
+
+#define SPI_FLASH_STORE_QUIET_MILLIS		1000	///< Default, a commit waits until the changes stop for this long
+#define SPI_FLASH_STORE_DEFER_MAX_MILLIS	10000	///< A commit is not deferred longer than this after the first change
+
+#define SPI_FLASH_STORE_RECORD_SIZE_MAX		(8 + 144)	///< Record header and the largest store
 
 enum TStore {
 	STORE_NETWORK,
@@ -51,10 +58,19 @@ enum TStore {
 enum TStoreState {
 	STORE_STATE_IDLE,
 	STORE_STATE_CHANGED,
-	STORE_STATE_ERASED
+	STORE_STATE_ERASING,
+	STORE_STATE_WRITING
 };
 
-class SpiFlashStore {
+struct TSpiFlashStoreStats {
+	uint32_t nCommits;	///< Flash updates, appended or rotated
+	uint32_t nRecords;	///< Records written
+	uint32_t nErases;	///< Sector rotations
+	uint32_t nCoalesced;///< Changes that joined a commit that was already pending
+	uint32_t nDeferred;	///< Changes during a running commit, they go into the next one
+};
+
+class SpiFlashStore: public RebootHandler {
 public:
 	SpiFlashStore(void);
 	~SpiFlashStore(void);
@@ -72,10 +88,41 @@ public:
 	void UuidUpdate(const uuid_t uuid);
 	void UuidCopyTo(uuid_t uuid);
 
+	/**
+	 * Runs one step of the commit state machine, call it from the main loop.
+	 * A commit starts after the quiet period, or SPI_FLASH_STORE_DEFER_MAX_MILLIS after the first change.
+	 * A step is a status read, one sector erase command or one page program of at most 128 bytes,
+	 * the flash chip is never waited for.
+	 * @return true when the commit is in progress
+	 */
 	bool Flash(void);
 
+	/**
+	 * Writes the pending changes now, blocking until the flash is updated.
+	 * Call it before a reboot or power off, the quiet period is not waited for.
+	 */
+	void Commit(void);
+
+	/**
+	 * \ref RebootHandler, commits the pending changes
+	 */
+	void Run(void) {
+		Commit();
+	}
+
+	inline void SetQuietMillis(uint32_t nQuietMillis) {
+		m_nQuietMillis = nQuietMillis;
+	}
+	inline uint32_t GetQuietMillis(void) const {
+		return m_nQuietMillis;
+	}
+
 	void Dump(void);
 
+	inline void GetStats(struct TSpiFlashStoreStats *pStats) const {
+		*pStats = m_tStats;
+	}
+
 	inline StoreNetwork *GetStoreNetwork(void) {
 		return &m_StoreNetwork;
 	}
@@ -97,6 +144,15 @@ public:
 private:
 	bool Init(void);
 	uint32_t GetStoreOffset(enum TStore tStore);
+	uint32_t GetRecordOffset(uint32_t nRecord);
+	uint32_t GetRecordSize(uint32_t nRecord);
+
+	void ScanSector(void);
+	void SetChanged(uint32_t nRecord);
+	void BeginCommit(void);
+	void EndCommit(void);
+	bool NextRecord(void);
+	bool WriteChunk(void);
 
 public:
 	inline static SpiFlashStore* Get(void) { return s_pThis; }
@@ -107,10 +163,28 @@ private:
 private:
 	bool m_bHaveFlashChip;
 	bool m_bIsNew;
+	bool m_bRotate;
 	uint32_t m_nStartAddress;
 	uint8_t m_aSpiFlashData[SPI_FLASH_STORE_SIZE];
 	uint32_t m_nSpiFlashStoreSize;
 	TStoreState m_tState;
+	uint32_t m_nDirty;			///< One bit per record, the stores and the signature/UUID
+	uint32_t m_nSector;			///< Active sector of the log
+	uint32_t m_nWriteOffset;	///< Next record in the active sector
+	uint32_t m_nGeneration;		///< Of the active sector
+	uint32_t m_nSequence;		///< Of the last record
+	uint32_t m_nQuietMillis;
+	uint32_t m_nChangedMillis;	///< Last change
+	uint32_t m_nPendingMillis;	///< First change that is not committed
+	bool m_bCommitNow;			///< No deferral, for Commit
+	bool m_bCommitRotate;		///< The commit goes to a new sector, its header is written last
+	uint32_t m_nCommitRecords;	///< Still to write in the running commit
+	uint32_t m_nCommitAddress;	///< Sector of the running commit
+	uint8_t m_aRecord[SPI_FLASH_STORE_RECORD_SIZE_MAX];
+	uint32_t m_nRecordLength;
+	uint32_t m_nRecordWritten;
+	bool m_bWritingHeader;		///< m_aRecord holds the sector header, not a record
+	struct TSpiFlashStoreStats m_tStats;
 
 	StoreNetwork m_StoreNetwork;
 	StoreArtNet m_StoreArtNet;
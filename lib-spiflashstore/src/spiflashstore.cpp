@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <uuid/uuid.h>
 #include <assert.h>
 
@@ -32,6 +33,8 @@
 
 #include "spi_flash.h"
 
+#include "hardware.h"
+
 #include "debug.h"
 
 static const uint8_t s_aSignature[] = {'A', 'v', 'V', 0x10};
@@ -43,13 +46,108 @@ static const uint32_t s_aStorSize[STORE_LAST] = {96, 144, 32, 32, 96};
 static const char s_aStoreName[STORE_LAST][12] = {"Network", "Art-Net", "DMX Send", "SPI", "E1.31"};
 #endif
 
+/*
+ * The stores are kept as an append-only log of records in the last
+ * SPI_FLASH_STORE_SECTORS sectors. A sector starts with a snapshot of all
+ * records, its header is written last and commits it. Changes are appended
+ * as records of the changed stores. When the active sector is full, the
+ * snapshot goes to the next sector, which is the oldest one.
+ * At boot only the active sector is read.
+ */
+
+#define SECTOR_MAGIC		0x4C567641	///< "AvVL"
+
+#define RECORD_SIGNATURE	STORE_LAST	///< The signature and the UUID
+#define RECORDS				(STORE_LAST + 1)
+#define RECORDS_ALL			((1U << RECORDS) - 1)
+
+struct TSectorHeader {
+	uint32_t nMagic;
+	uint32_t nGeneration;
+	uint16_t nCrc;
+	uint16_t nReserved;
+};
+
+struct TRecordHeader {
+	uint8_t nRecord;
+	uint8_t nLength;
+	uint16_t nCrc;
+	uint32_t nSequence;
+};
+
+#define RECORD_BUFFER_SIZE	SPI_FLASH_STORE_RECORD_SIZE_MAX
+
+#define PAGE_SIZE			256
+#define CHUNK_SIZE_MAX		128	///< Bytes per page program step
+
+// CRC-16/CCITT-FALSE
+static uint16_t crc16(uint16_t nCrc, const uint8_t *pData, uint32_t nLength) {
+	for (uint32_t i = 0; i < nLength; i++) {
+		nCrc ^= (uint16_t) pData[i] << 8;
+
+		for (uint32_t j = 0; j < 8; j++) {
+			nCrc = (nCrc & 0x8000) ? (uint16_t) ((nCrc << 1) ^ 0x1021) : (uint16_t) (nCrc << 1);
+		}
+	}
+
+	return nCrc;
+}
+
+static uint16_t record_crc(const struct TRecordHeader *pRecord, const uint8_t *pPayload) {
+	uint16_t nCrc = crc16(0xFFFF, &pRecord->nRecord, 2);
+	nCrc = crc16(nCrc, (const uint8_t *) &pRecord->nSequence, sizeof(pRecord->nSequence));
+
+	return crc16(nCrc, pPayload, pRecord->nLength);
+}
+
+static bool is_erased(const uint8_t *pData, uint32_t nLength) {
+	for (uint32_t i = 0; i < nLength; i++) {
+		if (pData[i] != 0xFF) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 SpiFlashStore *SpiFlashStore::s_pThis = 0;
 
-SpiFlashStore::SpiFlashStore(void): m_bHaveFlashChip(false), m_bIsNew(false), m_nStartAddress(0), m_nSpiFlashStoreSize(SPI_FLASH_STORE_SIZE), m_tState(STORE_STATE_IDLE) {
+SpiFlashStore::SpiFlashStore(void):
+	m_bHaveFlashChip(false),
+	m_bIsNew(false),
+	m_bRotate(false),
+	m_nStartAddress(0),
+	m_nSpiFlashStoreSize(OFFSET_STORES),
+	m_tState(STORE_STATE_IDLE),
+	m_nDirty(0),
+	m_nSector(0),
+	m_nWriteOffset(0),
+	m_nGeneration(0),
+	m_nSequence(0),
+	m_nQuietMillis(SPI_FLASH_STORE_QUIET_MILLIS),
+	m_nChangedMillis(0),
+	m_nPendingMillis(0),
+	m_bCommitNow(false),
+	m_bCommitRotate(false),
+	m_nCommitRecords(0),
+	m_nCommitAddress(0),
+	m_nRecordLength(0),
+	m_nRecordWritten(0),
+	m_bWritingHeader(false)
+{
 	DEBUG_ENTRY
 
 	s_pThis = this;
 
+	memset(&m_tStats, 0, sizeof(struct TSpiFlashStoreStats));
+
+	for (uint32_t j = 0; j < STORE_LAST; j++) {
+		m_nSpiFlashStoreSize += s_aStorSize[j];
+	}
+
+	DEBUG_PRINTF("OFFSET_STORES=%d", (int) OFFSET_STORES);
+	DEBUG_PRINTF("m_nSpiFlashStoreSize=%d", m_nSpiFlashStoreSize);
+
 	if (spi_flash_probe(0, 0, 0) < 0) {
 		DEBUG_PUTS("No SPI flash chip");
 	} else {
@@ -58,14 +156,8 @@ SpiFlashStore::SpiFlashStore(void): m_bHaveFlashChip(false), m_bIsNew(false), m_
 	}
 
 	if (m_bHaveFlashChip) {
-		m_nSpiFlashStoreSize = OFFSET_STORES;
-
-		for (uint32_t j = 0; j < STORE_LAST; j++) {
-			m_nSpiFlashStoreSize += s_aStorSize[j];
-		}
-
-		DEBUG_PRINTF("OFFSET_STORES=%d", (int) OFFSET_STORES);
-		DEBUG_PRINTF("m_nSpiFlashStoreSize=%d", m_nSpiFlashStoreSize);
+		assert(Hardware::Get() != 0);
+		m_nPendingMillis = m_nChangedMillis = Hardware::Get()->Millis();
 	}
 
 	DEBUG_EXIT
@@ -74,8 +166,7 @@ SpiFlashStore::SpiFlashStore(void): m_bHaveFlashChip(false), m_bIsNew(false), m_
 SpiFlashStore::~SpiFlashStore(void) {
 	DEBUG_ENTRY
 
-	while (Flash())
-		;
+	Commit();
 
 	DEBUG_EXIT
 }
@@ -88,14 +179,48 @@ bool SpiFlashStore::Init(void) {
 		return false;
 	}
 
-	m_nStartAddress = spi_flash_get_size() - nEraseSize;
+	assert((sizeof(struct TSectorHeader) + (RECORDS * sizeof(struct TRecordHeader)) + m_nSpiFlashStoreSize) <= SPI_FLASH_STORE_SIZE);
+	assert((sizeof(struct TRecordHeader) + s_aStorSize[STORE_ARTNET]) <= RECORD_BUFFER_SIZE);
+
+	m_nStartAddress = spi_flash_get_size() - (SPI_FLASH_STORE_SECTORS * nEraseSize);
 	assert(!(m_nStartAddress % nEraseSize));
 
 	if (m_nStartAddress % nEraseSize) {
 		return false;
 	}
 
-	spi_flash_cmd_read_fast(m_nStartAddress, (size_t) SPI_FLASH_STORE_SIZE, (void *) &m_aSpiFlashData);
+	// The active sector has the highest generation
+	bool bHaveLog = false;
+
+	for (uint32_t i = 0; i < SPI_FLASH_STORE_SECTORS; i++) {
+		struct TSectorHeader tHeader;
+
+		spi_flash_cmd_read_fast(m_nStartAddress + (i * SPI_FLASH_STORE_SIZE), sizeof(struct TSectorHeader), (void *) &tHeader);
+
+		if ((tHeader.nMagic != SECTOR_MAGIC) || (tHeader.nCrc != crc16(0xFFFF, (const uint8_t *) &tHeader, 8))) {
+			continue;
+		}
+
+		if (!bHaveLog || (tHeader.nGeneration > m_nGeneration)) {
+			bHaveLog = true;
+			m_nSector = i;
+			m_nGeneration = tHeader.nGeneration;
+		}
+	}
+
+	if (bHaveLog) {
+		DEBUG_PRINTF("m_nSector=%d, m_nGeneration=%d", m_nSector, m_nGeneration);
+
+		memset(m_aSpiFlashData, 0xFF, sizeof(m_aSpiFlashData));
+		ScanSector();
+	} else {
+		// The single sector store of earlier versions is in the last sector, it is erased last
+		m_nSector = SPI_FLASH_STORE_SECTORS - 1;
+		m_bRotate = true;
+		m_tState = STORE_STATE_CHANGED;
+
+		spi_flash_cmd_read_fast(m_nStartAddress + (m_nSector * SPI_FLASH_STORE_SIZE), (size_t) SPI_FLASH_STORE_SIZE, (void *) &m_aSpiFlashData);
+	}
 
 	bool bSignatureOK = true;
 
@@ -127,11 +252,67 @@ bool SpiFlashStore::Init(void) {
 		}
 
 		m_tState = STORE_STATE_CHANGED;
+		m_bRotate = true;
 	}
 
 	return true;
 }
 
+void SpiFlashStore::ScanSector(void) {
+	const uint32_t nSectorAddress = m_nStartAddress + (m_nSector * SPI_FLASH_STORE_SIZE);
+	uint8_t aBuffer[RECORD_BUFFER_SIZE];
+	uint32_t nOffset = sizeof(struct TSectorHeader);
+
+	m_bRotate = false;
+
+	while ((nOffset + sizeof(struct TRecordHeader)) <= SPI_FLASH_STORE_SIZE) {
+		struct TRecordHeader tRecord;
+
+		spi_flash_cmd_read_fast(nSectorAddress + nOffset, sizeof(struct TRecordHeader), (void *) &tRecord);
+
+		if (is_erased((const uint8_t *) &tRecord, sizeof(struct TRecordHeader))) {
+			break;
+		}
+
+		const uint32_t nEnd = nOffset + sizeof(struct TRecordHeader) + tRecord.nLength;
+
+		if ((tRecord.nRecord >= RECORDS) || (tRecord.nLength != GetRecordSize(tRecord.nRecord)) || (nEnd > SPI_FLASH_STORE_SIZE) || (tRecord.nSequence <= m_nSequence)) {
+			DEBUG_PRINTF("Invalid record at %d", nOffset);
+			m_bRotate = true;
+			break;
+		}
+
+		spi_flash_cmd_read_fast(nSectorAddress + nOffset + sizeof(struct TRecordHeader), tRecord.nLength, (void *) aBuffer);
+
+		if (tRecord.nCrc != record_crc(&tRecord, aBuffer)) {
+			DEBUG_PRINTF("CRC error at %d", nOffset);
+			m_bRotate = true;
+			break;
+		}
+
+		memcpy(&m_aSpiFlashData[GetRecordOffset(tRecord.nRecord)], aBuffer, tRecord.nLength);
+
+		m_nSequence = tRecord.nSequence;
+		nOffset = nEnd;
+	}
+
+	m_nWriteOffset = nOffset;
+
+	// A record that was interrupted can leave programmed bytes within one record length after the end of the log
+	if (!m_bRotate && (nOffset < SPI_FLASH_STORE_SIZE)) {
+		const uint32_t nLength = ((SPI_FLASH_STORE_SIZE - nOffset) < sizeof(aBuffer)) ? (SPI_FLASH_STORE_SIZE - nOffset) : sizeof(aBuffer);
+
+		spi_flash_cmd_read_fast(nSectorAddress + nOffset, nLength, (void *) aBuffer);
+
+		if (!is_erased(aBuffer, nLength)) {
+			DEBUG_PRINTF("Not erased at %d", nOffset);
+			m_bRotate = true;
+		}
+	}
+
+	DEBUG_PRINTF("m_nWriteOffset=%d, m_nSequence=%d, m_bRotate=%d", m_nWriteOffset, m_nSequence, (int) m_bRotate);
+}
+
 uint32_t SpiFlashStore::GetStoreOffset(enum TStore tStore) {
 	assert(tStore < STORE_LAST);
 
@@ -146,6 +327,24 @@ uint32_t SpiFlashStore::GetStoreOffset(enum TStore tStore) {
 	return nOffset;
 }
 
+uint32_t SpiFlashStore::GetRecordOffset(uint32_t nRecord) {
+	if (nRecord == RECORD_SIGNATURE) {
+		return 0;
+	}
+
+	return GetStoreOffset((enum TStore) nRecord);
+}
+
+uint32_t SpiFlashStore::GetRecordSize(uint32_t nRecord) {
+	assert(nRecord < RECORDS);
+
+	if (nRecord == RECORD_SIGNATURE) {
+		return OFFSET_STORES;
+	}
+
+	return s_aStorSize[nRecord];
+}
+
 void SpiFlashStore::Update(enum TStore tStore, uint32_t nOffset, void* pData, uint32_t nDataLength, uint32_t bSetList) {
 	DEBUG1_ENTRY
 
@@ -175,8 +374,8 @@ void SpiFlashStore::Update(enum TStore tStore, uint32_t nOffset, void* pData, ui
 		src++;
 	}
 
-	if (bIsChanged && (m_tState != STORE_STATE_ERASED)) {
-		m_tState = STORE_STATE_CHANGED;
+	if (bIsChanged) {
+		SetChanged(tStore);
 	}
 
 	if ((0 != nOffset) && (bIsChanged)) {
@@ -232,8 +431,8 @@ void SpiFlashStore::UuidUpdate(const uuid_t uuid) {
 		src++;
 	}
 
-	if (bIsChanged && (m_tState != STORE_STATE_ERASED)) {
-		m_tState = STORE_STATE_CHANGED;
+	if (bIsChanged) {
+		SetChanged(RECORD_SIGNATURE);
 	}
 }
 
@@ -265,33 +464,221 @@ void SpiFlashStore::Dump(void) {
 	}
 
 	printf("m_tState=%d\n", m_tState);
+	printf("Sector %d, generation %d, offset %d, sequence %d\n", m_nSector, m_nGeneration, m_nWriteOffset, m_nSequence);
+	printf("Commits %d, coalesced %d, deferred %d, erases %d\n", m_tStats.nCommits, m_tStats.nCoalesced, m_tStats.nDeferred, m_tStats.nErases);
 #endif
 }
 
+void SpiFlashStore::SetChanged(uint32_t nRecord) {
+	const uint32_t nMillis = Hardware::Get()->Millis();
+
+	if ((m_tState == STORE_STATE_ERASING) || (m_tState == STORE_STATE_WRITING)) {
+		m_tStats.nDeferred++;
+	} else {
+		if (m_nDirty != 0) {
+			m_tStats.nCoalesced++;
+		}
+		m_tState = STORE_STATE_CHANGED;
+	}
+
+	if (m_nDirty == 0) {
+		m_nPendingMillis = nMillis;
+	}
+
+	m_nChangedMillis = nMillis;
+	m_nDirty |= (1U << nRecord);
+}
+
+void SpiFlashStore::BeginCommit(void) {
+	uint32_t nLength = 0;
+
+	for (uint32_t i = 0; i < RECORDS; i++) {
+		if (m_nDirty & (1U << i)) {
+			nLength += sizeof(struct TRecordHeader) + GetRecordSize(i);
+		}
+	}
+
+	m_nCommitRecords = m_nDirty;
+	m_nDirty = 0;
+	m_nRecordLength = 0;
+	m_nRecordWritten = 0;
+	m_bWritingHeader = false;
+
+	if (!m_bRotate && ((m_nWriteOffset + nLength) <= SPI_FLASH_STORE_SIZE)) {
+		// Append the changed stores
+		m_bCommitRotate = false;
+		m_nCommitAddress = m_nStartAddress + (m_nSector * SPI_FLASH_STORE_SIZE);
+		m_tState = STORE_STATE_WRITING;
+		return;
+	}
+
+	// The next sector is the oldest one, it gets a snapshot
+	m_bCommitRotate = true;
+	m_nCommitRecords = RECORDS_ALL;
+	m_nSector = (m_nSector + 1) % SPI_FLASH_STORE_SECTORS;
+	m_nCommitAddress = m_nStartAddress + (m_nSector * SPI_FLASH_STORE_SIZE);
+
+	spi_flash_cmd_erase(m_nCommitAddress, (size_t) SPI_FLASH_STORE_SIZE);
+
+	m_tStats.nErases++;
+	m_tState = STORE_STATE_ERASING;
+}
+
+void SpiFlashStore::EndCommit(void) {
+	if (m_bCommitRotate) {
+		m_bRotate = false;
+	}
+
+	m_tStats.nCommits++;
+	m_tState = (m_nDirty != 0) ? STORE_STATE_CHANGED : STORE_STATE_IDLE;
+
+	Dump();
+}
+
+bool SpiFlashStore::NextRecord(void) {
+	if (m_nCommitRecords == 0) {
+		if (!m_bCommitRotate || m_bWritingHeader) {
+			return false;
+		}
+
+		// The snapshot is complete, the header commits the sector
+		struct TSectorHeader *pHeader = (struct TSectorHeader *) m_aRecord;
+
+		pHeader->nMagic = SECTOR_MAGIC;
+		pHeader->nGeneration = m_nGeneration;
+		pHeader->nCrc = crc16(0xFFFF, (const uint8_t *) pHeader, 8);
+		pHeader->nReserved = 0xFFFF;
+
+		m_nRecordLength = sizeof(struct TSectorHeader);
+		m_nRecordWritten = 0;
+		m_bWritingHeader = true;
+
+		return true;
+	}
+
+	const uint32_t nRecord = (uint32_t) __builtin_ctz(m_nCommitRecords);
+	m_nCommitRecords &= ~(1U << nRecord);
+
+	struct TRecordHeader *pRecord = (struct TRecordHeader *) m_aRecord;
+	uint8_t *pPayload = &m_aRecord[sizeof(struct TRecordHeader)];
+
+	pRecord->nRecord = (uint8_t) nRecord;
+	pRecord->nLength = (uint8_t) GetRecordSize(nRecord);
+	pRecord->nSequence = ++m_nSequence;
+
+	memcpy(pPayload, &m_aSpiFlashData[GetRecordOffset(nRecord)], pRecord->nLength);
+
+	pRecord->nCrc = record_crc(pRecord, pPayload);
+
+	m_nRecordLength = sizeof(struct TRecordHeader) + pRecord->nLength;
+	m_nRecordWritten = 0;
+
+	assert((m_nWriteOffset + m_nRecordLength) <= SPI_FLASH_STORE_SIZE);
+
+	return true;
+}
+
+bool SpiFlashStore::WriteChunk(void) {
+	// The sector header is at the start of the sector, the records are appended
+	const uint32_t nAddress = m_nCommitAddress + (m_bWritingHeader ? m_nRecordWritten : m_nWriteOffset);
+	uint32_t nLength = m_nRecordLength - m_nRecordWritten;
+
+	if (nLength > CHUNK_SIZE_MAX) {
+		nLength = CHUNK_SIZE_MAX;
+	}
+
+	if (nLength > (PAGE_SIZE - (nAddress % PAGE_SIZE))) {
+		nLength = PAGE_SIZE - (nAddress % PAGE_SIZE);
+	}
+
+	if (spi_flash_cmd_write_multi(nAddress, (size_t) nLength, (const void *) &m_aRecord[m_nRecordWritten]) < 0) {
+		return false;
+	}
+
+	m_nRecordWritten += nLength;
+
+	if (!m_bWritingHeader) {
+		m_nWriteOffset += nLength;
+
+		if (m_nRecordWritten == m_nRecordLength) {
+			m_tStats.nRecords++;
+		}
+	}
+
+	return true;
+}
+
+void SpiFlashStore::Commit(void) {
+	DEBUG_ENTRY
+
+	m_bCommitNow = true;
+
+	while (Flash())
+		;
+
+	m_bCommitNow = false;
+
+	DEBUG_EXIT
+}
+
 bool SpiFlashStore::Flash(void) {
 	if (__builtin_expect((m_tState == STORE_STATE_IDLE), 1)) {
 		return false;
 	}
 
-	DEBUG_PRINTF("m_tState=%d", m_tState);
-
 	assert(m_nStartAddress != 0);
 
 	switch (m_tState) {
 		case STORE_STATE_CHANGED:
-			spi_flash_cmd_erase(m_nStartAddress, (size_t) SPI_FLASH_STORE_SIZE);
-			m_tState = STORE_STATE_ERASED;
+			if (!m_bCommitNow) {
+				const uint32_t nMillis = Hardware::Get()->Millis();
+
+				if (((nMillis - m_nChangedMillis) < m_nQuietMillis) && ((nMillis - m_nPendingMillis) < SPI_FLASH_STORE_DEFER_MAX_MILLIS)) {
+					return false;
+				}
+			}
+
+			if (spi_flash_is_busy()) {
+				return true;
+			}
+
+			DEBUG_PRINTF("m_nDirty=%x", m_nDirty);
+
+			BeginCommit();
+			return true;
+			break;
+		case STORE_STATE_ERASING:
+			if (spi_flash_is_busy()) {
+				return true;
+			}
+
+			m_nWriteOffset = sizeof(struct TSectorHeader);
+			m_nGeneration++;
+			m_tState = STORE_STATE_WRITING;
 			return true;
 			break;
-		case STORE_STATE_ERASED:
-			spi_flash_cmd_write_multi(m_nStartAddress, (size_t) m_nSpiFlashStoreSize, (const void *)&m_aSpiFlashData);
-			m_tState = STORE_STATE_IDLE;
+		case STORE_STATE_WRITING:
+			if (spi_flash_is_busy()) {
+				return true;
+			}
+
+			if ((m_nRecordWritten == m_nRecordLength) && !NextRecord()) {
+				EndCommit();
+				return m_bCommitNow && (m_tState != STORE_STATE_IDLE);
+			}
+
+			if (!WriteChunk()) {
+				// Start over in a fresh sector
+				m_bRotate = true;
+				m_nDirty |= RECORDS_ALL;
+				m_tState = STORE_STATE_CHANGED;
+			}
+
+			return true;
 			break;
 		default:
 			break;
 	}
 
-	Dump();
-
 	return false;
 }
@@ -0,0 +1,47 @@
+/**
+ * @file bcm2835.h
+ *
+ * The part of the libbcm2835 API used by WS28XXStripe on Linux, so that
+ * ws28xxstripe_test builds without the library. The test implements the functions.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BCM2835_H_
+#define BCM2835_H_
+
+#include <stdint.h>
+
+#define BCM2835_CORE_CLK_HZ		250000000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int bcm2835_spi_begin(void);
+extern void bcm2835_spi_setClockDivider(uint16_t);
+extern void bcm2835_spi_writenb(const char *, uint32_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BCM2835_H_ */
@@ -0,0 +1,226 @@
+/**
+ * @file ws28xxstripe_test.cpp
+ *
+ * Checks the table based SetLED and SetLEDs against the per-bit encoder they replaced,
+ * for every LED type, and times the three for 680 WS2812B LEDs.
+ * The SPI functions are replaced, so that the encoded frame can be read back from Update.
+ */
+/* Copyright (C) 2026 by agent mailto:agent@local
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ws28xxstripe.h"
+
+#define LED_COUNT		170		///< One universe of RGB
+#define BENCH_LED_COUNT	680		///< 4 universes of RGB
+#define BENCH_FRAMES	2000
+
+static uint8_t s_SpiData[BENCH_LED_COUNT * 4 * 8];
+static uint32_t s_nSpiLength;
+static volatile uint8_t s_nSink;
+
+extern "C" {
+int bcm2835_spi_begin(void) {
+	return 1;
+}
+
+void bcm2835_spi_setClockDivider(uint16_t nDivider) {
+}
+
+void bcm2835_spi_writenb(const char *pBuffer, uint32_t nLength) {
+	if (nLength > sizeof(s_SpiData)) {
+		nLength = sizeof(s_SpiData);
+	}
+
+	memcpy(s_SpiData, pBuffer, nLength);
+	s_nSpiLength = nLength;
+}
+}
+
+static unsigned get_channels(TWS28XXType Type) {
+	return (Type == SK6812W) ? 4 : 3;
+}
+
+/*
+ * The per-bit encoder used before the table, with the colour order of SetLED
+ */
+static void encode_reference(uint8_t *pBuffer, TWS28XXType Type, const uint8_t *pData, unsigned nCount) {
+	const uint8_t nHighCode = (Type == WS2812B) ? 0xF8 : 0xF0;
+	const unsigned nChannels = get_channels(Type);
+
+	for (unsigned i = 0; i < nCount; i++) {
+		const uint8_t *pLED = &pData[i * nChannels];
+
+		if (Type == WS2801) {
+			memcpy(&pBuffer[i * 3], pLED, 3);
+			continue;
+		}
+
+		uint8_t values[4];
+
+		if (Type == WS2811) {
+			values[0] = pLED[0];
+			values[1] = pLED[1];
+		} else {
+			values[0] = pLED[1];
+			values[1] = pLED[0];
+		}
+
+		values[2] = pLED[2];
+		values[3] = (nChannels == 4) ? pLED[3] : 0;
+
+		unsigned nOffset = i * nChannels * 8;
+
+		for (unsigned nChannel = 0; nChannel < nChannels; nChannel++) {
+			for (uint8_t nMask = 0x80; nMask != 0; nMask >>= 1) {
+				pBuffer[nOffset++] = (values[nChannel] & nMask) ? nHighCode : 0xC0;
+			}
+		}
+	}
+}
+
+static bool is_equal(const uint8_t *pReference, uint32_t nLength) {
+	return (s_nSpiLength == nLength) && (memcmp(s_SpiData, pReference, nLength) == 0);
+}
+
+static int test(void) {
+	static const TWS28XXType types[] = {WS2801, WS2811, WS2812, WS2812B, WS2813, SK6812, SK6812W};
+	static uint8_t data[LED_COUNT * 4];
+	static uint8_t reference[LED_COUNT * 4 * 8];
+	int nErrors = 0;
+
+	for (unsigned i = 0; i < sizeof(data); i++) {
+		data[i] = (uint8_t) ((i * 37) ^ (i >> 3));
+	}
+
+	for (unsigned t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+		const TWS28XXType Type = types[t];
+		const unsigned nChannels = get_channels(Type);
+		const uint32_t nLength = LED_COUNT * nChannels * ((Type == WS2801) ? 1 : 8);
+
+		encode_reference(reference, Type, data, LED_COUNT);
+
+		WS28XXStripe stripe(Type, LED_COUNT);
+
+		for (unsigned i = 0; i < LED_COUNT; i++) {
+			const uint8_t *pLED = &data[i * nChannels];
+
+			if (nChannels == 4) {
+				stripe.SetLED(i, pLED[0], pLED[1], pLED[2], pLED[3]);
+			} else {
+				stripe.SetLED(i, pLED[0], pLED[1], pLED[2]);
+			}
+		}
+
+		stripe.Update();
+
+		if (!is_equal(reference, nLength)) {
+			printf("Type %u: SetLED differs\n", (unsigned) Type);
+			nErrors++;
+		}
+
+		WS28XXStripe stripe_run(Type, LED_COUNT);
+
+		// In two runs, so that the LED index is used
+		stripe_run.SetLEDs(0, data, LED_COUNT / 2);
+		stripe_run.SetLEDs(LED_COUNT / 2, &data[(LED_COUNT / 2) * nChannels], LED_COUNT - LED_COUNT / 2);
+		stripe_run.Update();
+
+		if (!is_equal(reference, nLength)) {
+			printf("Type %u: SetLEDs differs\n", (unsigned) Type);
+			nErrors++;
+		}
+	}
+
+	return nErrors;
+}
+
+static double nanos(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static void benchmark(void) {
+	static uint8_t data[BENCH_LED_COUNT * 3];
+	static uint8_t buffer[BENCH_LED_COUNT * 3 * 8];
+	WS28XXStripe stripe(WS2812B, BENCH_LED_COUNT);
+
+	for (unsigned i = 0; i < sizeof(data); i++) {
+		data[i] = (uint8_t) (i * 13);
+	}
+
+	// One value changes per frame, so that no loop is hoisted
+	double fStart = nanos();
+
+	for (unsigned nFrame = 0; nFrame < BENCH_FRAMES; nFrame++) {
+		data[nFrame % sizeof(data)]++;
+		encode_reference(buffer, WS2812B, data, BENCH_LED_COUNT);
+	}
+
+	const double fReference = nanos() - fStart;
+
+	fStart = nanos();
+
+	for (unsigned nFrame = 0; nFrame < BENCH_FRAMES; nFrame++) {
+		data[nFrame % sizeof(data)]++;
+		for (unsigned i = 0; i < BENCH_LED_COUNT; i++) {
+			stripe.SetLED(i, data[i * 3], data[i * 3 + 1], data[i * 3 + 2]);
+		}
+	}
+
+	const double fSetLED = nanos() - fStart;
+
+	fStart = nanos();
+
+	for (unsigned nFrame = 0; nFrame < BENCH_FRAMES; nFrame++) {
+		data[nFrame % sizeof(data)]++;
+		stripe.SetLEDs(0, data, BENCH_LED_COUNT);
+	}
+
+	const double fSetLEDs = nanos() - fStart;
+
+	s_nSink = buffer[5];
+
+	printf("%u WS2812B LEDs, per frame:\n", BENCH_LED_COUNT);
+	printf("  bit loop        %5.1f us\n", fReference / BENCH_FRAMES / 1000);
+	printf("  SetLED + table  %5.1f us\n", fSetLED / BENCH_FRAMES / 1000);
+	printf("  SetLEDs         %5.1f us\n", fSetLEDs / BENCH_FRAMES / 1000);
+}
+
+int main(int argc, char **argv) {
+	const int nErrors = test();
+
+	printf("ws28xxstripe_test: %d errors\n", nErrors);
+
+	if ((argc > 1) && (strcmp(argv[1], "-b") == 0)) {
+		benchmark();
+	}
+
+	return (nErrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
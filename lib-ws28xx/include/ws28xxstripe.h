@@ -69,6 +69,7 @@ public:
 
 	void SetLED(unsigned nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue);					// nIndex is 0-based
 	void SetLED(unsigned nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite);	// nIndex is 0-based
+	void SetLEDs(unsigned nLEDIndex, const uint8_t *pData, unsigned nCount);						// pData holds RGB or RGBW (SK6812W) per LED
 
 	void Update(void);
 	void Blackout(void);
@@ -76,6 +77,14 @@ public:
 #if defined (__circle__)
 	// returns TRUE while DMA operation is active
 	bool IsUpdating (void) const;
+
+	// Update() calls that had to wait for the previous frame, and the total time waited
+	inline uint32_t GetWaitCount(void) const {
+		return m_nWaitCount;
+	}
+	inline uint32_t GetWaitMicros(void) const {
+		return m_nWaitMicros;
+	}
 #else
 	inline 	bool IsUpdating (void) const {
 		return false;
@@ -84,6 +93,9 @@ public:
 
 private:
 	void SetColorWS28xx(unsigned nOffset, uint8_t nValue);
+	void InitLut(void);
+	template<unsigned nChannels, unsigned nFirst, unsigned nSecond>
+	void EncodeLEDs(unsigned nOffset, const uint8_t *pData, unsigned nCount);
 
 #if defined (__circle__)
 private:
@@ -95,12 +107,16 @@ private:
 	TWS28XXType			m_Type;
 	unsigned			m_nLEDCount;
 	unsigned			m_nBufSize;
-	uint8_t				*m_pBuffer;
+	uint8_t				*m_pBuffer;			///< Back buffer, SetLED() encodes into this one
 	uint8_t				*m_pBlackoutBuffer;
 	volatile bool	 	m_bUpdating;
 	uint8_t				m_nHighCode;
+	uint64_t			m_aLut[256];	///< SPI pattern for each colour value, MSB first
 #if defined (__circle__)
+	uint8_t				*m_pFrontBuffer;	///< Clocked out by DMA
 	uint8_t				*m_pReadBuffer;
+	uint32_t			m_nWaitCount;
+	uint32_t			m_nWaitMicros;
 	CSPIMasterDMA	 	m_SPIMaster;
 #endif
 };
@@ -30,6 +30,7 @@
 #include <assert.h>
 
 #include <circle/logger.h>
+#include <circle/timer.h>
 #include <circle/util.h>
 
 #include "ws28xxstripe.h"
@@ -39,6 +40,8 @@ WS28XXStripe::WS28XXStripe (CInterruptSystem *pInterruptSystem, TWS28XXType Type
 	m_nLEDCount (nLEDCount),
 	m_bUpdating (FALSE),
 	m_nHighCode(Type == WS2812B ? 0xF8 : 0xF0),
+	m_nWaitCount(0),
+	m_nWaitMicros(0),
 	m_SPIMaster (pInterruptSystem, m_Type == WS2801 ? nClockSpeed : 6400000, 0, 0)
 {
 	assert(m_Type <= SK6812W);
@@ -54,6 +57,8 @@ WS28XXStripe::WS28XXStripe (CInterruptSystem *pInterruptSystem, TWS28XXType Type
 		m_nBufSize *= 8;
 	}
 
+	InitLut();
+
 	m_pBuffer = new u8[m_nBufSize];
 	assert(m_pBuffer != 0);
 
@@ -61,6 +66,10 @@ WS28XXStripe::WS28XXStripe (CInterruptSystem *pInterruptSystem, TWS28XXType Type
 		SetLED(nLEDIndex, 0, 0, 0);
 	}
 
+	m_pFrontBuffer = new u8[m_nBufSize];
+	assert(m_pFrontBuffer != 0);
+	memcpy(m_pFrontBuffer, m_pBuffer, m_nBufSize);
+
 	m_pReadBuffer = new u8[m_nBufSize];
 	assert(m_pReadBuffer != 0);
 
@@ -80,6 +89,9 @@ WS28XXStripe::~WS28XXStripe(void) {
 	delete[] m_pReadBuffer;
 	m_pReadBuffer = 0;
 
+	delete[] m_pFrontBuffer;
+	m_pFrontBuffer = 0;
+
 	delete[] m_pBuffer;
 	m_pBuffer = 0;
 }
@@ -89,14 +101,33 @@ bool WS28XXStripe::Initialize(void) {
 }
 
 void WS28XXStripe::Update(void) {
-	assert(!m_bUpdating);
+	if (m_bUpdating) {
+		const unsigned nStart = CTimer::GetClockTicks();
+
+		while (m_bUpdating) {
+			// wait for the previous frame
+		}
+
+		m_nWaitMicros += CTimer::GetClockTicks() - nStart;
+		m_nWaitCount++;
+	}
+
 	m_bUpdating = TRUE;
 
+	assert(m_pBuffer != 0);
+	assert(m_pFrontBuffer != 0);
+
+	u8 *pBuffer = m_pFrontBuffer;
+	m_pFrontBuffer = m_pBuffer;
+	m_pBuffer = pBuffer;
+
 	m_SPIMaster.SetCompletionRoutine(SPICompletionStub, this);
 
-	assert(m_pBuffer != 0);
 	assert(m_pReadBuffer != 0);
-	m_SPIMaster.StartWriteRead(0, m_pBuffer, m_pReadBuffer, m_nBufSize);
+	m_SPIMaster.StartWriteRead(0, m_pFrontBuffer, m_pReadBuffer, m_nBufSize);
+
+	// The back buffer must hold the complete frame, as callers only re-encode the LEDs that changed
+	memcpy(m_pBuffer, m_pFrontBuffer, m_nBufSize);
 }
 
 void WS28XXStripe::Blackout(void) {
@@ -53,6 +53,8 @@ WS28XXStripe::WS28XXStripe(TWS28XXType Type, uint16_t nLEDCount, uint32_t nClock
 		m_nBufSize *= 8;
 	}
 
+	InitLut();
+
 	m_pBuffer = new uint8_t[m_nBufSize];
 	assert(m_pBuffer != 0);
 	memset(m_pBuffer, m_Type == WS2801 ? 0 : 0xC0, m_nBufSize);
@@ -23,13 +23,34 @@
  * THE SOFTWARE.
  */
 
+#include <stdint.h>
 #include <assert.h>
 
+#if defined (__circle__)
+ #include <circle/util.h>
+#else
+ #include <string.h>
+#endif
+
 #include "ws28xxstripe.h"
 
-void WS28XXStripe::SetLED(unsigned nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue) {
-	assert(!m_bUpdating);
+#define WS28XX_LOW_CODE		0xC0	///< Same for all
+
+void WS28XXStripe::InitLut(void) {
+	for (unsigned nValue = 0; nValue < 256; nValue++) {
+		uint8_t aPattern[8];
+		uint8_t mask = 0x80;
+
+		for (unsigned i = 0; i < 8; i++) {
+			aPattern[i] = (nValue & mask) ? m_nHighCode : WS28XX_LOW_CODE;
+			mask >>= 1;
+		}
 
+		memcpy(&m_aLut[nValue], aPattern, sizeof(aPattern));
+	}
+}
+
+void WS28XXStripe::SetLED(unsigned nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue) {
 	assert(m_pBuffer != 0);
 	assert(nLEDIndex < m_nLEDCount);
 	unsigned nOffset = nLEDIndex * 3;
@@ -55,8 +76,6 @@ void WS28XXStripe::SetLED(unsigned nLEDIndex, uint8_t nRed, uint8_t nGreen, uint
 }
 
 void WS28XXStripe::SetLED(unsigned nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite) {
-	assert(!m_bUpdating);
-
 	assert(m_pBuffer != 0);
 	assert(nLEDIndex < m_nLEDCount);
 	assert(m_Type == SK6812W);
@@ -75,18 +94,47 @@ void WS28XXStripe::SetLED(unsigned nLEDIndex, uint8_t nRed, uint8_t nGreen, uint
 
 void WS28XXStripe::SetColorWS28xx(unsigned nOffset, uint8_t nValue) {
 	assert(m_Type != WS2801);
-	uint8_t mask;
-
 	assert(nOffset + 7 < m_nBufSize);
 
-	for (mask = 0x80; mask != 0; mask >>= 1) {
-		if (nValue & mask) {
-			m_pBuffer[nOffset] = m_nHighCode;
-		} else {
-			m_pBuffer[nOffset] = 0xC0;	// Same for all
+	memcpy(&m_pBuffer[nOffset], &m_aLut[nValue], sizeof(uint64_t));
+}
+
+template<unsigned nChannels, unsigned nFirst, unsigned nSecond>
+void WS28XXStripe::EncodeLEDs(unsigned nOffset, const uint8_t *pData, unsigned nCount) {
+	uint8_t *pDst = &m_pBuffer[nOffset];
+
+	for (unsigned i = 0; i < nCount; i++) {
+		memcpy(&pDst[0], &m_aLut[pData[nFirst]], sizeof(uint64_t));
+		memcpy(&pDst[8], &m_aLut[pData[nSecond]], sizeof(uint64_t));
+		memcpy(&pDst[16], &m_aLut[pData[2]], sizeof(uint64_t));
+
+		if (nChannels == 4) {
+			memcpy(&pDst[24], &m_aLut[pData[3]], sizeof(uint64_t));
 		}
 
-		nOffset++;
+		pDst += nChannels * 8;
+		pData += nChannels;
+	}
+}
+
+void WS28XXStripe::SetLEDs(unsigned nLEDIndex, const uint8_t *pData, unsigned nCount) {
+	assert(m_pBuffer != 0);
+	assert(pData != 0);
+	assert(nLEDIndex + nCount <= m_nLEDCount);
+
+	switch (m_Type) {
+	case WS2801:
+		memcpy(&m_pBuffer[nLEDIndex * 3], pData, nCount * 3);
+		break;
+	case WS2811:
+		EncodeLEDs<3, 0, 1>(nLEDIndex * 3 * 8, pData, nCount);
+		break;
+	case SK6812W:
+		EncodeLEDs<4, 1, 0>(nLEDIndex * 4 * 8, pData, nCount);
+		break;
+	default:
+		EncodeLEDs<3, 1, 0>(nLEDIndex * 3 * 8, pData, nCount);
+		break;
 	}
 }
 
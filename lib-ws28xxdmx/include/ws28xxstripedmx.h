@@ -49,6 +49,7 @@ public:
 	void Stop(uint8_t nPort = 0);
 
 	virtual void SetData(uint8_t nPort, const uint8_t *, uint16_t);
+	virtual void SetDataRange(uint8_t nPort, const uint8_t *, uint16_t, uint16_t nFirstSlot, uint16_t nLastSlot);
 
 	virtual void SetLEDType(TWS28XXType);
 	inline TWS28XXType GetLEDType(void) {
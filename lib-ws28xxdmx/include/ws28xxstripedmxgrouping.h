@@ -45,6 +45,7 @@ public:
 	~WS28xxStripeDmxGrouping(void);
 
 	void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLenght);
+	void SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nLenght, uint16_t nFirstSlot, uint16_t nLastSlot);
 
 	void SetLEDType(TWS28XXType tLedType);
 
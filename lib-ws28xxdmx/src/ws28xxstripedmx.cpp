@@ -89,9 +89,6 @@ void SPISend::Start(uint8_t nPort) {
 		assert(m_pLEDStripe != 0);
 		m_pLEDStripe->Initialize();
 	} else {
-		while (m_pLEDStripe->IsUpdating()) {
-			// wait for completion
-		}
 		m_pLEDStripe->Update();
 	}
 }
@@ -112,6 +109,14 @@ void SPISend::Stop(uint8_t nPort) {
 }
 
 void SPISend::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLength) {
+	if (nLength == 0) {
+		return;
+	}
+
+	SetDataRange(nPortId, pData, nLength, 0, nLength - 1);
+}
+
+void SPISend::SetDataRange(uint8_t nPortId, const uint8_t *pData, uint16_t nLength, uint16_t nFirstSlot, uint16_t nLastSlot) {
 	assert(pData != 0);
 	assert(nLength <= DMX_MAX_CHANNELS);
 
@@ -163,25 +168,22 @@ void SPISend::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLength) {
 #endif
 #endif
 
-	while (m_pLEDStripe->IsUpdating()) {
-		// wait for completion
+	// Only re-encode the LEDs covering the changed slots
+	if (nFirstSlot > i) {
+		const uint16_t nSkip = (nFirstSlot - i) / m_nChannelsPerLed;
+		beginIndex = beginIndex + nSkip;
+		i = i + nSkip * m_nChannelsPerLed;
 	}
 
-	for (uint16_t j = beginIndex; j < endIndex; j++) {
-		__builtin_prefetch(&pData[i]);
-		if (m_tLedType == SK6812W) {
-			if (i + 3 > nLength) {
-				break;
-			}
-			m_pLEDStripe->SetLED(j, pData[i], pData[i + 1], pData[i + 2], pData[i + 3]);
-			i = i + 4;
-		} else {
-			if (i + 2 > nLength) {
-				break;
-			}
-			m_pLEDStripe->SetLED(j, pData[i], pData[i + 1], pData[i + 2]);
-			i = i + 3;
-		}
+	if (nLastSlot < i) {
+		endIndex = beginIndex;
+	} else {
+		endIndex = MIN(endIndex, (uint16_t) (beginIndex + ((nLastSlot - i) / m_nChannelsPerLed) + 1));
+	}
+
+	if ((endIndex > beginIndex) && (i < nLength)) {
+		const uint16_t nCount = MIN((uint16_t) (endIndex - beginIndex), (uint16_t) ((nLength - i) / m_nChannelsPerLed));
+		m_pLEDStripe->SetLEDs(beginIndex, &pData[i], nCount);
 	}
 
 	if (bUpdate) {
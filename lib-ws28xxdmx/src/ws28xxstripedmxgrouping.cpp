@@ -48,15 +48,22 @@ WS28xxStripeDmxGrouping::WS28xxStripeDmxGrouping(void) {
 WS28xxStripeDmxGrouping::~WS28xxStripeDmxGrouping(void) {
 }
 
+void WS28xxStripeDmxGrouping::SetDataRange(uint8_t nPort, const uint8_t* pData, uint16_t nLenght, uint16_t nFirstSlot, uint16_t nLastSlot) {
+	const uint16_t nFirst = m_nDmxStartAddress - 1;
+	const uint16_t nChannels = (m_tLedType == SK6812W) ? 4 : 3;
+
+	if ((m_pLEDStripe != 0) && ((nLastSlot < nFirst) || (nFirstSlot >= nFirst + nChannels))) {
+		return;
+	}
+
+	SetData(nPort, pData, nLenght);
+}
+
 void WS28xxStripeDmxGrouping::SetData(uint8_t nPort, const uint8_t* pData, uint16_t nLenght) {
 	if (__builtin_expect((m_pLEDStripe == 0), 0)) {
 		Start();
 	}
 
-	while (m_pLEDStripe->IsUpdating()) {
-		// wait for completion
-	}
-
 	const uint8_t *p = pData + m_nDmxStartAddress - 1;
 	bool bIsChanged = false;
 
@@ -27,9 +27,15 @@
 
 #include "ws28xxstripeparams.h"
 #include "ws28xxstripedmx.h"
+#include "ws28xxstripe.h"
 
 void SPISend::Print(void) {
 	printf("Led stripe parameters\n");
 	printf(" Type  : %s [%d]\n", WS28XXStripeParams::GetLedTypeString(m_tLedType), m_tLedType);
 	printf(" Count : %d\n", (int) m_nLedCount);
+#if defined (__circle__)
+	if (m_pLEDStripe != 0) {
+		printf(" Wait  : %u (%u us)\n", (unsigned) m_pLEDStripe->GetWaitCount(), (unsigned) m_pLEDStripe->GetWaitMicros());
+	}
+#endif
 }
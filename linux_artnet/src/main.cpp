@@ -88,10 +88,9 @@ int main(int argc, char **argv) {
 		return -1;
 	}
 
-	node.SetUniverseSwitch(0, ARTNET_OUTPUT_PORT, artnetparams.GetUniverse());
-	node.SetUniverseSwitch(1, ARTNET_OUTPUT_PORT, artnetparams.GetUniverse() + 1);
-	node.SetUniverseSwitch(2, ARTNET_OUTPUT_PORT, artnetparams.GetUniverse() + 2);
-	node.SetUniverseSwitch(3, ARTNET_OUTPUT_PORT, artnetparams.GetUniverse() + 3);
+	for (uint32_t i = 0; i < node.GetMaxPorts(); i++) {
+		node.SetUniverseSwitch(i, ARTNET_OUTPUT_PORT, artnetparams.GetUniverse() + i);
+	}
 
 	node.SetOutput(&monitor);
 
@@ -122,7 +121,7 @@ int main(int argc, char **argv) {
 	node.Start();
 
 	for (;;) {
-		(void) node.HandlePacket();
+		(void) node.HandlePackets();
 		identify.Run();
 	}
 
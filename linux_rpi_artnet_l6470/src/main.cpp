@@ -109,13 +109,16 @@ int main(int argc, char **argv) {
 
 	node.SetUniverseSwitch(0, ARTNET_OUTPUT_PORT, artnetparams.GetUniverse());
 
+	SlushDmx *pSlushDmx = 0;
+	SparkFunDmx *pSparkFunDmx = 0;
+
 	if (board == BOARD_SLUSH) {
-		SlushDmx *pSlushDmx = new SlushDmx(false);	// Do not use SPI busy check
+		pSlushDmx = new SlushDmx(false);	// Do not use SPI busy check
 		assert(pSlushDmx != 0);
 		pSlushDmx->ReadConfigFiles();
 		pBoard = pSlushDmx;
 	} else {
-		SparkFunDmx *pSparkFunDmx = new SparkFunDmx;
+		pSparkFunDmx = new SparkFunDmx;
 		assert(pSparkFunDmx != 0);
 		pSparkFunDmx->ReadConfigFiles();
 		pBoard = pSparkFunDmx;
@@ -170,6 +173,12 @@ int main(int argc, char **argv) {
 	for (;;) {
 		(void) node.HandlePacket();
 		identify.Run();
+		// Busy motors get their pending target when they are free
+		if (pSlushDmx != 0) {
+			pSlushDmx->Run();
+		} else {
+			pSparkFunDmx->Run();
+		}
 	}
 
 	return 0;
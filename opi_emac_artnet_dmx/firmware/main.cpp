@@ -75,6 +75,7 @@ void notmain(void) {
 	}
 
 	SpiFlashStore spiFlashStore;
+	hw.SetRebootHandler(&spiFlashStore);
 	ArtNetParams artnetparams((ArtNetParamsStore *)spiFlashStore.GetStoreArtNet());
 #else
 	ArtNetParams artnetparams;
@@ -118,7 +119,7 @@ void notmain(void) {
 	nw.Print();
 
 	ArtNetNode node;
-	ArtNetRdmController discovery;
+	ArtNetRdmController discovery(artnetparams.GetRdmTodSize());
 
 	console_status(CONSOLE_YELLOW, NODE_PARMAS);
 	display.TextStatus(NODE_PARMAS);
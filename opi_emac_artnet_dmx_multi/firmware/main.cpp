@@ -65,6 +65,7 @@ void notmain(void) {
 	}
 
 	SpiFlashStore spiFlashStore;
+	hw.SetRebootHandler(&spiFlashStore);
 
 	ArtNetParams artnetparams((ArtNetParamsStore *)spiFlashStore.GetStoreArtNet());
 
@@ -193,7 +194,7 @@ void notmain(void) {
 		(void) display.Printf(7, "Active ports: %d", node.GetActiveOutputPorts());
 	}
 
-	ArtNetRdmController discovery;
+	ArtNetRdmController discovery(artnetparams.GetRdmTodSize());
 
 	if(artnetparams.IsRdm()) {
 		if (artnetparams.IsRdmDiscovery()) {
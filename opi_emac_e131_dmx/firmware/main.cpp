@@ -73,6 +73,7 @@ void notmain(void) {
 	}
 
 	SpiFlashStore spiFlashStore;
+	hw.SetRebootHandler(&spiFlashStore);
 	E131Params e131params((E131ParamsStore *)spiFlashStore.GetStoreE131());
 #else
 	E131Params e131params;
@@ -193,6 +194,9 @@ void notmain(void) {
 		nw.Run();
 		(void) bridge.Run();
 		lb.Run();
+#if defined (ORANGE_PI)
+		spiFlashStore.Flash();
+#endif
 	}
 }
 
@@ -81,13 +81,16 @@ void notmain(void) {
 
 	hw.SetLed(HARDWARE_LED_ON);
 
+	SlushDmx *pSlushDmx = 0;
+	SparkFunDmx *pSparkFunDmx = 0;
+
 	if (board == BOARD_SLUSH) {
-		SlushDmx *pSlushDmx = new SlushDmx(false);	// Do not use SPI busy check
+		pSlushDmx = new SlushDmx(false);	// Do not use SPI busy check
 		assert(pSlushDmx != 0);
 		pSlushDmx->ReadConfigFiles();
 		pBoard = pSlushDmx;
 	} else {
-		SparkFunDmx *pSparkFunDmx = new SparkFunDmx;
+		pSparkFunDmx = new SparkFunDmx;
 		assert(pSparkFunDmx != 0);
 		pSparkFunDmx->ReadConfigFiles();
 		pBoard = pSparkFunDmx;
@@ -143,6 +146,12 @@ void notmain(void) {
 		hw.WatchdogFeed();
 		(void) dmxrdm.Run();
 		lb.Run();
+		// Busy motors get their pending target when they are free
+		if (pSlushDmx != 0) {
+			pSlushDmx->Run();
+		} else {
+			pSparkFunDmx->Run();
+		}
 	}
 }
 
@@ -113,7 +113,7 @@ void notmain(void) {
 #endif
 	TimeCode timecode;
 	TimeSync timesync;
-	ArtNetRdmController discovery;
+	ArtNetRdmController discovery(artnetparams.GetRdmTodSize());
 
 	console_status(CONSOLE_YELLOW, "Setting Node parameters ...");
 	DISPLAY_CONNECTED(oled_connected, display.TextStatus("Setting Node parameters ..."));